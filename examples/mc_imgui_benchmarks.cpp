@@ -0,0 +1,827 @@
+// Copyright (c) 2012-2019 Matt Campbell
+// MIT license (see License.txt)
+
+#include "mc_imgui_benchmarks.h"
+
+#if defined(MC_IMGUI_BENCHMARKS)
+
+#include "imgui_column_sort.h"
+#include "imgui_column_table.h"
+#include "imgui_image_bc.h"
+#include "imgui_image_disk_cache.h"
+#include "imgui_image_file.h"
+#include "imgui_image_triple_buffer.h"
+#include "imgui_text_buffer.h"
+#include "imgui_utils.h"
+#include "message_box.h"
+#include "ui_message_box.h"
+#include "va.h"
+#include "wrap_imgui.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static u32 MC_Imgui_Benchmark_Rand(u32 *state)
+{
+	*state = *state * 1664525u + 1013904223u;
+	return *state >> 8;
+}
+
+static double MC_Imgui_Benchmark_ElapsedMs(LARGE_INTEGER start, LARGE_INTEGER end)
+{
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	return (double)(end.QuadPart - start.QuadPart) * 1000.0 / (double)frequency.QuadPart;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Image disk cache
+
+struct diskCacheBenchmark {
+	u32 numImages;
+	u32 numCached;
+	double coldMs; // stb_image decode + swizzle
+	double warmMs; // disk cache load
+	u64 pixelBytes;
+	u64 cacheBytes;
+};
+
+static diskCacheBenchmark s_diskCache;
+static bool s_diskCacheRan;
+
+// Times a cold decode against a warm cache load for each path.  Populates the cache as a side
+// effect, so it also pre-warms the cache directory.
+static diskCacheBenchmark MC_Imgui_Benchmark_DiskCache(const char *const *paths, u32 numPaths)
+{
+	diskCacheBenchmark result = { BB_EMPTY_INITIALIZER };
+	if(!*ImGui_ImageDiskCache_GetDirectory()) {
+		BB_WARNING("Benchmark", "Image cache benchmark requires a cache directory");
+		return result;
+	}
+	for(u32 i = 0; i < numPaths; ++i) {
+		int width = 0;
+		int height = 0;
+		LARGE_INTEGER start, end;
+		QueryPerformanceCounter(&start);
+		u8 *pixelData = ImGui_ImageFile_Load(paths[i], &width, &height);
+		QueryPerformanceCounter(&end);
+		if(!pixelData)
+			continue;
+		++result.numImages;
+		result.coldMs += MC_Imgui_Benchmark_ElapsedMs(start, end);
+		result.pixelBytes += (u64)width * (u64)height * sizeof(u32);
+		u64 bytesWritten = ImGui_ImageDiskCache_GetStats().bytesWritten;
+		ImGui_ImageDiskCache_Store(paths[i], pixelData, width, height);
+		result.cacheBytes += ImGui_ImageDiskCache_GetStats().bytesWritten - bytesWritten;
+		free(pixelData);
+
+		QueryPerformanceCounter(&start);
+		pixelData = ImGui_ImageDiskCache_Load(paths[i], &width, &height);
+		QueryPerformanceCounter(&end);
+		if(pixelData) {
+			++result.numCached;
+			result.warmMs += MC_Imgui_Benchmark_ElapsedMs(start, end);
+			free(pixelData);
+		}
+	}
+	BB_LOG("Benchmark", "Image cache benchmark: %u images, cold %.2f ms, warm %.2f ms (%u cached), %llu pixel bytes -> %llu cache bytes",
+	       result.numImages, result.coldMs, result.warmMs, result.numCached, result.pixelBytes, result.cacheBytes);
+	return result;
+}
+
+static void MC_Imgui_Benchmarks_DiskCache(void)
+{
+	if(ImGui::Button("Image disk cache")) {
+		static const char *s_paths[] = { R"(..\examples\mc_imgui_example.png)" };
+		s_diskCache = MC_Imgui_Benchmark_DiskCache(s_paths, BB_ARRAYSIZE(s_paths));
+		s_diskCacheRan = true;
+	}
+	if(s_diskCacheRan) {
+		ImGui::SameLine();
+		ImGui::Text("%u images: cold %.2f ms, warm %.2f ms (%u cached), %llu pixel bytes -> %llu cache bytes",
+		            s_diskCache.numImages, s_diskCache.coldMs, s_diskCache.warmMs, s_diskCache.numCached, s_diskCache.pixelBytes, s_diskCache.cacheBytes);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Streaming images
+
+struct streamBenchmark {
+	u32 width;
+	u32 height;
+	u32 framesPublished;
+	u32 framesConsumed;
+	double seconds;
+	double publishFps;
+	double consumeFps;
+	double copyMBps; // producer + consumer copy bandwidth
+};
+
+struct streamBenchmarkProducer {
+	tripleBuffer *tb;
+	const u8 *source;
+	volatile LONG stop;
+	u8 pad[4];
+};
+
+static streamBenchmark s_stream;
+static bool s_streamRan;
+
+static DWORD WINAPI MC_Imgui_Benchmark_StreamProducer(void *param)
+{
+	streamBenchmarkProducer *producer = (streamBenchmarkProducer *)param;
+	while(!producer->stop) {
+		memcpy(tripleBuffer_back(producer->tb), producer->source, (size_t)producer->tb->frameBytes);
+		tripleBuffer_publish(producer->tb);
+	}
+	return 0;
+}
+
+// Runs a producer thread against a consumer on the calling thread for the given duration, using
+// the triple buffer behind streaming images but copying into system memory instead of textures.
+static streamBenchmark MC_Imgui_Benchmark_Stream(int width, int height, double seconds)
+{
+	streamBenchmark result = { BB_EMPTY_INITIALIZER };
+	result.width = (u32)width;
+	result.height = (u32)height;
+	if(width <= 0 || height <= 0)
+		return result;
+
+	u64 frameBytes = (u64)width * (u64)height * 4;
+	tripleBuffer tb;
+	u8 *source = (u8 *)malloc((size_t)frameBytes);
+	u8 *dest = (u8 *)malloc((size_t)frameBytes);
+	if(tripleBuffer_init(&tb, frameBytes) && source && dest) {
+		for(u64 i = 0; i < frameBytes; ++i) {
+			source[i] = (u8)i;
+		}
+
+		streamBenchmarkProducer producer = { BB_EMPTY_INITIALIZER };
+		producer.tb = &tb;
+		producer.source = source;
+
+		LARGE_INTEGER frequency, start, now;
+		QueryPerformanceFrequency(&frequency);
+		QueryPerformanceCounter(&start);
+		HANDLE hThread = CreateThread(nullptr, 0, &MC_Imgui_Benchmark_StreamProducer, &producer, 0, nullptr);
+		if(hThread) {
+			// consumer: stands in for NewFrame's upload
+			do {
+				const u8 *pixelData = tripleBuffer_acquire(&tb);
+				if(pixelData) {
+					memcpy(dest, pixelData, (size_t)frameBytes);
+					++result.framesConsumed;
+				} else {
+					YieldProcessor();
+				}
+				QueryPerformanceCounter(&now);
+			} while((double)(now.QuadPart - start.QuadPart) < seconds * (double)frequency.QuadPart);
+			InterlockedExchange(&producer.stop, 1);
+			WaitForSingleObject(hThread, INFINITE);
+			CloseHandle(hThread);
+			QueryPerformanceCounter(&now);
+
+			result.seconds = (double)(now.QuadPart - start.QuadPart) / (double)frequency.QuadPart;
+			result.framesPublished = (u32)tb.published;
+			result.publishFps = result.framesPublished / result.seconds;
+			result.consumeFps = result.framesConsumed / result.seconds;
+			result.copyMBps = (double)(result.framesPublished + result.framesConsumed) * (double)frameBytes / (1024.0 * 1024.0) / result.seconds;
+		}
+	}
+	tripleBuffer_reset(&tb);
+	free(source);
+	free(dest);
+	BB_LOG("Benchmark", "Stream benchmark %ux%u: published %.1f fps, consumed %.1f fps, %.0f MB/s copied",
+	       result.width, result.height, result.publishFps, result.consumeFps, result.copyMBps);
+	return result;
+}
+
+static void MC_Imgui_Benchmarks_Stream(void)
+{
+	if(ImGui::Button("Streaming image")) {
+		s_stream = MC_Imgui_Benchmark_Stream(1920, 1080, 2.0);
+		s_streamRan = true;
+	}
+	if(s_streamRan) {
+		ImGui::SameLine();
+		ImGui::Text("%ux%u: published %.1f fps, consumed %.1f fps, %.0f MB/s copied",
+		            s_stream.width, s_stream.height, s_stream.publishFps, s_stream.consumeFps, s_stream.copyMBps);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Block compression
+
+struct bcBenchmark {
+	double encodeMs;
+	double megapixelsPerSecond;
+	double psnr;
+};
+
+static bcBenchmark s_bc[2][kBcQuality_Count];
+static bool s_bcRan;
+
+// Encodes iterations times and reports throughput, then decodes and reports PSNR.
+static bcBenchmark MC_Imgui_Benchmark_BC(bcFormat format, bcQuality quality, const u8 *bgra, u32 width, u32 height, u32 iterations)
+{
+	bcBenchmark result = { BB_EMPTY_INITIALIZER };
+	u8 *blocks = (u8 *)malloc((size_t)bc_encoded_size(format, width, height));
+	u8 *decoded = (u8 *)malloc((size_t)width * height * 4);
+	if(blocks && decoded && iterations) {
+		LARGE_INTEGER start, end;
+		QueryPerformanceCounter(&start);
+		for(u32 i = 0; i < iterations; ++i) {
+			bc_encode_image(format, quality, bgra, width, height, (s32)(width * 4), blocks);
+		}
+		QueryPerformanceCounter(&end);
+		result.encodeMs = MC_Imgui_Benchmark_ElapsedMs(start, end) / iterations;
+		if(result.encodeMs > 0.0) {
+			result.megapixelsPerSecond = (double)width * height / 1000.0 / result.encodeMs;
+		}
+		bc_decode_image(format, blocks, width, height, decoded);
+		result.psnr = bc_psnr(bgra, decoded, width, height, format == kBcFormat_BC3);
+	}
+	free(blocks);
+	free(decoded);
+	BB_LOG("Benchmark", "BC%d quality %d %ux%u: %.2f ms, %.1f MP/s, %.2f dB",
+	       format == kBcFormat_BC1 ? 1 : 3, quality, width, height, result.encodeMs, result.megapixelsPerSecond, result.psnr);
+	return result;
+}
+
+// Smooth gradients with a little noise and an alpha ramp - opaque for BC1.
+static void MC_Imgui_Benchmark_BCImage(u8 *bgra, u32 width, u32 height, bool bAlpha)
+{
+	u32 rng = 1;
+	for(u32 y = 0; y < height; ++y) {
+		for(u32 x = 0; x < width; ++x) {
+			u8 *pixel = bgra + ((size_t)y * width + x) * 4;
+			rng = rng * 1664525u + 1013904223u;
+			pixel[0] = (u8)(x * 255 / width);
+			pixel[1] = (u8)(y * 255 / height);
+			pixel[2] = (u8)((x + y) * 127 / (width + height) + (rng >> 29));
+			pixel[3] = bAlpha ? (u8)(255 - x * 255 / width) : 255;
+		}
+	}
+}
+
+static void MC_Imgui_Benchmarks_BC(void)
+{
+	if(ImGui::Button("Block compression")) {
+		const u32 width = 1024;
+		const u32 height = 1024;
+		u8 *bgra = (u8 *)malloc((size_t)width * height * 4);
+		if(bgra) {
+			for(u32 format = 0; format < BB_ARRAYSIZE(s_bc); ++format) {
+				MC_Imgui_Benchmark_BCImage(bgra, width, height, format == kBcFormat_BC3);
+				for(u32 quality = 0; quality < kBcQuality_Count; ++quality) {
+					s_bc[format][quality] = MC_Imgui_Benchmark_BC((bcFormat)format, (bcQuality)quality, bgra, width, height, 4);
+				}
+			}
+			free(bgra);
+			s_bcRan = true;
+		}
+	}
+	if(s_bcRan) {
+		for(u32 format = 0; format < BB_ARRAYSIZE(s_bc); ++format) {
+			for(u32 quality = 0; quality < kBcQuality_Count; ++quality) {
+				const bcBenchmark &result = s_bc[format][quality];
+				ImGui::BulletText("BC%d quality %u: %.2f ms, %.1f MP/s, %.2f dB",
+				                  format == kBcFormat_BC1 ? 1 : 3, quality, result.encodeMs, result.megapixelsPerSecond, result.psnr);
+			}
+		}
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Gap buffer
+
+struct gapBufferBenchmark {
+	u64 documentBytes;
+	u32 edits;
+	bool bMatched;             // both buffers ended up with the same text
+	u8 pad[3];
+	double gapEditsPerSecond;  // localized inserts/deletes through the gap buffer
+	double flatEditsPerSecond; // the same edits on a flat buffer, memmoving the tail each time
+	double flattenMs;          // one gapBuffer_flatten after the edits
+};
+
+static gapBufferBenchmark s_gapBuffer;
+static bool s_gapBufferRan;
+
+// Builds a documentBytes document, then times edits clustered around a wandering cursor against the
+// same edits on a flat buffer.
+static gapBufferBenchmark MC_Imgui_Benchmark_GapBuffer(u64 documentBytes, u32 edits)
+{
+	static const char s_insertText[] = "edit text\n";
+	gapBufferBenchmark result = { BB_EMPTY_INITIALIZER };
+	result.documentBytes = documentBytes;
+	result.edits = edits;
+	u64 flatLen = documentBytes;
+	u64 flatCapacity = documentBytes + (u64)edits * sizeof(s_insertText) + 1;
+	char *flat = (char *)malloc((size_t)flatCapacity);
+	if(!flat)
+		return result;
+	u32 rng = 1;
+	for(u64 i = 0; i < documentBytes; ++i) {
+		u32 r = MC_Imgui_Benchmark_Rand(&rng) % 64;
+		flat[i] = r == 0 ? '\n' : (char)('a' + r % 26);
+	}
+	gapBuffer gb;
+	gapBuffer_init(&gb, 0);
+	if(!gapBuffer_assign(&gb, flat, documentBytes)) {
+		free(flat);
+		return result;
+	}
+
+	// a cursor wandering through the middle of the document, typing and deleting as it goes
+	LARGE_INTEGER start, end;
+	rng = 2;
+	u64 cursor = documentBytes / 2;
+	QueryPerformanceCounter(&start);
+	for(u32 i = 0; i < edits; ++i) {
+		u32 r = MC_Imgui_Benchmark_Rand(&rng);
+		u64 len = gapBuffer_length(&gb);
+		cursor = BB_MIN(cursor + (r % 129), len + 64);
+		cursor = cursor >= 64 ? cursor - 64 : 0;
+		cursor = BB_MIN(cursor, len);
+		if((r >> 8) % 4) {
+			gapBuffer_insert(&gb, cursor, s_insertText, 1 + (r >> 12) % (sizeof(s_insertText) - 1));
+		} else {
+			gapBuffer_erase(&gb, cursor, 1 + (r >> 12) % 4);
+		}
+	}
+	QueryPerformanceCounter(&end);
+	result.gapEditsPerSecond = edits * 1000.0 / (MC_Imgui_Benchmark_ElapsedMs(start, end) + 1e-6);
+
+	rng = 2;
+	cursor = documentBytes / 2;
+	QueryPerformanceCounter(&start);
+	for(u32 i = 0; i < edits; ++i) {
+		u32 r = MC_Imgui_Benchmark_Rand(&rng);
+		cursor = BB_MIN(cursor + (r % 129), flatLen + 64);
+		cursor = cursor >= 64 ? cursor - 64 : 0;
+		cursor = BB_MIN(cursor, flatLen);
+		if((r >> 8) % 4) {
+			u64 count = 1 + (r >> 12) % (sizeof(s_insertText) - 1);
+			memmove(flat + cursor + count, flat + cursor, (size_t)(flatLen - cursor));
+			memcpy(flat + cursor, s_insertText, (size_t)count);
+			flatLen += count;
+		} else if(cursor < flatLen) {
+			u64 count = BB_MIN(1 + (r >> 12) % 4, flatLen - cursor);
+			memmove(flat + cursor, flat + cursor + count, (size_t)(flatLen - cursor - count));
+			flatLen -= count;
+		}
+	}
+	QueryPerformanceCounter(&end);
+	result.flatEditsPerSecond = edits * 1000.0 / (MC_Imgui_Benchmark_ElapsedMs(start, end) + 1e-6);
+
+	QueryPerformanceCounter(&start);
+	gapBuffer_flatten(&gb);
+	QueryPerformanceCounter(&end);
+	result.flattenMs = MC_Imgui_Benchmark_ElapsedMs(start, end);
+	result.bMatched = gapBuffer_length(&gb) == flatLen && !memcmp(gb.data, flat, (size_t)flatLen);
+
+	gapBuffer_reset(&gb);
+	free(flat);
+	BB_LOG("Benchmark", "Gap buffer benchmark %llu bytes, %u edits: gap %.0f edits/s, flat %.0f edits/s, flatten %.2f ms%s",
+	       result.documentBytes, result.edits, result.gapEditsPerSecond, result.flatEditsPerSecond, result.flattenMs,
+	       result.bMatched ? "" : " (MISMATCH)");
+	return result;
+}
+
+static void MC_Imgui_Benchmarks_GapBuffer(void)
+{
+	if(ImGui::Button("Gap buffer")) {
+		s_gapBuffer = MC_Imgui_Benchmark_GapBuffer(64 * 1024 * 1024, 20000);
+		s_gapBufferRan = true;
+	}
+	if(s_gapBufferRan) {
+		ImGui::SameLine();
+		ImGui::Text("%llu bytes, %u edits: gap %.0f edits/s, flat %.0f edits/s, flatten %.2f ms%s",
+		            s_gapBuffer.documentBytes, s_gapBuffer.edits, s_gapBuffer.gapEditsPerSecond, s_gapBuffer.flatEditsPerSecond,
+		            s_gapBuffer.flattenMs, s_gapBuffer.bMatched ? "" : " (MISMATCH)");
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Column table
+
+struct columnTableBenchmark {
+	u32 numRows;
+	u32 visibleRows;
+	double fixedMs;    // one frame of a fixed-height table
+	double variableMs; // one frame of a variable-height table
+	double offsetsMs;  // building its row offsets from scratch
+};
+
+struct columnTableBenchmarkRows {
+	u32 numRows;
+	u8 pad[4];
+};
+
+static columnTableBenchmark s_columnTable[5];
+static u32 s_columnTableCount;
+
+static void MC_Imgui_Benchmark_ColumnTableRow(const ImGui::columnDrawData &columns, u32 row, void *userData)
+{
+	const columnTableBenchmarkRows *rows = (const columnTableBenchmarkRows *)userData;
+	char text[32];
+	snprintf(text, sizeof(text), "%u", row);
+	ImGui::DrawColumnText(columns, 0, text);
+	snprintf(text, sizeof(text), "%u", rows->numRows - row);
+	ImGui::DrawColumnText(columns, 1, text);
+	ImGui::DrawColumnText(columns, 2, (row & 1) ? "odd row" : "even row");
+}
+
+// Draws and times tables of 1k to 10M rows in the current window - call within a frame.  Returns
+// the number of results written, up to maxResults.
+static u32 MC_Imgui_Benchmark_ColumnTable(columnTableBenchmark *results, u32 maxResults)
+{
+	static const u32 s_rowCounts[] = { 1000, 10000, 100000, 1000000, 10000000 };
+	const char *columnNames[] = { "Row", "Remaining", "Text" };
+	float columnWidths[] = { 80.0f, 80.0f, 0.0f };
+	float columnOffsets[BB_ARRAYSIZE(columnNames) + 1] = {};
+	u32 count = 0;
+
+	for(u32 i = 0; i < BB_ARRAYSIZE(s_rowCounts) && count < maxResults; ++i) {
+		u32 numRows = s_rowCounts[i];
+		float *rowHeights = (float *)malloc(numRows * sizeof(float));
+		float *rowOffsets = (float *)malloc((numRows + 1) * sizeof(float));
+		if(!rowHeights || !rowOffsets) {
+			free(rowHeights);
+			free(rowOffsets);
+			break;
+		}
+		float lineHeight = ImGui::GetTextLineHeightWithSpacing();
+		for(u32 row = 0; row < numRows; ++row) {
+			rowHeights[row] = (row % 3) ? lineHeight : lineHeight * 2.0f;
+		}
+
+		columnTableBenchmark *result = results + count++;
+		*result = columnTableBenchmark();
+		result->numRows = numRows;
+		columnTableBenchmarkRows rows = { numRows, {} };
+		ImGui::columnTable table = {};
+		table.columns.columnNames = columnNames;
+		table.columns.columnWidths = columnWidths;
+		table.columns.columnOffsets = columnOffsets;
+		table.columns.numColumns = BB_ARRAYSIZE(columnNames);
+		table.numRows = numRows;
+		ImVec2 size(0.0f, 10.0f * lineHeight);
+		LARGE_INTEGER start, end;
+
+		ImGui::PushID((int)i);
+		QueryPerformanceCounter(&start);
+		ImGui::columnTableResult fixed = ImGui::ColumnTable("fixed", table, &MC_Imgui_Benchmark_ColumnTableRow, &rows, size);
+		QueryPerformanceCounter(&end);
+		result->fixedMs = MC_Imgui_Benchmark_ElapsedMs(start, end);
+		result->visibleRows = fixed.visibleRows;
+
+		QueryPerformanceCounter(&start);
+		ImGui::UpdateColumnTableRowOffsets(rowOffsets, rowHeights, numRows);
+		QueryPerformanceCounter(&end);
+		result->offsetsMs = MC_Imgui_Benchmark_ElapsedMs(start, end);
+
+		table.rowOffsets = rowOffsets;
+		QueryPerformanceCounter(&start);
+		ImGui::ColumnTable("variable", table, &MC_Imgui_Benchmark_ColumnTableRow, &rows, size);
+		QueryPerformanceCounter(&end);
+		result->variableMs = MC_Imgui_Benchmark_ElapsedMs(start, end);
+		ImGui::PopID();
+
+		free(rowHeights);
+		free(rowOffsets);
+		BB_LOG("Benchmark", "Column table benchmark: %u rows, %u visible, fixed %.3f ms, variable %.3f ms, offsets %.3f ms",
+		       result->numRows, result->visibleRows, result->fixedMs, result->variableMs, result->offsetsMs);
+	}
+	return count;
+}
+
+static void MC_Imgui_Benchmarks_ColumnTable(void)
+{
+	// the tables are drawn for the one frame they are timed in
+	if(ImGui::Button("Column table")) {
+		s_columnTableCount = MC_Imgui_Benchmark_ColumnTable(s_columnTable, BB_ARRAYSIZE(s_columnTable));
+	}
+	for(u32 i = 0; i < s_columnTableCount; ++i) {
+		const columnTableBenchmark &result = s_columnTable[i];
+		ImGui::BulletText("%u rows, %u visible: fixed %.3f ms, variable %.3f ms, offsets %.3f ms",
+		                  result.numRows, result.visibleRows, result.fixedMs, result.variableMs, result.offsetsMs);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Text shadows
+
+struct textShadowBenchmark {
+	u32 glyphs;
+	u8 pad[4];
+	double addTextTwiceMs; // shadow and text as two AddText calls
+	double singlePassMs;   // AddTextShadowed
+	double outlineMs;      // AddTextShadowed with kTextShadow_Outline
+};
+
+static textShadowBenchmark s_textShadow;
+static bool s_textShadowRan;
+
+// Draws numLines lines of text each way in a private headless ImGui context, and times them.
+static textShadowBenchmark MC_Imgui_Benchmark_TextShadow(u32 numLines)
+{
+	static const char s_line[] = "The quick brown fox jumps over the lazy dog 0123456789 times.";
+	textShadowBenchmark result = {};
+	const ImU32 col = IM_COL32(255, 255, 255, 255);
+	const ImU32 shadowCol = IM_COL32(0, 0, 0, 255);
+
+	ImGuiContext *prevContext = ImGui::GetCurrentContext();
+	ImGuiContext *context = ImGui::CreateContext();
+	ImGui::SetCurrentContext(context);
+	ImGuiIO &io = ImGui::GetIO();
+	io.IniFilename = nullptr;
+	io.DisplaySize = ImVec2(1920.0f, 1080.0f);
+	io.DeltaTime = 1.0f / 60.0f;
+	io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;
+	unsigned char *pixels = nullptr;
+	int width = 0;
+	int height = 0;
+	io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height); // builds the default font
+
+	ImGui::NewFrame();
+	ImGui::Begin("text", nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoSavedSettings);
+	ImDrawList *drawList = ImGui::GetWindowDrawList();
+	drawList->PushClipRectFullScreen();
+	ImFont *font = ImGui::GetFont();
+	const float fontSize = ImGui::GetFontSize();
+	LARGE_INTEGER start, end;
+
+	QueryPerformanceCounter(&start);
+	for(u32 line = 0; line < numLines; ++line) {
+		ImVec2 pos(0.0f, fontSize * (float)line);
+		drawList->AddText(font, fontSize, ImVec2(pos.x + 1.0f, pos.y + 1.0f), shadowCol, s_line);
+		drawList->AddText(font, fontSize, pos, col, s_line);
+	}
+	QueryPerformanceCounter(&end);
+	result.addTextTwiceMs = MC_Imgui_Benchmark_ElapsedMs(start, end);
+
+	QueryPerformanceCounter(&start);
+	for(u32 line = 0; line < numLines; ++line) {
+		ImGui::AddTextShadowed(drawList, font, fontSize, ImVec2(0.0f, fontSize * (float)line), col, shadowCol, s_line);
+	}
+	QueryPerformanceCounter(&end);
+	result.singlePassMs = MC_Imgui_Benchmark_ElapsedMs(start, end);
+
+	QueryPerformanceCounter(&start);
+	for(u32 line = 0; line < numLines; ++line) {
+		ImGui::AddTextShadowed(drawList, font, fontSize, ImVec2(0.0f, fontSize * (float)line), col, shadowCol, s_line, nullptr, 0.0f, ImGui::kTextShadow_Outline);
+	}
+	QueryPerformanceCounter(&end);
+	result.outlineMs = MC_Imgui_Benchmark_ElapsedMs(start, end);
+
+	drawList->PopClipRect();
+	ImGui::End();
+	ImGui::EndFrame();
+	ImGui::DestroyContext(context);
+	ImGui::SetCurrentContext(prevContext);
+
+	result.glyphs = numLines * (u32)(BB_ARRAYSIZE(s_line) - 1);
+	BB_LOG("Benchmark", "Text shadow benchmark: %u glyphs, AddText twice %.3f ms, single pass %.3f ms, outline %.3f ms",
+	       result.glyphs, result.addTextTwiceMs, result.singlePassMs, result.outlineMs);
+	return result;
+}
+
+static void MC_Imgui_Benchmarks_TextShadow(void)
+{
+	if(ImGui::Button("Text shadows")) {
+		s_textShadow = MC_Imgui_Benchmark_TextShadow(1000);
+		s_textShadowRan = true;
+	}
+	if(s_textShadowRan) {
+		ImGui::SameLine();
+		ImGui::Text("%u glyphs: AddText twice %.3f ms, single pass %.3f ms, outline %.3f ms",
+		            s_textShadow.glyphs, s_textShadow.addTextTwiceMs, s_textShadow.singlePassMs, s_textShadow.outlineMs);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Column sort
+
+struct columnSortBenchmark {
+	u32 numRows;
+	u32 processors;
+	double fullSortMs;   // full sort across the worker threads
+	double serialSortMs; // the same sort on one thread
+	double appendMs;     // merging in 1% more rows
+	double flipMs;       // reversing the direction
+};
+
+static columnSortBenchmark s_columnSort;
+static bool s_columnSortRan;
+
+static int MC_Imgui_Benchmark_ColumnSortCompare(u32 rowA, u32 rowB, u32 column, void *userData)
+{
+	BB_UNUSED(column);
+	const u32 *keys = (const u32 *)userData;
+	return (keys[rowA] < keys[rowB]) ? -1 : (keys[rowA] > keys[rowB]) ? 1 : 0;
+}
+
+// Sorts numRows random keys and times each path.
+static columnSortBenchmark MC_Imgui_Benchmark_ColumnSort(u32 numRows)
+{
+	columnSortBenchmark result = {};
+	u32 numAppended = numRows / 100;
+	u32 totalRows = numRows + numAppended;
+	u32 *keys = (u32 *)malloc((size_t)totalRows * sizeof(u32));
+	if(!keys)
+		return result;
+	u32 rng = 0x12345678u;
+	for(u32 i = 0; i < totalRows; ++i) {
+		keys[i] = MC_Imgui_Benchmark_Rand(&rng);
+	}
+
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	result.numRows = numRows;
+	result.processors = (u32)info.dwNumberOfProcessors;
+	u32 sortColumn = 0;
+	b32 sortDescending = false;
+	ImGui::columnDrawData columns = {};
+	columns.sortColumn = &sortColumn;
+	columns.sortDescending = &sortDescending;
+	columns.numColumns = 1;
+	LARGE_INTEGER start, end;
+
+	ImGui::columnSort serial;
+	ImGui::InitColumnSort(&serial, 1, &MC_Imgui_Benchmark_ColumnSortCompare, keys);
+	serial.maxThreads = 1;
+	QueryPerformanceCounter(&start);
+	ImGui::UpdateColumnSort(&serial, columns, numRows);
+	QueryPerformanceCounter(&end);
+	result.serialSortMs = MC_Imgui_Benchmark_ElapsedMs(start, end);
+	ImGui::ResetColumnSort(&serial);
+
+	ImGui::columnSort sort;
+	ImGui::InitColumnSort(&sort, 1, &MC_Imgui_Benchmark_ColumnSortCompare, keys);
+	QueryPerformanceCounter(&start);
+	ImGui::UpdateColumnSort(&sort, columns, numRows);
+	QueryPerformanceCounter(&end);
+	result.fullSortMs = MC_Imgui_Benchmark_ElapsedMs(start, end);
+
+	QueryPerformanceCounter(&start);
+	ImGui::UpdateColumnSort(&sort, columns, totalRows);
+	QueryPerformanceCounter(&end);
+	result.appendMs = MC_Imgui_Benchmark_ElapsedMs(start, end);
+
+	sortDescending = true;
+	QueryPerformanceCounter(&start);
+	ImGui::UpdateColumnSort(&sort, columns, totalRows);
+	QueryPerformanceCounter(&end);
+	result.flipMs = MC_Imgui_Benchmark_ElapsedMs(start, end);
+
+	ImGui::ResetColumnSort(&sort);
+	free(keys);
+	BB_LOG("Benchmark", "Column sort benchmark: %u rows, %u processors, full sort %.1f ms (%.1f ms on one thread), append 1%% %.1f ms, flip %.3f ms",
+	       result.numRows, result.processors, result.fullSortMs, result.serialSortMs, result.appendMs, result.flipMs);
+	return result;
+}
+
+static void MC_Imgui_Benchmarks_ColumnSort(void)
+{
+	if(ImGui::Button("Column sort")) {
+		s_columnSort = MC_Imgui_Benchmark_ColumnSort(10000000);
+		s_columnSortRan = true;
+	}
+	if(s_columnSortRan) {
+		ImGui::SameLine();
+		ImGui::Text("%u rows, %u processors: full sort %.1f ms (%.1f ms on one thread), append 1%% %.1f ms, flip %.3f ms",
+		            s_columnSort.numRows, s_columnSort.processors, s_columnSort.fullSortMs, s_columnSort.serialSortMs,
+		            s_columnSort.appendMs, s_columnSort.flipMs);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Message boxes
+
+struct messageBoxBenchmark {
+	u32 numBoxes;
+	u32 numFrames;
+	double lookupMs; // resolving the active box's entries by name each frame, as drawing used to
+	double drawMs;   // drawing the active box from its compiled layout each frame
+	double drainMs;  // drawing and removing each queued box once, compiling each
+};
+
+static messageBoxBenchmark s_messageBox;
+static bool s_messageBoxRan;
+
+static void MC_Imgui_Benchmark_MessageBoxFrame(messageBoxes *boxes, double *ms)
+{
+	LARGE_INTEGER start, end;
+	ImGui::NewFrame();
+	ImGui::Begin("message boxes", nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoSavedSettings);
+	QueryPerformanceCounter(&start);
+	UIMessageBox_Update(boxes);
+	QueryPerformanceCounter(&end);
+	ImGui::End();
+	ImGui::EndFrame();
+	*ms += MC_Imgui_Benchmark_ElapsedMs(start, end);
+}
+
+// Queues numBoxes boxes on a private queue and draws them inline in a private headless ImGui
+// context: numFrames frames of the first box, then each box once until the queue is empty.
+static messageBoxBenchmark MC_Imgui_Benchmark_MessageBox(u32 numBoxes, u32 numFrames)
+{
+	messageBoxBenchmark result = {};
+	messageBoxes boxes = {};
+	for(u32 i = 0; i < numBoxes; ++i) {
+		messageBox mb = {};
+		sdict_add_raw(&mb.data, "title", "Update Available");
+		sdict_add_raw(&mb.data, "text", "An update is available.  Update and restart?");
+		sdict_add_raw(&mb.data, "version", "1234");
+		sdict_add_raw(&mb.data, "button1", "Update");
+		sdict_add_raw(&mb.data, "button2", "Ignore");
+		sdict_add_raw(&mb.data, "button3", "Remind me later");
+		mb_queue(mb, &boxes);
+	}
+	result.numBoxes = numBoxes;
+	result.numFrames = numFrames;
+
+	// what each frame resolved before: title, text and inputNumber lookups plus probing buttons
+	size_t checksum = 0;
+	LARGE_INTEGER start, end;
+	QueryPerformanceCounter(&start);
+	for(u32 frame = 0; frame < numFrames; ++frame) {
+		messageBox *mb = mb_get_active(&boxes);
+		if(!mb)
+			break;
+		const char *title = sdict_find(&mb->data, "title");
+		const char *text = sdict_find(&mb->data, "text");
+		sdictEntry_t *inputNumber = sdict_find_entry(&mb->data, "inputNumber");
+		u32 numButtons = 0;
+		while(sdict_find(&mb->data, va("button%u", numButtons + 1))) {
+			++numButtons;
+		}
+		checksum += (size_t)title + (size_t)text + (size_t)inputNumber + numButtons;
+	}
+	QueryPerformanceCounter(&end);
+	result.lookupMs = MC_Imgui_Benchmark_ElapsedMs(start, end);
+
+	ImGuiContext *prevContext = ImGui::GetCurrentContext();
+	ImGuiContext *context = ImGui::CreateContext();
+	ImGui::SetCurrentContext(context);
+	ImGuiIO &io = ImGui::GetIO();
+	io.IniFilename = nullptr;
+	io.DisplaySize = ImVec2(1920.0f, 1080.0f);
+	io.DeltaTime = 1.0f / 60.0f;
+	unsigned char *pixels = nullptr;
+	int width = 0;
+	int height = 0;
+	io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height); // builds the default font
+
+	for(u32 frame = 0; frame < numFrames; ++frame) {
+		MC_Imgui_Benchmark_MessageBoxFrame(&boxes, &result.drawMs);
+	}
+	while(mb_get_active(&boxes)) {
+		MC_Imgui_Benchmark_MessageBoxFrame(&boxes, &result.drainMs);
+		mb_remove_active(&boxes);
+	}
+	// lets the message box code drop the layout of the last box, which it didn't remove itself
+	MC_Imgui_Benchmark_MessageBoxFrame(&boxes, &result.drainMs);
+
+	ImGui::DestroyContext(context);
+	ImGui::SetCurrentContext(prevContext);
+	mb_shutdown(&boxes);
+
+	BB_LOG("Benchmark", "Message box benchmark: %u boxes, %u frames: lookups %.3f ms, compiled draw %.3f ms, drain %.2f ms%s",
+	       result.numBoxes, result.numFrames, result.lookupMs, result.drawMs, result.drainMs, checksum ? "" : " - no lookups");
+	return result;
+}
+
+static void MC_Imgui_Benchmarks_MessageBox(void)
+{
+	if(ImGui::Button("Message boxes")) {
+		s_messageBox = MC_Imgui_Benchmark_MessageBox(5000, 10000);
+		s_messageBoxRan = true;
+	}
+	if(s_messageBoxRan) {
+		ImGui::SameLine();
+		ImGui::Text("%u boxes, %u frames: lookups %.3f ms, compiled draw %.3f ms, drain %.2f ms",
+		            s_messageBox.numBoxes, s_messageBox.numFrames, s_messageBox.lookupMs, s_messageBox.drawMs, s_messageBox.drainMs);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+void MC_Imgui_Benchmarks_Window(bool *open)
+{
+	if(ImGui::Begin("Benchmarks", open)) {
+		MC_Imgui_Benchmarks_DiskCache();
+		MC_Imgui_Benchmarks_Stream();
+		MC_Imgui_Benchmarks_BC();
+		MC_Imgui_Benchmarks_GapBuffer();
+		MC_Imgui_Benchmarks_ColumnTable();
+		MC_Imgui_Benchmarks_TextShadow();
+		MC_Imgui_Benchmarks_ColumnSort();
+		MC_Imgui_Benchmarks_MessageBox();
+	}
+	ImGui::End();
+}
+
+#endif // #if defined(MC_IMGUI_BENCHMARKS)
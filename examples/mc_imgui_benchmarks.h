@@ -0,0 +1,14 @@
+// Copyright (c) 2012-2019 Matt Campbell
+// MIT license (see License.txt)
+
+#pragma once
+
+#include "common.h"
+
+#if defined(MC_IMGUI_BENCHMARKS)
+
+// Timings for the library's optimized paths, kept in the example so the library doesn't carry
+// them.  Each benchmark runs on demand from the window and logs its results.
+void MC_Imgui_Benchmarks_Window(bool *open);
+
+#endif // #if defined(MC_IMGUI_BENCHMARKS)
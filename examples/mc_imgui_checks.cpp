@@ -0,0 +1,1592 @@
+// Copyright (c) 2012-2019 Matt Campbell
+// MIT license (see License.txt)
+
+#include "mc_imgui_checks.h"
+
+#if defined(MC_IMGUI_BENCHMARKS)
+
+#include "app_update.h"
+#include "bb_time.h"
+#include "imgui_column_filter.h"
+#include "imgui_column_sort.h"
+#include "imgui_core.h"
+#include "imgui_image_bc.h"
+#include "imgui_image_disk_cache.h"
+#include "imgui_image_tile_cache.h"
+#include "imgui_image_triple_buffer.h"
+#include "imgui_input_text.h"
+#include "imgui_selection.h"
+#include "imgui_text_buffer.h"
+#include "imgui_text_search.h"
+#include "imgui_utils.h"
+#include "message_box.h"
+#include "sb.h"
+#include "ui_message_box.h"
+#include "va.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static u32 s_checks;
+static u32 s_failures;
+
+static bool MC_Imgui_Check(bool ok, const char *expr, const char *file, int line)
+{
+	++s_checks;
+	if(!ok) {
+		++s_failures;
+		BB_WARNING("Checks", "%s(%d): check failed: %s", file, line, expr);
+	}
+	return ok;
+}
+
+#define CHECK(expr) MC_Imgui_Check((expr) != 0, #expr, __FILE__, __LINE__)
+
+static u32 MC_Imgui_Checks_Rand(u32 *state)
+{
+	*state = *state * 1664525u + 1013904223u;
+	return *state >> 8;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Image disk cache
+
+static bool MC_Imgui_Checks_WriteFile(const char *path, const void *data, size_t size)
+{
+	FILE *fp = fopen(path, "wb");
+	if(!fp)
+		return false;
+	bool ok = fwrite(data, 1, size, fp) == size;
+	fclose(fp);
+	return ok;
+}
+
+// The cache holds one entry here, so it can be found without knowing how entries are named.
+static bool MC_Imgui_Checks_FindCacheEntry(const char *dir, sb_t *entryPath)
+{
+	WIN32_FIND_DATAA find;
+	HANDLE hFind = FindFirstFileA(va("%s\\*.img", dir), &find);
+	if(hFind == INVALID_HANDLE_VALUE)
+		return false;
+	FindClose(hFind);
+	sb_reset(entryPath);
+	sb_va(entryPath, "%s\\%s", dir, find.cFileName);
+	return true;
+}
+
+static bool MC_Imgui_Checks_RoundTrip(const char *source, const u8 *pixels, int width, int height)
+{
+	if(!ImGui_ImageDiskCache_Store(source, pixels, width, height))
+		return false;
+	int loadedWidth = 0;
+	int loadedHeight = 0;
+	u8 *loaded = ImGui_ImageDiskCache_Load(source, &loadedWidth, &loadedHeight);
+	bool ok = loaded && loadedWidth == width && loadedHeight == height && !memcmp(loaded, pixels, (size_t)(width * height * 4));
+	free(loaded);
+	return ok;
+}
+
+static void MC_Imgui_Checks_DiskCache(void)
+{
+	char tempDir[MAX_PATH];
+	if(!CHECK(GetTempPathA(sizeof(tempDir), tempDir)))
+		return;
+	sb_t prevDir = { BB_EMPTY_INITIALIZER };
+	sb_append(&prevDir, ImGui_ImageDiskCache_GetDirectory());
+	sb_t cacheDir = { BB_EMPTY_INITIALIZER };
+	sb_va(&cacheDir, "%smc_imgui_checks", tempDir);
+	sb_t source = { BB_EMPTY_INITIALIZER };
+	sb_va(&source, "%s\\source.png", sb_get(&cacheDir));
+	sb_t entryPath = { BB_EMPTY_INITIALIZER };
+	ImGui_ImageDiskCache_SetDirectory(sb_get(&cacheDir));
+
+	// entries are keyed on the source file's path, size and mtime - its contents don't matter
+	const int width = 61;
+	const int height = 37;
+	const size_t pixelBytes = (size_t)(width * height * 4);
+	u8 *pixels = (u8 *)malloc(pixelBytes);
+	if(CHECK(pixels) && CHECK(MC_Imgui_Checks_WriteFile(sb_get(&source), "source", 6))) {
+		// flat runs broken up by literals - RLE
+		u32 *words = (u32 *)pixels;
+		u32 rng = 1;
+		for(int i = 0; i < width * height; ++i) {
+			words[i] = (MC_Imgui_Checks_Rand(&rng) % 8) ? 0xff204060u + (u32)(i / 150) : MC_Imgui_Checks_Rand(&rng);
+		}
+		CHECK(MC_Imgui_Checks_RoundTrip(sb_get(&source), pixels, width, height));
+
+		// noise - stored raw
+		for(int i = 0; i < width * height; ++i) {
+			words[i] = MC_Imgui_Checks_Rand(&rng) ^ (MC_Imgui_Checks_Rand(&rng) << 24);
+		}
+		CHECK(MC_Imgui_Checks_RoundTrip(sb_get(&source), pixels, width, height));
+		CHECK(MC_Imgui_Checks_RoundTrip(sb_get(&source), pixels, 1, 1));
+
+		// a truncated entry is rejected, and deleted
+		CHECK(MC_Imgui_Checks_RoundTrip(sb_get(&source), pixels, width, height));
+		if(CHECK(MC_Imgui_Checks_FindCacheEntry(sb_get(&cacheDir), &entryPath))) {
+			FILE *fp = fopen(sb_get(&entryPath), "rb");
+			if(CHECK(fp)) {
+				u8 *entry = (u8 *)malloc(pixelBytes + 1024);
+				size_t entrySize = entry ? fread(entry, 1, pixelBytes + 1024, fp) : 0;
+				fclose(fp);
+				int loadedWidth = 0;
+				int loadedHeight = 0;
+				if(CHECK(entry && entrySize > 16) && CHECK(MC_Imgui_Checks_WriteFile(sb_get(&entryPath), entry, entrySize - 1))) {
+					CHECK(!ImGui_ImageDiskCache_Load(sb_get(&source), &loadedWidth, &loadedHeight));
+					CHECK(GetFileAttributesA(sb_get(&entryPath)) == INVALID_FILE_ATTRIBUTES);
+				}
+
+				// so is a header claiming dimensions no image of ours has (width is the third u32)
+				if(entry && entrySize > 16) {
+					u32 hugeWidth = 1u << 20;
+					memcpy(entry + 8, &hugeWidth, sizeof(hugeWidth));
+					if(CHECK(MC_Imgui_Checks_WriteFile(sb_get(&entryPath), entry, entrySize))) {
+						CHECK(!ImGui_ImageDiskCache_Load(sb_get(&source), &loadedWidth, &loadedHeight));
+					}
+				}
+				free(entry);
+			}
+		}
+
+		// and oversized images are never stored
+		u8 *wide = (u8 *)calloc(16385, 4);
+		CHECK(wide && !ImGui_ImageDiskCache_Store(sb_get(&source), wide, 16385, 1));
+		free(wide);
+	}
+	free(pixels);
+
+	if(MC_Imgui_Checks_FindCacheEntry(sb_get(&cacheDir), &entryPath)) {
+		DeleteFileA(sb_get(&entryPath));
+	}
+	DeleteFileA(sb_get(&source));
+	RemoveDirectoryA(sb_get(&cacheDir));
+	ImGui_ImageDiskCache_SetDirectory(sb_get(&prevDir));
+	sb_reset(&entryPath);
+	sb_reset(&source);
+	sb_reset(&cacheDir);
+	sb_reset(&prevDir);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Triple buffer
+
+enum {
+	kTripleBufferCheck_FrameWords = 4096,
+	kTripleBufferCheck_Frames = 20000,
+};
+
+// Fills each frame with its sequence number, so a torn frame shows up as mixed words.
+static DWORD WINAPI MC_Imgui_Checks_TripleBufferProducer(void *param)
+{
+	tripleBuffer *tb = (tripleBuffer *)param;
+	for(u32 sequence = 1; sequence <= kTripleBufferCheck_Frames; ++sequence) {
+		u32 *words = (u32 *)tripleBuffer_back(tb);
+		for(u32 i = 0; i < kTripleBufferCheck_FrameWords; ++i) {
+			words[i] = sequence;
+		}
+		tripleBuffer_publish(tb);
+	}
+	return 0;
+}
+
+static bool MC_Imgui_Checks_FrameIs(const u8 *frame, u32 sequence)
+{
+	const u32 *words = (const u32 *)frame;
+	for(u32 i = 0; i < kTripleBufferCheck_FrameWords; ++i) {
+		if(words[i] != sequence)
+			return false;
+	}
+	return true;
+}
+
+static void MC_Imgui_Checks_TripleBuffer(void)
+{
+	tripleBuffer tb;
+	if(!CHECK(tripleBuffer_init(&tb, kTripleBufferCheck_FrameWords * sizeof(u32))))
+		return;
+
+	// single thread: nothing fresh until published, and only the newest of several publishes is seen
+	CHECK(!tripleBuffer_acquire(&tb));
+	memset(tripleBuffer_back(&tb), 1, (size_t)tb.frameBytes);
+	tripleBuffer_publish(&tb);
+	const u8 *frame = tripleBuffer_acquire(&tb);
+	CHECK(frame && frame[0] == 1 && frame == tripleBuffer_present(&tb));
+	CHECK(!tripleBuffer_acquire(&tb));
+	memset(tripleBuffer_back(&tb), 2, (size_t)tb.frameBytes);
+	tripleBuffer_publish(&tb);
+	memset(tripleBuffer_back(&tb), 3, (size_t)tb.frameBytes);
+	tripleBuffer_publish(&tb);
+	frame = tripleBuffer_acquire(&tb);
+	CHECK(frame && frame[0] == 3 && frame == tripleBuffer_present(&tb));
+	CHECK(tb.published == 3 && tb.dropped == 1);
+	CHECK(tripleBuffer_back(&tb) != tripleBuffer_present(&tb));
+	tripleBuffer_reset(&tb);
+
+	// threaded: every acquired frame is whole, and frames arrive in order
+	if(!CHECK(tripleBuffer_init(&tb, kTripleBufferCheck_FrameWords * sizeof(u32))))
+		return;
+	HANDLE hThread = CreateThread(nullptr, 0, &MC_Imgui_Checks_TripleBufferProducer, &tb, 0, nullptr);
+	if(CHECK(hThread)) {
+		u32 lastSequence = 0;
+		u32 acquired = 0;
+		bool whole = true;
+		bool ordered = true;
+		while(lastSequence < kTripleBufferCheck_Frames) {
+			frame = tripleBuffer_acquire(&tb);
+			if(!frame) {
+				YieldProcessor();
+				continue;
+			}
+			u32 sequence = *(const u32 *)frame;
+			whole = whole && MC_Imgui_Checks_FrameIs(frame, sequence);
+			ordered = ordered && sequence > lastSequence;
+			lastSequence = sequence;
+			++acquired;
+		}
+		WaitForSingleObject(hThread, INFINITE);
+		CloseHandle(hThread);
+		CHECK(whole);
+		CHECK(ordered);
+		CHECK(tb.published == kTripleBufferCheck_Frames);
+		CHECK(tb.published - tb.dropped == acquired);
+	}
+	tripleBuffer_reset(&tb);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Block compression
+
+static double MC_Imgui_Checks_BCRoundTrip(bcFormat format, bcQuality quality, const u8 *bgra, u32 width, u32 height, u8 *decoded)
+{
+	double psnr = 0.0;
+	u8 *blocks = (u8 *)malloc((size_t)bc_encoded_size(format, width, height));
+	if(blocks) {
+		bc_encode_image(format, quality, bgra, width, height, (s32)(width * 4), blocks);
+		bc_decode_image(format, blocks, width, height, decoded);
+		psnr = bc_psnr(bgra, decoded, width, height, format == kBcFormat_BC3);
+		free(blocks);
+	}
+	return psnr;
+}
+
+static void MC_Imgui_Checks_BC(void)
+{
+	CHECK(bc_encoded_size(kBcFormat_BC1, 13, 7) == 4 * 2 * 8);
+	CHECK(bc_encoded_size(kBcFormat_BC3, 13, 7) == 4 * 2 * 16);
+	CHECK(bc_block_pitch(kBcFormat_BC3, 13) == 4 * 16);
+
+	// dimensions that aren't a multiple of 4 exercise the edge blocks
+	const u32 width = 61;
+	const u32 height = 37;
+	const size_t pixelBytes = (size_t)width * height * 4;
+	u8 *bgra = (u8 *)malloc(pixelBytes);
+	u8 *decoded = (u8 *)malloc(pixelBytes);
+	if(CHECK(bgra && decoded)) {
+		u32 rng = 1;
+		for(u32 y = 0; y < height; ++y) {
+			for(u32 x = 0; x < width; ++x) {
+				u8 *pixel = bgra + ((size_t)y * width + x) * 4;
+				pixel[0] = (u8)(x * 4);
+				pixel[1] = (u8)(y * 6);
+				pixel[2] = (u8)((x + y) * 2 + MC_Imgui_Checks_Rand(&rng) % 8);
+				pixel[3] = 255;
+			}
+		}
+		CHECK(bc_choose_format(bgra, width, height, (s32)(width * 4)) == kBcFormat_BC1);
+		CHECK(bc_psnr(bgra, bgra, width, height, true) == 100.0);
+
+		// refinement only ever accepts endpoints that lower the error
+		double psnr[kBcQuality_Count];
+		for(u32 quality = 0; quality < kBcQuality_Count; ++quality) {
+			psnr[quality] = MC_Imgui_Checks_BCRoundTrip(kBcFormat_BC1, (bcQuality)quality, bgra, width, height, decoded);
+			CHECK(psnr[quality] > 33.0);
+		}
+		CHECK(psnr[kBcQuality_High] >= psnr[kBcQuality_Normal]);
+
+		// BC3 alpha is interpolated
+		for(u32 i = 0; i < width * height; ++i) {
+			bgra[i * 4 + 3] = (u8)(255 - (i % width) * 3);
+		}
+		CHECK(bc_choose_format(bgra, width, height, (s32)(width * 4)) == kBcFormat_BC3);
+		CHECK(MC_Imgui_Checks_BCRoundTrip(kBcFormat_BC3, kBcQuality_Normal, bgra, width, height, decoded) > 33.0);
+
+		// BC1 1-bit alpha is exact
+		for(u32 i = 0; i < width * height; ++i) {
+			bgra[i * 4 + 3] = (i % 3) ? 255 : 0;
+		}
+		CHECK(bc_choose_format(bgra, width, height, (s32)(width * 4)) == kBcFormat_BC1);
+		MC_Imgui_Checks_BCRoundTrip(kBcFormat_BC1, kBcQuality_Normal, bgra, width, height, decoded);
+		bool bAlphaExact = true;
+		for(u32 i = 0; i < width * height; ++i) {
+			bAlphaExact = bAlphaExact && decoded[i * 4 + 3] == bgra[i * 4 + 3];
+		}
+		CHECK(bAlphaExact);
+
+		// solid blocks come within 1 of every channel value
+		u32 maxError = 0;
+		for(u32 value = 0; value < 256; ++value) {
+			for(u32 i = 0; i < 16; ++i) {
+				bgra[i * 4 + 0] = (u8)value;
+				bgra[i * 4 + 1] = (u8)(255 - value);
+				bgra[i * 4 + 2] = (u8)(value / 2);
+				bgra[i * 4 + 3] = 255;
+			}
+			MC_Imgui_Checks_BCRoundTrip(kBcFormat_BC1, kBcQuality_Normal, bgra, 4, 4, decoded);
+			for(u32 i = 0; i < 16 * 4; ++i) {
+				u32 error = (u32)abs((int)decoded[i] - (int)bgra[i]);
+				maxError = BB_MAX(maxError, error);
+			}
+		}
+		CHECK(maxError <= 1);
+	}
+	free(bgra);
+	free(decoded);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Tile cache
+
+static tileCacheKey MC_Imgui_Checks_TileKey(u32 imageId, u32 tileX)
+{
+	tileCacheKey key = { imageId, 0, tileX, 0 };
+	return key;
+}
+
+static bool MC_Imgui_Checks_TileKeyEqual(tileCacheKey a, tileCacheKey b)
+{
+	return a.imageId == b.imageId && a.level == b.level && a.tileX == b.tileX && a.tileY == b.tileY;
+}
+
+static void MC_Imgui_Checks_TileCache(void)
+{
+	tileCache cache = {};
+	tileCache_init(&cache, 4);
+	if(!CHECK(cache.numSlots == 4))
+		return;
+
+	// acquire fills empty slots, and find returns them
+	u32 slots[4];
+	for(u32 i = 0; i < 4; ++i) {
+		b32 bEvicted = true;
+		slots[i] = tileCache_acquire(&cache, MC_Imgui_Checks_TileKey(1, i), &bEvicted, nullptr);
+		CHECK(slots[i] != kTileCache_InvalidSlot && !bEvicted);
+	}
+	CHECK(tileCache_count_occupied(&cache) == 4);
+	for(u32 i = 0; i < 4; ++i) {
+		CHECK(tileCache_find(&cache, MC_Imgui_Checks_TileKey(1, i)) == slots[i]);
+	}
+	CHECK(tileCache_find(&cache, MC_Imgui_Checks_TileKey(2, 0)) == kTileCache_InvalidSlot);
+	CHECK(cache.hits == 4 && cache.misses == 1);
+
+	// slots used this frame are never evicted
+	CHECK(tileCache_acquire(&cache, MC_Imgui_Checks_TileKey(2, 0), nullptr, nullptr) == kTileCache_InvalidSlot);
+
+	// eviction takes the least recently used slot: touch tiles 2, 0, 3 and 1 on successive frames
+	static const u32 s_touchOrder[] = { 2, 0, 3, 1 };
+	for(u32 i = 0; i < BB_ARRAYSIZE(s_touchOrder); ++i) {
+		tileCache_new_frame(&cache);
+		tileCache_find(&cache, MC_Imgui_Checks_TileKey(1, s_touchOrder[i]));
+	}
+	tileCache_new_frame(&cache);
+	for(u32 i = 0; i < BB_ARRAYSIZE(s_touchOrder); ++i) {
+		b32 bEvicted = false;
+		tileCacheKey evictedKey = {};
+		u32 slot = tileCache_acquire(&cache, MC_Imgui_Checks_TileKey(2, i), &bEvicted, &evictedKey);
+		CHECK(slot == slots[s_touchOrder[i]] && bEvicted);
+		CHECK(MC_Imgui_Checks_TileKeyEqual(evictedKey, MC_Imgui_Checks_TileKey(1, s_touchOrder[i])));
+	}
+	CHECK(cache.evictions == 4);
+	CHECK(tileCache_find(&cache, MC_Imgui_Checks_TileKey(1, 0)) == kTileCache_InvalidSlot);
+
+	// a released slot is reused before anything is evicted
+	tileCache_new_frame(&cache);
+	tileCache_release_slot(&cache, slots[1]);
+	CHECK(tileCache_count_occupied(&cache) == 3);
+	CHECK(tileCache_find(&cache, MC_Imgui_Checks_TileKey(2, 3)) == kTileCache_InvalidSlot);
+	CHECK(tileCache_acquire(&cache, MC_Imgui_Checks_TileKey(3, 0), nullptr, nullptr) == slots[1]);
+	CHECK(cache.evictions == 0);
+
+	// pinned slots survive while older slots are evicted, and a full pinned cache returns nothing
+	tileCache_new_frame(&cache);
+	tileCache_pin_slot(&cache, slots[2]);
+	tileCache_pin_slot(&cache, slots[0]);
+	tileCache_new_frame(&cache);
+	for(u32 i = 0; i < 2; ++i) {
+		u32 slot = tileCache_acquire(&cache, MC_Imgui_Checks_TileKey(4, i), nullptr, nullptr);
+		CHECK(slot != slots[2] && slot != slots[0] && slot != kTileCache_InvalidSlot);
+		tileCache_pin_slot(&cache, slot);
+	}
+	tileCache_new_frame(&cache);
+	CHECK(tileCache_acquire(&cache, MC_Imgui_Checks_TileKey(5, 0), nullptr, nullptr) == kTileCache_InvalidSlot);
+
+	// evicting an image frees its slots, pinned or not, and leaves the rest
+	tileCache_evict_image(&cache, 4);
+	CHECK(tileCache_count_occupied(&cache) == 2);
+	CHECK(tileCache_find(&cache, MC_Imgui_Checks_TileKey(4, 0)) == kTileCache_InvalidSlot);
+	CHECK(tileCache_find(&cache, MC_Imgui_Checks_TileKey(2, 0)) == slots[2]);
+	b32 bEvicted = true;
+	u32 slot = tileCache_acquire(&cache, MC_Imgui_Checks_TileKey(5, 0), &bEvicted, nullptr);
+	CHECK(slot != kTileCache_InvalidSlot && !bEvicted);
+
+	tileCache_clear(&cache);
+	CHECK(tileCache_count_occupied(&cache) == 0);
+	tileCache_reset(&cache);
+	CHECK(!cache.slots && !cache.numSlots);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Gap buffer
+
+enum {
+	kGapBufferCheck_Edits = 2000,
+	kGapBufferCheck_MaxBytes = 64 * 1024,
+};
+
+// Compares gb against a flat reference through every read path - char_at, spans, copy and
+// flatten_range - so a gap in the wrong place shows up regardless of how it is read.
+static bool MC_Imgui_Checks_GapBufferMatches(gapBuffer *gb, const char *flat, u64 flatLen, u32 *rng, char *scratch)
+{
+	if(gapBuffer_length(gb) != flatLen)
+		return false;
+
+	const char *first, *second;
+	u64 firstLen, secondLen;
+	gapBuffer_spans(gb, &first, &firstLen, &second, &secondLen);
+	if(firstLen + secondLen != flatLen || memcmp(first, flat, (size_t)firstLen) || memcmp(second, flat + firstLen, (size_t)secondLen))
+		return false;
+
+	u64 pos = flatLen ? MC_Imgui_Checks_Rand(rng) % (flatLen + 8) : 0;
+	u64 len = MC_Imgui_Checks_Rand(rng) % 256;
+	u64 expected = pos < flatLen ? BB_MIN(len, flatLen - pos) : 0;
+	if(gapBuffer_char_at(gb, pos) != (pos < flatLen ? flat[pos] : '\0'))
+		return false;
+	if(gapBuffer_copy(gb, pos, len, scratch) != expected || memcmp(scratch, flat + BB_MIN(pos, flatLen), (size_t)expected))
+		return false;
+	if(pos <= flatLen && memcmp(gapBuffer_flatten_range(gb, pos, len), flat + pos, (size_t)expected))
+		return false;
+	return true;
+}
+
+static void MC_Imgui_Checks_GapBuffer(void)
+{
+	static const char s_text[] = "gap \xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80 buffer\n";
+	char *flat = (char *)malloc(kGapBufferCheck_MaxBytes);
+	char *scratch = (char *)malloc(256);
+	gapBuffer gb;
+	gapBuffer_init(&gb, 0);
+	if(CHECK(flat && scratch)) {
+		CHECK(gapBuffer_length(&gb) == 0 && !strcmp(gapBuffer_flatten(&gb), ""));
+
+		// random inserts, erases and replaces from an empty buffer, growing it several times
+		u32 rng = 3;
+		u64 flatLen = 0;
+		u32 edits = gb.edits;
+		bool bMatched = true;
+		for(u32 i = 0; i < kGapBufferCheck_Edits && bMatched; ++i) {
+			u32 r = MC_Imgui_Checks_Rand(&rng);
+			u64 pos = MC_Imgui_Checks_Rand(&rng) % (flatLen + 1);
+			u64 insertLen = 1 + (r >> 4) % (sizeof(s_text) - 1);
+			u64 eraseLen = BB_MIN((u64)((r >> 10) % 16), flatLen - pos);
+			if(flatLen + insertLen >= kGapBufferCheck_MaxBytes) {
+				r = 1;
+			}
+			switch(r % 3) {
+			case 0:
+				bMatched = gapBuffer_insert(&gb, pos, s_text, insertLen) != 0;
+				memmove(flat + pos + insertLen, flat + pos, (size_t)(flatLen - pos));
+				memcpy(flat + pos, s_text, (size_t)insertLen);
+				flatLen += insertLen;
+				break;
+			case 1:
+				gapBuffer_erase(&gb, pos, eraseLen);
+				memmove(flat + pos, flat + pos + eraseLen, (size_t)(flatLen - pos - eraseLen));
+				flatLen -= eraseLen;
+				break;
+			default:
+				bMatched = gapBuffer_replace(&gb, pos, eraseLen, s_text, insertLen) != 0;
+				memmove(flat + pos + insertLen, flat + pos + eraseLen, (size_t)(flatLen - pos - eraseLen));
+				memcpy(flat + pos, s_text, (size_t)insertLen);
+				flatLen += insertLen - eraseLen;
+				break;
+			}
+			bMatched = bMatched && MC_Imgui_Checks_GapBufferMatches(&gb, flat, flatLen, &rng, scratch);
+		}
+		CHECK(bMatched);
+		CHECK(gb.grows > 1);
+		CHECK(gb.edits != edits);
+
+		// past-the-end positions clamp
+		edits = gb.edits;
+		gapBuffer_erase(&gb, flatLen, 10);
+		CHECK(gb.edits == edits);
+		CHECK(gapBuffer_insert(&gb, flatLen + 100, "!", 1));
+		flat[flatLen++] = '!';
+		const char *text = gapBuffer_flatten(&gb);
+		CHECK(text[flatLen] == '\0' && !memcmp(text, flat, (size_t)flatLen));
+
+		// utf8_align lands on the lead byte of each multi-byte sequence
+		CHECK(gapBuffer_assign(&gb, s_text, sizeof(s_text) - 1));
+		gapBuffer_insert(&gb, 6, "", 0); // gap inside the 3-byte sequence
+		CHECK(gapBuffer_utf8_align(&gb, 5) == 4);
+		CHECK(gapBuffer_utf8_align(&gb, 4) == 4);
+		CHECK(gapBuffer_utf8_align(&gb, 8) == 6);
+		CHECK(gapBuffer_utf8_align(&gb, 12) == 9);
+		CHECK(gapBuffer_utf8_align(&gb, 13) == 13);
+	}
+	gapBuffer_reset(&gb);
+	free(flat);
+	free(scratch);
+}
+
+enum {
+	kGapBufferWindowCheck_Moves = 500,
+	kGapBufferWindowCheck_MaxBytes = 256 * 1024,
+};
+
+// Compares every line start with a scan of the reference.
+static bool MC_Imgui_Checks_GapBufferLinesMatch(const gapBufferWindow *w, const char *flat, u64 flatLen)
+{
+	u32 line = 0;
+	if(gapBufferWindow_line_start(w, line++) != 0)
+		return false;
+	for(u64 i = 0; i < flatLen; ++i) {
+		if(flat[i] == '\n' && gapBufferWindow_line_start(w, line++) != i + 1)
+			return false;
+	}
+	if(gapBufferWindow_line_count(w) != line)
+		return false;
+	u32 probe = line / 2;
+	return gapBufferWindow_find_line(w, gapBufferWindow_line_start(w, probe)) == probe &&
+	       gapBufferWindow_find_line(w, gapBufferWindow_line_end(w, probe)) == probe;
+}
+
+// Moves a window around a document, editing through it as an editor would and now and then
+// editing the gapBuffer directly, and compares the text and line starts with a flat copy.
+static void MC_Imgui_Checks_GapBufferWindow(void)
+{
+	char *flat = (char *)malloc(kGapBufferWindowCheck_MaxBytes);
+	char *edit = (char *)malloc(kGapBufferWindowCheck_MaxBytes);
+	gapBuffer gb;
+	gapBufferWindow w = {};
+	gapBuffer_init(&gb, 0);
+	if(CHECK(flat && edit)) {
+		u32 rng = 5;
+		u64 flatLen = 0;
+		while(flatLen < kGapBufferWindowCheck_MaxBytes / 4) {
+			u32 r = MC_Imgui_Checks_Rand(&rng);
+			flat[flatLen++] = r % 7 ? (char)('a' + r % 26) : '\n';
+		}
+		CHECK(gapBuffer_assign(&gb, flat, flatLen));
+		CHECK(gapBufferWindow_sync(&w, &gb));
+		CHECK(!gapBufferWindow_sync(&w, &gb));
+		CHECK(MC_Imgui_Checks_GapBufferLinesMatch(&w, flat, flatLen));
+
+		bool bMatched = true;
+		for(u32 i = 0; i < kGapBufferWindowCheck_Moves && bMatched; ++i) {
+			u32 line = MC_Imgui_Checks_Rand(&rng) % gapBufferWindow_line_count(&w);
+			u32 maxLines = 1 + MC_Imgui_Checks_Rand(&rng) % 80;
+			u64 maxBytes = MC_Imgui_Checks_Rand(&rng) % 2048;
+			const char *text = gapBufferWindow_open(&w, &gb, line, maxLines, maxBytes);
+			u64 start = w.start;
+			u64 end = w.start + w.len;
+			bMatched = text && w.bOpen && end <= flatLen && !memcmp(text, flat + start, (size_t)w.len);
+			bMatched = bMatched && (start == 0 || flat[start - 1] == '\n') && (end == flatLen || flat[end] == '\n');
+			bMatched = bMatched && start <= gapBufferWindow_line_start(&w, line) && gapBufferWindow_line_end(&w, line) <= end;
+			bMatched = bMatched && w.linesWindow <= maxLines;
+			if(!bMatched)
+				break;
+
+			// a few edits in the editor's copy, then one commit
+			u64 len = w.len;
+			memcpy(edit, text, (size_t)len);
+			u32 edits = MC_Imgui_Checks_Rand(&rng) % 4;
+			for(u32 j = 0; j < edits; ++j) {
+				u32 r = MC_Imgui_Checks_Rand(&rng);
+				u64 pos = MC_Imgui_Checks_Rand(&rng) % (len + 1);
+				u64 eraseLen = BB_MIN((u64)(r % 8), len - pos);
+				u64 insertLen = (r >> 4) % 6;
+				if(flatLen - w.len + len + insertLen >= kGapBufferWindowCheck_MaxBytes) {
+					insertLen = 0;
+				}
+				memmove(edit + pos + insertLen, edit + pos + eraseLen, (size_t)(len - pos - eraseLen));
+				for(u64 k = 0; k < insertLen; ++k) {
+					edit[pos + k] = (r >> (8 + k)) & 1 ? '\n' : 'z';
+				}
+				len += insertLen - eraseLen;
+			}
+			bool bChanged = len != w.len || memcmp(edit, flat + start, (size_t)len);
+			bMatched = (gapBufferWindow_commit(&w, &gb, edit, len) != 0) == bChanged;
+			memmove(flat + start + len, flat + end, (size_t)(flatLen - end));
+			memcpy(flat + start, edit, (size_t)len);
+			flatLen += len - (end - start);
+			bMatched = bMatched && w.len == len && !gapBufferWindow_sync(&w, &gb);
+
+			// an edit from outside re-indexes and closes the window
+			if(MC_Imgui_Checks_Rand(&rng) % 16 == 0) {
+				u64 pos = MC_Imgui_Checks_Rand(&rng) % (flatLen + 1);
+				gapBuffer_insert(&gb, pos, "\n", 1);
+				memmove(flat + pos + 1, flat + pos, (size_t)(flatLen - pos));
+				flat[pos] = '\n';
+				++flatLen;
+				bMatched = bMatched && gapBufferWindow_sync(&w, &gb) && !w.bOpen;
+			}
+
+			const char *first, *second;
+			u64 firstLen, secondLen;
+			gapBuffer_spans(&gb, &first, &firstLen, &second, &secondLen);
+			bMatched = bMatched && firstLen + secondLen == flatLen && !memcmp(first, flat, (size_t)firstLen) && !memcmp(second, flat + firstLen, (size_t)secondLen);
+			bMatched = bMatched && MC_Imgui_Checks_GapBufferLinesMatch(&w, flat, flatLen);
+		}
+		CHECK(bMatched);
+
+		// the window always holds the line it was opened on, however long
+		gapBufferWindow_close(&w);
+		CHECK(!w.bOpen && MC_Imgui_Checks_GapBufferLinesMatch(&w, flat, flatLen));
+		CHECK(gapBufferWindow_open(&w, &gb, 0, 16, 0) && w.linesWindow == 1 && w.len == gapBufferWindow_line_end(&w, 0));
+	}
+	gapBufferWindow_reset(&w);
+	gapBuffer_reset(&gb);
+	free(flat);
+	free(edit);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Text search
+
+enum {
+	kTextSearchCheck_TextBytes = 16 * 1024,
+	kTextSearchCheck_LineBytes = 1024 * 1024,
+};
+
+static u64 MC_Imgui_Checks_FindNaive(const char *text, u64 textLen, const char *pattern, u64 patternLen, bool bIgnoreCase)
+{
+	for(u64 pos = 0; pos + patternLen <= textLen; ++pos) {
+		u64 i = 0;
+		for(; i < patternLen; ++i) {
+			char a = text[pos + i];
+			char b = pattern[i];
+			if(bIgnoreCase) {
+				a = (a >= 'A' && a <= 'Z') ? a - 'A' + 'a' : a;
+				b = (b >= 'A' && b <= 'Z') ? b - 'A' + 'a' : b;
+			}
+			if(a != b)
+				break;
+		}
+		if(i == patternLen)
+			return pos;
+	}
+	return textLen;
+}
+
+// matches is offset/length pairs
+static bool MC_Imgui_Checks_SearchIs(const textSearch *search, const u64 *matches, u32 count)
+{
+	if(search->matches.count != count)
+		return false;
+	for(u32 i = 0; i < count; ++i) {
+		if(search->matches.data[i].offset != matches[i * 2] || search->matches.data[i].length != matches[i * 2 + 1])
+			return false;
+	}
+	return true;
+}
+
+static bool MC_Imgui_Checks_SearchText(const char *pattern, u32 flags, const char *text, const u64 *matches, u32 count)
+{
+	textSearch search;
+	textSearch_init(&search);
+	bool ok = textSearch_set_pattern(&search, pattern, flags) &&
+	          textSearch_update(&search, text, strlen(text), 1, 0) &&
+	          MC_Imgui_Checks_SearchIs(&search, matches, count);
+	textSearch_reset(&search);
+	return ok;
+}
+
+static bool MC_Imgui_Checks_SearchSame(const textSearch *a, const textSearch *b)
+{
+	return a->matches.count == b->matches.count &&
+	       (!a->matches.count || !memcmp(a->matches.data, b->matches.data, a->matches.count * sizeof(textSearchMatch)));
+}
+
+static void MC_Imgui_Checks_TextSearch(void)
+{
+	// random text from a small alphabet, so short patterns match often and long ones occasionally,
+	// searched at every alignment the vector filters see
+	char *text = (char *)malloc(kTextSearchCheck_TextBytes + 1);
+	if(!CHECK(text))
+		return;
+	u32 rng = 4;
+	for(u32 i = 0; i < kTextSearchCheck_TextBytes; ++i) {
+		static const char s_alphabet[] = "abAB \n";
+		text[i] = s_alphabet[MC_Imgui_Checks_Rand(&rng) % (sizeof(s_alphabet) - 1)];
+	}
+	text[kTextSearchCheck_TextBytes] = '\0';
+	bool bFindMatched = true;
+	for(u32 i = 0; i < 2000 && bFindMatched; ++i) {
+		u64 patternLen = 1 + MC_Imgui_Checks_Rand(&rng) % 40;
+		u64 textLen = MC_Imgui_Checks_Rand(&rng) % 200;
+		u64 textStart = MC_Imgui_Checks_Rand(&rng) % (kTextSearchCheck_TextBytes - 256);
+		bool bIgnoreCase = (i & 1) != 0;
+		char pattern[40];
+		if(i & 2) {
+			// a pattern that is in the text, so long patterns are found too
+			u64 from = MC_Imgui_Checks_Rand(&rng) % (kTextSearchCheck_TextBytes - 64);
+			memcpy(pattern, text + from, (size_t)patternLen);
+		} else {
+			for(u64 j = 0; j < patternLen; ++j) {
+				pattern[j] = "abAB"[MC_Imgui_Checks_Rand(&rng) % 4];
+			}
+		}
+		if(i & 4) {
+			textStart = (MC_Imgui_Checks_Rand(&rng) % (kTextSearchCheck_TextBytes - 256 - patternLen));
+			memcpy(text + textStart + textLen, pattern, (size_t)patternLen); // one near the end of the range
+			textLen += patternLen;
+		}
+		bFindMatched = textSearch_find_literal(text + textStart, textLen, pattern, patternLen, bIgnoreCase) ==
+		               MC_Imgui_Checks_FindNaive(text + textStart, textLen, pattern, patternLen, bIgnoreCase);
+	}
+	CHECK(bFindMatched);
+	CHECK(textSearch_find_literal("abc", 3, "abcd", 4, false) == 3);
+	CHECK(textSearch_find_literal("", 0, "a", 1, false) == 0);
+
+	// literal matches don't overlap
+	{
+		const u64 expected[] = { 0, 2, 2, 2 };
+		CHECK(MC_Imgui_Checks_SearchText("aa", 0, "aaaaa", expected, 2));
+	}
+	{
+		const u64 expected[] = { 0, 3, 4, 3 };
+		CHECK(MC_Imgui_Checks_SearchText("abc", kTextSearch_IgnoreCase, "aBc ABC ab", expected, 2));
+	}
+
+	// regex
+	{
+		const u64 expected[] = { 3, 2, 7, 3, 11, 1 };
+		CHECK(MC_Imgui_Checks_SearchText("\\d+", kTextSearch_Regex, "ab 12 c345\n6", expected, 3));
+	}
+	{
+		const u64 expected[] = { 0, 3, 9, 3 };
+		CHECK(MC_Imgui_Checks_SearchText("^foo", kTextSearch_Regex, "foo\nxfoo\nfoo", expected, 2));
+	}
+	{
+		const u64 expected[] = { 2, 1, 8, 1 };
+		CHECK(MC_Imgui_Checks_SearchText("o$", kTextSearch_Regex, "foo\nbar o\r\n", expected, 2));
+	}
+	{
+		const u64 expected[] = { 0, 5, 6, 6 };
+		CHECK(MC_Imgui_Checks_SearchText("colou?r", kTextSearch_Regex | kTextSearch_IgnoreCase, "Color COLOUR colr", expected, 2));
+	}
+	{
+		const u64 expected[] = { 0, 4, 8, 2 };
+		CHECK(MC_Imgui_Checks_SearchText("[a-c]+x", kTextSearch_Regex, "abcx zx bx", expected, 2));
+	}
+	{
+		// greedy, but never across a line
+		const u64 expected[] = { 0, 5, 6, 3 };
+		CHECK(MC_Imgui_Checks_SearchText("a.*b", kTextSearch_Regex, "a1b2b\na3b", expected, 2));
+	}
+	{
+		textSearch search;
+		textSearch_init(&search);
+		CHECK(!textSearch_set_pattern(&search, "[abc", kTextSearch_Regex));
+		CHECK(!textSearch_set_pattern(&search, "*a", kTextSearch_Regex));
+		CHECK(!textSearch_set_pattern(&search, "a**", kTextSearch_Regex));
+		CHECK(!textSearch_set_pattern(&search, "", 0));
+		textSearch_reset(&search);
+	}
+
+	// appending in chunks, and scanning in slices, finds what one full search does
+	static const char *s_patterns[] = { "aba", "a b", "Ab a", "b\\w*a", "a+$", "^b" };
+	for(u32 i = 0; i < BB_ARRAYSIZE(s_patterns); ++i) {
+		u32 flags = (i >= 3 ? kTextSearch_Regex : 0) | (i == 2 ? kTextSearch_IgnoreCase : 0);
+		textSearch full, appended, sliced;
+		textSearch_init(&full);
+		textSearch_init(&appended);
+		textSearch_init(&sliced);
+		CHECK(textSearch_set_pattern(&full, s_patterns[i], flags));
+		textSearch_set_pattern(&appended, s_patterns[i], flags);
+		textSearch_set_pattern(&sliced, s_patterns[i], flags);
+		textSearch_update(&full, text, kTextSearchCheck_TextBytes, 1, 0);
+		for(u64 len = 0; len < kTextSearchCheck_TextBytes;) {
+			u64 chunk = 1 + MC_Imgui_Checks_Rand(&rng) % 700;
+			len = BB_MIN(len + chunk, (u64)kTextSearchCheck_TextBytes);
+			textSearch_update(&appended, text, len, 1, 0);
+		}
+		u32 updates = 0;
+		while(!textSearch_update(&sliced, text, kTextSearchCheck_TextBytes, 1, 333)) {
+			++updates;
+		}
+		CHECK(full.matches.count > 0);
+		CHECK(MC_Imgui_Checks_SearchSame(&full, &appended));
+		CHECK(MC_Imgui_Checks_SearchSame(&full, &sliced));
+		CHECK(updates > 1); // matches may run past a slice, so not exactly one per slice
+		textSearch_reset(&full);
+		textSearch_reset(&appended);
+		textSearch_reset(&sliced);
+	}
+
+	// regex work is linear in the text, so one long line fits in a budget of about its length, and a
+	// smaller budget picks up mid-match on the next update
+	{
+		char *line = (char *)malloc(kTextSearchCheck_LineBytes);
+		if(line) {
+			memset(line, 'a', kTextSearchCheck_LineBytes);
+			textSearch search;
+			textSearch_init(&search);
+			textSearch_set_pattern(&search, "a.*z", kTextSearch_Regex);
+			CHECK(textSearch_update(&search, line, kTextSearchCheck_LineBytes, 1, kTextSearchCheck_LineBytes + 1));
+			CHECK(search.matches.count == 0);
+			line[kTextSearchCheck_LineBytes - 1] = 'z';
+			u32 updates = 1;
+			while(!textSearch_update(&search, line, kTextSearchCheck_LineBytes, 2, kTextSearchCheck_LineBytes / 16)) {
+				++updates;
+			}
+			CHECK(updates <= 17);
+			CHECK(search.matches.count == 1 && search.matches.data[0].offset == 0 && search.matches.data[0].length == kTextSearchCheck_LineBytes);
+			textSearch_reset(&search);
+			free(line);
+		}
+	}
+
+	// editing text already searched requires a new version
+	{
+		char edited[] = "xx ab xx";
+		textSearch search;
+		textSearch_init(&search);
+		textSearch_set_pattern(&search, "ab", 0);
+		textSearch_update(&search, edited, 8, 1, 0);
+		CHECK(search.matches.count == 1 && search.matches.data[0].offset == 3);
+		edited[0] = 'a';
+		edited[1] = 'b';
+		textSearch_update(&search, edited, 8, 2, 0);
+		CHECK(search.matches.count == 2 && search.matches.data[0].offset == 0);
+
+		// navigation
+		CHECK(textSearch_first_ending_after(&search, 2) == 1);
+		CHECK(textSearch_first_ending_after(&search, 5) == 2);
+		textSearch_select_next(&search, 1);
+		CHECK(search.current == 1 && search.bScrollToCurrent);
+		textSearch_select_next(&search, 1);
+		CHECK(search.current == 0);
+		search.current = kTextSearch_None;
+		textSearch_select_prev(&search, 1);
+		CHECK(search.current == 0);
+		textSearch_select_prev(&search, 1);
+		CHECK(search.current == 1);
+		textSearch_reset(&search);
+	}
+	free(text);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Selection
+
+enum {
+	kSelectionCheck_Items = 300,
+	kSelectionCheck_Edits = 5000,
+};
+
+// Ranges must be sorted, non-empty, and neither overlap nor touch, and agree with the flags on
+// every query.
+static bool MC_Imgui_Checks_SelectionMatches(const selection *sel, const u8 *selected)
+{
+	for(u32 i = 0; i < sel->ranges.count; ++i) {
+		const selectionRange *range = sel->ranges.data + i;
+		if(range->start >= range->end || (i > 0 && range[-1].end >= range->start))
+			return false;
+	}
+	u32 count = 0;
+	u32 next = kSelection_None;
+	for(u32 item = kSelectionCheck_Items + 8; item-- > 0;) {
+		bool bSelected = item < kSelectionCheck_Items && selected[item];
+		if(bSelected) {
+			++count;
+			next = item;
+		}
+		if((selection_contains(sel, item) != 0) != bSelected || selection_next(sel, item) != next)
+			return false;
+	}
+	return selection_count(sel) == count;
+}
+
+static void MC_Imgui_Checks_Selection(void)
+{
+	u8 selected[kSelectionCheck_Items] = {};
+	selection sel;
+	selection_init(&sel);
+
+	// random range edits against a flag per item
+	u32 rng = 5;
+	bool bMatched = true;
+	for(u32 i = 0; i < kSelectionCheck_Edits && bMatched; ++i) {
+		u32 op = MC_Imgui_Checks_Rand(&rng) % 16;
+		u32 start = MC_Imgui_Checks_Rand(&rng) % kSelectionCheck_Items;
+		u32 len = MC_Imgui_Checks_Rand(&rng) % 40;
+		u32 end = BB_MIN(start + len, (u32)kSelectionCheck_Items);
+		if(op < 6) {
+			bMatched = selection_add_range(&sel, start, end) != 0;
+			memset(selected + start, 1, end - start);
+		} else if(op < 12) {
+			bMatched = selection_remove_range(&sel, start, end) != 0;
+			memset(selected + start, 0, end - start);
+		} else if(op < 15) {
+			bMatched = selection_toggle(&sel, start) != 0;
+			selected[start] = !selected[start];
+		} else if(start & 1) {
+			bMatched = selection_invert(&sel, end) != 0;
+			for(u32 item = 0; item < kSelectionCheck_Items; ++item) {
+				selected[item] = item < end && !selected[item];
+			}
+		} else {
+			bMatched = selection_select_all(&sel, end) != 0;
+			for(u32 item = 0; item < kSelectionCheck_Items; ++item) {
+				selected[item] = item < end;
+			}
+		}
+		bMatched = bMatched && MC_Imgui_Checks_SelectionMatches(&sel, selected);
+	}
+	CHECK(bMatched);
+
+	// clicks
+	selection_reset(&sel);
+	selection_click(&sel, 7, kSelection_Shift); // no anchor yet - a plain click
+	CHECK(selection_count(&sel) == 1 && selection_contains(&sel, 7) && sel.anchor == 7);
+	selection_click(&sel, 5, 0);
+	CHECK(selection_count(&sel) == 1 && selection_contains(&sel, 5) && sel.anchor == 5 && sel.cursor == 5);
+	selection_click(&sel, 8, kSelection_Shift);
+	CHECK(sel.ranges.count == 1 && sel.ranges.data[0].start == 5 && sel.ranges.data[0].end == 9 && sel.anchor == 5);
+	selection_click(&sel, 10, kSelection_Ctrl);
+	CHECK(sel.ranges.count == 2 && selection_count(&sel) == 5 && sel.anchor == 10);
+	selection_click(&sel, 12, kSelection_Ctrl | kSelection_Shift);
+	CHECK(sel.ranges.count == 2 && sel.ranges.data[1].start == 10 && sel.ranges.data[1].end == 13);
+	selection_click(&sel, 3, kSelection_Shift);
+	CHECK(sel.ranges.count == 1 && sel.ranges.data[0].start == 3 && sel.ranges.data[0].end == 11 && sel.cursor == 3);
+	selection_click(&sel, 6, kSelection_Ctrl);
+	CHECK(sel.ranges.count == 2 && !selection_contains(&sel, 6) && sel.anchor == 6);
+
+	// ctrl navigation only moves the cursor
+	selection_navigate(&sel, 20, kSelection_Ctrl);
+	CHECK(sel.cursor == 20 && sel.anchor == 6 && selection_count(&sel) == 7);
+	selection_navigate(&sel, 15, 0);
+	CHECK(selection_count(&sel) == 1 && selection_contains(&sel, 15) && sel.anchor == 15);
+
+	// a million items is still one range
+	CHECK(selection_select_all(&sel, 1000000) && sel.ranges.count == 1 && selection_count(&sel) == 1000000);
+	CHECK(selection_toggle(&sel, 500000) && sel.ranges.count == 2);
+	CHECK(selection_invert(&sel, 1000000) && sel.ranges.count == 1 && selection_next(&sel, 0) == 500000);
+	selection_reset(&sel);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Column sort
+
+enum {
+	kColumnSortCheck_Rows = 200000, // enough for the sort to be split across threads
+	kColumnSortCheck_Keys = 1000,   // few enough distinct keys that ties are common
+};
+
+struct columnSortCheckKeys {
+	u32 *keys[2]; // per column
+};
+
+static const u32 *s_columnSortCheckKeys;
+
+static int MC_Imgui_Checks_ColumnSortCompare(u32 rowA, u32 rowB, u32 column, void *userData)
+{
+	const u32 *keys = ((const columnSortCheckKeys *)userData)->keys[column];
+	return (keys[rowA] < keys[rowB]) ? -1 : (keys[rowA] > keys[rowB]) ? 1 : 0;
+}
+
+// qsort isn't stable, so ties are broken on row as a stable sort would.
+static int MC_Imgui_Checks_ColumnSortReferenceCompare(const void *a, const void *b)
+{
+	u32 rowA = *(const u32 *)a;
+	u32 rowB = *(const u32 *)b;
+	u32 keyA = s_columnSortCheckKeys[rowA];
+	u32 keyB = s_columnSortCheckKeys[rowB];
+	if(keyA != keyB)
+		return keyA < keyB ? -1 : 1;
+	return rowA < rowB ? -1 : rowA > rowB ? 1 : 0;
+}
+
+static bool MC_Imgui_Checks_ColumnSortMatches(const ImGui::columnSort *sort, const u32 *keys, u32 numRows, bool bDescending, u32 *reference)
+{
+	for(u32 i = 0; i < numRows; ++i) {
+		reference[i] = i;
+	}
+	s_columnSortCheckKeys = keys;
+	qsort(reference, numRows, sizeof(u32), &MC_Imgui_Checks_ColumnSortReferenceCompare);
+	if(sort->numRows != numRows)
+		return false;
+	for(u32 i = 0; i < numRows; ++i) {
+		if(ImGui::ColumnSortRow(sort, i) != reference[bDescending ? numRows - 1 - i : i])
+			return false;
+	}
+	return true;
+}
+
+static void MC_Imgui_Checks_ColumnSort(void)
+{
+	columnSortCheckKeys keys = {};
+	keys.keys[0] = (u32 *)malloc(kColumnSortCheck_Rows * sizeof(u32));
+	keys.keys[1] = (u32 *)malloc(kColumnSortCheck_Rows * sizeof(u32));
+	u32 *reference = (u32 *)malloc(kColumnSortCheck_Rows * sizeof(u32));
+	if(CHECK(keys.keys[0] && keys.keys[1] && reference)) {
+		u32 rng = 6;
+		for(u32 i = 0; i < kColumnSortCheck_Rows; ++i) {
+			keys.keys[0][i] = MC_Imgui_Checks_Rand(&rng) % kColumnSortCheck_Keys;
+			keys.keys[1][i] = MC_Imgui_Checks_Rand(&rng);
+		}
+
+		u32 sortColumn = 0;
+		b32 sortDescending = false;
+		ImGui::columnDrawData columns = {};
+		columns.sortColumn = &sortColumn;
+		columns.sortDescending = &sortDescending;
+		columns.numColumns = 2;
+		ImGui::columnSort sort;
+		ImGui::InitColumnSort(&sort, 2, &MC_Imgui_Checks_ColumnSortCompare, &keys);
+
+		// full sort, then a few rows appended (binary searched into place) and many (merged)
+		const u32 numRows = kColumnSortCheck_Rows / 2;
+		CHECK(ImGui::UpdateColumnSort(&sort, columns, numRows));
+		CHECK(MC_Imgui_Checks_ColumnSortMatches(&sort, keys.keys[0], numRows, false, reference));
+		CHECK(ImGui::UpdateColumnSort(&sort, columns, numRows + 10));
+		CHECK(MC_Imgui_Checks_ColumnSortMatches(&sort, keys.keys[0], numRows + 10, false, reference));
+		CHECK(ImGui::UpdateColumnSort(&sort, columns, kColumnSortCheck_Rows));
+		CHECK(MC_Imgui_Checks_ColumnSortMatches(&sort, keys.keys[0], kColumnSortCheck_Rows, false, reference));
+		CHECK(sort.fullSorts == 1 && sort.mergedRows == kColumnSortCheck_Rows - numRows);
+
+		// descending reads the same order backwards
+		sortDescending = true;
+		CHECK(ImGui::UpdateColumnSort(&sort, columns, kColumnSortCheck_Rows));
+		CHECK(MC_Imgui_Checks_ColumnSortMatches(&sort, keys.keys[0], kColumnSortCheck_Rows, true, reference));
+		CHECK(sort.fullSorts == 1);
+		CHECK(ImGui::ColumnSortRow(&sort, kColumnSortCheck_Rows + 5) == kColumnSortCheck_Rows + 5);
+
+		// each column keeps its own order
+		sortColumn = 1;
+		sortDescending = false;
+		CHECK(ImGui::UpdateColumnSort(&sort, columns, kColumnSortCheck_Rows));
+		CHECK(MC_Imgui_Checks_ColumnSortMatches(&sort, keys.keys[1], kColumnSortCheck_Rows, false, reference));
+		sortColumn = 0;
+		CHECK(ImGui::UpdateColumnSort(&sort, columns, kColumnSortCheck_Rows));
+		CHECK(sort.fullSorts == 2);
+
+		// removing rows, or changing them, re-sorts
+		CHECK(ImGui::UpdateColumnSort(&sort, columns, numRows));
+		CHECK(MC_Imgui_Checks_ColumnSortMatches(&sort, keys.keys[0], numRows, false, reference));
+		CHECK(sort.fullSorts == 3);
+		for(u32 i = 0; i < numRows; i += 7) {
+			keys.keys[0][i] = kColumnSortCheck_Keys - keys.keys[0][i];
+		}
+		ImGui::InvalidateColumnSort(&sort);
+		CHECK(ImGui::UpdateColumnSort(&sort, columns, numRows));
+		CHECK(MC_Imgui_Checks_ColumnSortMatches(&sort, keys.keys[0], numRows, false, reference));
+
+		// one thread sorts the same
+		ImGui::InvalidateColumnSort(&sort);
+		sort.maxThreads = 1;
+		CHECK(ImGui::UpdateColumnSort(&sort, columns, kColumnSortCheck_Rows));
+		CHECK(MC_Imgui_Checks_ColumnSortMatches(&sort, keys.keys[0], kColumnSortCheck_Rows, false, reference));
+
+		// an unknown column leaves rows in data order
+		sortColumn = 2;
+		CHECK(!ImGui::UpdateColumnSort(&sort, columns, numRows));
+		CHECK(ImGui::ColumnSortRow(&sort, 3) == 3);
+		ImGui::ResetColumnSort(&sort);
+	}
+	free(keys.keys[0]);
+	free(keys.keys[1]);
+	free(reference);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Column filter
+
+enum {
+	kColumnFilterCheck_Rows = 100000, // several chunks
+};
+
+struct columnFilterCheckRows {
+	u32 salt; // changes every row's text
+	volatile LONG calls;
+};
+
+// Six letters from "abc" per row, so short queries match often and longer ones rarely.
+static void MC_Imgui_Checks_FilterRowText(u32 row, u32 salt, char text[7])
+{
+	u32 hash = (row + salt) * 2654435761u;
+	for(u32 i = 0; i < 6; ++i) {
+		text[i] = "abc"[hash % 3];
+		hash /= 3;
+	}
+	text[6] = '\0';
+}
+
+static bool MC_Imgui_Checks_FilterRow(u32 row, const char *query, void *userData)
+{
+	columnFilterCheckRows *rows = (columnFilterCheckRows *)userData;
+	char text[7];
+	InterlockedIncrement(&rows->calls);
+	MC_Imgui_Checks_FilterRowText(row, rows->salt, text);
+	return strstr(text, query) != nullptr;
+}
+
+// Updates until the filter completes, then compares its rows with a scan of every row.
+static bool MC_Imgui_Checks_FilterMatches(ImGui::columnFilter *filter, const char *query, u32 numRows)
+{
+	const columnFilterCheckRows *rows = (const columnFilterCheckRows *)filter->userData;
+	while(!ImGui::UpdateColumnFilter(filter, query, numRows)) {
+		Sleep(1);
+	}
+	u32 index = 0;
+	for(u32 row = 0; row < numRows; ++row) {
+		char text[7];
+		MC_Imgui_Checks_FilterRowText(row, rows->salt, text);
+		if(strstr(text, query)) {
+			if(index >= filter->rows.count || filter->rows.data[index] != row)
+				return false;
+			++index;
+		}
+	}
+	return index == filter->rows.count;
+}
+
+static void MC_Imgui_Checks_ColumnFilter(void)
+{
+	columnFilterCheckRows rows = {};
+	ImGui::columnFilter filter;
+	ImGui::InitColumnFilter(&filter, &MC_Imgui_Checks_FilterRow, &rows);
+	const u32 numRows = kColumnFilterCheck_Rows;
+
+	CHECK(MC_Imgui_Checks_FilterMatches(&filter, "ab", numRows));
+	CHECK((u32)rows.calls == numRows);
+
+	// a longer query only re-tests the previous matches
+	u32 prevMatches = filter.rows.count;
+	rows.calls = 0;
+	CHECK(MC_Imgui_Checks_FilterMatches(&filter, "abc", numRows));
+	CHECK((u32)rows.calls == prevMatches && filter.rows.count < prevMatches);
+
+	// appended rows are filtered on their own
+	rows.calls = 0;
+	CHECK(MC_Imgui_Checks_FilterMatches(&filter, "abc", numRows + 1000));
+	CHECK((u32)rows.calls == 1000);
+
+	// a shorter query, or fewer rows, filters every row again
+	rows.calls = 0;
+	CHECK(MC_Imgui_Checks_FilterMatches(&filter, "a", numRows));
+	CHECK((u32)rows.calls == numRows);
+	rows.calls = 0;
+	CHECK(MC_Imgui_Checks_FilterMatches(&filter, "a", numRows / 2));
+	CHECK((u32)rows.calls == numRows / 2);
+
+	// an empty query matches every row without testing any
+	rows.calls = 0;
+	CHECK(MC_Imgui_Checks_FilterMatches(&filter, "", numRows));
+	CHECK((u32)rows.calls == 0 && filter.rows.count == numRows);
+
+	// changed rows need an invalidate
+	CHECK(MC_Imgui_Checks_FilterMatches(&filter, "cab", numRows));
+	ImGui::InvalidateColumnFilter(&filter);
+	rows.salt = 1;
+	CHECK(MC_Imgui_Checks_FilterMatches(&filter, "cab", numRows));
+
+	// queries changing before the last completes leave nothing of it behind
+	for(u32 i = 0; i < 20; ++i) {
+		static const char *s_queries[] = { "b", "bc", "bca", "c", "" };
+		ImGui::UpdateColumnFilter(&filter, s_queries[i % BB_ARRAYSIZE(s_queries)], numRows);
+	}
+	CHECK(MC_Imgui_Checks_FilterMatches(&filter, "ca", numRows));
+	ImGui::ResetColumnFilter(&filter);
+	CHECK(filter.rows.count == 0 && !filter.query);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Column channels
+
+enum {
+	kColumnChannelsCheck_Rows = 50,
+	kColumnChannelsCheck_Columns = 8,
+};
+
+// Draws the same cells with and without column channels in a private headless ImGui context, and
+// counts the draw commands each leaves in the window's draw list.  With channels, each column's
+// cells share one command, beside the one for the window itself.
+static void MC_Imgui_Checks_ColumnChannels(void)
+{
+	const u32 numColumns = kColumnChannelsCheck_Columns;
+	float columnWidths[kColumnChannelsCheck_Columns];
+	float columnOffsets[kColumnChannelsCheck_Columns + 1];
+
+	ImGuiContext *prevContext = ImGui::GetCurrentContext();
+	ImGuiContext *context = ImGui::CreateContext();
+	ImGui::SetCurrentContext(context);
+	ImGuiIO &io = ImGui::GetIO();
+	io.IniFilename = nullptr;
+	io.DisplaySize = ImVec2(1920.0f, 1080.0f);
+	io.DeltaTime = 1.0f / 60.0f;
+	unsigned char *pixels = nullptr;
+	int width = 0;
+	int height = 0;
+	io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height); // builds the default font
+
+	u32 drawCmdsClipPerCell = 0;
+	u32 drawCmdsChannels = 0;
+	for(int pass = 0; pass < 2; ++pass) {
+		ImGui::NewFrame();
+		ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+		ImGui::SetNextWindowSize(io.DisplaySize);
+		ImGui::Begin("columns", nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoSavedSettings);
+		ImGui::columnDrawData columns = {};
+		columns.columnWidths = columnWidths;
+		columns.columnOffsets = columnOffsets;
+		columns.numColumns = numColumns;
+		for(u32 i = 0; i <= numColumns; ++i) {
+			if(i < numColumns) {
+				columnWidths[i] = 100.0f;
+			}
+			columnOffsets[i] = ImGui::GetCursorPosX() + 100.0f * (float)i;
+		}
+		if(pass) {
+			ImGui::BeginColumnChannels(columns);
+		}
+		for(u32 row = 0; row < kColumnChannelsCheck_Rows; ++row) {
+			for(u32 column = 0; column < numColumns; ++column) {
+				ImGui::DrawColumnText(columns, column, "cell text");
+			}
+		}
+		if(pass) {
+			ImGui::EndColumnChannels();
+		}
+		ImDrawList *drawList = ImGui::GetWindowDrawList();
+		ImGui::End();
+		ImGui::Render();
+		u32 drawCmds = (u32)drawList->CmdBuffer.Size;
+		if(pass) {
+			drawCmdsChannels = drawCmds;
+		} else {
+			drawCmdsClipPerCell = drawCmds;
+		}
+	}
+
+	ImGui::DestroyContext(context);
+	ImGui::SetCurrentContext(prevContext);
+	CHECK(drawCmdsChannels <= numColumns + 1);
+	CHECK(drawCmdsChannels < drawCmdsClipPerCell);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Frame allocations
+
+enum {
+	kFrameAllocationsCheck_WarmupFrames = 4,
+	kFrameAllocationsCheck_Frames = 16,
+	kFrameAllocationsCheck_Columns = 6,
+};
+
+static void MC_Imgui_Checks_FrameAllocationsFrame(ImGui::columnDrawData columns, messageBoxes *boxes)
+{
+	Imgui_Core_BeginFrameAllocations();
+	ImGui::NewFrame();
+	ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+	ImGui::SetNextWindowSize(ImGui::GetIO().DisplaySize);
+	ImGui::Begin("frame allocations", nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoSavedSettings);
+	for(u32 i = 0; i < columns.numColumns; ++i) {
+		ImGui::DrawColumnHeader(columns, i);
+	}
+	ImGui::NewLine();
+	UIMessageBox_Update(boxes);
+	ImGui::End();
+	ImGui::Render();
+}
+
+// Once warmed up, drawing column headers and a message box in a private headless ImGui context
+// shouldn't touch the heap.
+static void MC_Imgui_Checks_FrameAllocations(void)
+{
+	const char *columnNames[kFrameAllocationsCheck_Columns] = { "Time", "Thread", "Category", "File", "Line", "Message" };
+	float columnWidths[kFrameAllocationsCheck_Columns] = {};
+	float columnOffsets[kFrameAllocationsCheck_Columns + 1] = {};
+	b32 sortDescending = false;
+	u32 sortColumn = 0;
+	ImGui::columnDrawData columns = {};
+	columns.columnWidths = columnWidths;
+	columns.columnOffsets = columnOffsets;
+	columns.columnNames = columnNames;
+	columns.sortDescending = &sortDescending;
+	columns.sortColumn = &sortColumn;
+	columns.numColumns = kFrameAllocationsCheck_Columns;
+
+	messageBoxes boxes = {};
+	messageBox mb = {};
+	sdict_add_raw(&mb.data, "title", "Update Available");
+	sdict_add_raw(&mb.data, "text", "An update is available.  Update and restart?");
+	sdict_add_raw(&mb.data, "button1", "Update");
+	sdict_add_raw(&mb.data, "button2", "Ignore");
+	mb_queue(mb, &boxes);
+
+	b32 bWasEnabled = Imgui_Core_EnableAllocationCounter(true);
+	ImGuiContext *prevContext = ImGui::GetCurrentContext();
+	ImGuiContext *context = ImGui::CreateContext();
+	ImGui::SetCurrentContext(context);
+	ImGuiIO &io = ImGui::GetIO();
+	io.IniFilename = nullptr;
+	io.DisplaySize = ImVec2(1920.0f, 1080.0f);
+	io.DeltaTime = 1.0f / 60.0f;
+	unsigned char *pixels = nullptr;
+	int width = 0;
+	int height = 0;
+	io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height); // builds the default font
+
+	for(u32 frame = 0; frame < kFrameAllocationsCheck_WarmupFrames; ++frame) {
+		MC_Imgui_Checks_FrameAllocationsFrame(columns, &boxes);
+	}
+	u32 allocatingFrames = 0;
+	for(u32 frame = 0; frame < kFrameAllocationsCheck_Frames; ++frame) {
+		MC_Imgui_Checks_FrameAllocationsFrame(columns, &boxes);
+		// the previous frame's count, so the last frame is counted below
+		Imgui_Core_FrameAllocations allocations = Imgui_Core_GetFrameAllocations();
+		if(frame > 0 && (allocations.imgui || allocations.crt)) {
+			++allocatingFrames;
+		}
+	}
+	Imgui_Core_BeginFrameAllocations();
+	Imgui_Core_FrameAllocations allocations = Imgui_Core_GetFrameAllocations();
+	CHECK(allocations.imgui == 0 && allocations.crt == 0);
+	CHECK(allocatingFrames == 0);
+	CHECK(mb_get_active(&boxes) != nullptr);
+
+	mb_remove_active(&boxes);
+	MC_Imgui_Checks_FrameAllocationsFrame(columns, &boxes); // lets the layout of the removed box go
+	ImGui::DestroyContext(context);
+	ImGui::SetCurrentContext(prevContext);
+	Imgui_Core_EnableAllocationCounter(bWasEnabled);
+	mb_shutdown(&boxes);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Input text state reclamation
+
+enum {
+	kInputTextStateCheck_Lifetime = 30,
+	kInputTextStateCheck_WidgetsPerFrame = 4,
+	kInputTextStateCheck_Frames = 600,
+	kInputTextStateCheck_CollectIntervalFrames = 60, // kWidgetState_CollectIntervalFrames
+};
+
+static void MC_Imgui_Checks_InputTextStateFrame(u32 frame, u32 numWidgets)
+{
+	static char s_text[] = "line 1\nline 2\nline 3";
+	ImGui::NewFrame();
+	ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+	ImGui::SetNextWindowSize(ImGui::GetIO().DisplaySize);
+	ImGui::Begin("input text states", nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoSavedSettings);
+	for(u32 i = 0; i < numWidgets; ++i) {
+		ImGui::PushID((int)(frame * numWidgets + i));
+		ImGui::InputTextMultilineScrolling("##text", s_text, sizeof(s_text), ImVec2(200.0f, 40.0f), ImGuiInputTextFlags_ReadOnly);
+		ImGui::PopID();
+	}
+	ImGui::End();
+	ImGui::EndFrame();
+}
+
+// Draws widgets with fresh IDs every frame in a private headless ImGui context, so each state goes
+// unused right away.  Live states should stay within what a lifetime and a collection interval can
+// hold, and the pool should stop growing once reclaimed states are reused.
+static void MC_Imgui_Checks_InputTextStates(void)
+{
+	const u32 maxLiveStates = kInputTextStateCheck_WidgetsPerFrame * (kInputTextStateCheck_Lifetime + kInputTextStateCheck_CollectIntervalFrames + 1);
+	u32 prevLifetime = ImGui::InputTextSetStateLifetime(kInputTextStateCheck_Lifetime);
+	InputTextStateStats before = ImGui::InputTextGetStateStats();
+
+	ImGuiContext *prevContext = ImGui::GetCurrentContext();
+	ImGuiContext *context = ImGui::CreateContext();
+	ImGui::SetCurrentContext(context);
+	ImGuiIO &io = ImGui::GetIO();
+	io.IniFilename = nullptr;
+	io.DisplaySize = ImVec2(1920.0f, 1080.0f);
+	io.DeltaTime = 1.0f / 60.0f;
+	unsigned char *pixels = nullptr;
+	int width = 0;
+	int height = 0;
+	io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height); // builds the default font
+
+	InputTextStateStats halfway = {};
+	u32 maxLive = 0;
+	for(u32 frame = 0; frame < kInputTextStateCheck_Frames; ++frame) {
+		MC_Imgui_Checks_InputTextStateFrame(frame, kInputTextStateCheck_WidgetsPerFrame);
+		InputTextStateStats stats = ImGui::InputTextGetStateStats();
+		maxLive = BB_MAX(maxLive, stats.liveStates - before.liveStates);
+		if(frame == kInputTextStateCheck_Frames / 2) {
+			halfway = stats;
+		}
+	}
+	InputTextStateStats after = ImGui::InputTextGetStateStats();
+	CHECK(maxLive <= maxLiveStates);
+	CHECK(after.poolBytes == halfway.poolBytes);
+	CHECK(after.reclaimedStates > halfway.reclaimedStates);
+	CHECK(after.reclaimedStates - before.reclaimedStates >= kInputTextStateCheck_Frames * kInputTextStateCheck_WidgetsPerFrame - maxLiveStates);
+
+	// the remaining states refer to this context's storage, so they have to go before it does
+	for(u32 frame = 0; frame <= kInputTextStateCheck_Lifetime; ++frame) {
+		MC_Imgui_Checks_InputTextStateFrame(frame, 0);
+	}
+	ImGui::InputTextCollectStates();
+	CHECK(ImGui::InputTextGetStateStats().liveStates == before.liveStates);
+
+	ImGui::DestroyContext(context);
+	ImGui::SetCurrentContext(prevContext);
+	ImGui::InputTextSetStateLifetime(prevLifetime);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Update manifest checks
+
+enum {
+	kUpdateCheck_TimeoutMs = 200,
+	kUpdateCheck_DelayMs = 50,
+	kUpdateCheck_DeadlineMs = 5000,
+	kUpdateCheck_MaxTickMs = 20,
+};
+
+// Stands in for reading the manifest share.  Each read reports its number as the stable version,
+// so the checks can tell which read was published.  The read numbered hangRead blocks until
+// release is signalled.
+struct updateCheckReader {
+	HANDLE release;
+	volatile LONG reads;
+	volatile LONG returned;
+	LONG hangRead;
+	u32 delayMs;
+};
+
+static updateCheckReader s_updateCheckReader;
+
+static JSON_Value *MC_Imgui_Checks_ManifestReader(const char *path)
+{
+	BB_UNUSED(path);
+	LONG read = InterlockedIncrement(&s_updateCheckReader.reads);
+	if(read == s_updateCheckReader.hangRead) {
+		WaitForSingleObject(s_updateCheckReader.release, INFINITE);
+	} else {
+		Sleep(s_updateCheckReader.delayMs);
+	}
+	char json[64];
+	snprintf(json, sizeof(json), "{ \"stable\": \"read%ld\" }", read);
+	JSON_Value *val = json_parse_string(json);
+	InterlockedIncrement(&s_updateCheckReader.returned);
+	return val;
+}
+
+static bool MC_Imgui_Checks_IsPublished(LONG read)
+{
+	char stable[32];
+	snprintf(stable, sizeof(stable), "read%ld", read);
+	return !strcmp(sb_get(&Update_GetManifest()->stable), stable);
+}
+
+// Ticks until read is published or the deadline passes, tracking the slowest tick.  Fails if
+// notRead is published along the way.
+static bool MC_Imgui_Checks_TickUntilPublished(LONG read, LONG notRead, u64 *maxTickMs)
+{
+	u64 deadlineMs = bb_current_time_ms() + kUpdateCheck_DeadlineMs;
+	while(bb_current_time_ms() < deadlineMs) {
+		u64 startMs = bb_current_time_ms();
+		Update_Tick();
+		u64 tickMs = bb_current_time_ms() - startMs;
+		*maxTickMs = BB_MAX(*maxTickMs, tickMs);
+		if(notRead && MC_Imgui_Checks_IsPublished(notRead))
+			return false;
+		if(MC_Imgui_Checks_IsPublished(read))
+			return true;
+		Sleep(1);
+	}
+	return false;
+}
+
+// Drives the manifest check through a reader that is slow, hangs, or is overtaken by a rewrite of
+// the manifest.  The reported versions aren't numbers, so no update is ever offered.
+static void MC_Imgui_Checks_Update(void)
+{
+	memset(&s_updateCheckReader, 0, sizeof(s_updateCheckReader));
+	s_updateCheckReader.release = CreateEventA(NULL, TRUE, FALSE, NULL);
+	s_updateCheckReader.delayMs = kUpdateCheck_DelayMs;
+	s_updateCheckReader.hangRead = 2;
+	if(!CHECK(s_updateCheckReader.release))
+		return;
+	Update_SetManifestReader(&MC_Imgui_Checks_ManifestReader);
+
+	updateData data = {};
+	data.appName = "mc_imgui_checks";
+	data.exeName = "mc_imgui_checks.exe";
+	data.windowClassname = "mc_imgui_checks";
+	data.manifestDir = "mc_imgui_checks";
+	data.manifestTimeoutMs = kUpdateCheck_TimeoutMs;
+	Update_Init(&data); // starts read 1
+	u64 maxTickMs = 0;
+
+	// a delayed read is published
+	CHECK(MC_Imgui_Checks_TickUntilPublished(1, 0, &maxTickMs));
+
+	// a hung read is abandoned after the timeout, and the next check reads again
+	Update_CheckForUpdates(false); // read 2 hangs
+	u64 startMs = bb_current_time_ms();
+	while(bb_current_time_ms() - startMs <= kUpdateCheck_TimeoutMs + kUpdateCheck_DelayMs) {
+		u64 tickStartMs = bb_current_time_ms();
+		Update_Tick();
+		u64 tickMs = bb_current_time_ms() - tickStartMs;
+		maxTickMs = BB_MAX(maxTickMs, tickMs);
+		Sleep(1);
+	}
+	Update_CheckForUpdates(false); // read 3
+	CHECK(MC_Imgui_Checks_TickUntilPublished(3, 0, &maxTickMs));
+	CHECK(s_updateCheckReader.returned == 2);
+
+	// a read overtaken by a rewrite of the manifest is dropped and replaced
+	Update_CheckForUpdates(false); // read 4
+	Update_ManifestChanged();
+	CHECK(MC_Imgui_Checks_TickUntilPublished(5, 4, &maxTickMs));
+
+	// the hung read finishing late publishes nothing
+	SetEvent(s_updateCheckReader.release);
+	u64 deadlineMs = bb_current_time_ms() + kUpdateCheck_DeadlineMs;
+	while(s_updateCheckReader.returned != s_updateCheckReader.reads && bb_current_time_ms() < deadlineMs) {
+		Update_Tick();
+		Sleep(1);
+	}
+	Update_Tick();
+	CHECK(s_updateCheckReader.returned == 5);
+	CHECK(MC_Imgui_Checks_IsPublished(5));
+	CHECK(maxTickMs <= kUpdateCheck_MaxTickMs);
+
+	Update_Shutdown();
+	Update_SetManifestReader(NULL);
+	CloseHandle(s_updateCheckReader.release);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+u32 MC_Imgui_Checks_Run(void)
+{
+	s_checks = 0;
+	s_failures = 0;
+	MC_Imgui_Checks_DiskCache();
+	MC_Imgui_Checks_TripleBuffer();
+	MC_Imgui_Checks_BC();
+	MC_Imgui_Checks_TileCache();
+	MC_Imgui_Checks_GapBuffer();
+	MC_Imgui_Checks_GapBufferWindow();
+	MC_Imgui_Checks_TextSearch();
+	MC_Imgui_Checks_Selection();
+	MC_Imgui_Checks_ColumnSort();
+	MC_Imgui_Checks_ColumnFilter();
+	MC_Imgui_Checks_ColumnChannels();
+	MC_Imgui_Checks_FrameAllocations();
+	MC_Imgui_Checks_InputTextStates();
+	MC_Imgui_Checks_Update();
+	BB_LOG("Checks", "%u checks, %u failed", s_checks, s_failures);
+	return s_failures;
+}
+
+#endif // #if defined(MC_IMGUI_BENCHMARKS)
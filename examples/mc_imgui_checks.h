@@ -0,0 +1,14 @@
+// Copyright (c) 2012-2019 Matt Campbell
+// MIT license (see License.txt)
+
+#pragma once
+
+#include "common.h"
+
+#if defined(MC_IMGUI_BENCHMARKS)
+
+// Correctness checks for the library code that runs without a window or device.  Failures are
+// logged as warnings.  Returns the number of failed checks.
+u32 MC_Imgui_Checks_Run(void);
+
+#endif // #if defined(MC_IMGUI_BENCHMARKS)
@@ -3,11 +3,14 @@
 
 #include "mc_imgui_example.h"
 #include "common.h"
+#include "cmdline.h"
 #include "crt_leak_check.h"
 #include "fonts.h"
 #include "imgui_core.h"
 #include "imgui_image.h"
 #include "imgui_input_text.h"
+#include "mc_imgui_benchmarks.h"
+#include "mc_imgui_checks.h"
 #include "message_box.h"
 #include "str.h"
 #include "tokenize.h"
@@ -18,6 +21,10 @@ static bool s_showImguiAbout;
 static bool s_showImguiMetrics;
 static bool s_showImguiUserGuide;
 static bool s_showImguiStyleEditor;
+static bool s_showImageStats;
+#if defined(MC_IMGUI_BENCHMARKS)
+static bool s_showBenchmarks;
+#endif
 static UserImageId s_imageId;
 
 static const char *s_colorschemes[] = {
@@ -79,6 +86,14 @@ static void MC_Imgui_Example_MainMenuBar(void)
 				ImGui::EndMenu();
 			}
 			Fonts_Menu();
+			ImGui::MenuItem("Image Stats", nullptr, &s_showImageStats);
+#if defined(MC_IMGUI_BENCHMARKS)
+			ImGui::Separator();
+			ImGui::MenuItem("Benchmarks", nullptr, &s_showBenchmarks);
+			if(ImGui::MenuItem("Run Checks")) {
+				MC_Imgui_Checks_Run();
+			}
+#endif
 			ImGui::EndMenu();
 		}
 		if(ImGui::BeginMenu("Imgui Help")) {
@@ -97,7 +112,7 @@ static void MC_Imgui_Example_Image(void)
 {
 	if(s_imageId.id) {
 		UserImageData image = ImGui_Image_Get(s_imageId);
-		if(image.texture) {
+		if(image.width > 0 && image.height > 0) {
 			ImVec2 windowSize = ImGui::GetContentRegionAvail();
 			if(windowSize.x >= (float)image.width) {
 				windowSize.x = (float)image.width;
@@ -111,7 +126,7 @@ static void MC_Imgui_Example_Image(void)
 			start.y += 20.0f;
 			ImVec2 end(start.x + constrainedSize.x, start.y + constrainedSize.y);
 			ImDrawList *drawList = ImGui::GetWindowDrawList();
-			drawList->AddImage(image.texture, start, end, ImVec2(0.0f, 0.0f), ImVec2(1.0f, 1.0f), 0xFFFFFFFF);
+			ImGui_Image_Draw(s_imageId, drawList, start, end);
 		}
 	}
 }
@@ -160,6 +175,17 @@ void MC_Imgui_Example_Update(void)
 	if(s_showImguiStyleEditor) {
 		ImGui::ShowStyleEditor();
 	}
+	if(s_showImageStats) {
+		if(ImGui::Begin("Image Stats", &s_showImageStats)) {
+			ImGui_Image_DrawStats();
+		}
+		ImGui::End();
+	}
+#if defined(MC_IMGUI_BENCHMARKS)
+	if(s_showBenchmarks) {
+		MC_Imgui_Benchmarks_Window(&s_showBenchmarks);
+	}
+#endif
 }
 
 int CALLBACK WinMain(_In_ HINSTANCE /*Instance*/, _In_opt_ HINSTANCE /*PrevInstance*/, _In_ LPSTR CommandLine, _In_ int /*ShowCode*/)
@@ -172,6 +198,16 @@ int CALLBACK WinMain(_In_ HINSTANCE /*Instance*/, _In_opt_ HINSTANCE /*PrevInsta
 
 	Imgui_Core_Init(CommandLine);
 
+#if defined(MC_IMGUI_BENCHMARKS)
+	// -checks runs the headless checks and exits with the number that failed, for scripted builds
+	if(cmdline_find("-checks") > 0) {
+		u32 failures = MC_Imgui_Checks_Run();
+		Imgui_Core_Shutdown();
+		BB_SHUTDOWN();
+		return (int)failures;
+	}
+#endif
+
 	ImGui::GetIO().ConfigFlags |= ImGuiConfigFlags_DockingEnable;
 	//ImGui::GetIO().ConfigFlags |= ImGuiConfigFlags_ViewportsEnable;
 
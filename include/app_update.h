@@ -4,6 +4,7 @@
 #pragma once
 
 #include "common.h"
+#include "parson/parson.h"
 #include "sb.h"
 #include "update_utils.h"
 
@@ -22,16 +23,24 @@ typedef struct tag_updateData {
 	b32 pauseAfterFailure;
 	u32 updateCheckMs;
 	b32 showUpdateManagement;
-	u8 pad[4];
+	u32 manifestTimeoutMs; // 0 for the default - a slower manifest read is abandoned
 } updateData;
 
 b32 Update_Init(updateData *data);
 void Update_Shutdown(void);
+// Call once per frame - manifest checks run on a worker thread and are applied here.
 void Update_Tick(void);
 void Update_Menu(void);
 updateData* Update_GetData(void);
 updateManifest_t *Update_GetManifest(void);
 void Update_CheckForUpdates(b32 bUpdateImmediately);
+// Call after rewriting the build manifest - a read in flight may have seen the old one, so its
+// result is dropped and the manifest read again.
+void Update_ManifestChanged(void);
+// Reads and parses the build manifest on a manifest check's worker thread - json_parse_file unless
+// replaced.  Pass NULL to restore it.  Checks already started keep the reader they started with.
+typedef JSON_Value *(Update_ManifestReader)(const char *path);
+void Update_SetManifestReader(Update_ManifestReader *reader);
 const char *Update_GetCurrentVersion(void);
 b32 Update_IsDesiredVersion(const char *versionName);
 void Update_SetDesiredVersion(const char *versionName);
@@ -0,0 +1,63 @@
+// Copyright (c) 2012-2019 Matt Campbell
+// MIT license (see License.txt)
+
+#pragma once
+
+#include "imgui_utils.h"
+
+namespace ImGui
+{
+	// Returns true if row matches query.  Runs on worker threads, so it must only read row data that
+	// stays unchanged while the filter runs - call InvalidateColumnFilter after changing rows.
+	typedef bool (*columnFilterFunc)(u32 row, const char *query, void *userData);
+
+	struct columnFilterChunk;
+
+	struct columnFilterRows {
+		u32 count;
+		u32 allocated;
+		u32 *data;
+	};
+
+	struct columnFilterChunks {
+		u32 count;
+		u32 allocated;
+		columnFilterChunk **data;
+	};
+
+	// Filters rows in chunks on a shared worker pool, off the UI thread.  UpdateColumnFilter, called
+	// each frame from the UI thread, starts work when the query or row count changes, and appends
+	// finished chunks to rows in row order, so matches appear progressively and the UI only ever
+	// reads rows.  A query that extends the previous one (adds to its end) only re-tests the previous
+	// matches, so predicates must never match more rows for a longer query, as with substring
+	// matching.  Rows appended since the last update are filtered without restarting.  An empty
+	// query matches every row without calling the predicate.
+	struct columnFilter {
+		columnFilterRows rows;      // published matches, in row order
+		columnFilterChunks pending; // queued chunks in row order, published up to nextChunk
+		columnFilterFunc func;
+		void *userData;
+		char *query;  // the query being filtered, or null before the first update
+		u32 *source;  // the previous matches being refined
+		u32 sourceCount;
+		u32 numRows;  // rows handed to the filter so far
+		u32 nextChunk;
+		volatile LONG generation; // bumped to cancel chunks in flight
+		volatile LONG inFlight;   // chunks being run by workers
+		b32 bComplete; // rows holds every match for query over numRows
+	};
+
+	void InitColumnFilter(columnFilter *filter, columnFilterFunc func, void *userData);
+	void ResetColumnFilter(columnFilter *filter);
+
+	// Call when existing rows change - the next update filters every row again.
+	void InvalidateColumnFilter(columnFilter *filter);
+
+	// Returns true once rows holds every match for query over numRows.  Fewer rows than before means
+	// rows were removed, which restarts the filter.
+	b32 UpdateColumnFilter(columnFilter *filter, const char *query, u32 numRows);
+
+	// Stops the worker pool.  Filters must be reset first.
+	void ColumnFilterShutdown(void);
+
+} // namespace ImGui
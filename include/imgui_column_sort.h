@@ -0,0 +1,52 @@
+// Copyright (c) 2012-2019 Matt Campbell
+// MIT license (see License.txt)
+
+#pragma once
+
+#include "imgui_utils.h"
+
+namespace ImGui
+{
+	// Returns < 0, 0 or > 0 as rowA sorts before, with or after rowB on column.
+	typedef int (*columnSortCompareFunc)(u32 rowA, u32 rowB, u32 column, void *userData);
+
+	// Cached ascending order of the rows for one column.  Ties keep row order.
+	struct columnSortOrder {
+		u32 *rows;
+		u32 numRows; // rows sorted so far - 0 when the order needs a full sort
+		u32 allocated;
+	};
+
+	// Sort service for a column table: keeps an order per column, built on first use, so switching
+	// between sort columns doesn't re-sort, and flipping the direction reads the order backwards.
+	// Rows appended since an order was built are sorted on their own and merged in.  Full sorts are
+	// merge sorts split across worker threads.  Rows are data indices, so anything keyed by display
+	// row (like a selection) needs remapping when the sort changes.
+	struct columnSort {
+		columnSortOrder *orders; // one per column
+		columnSortCompareFunc compare;
+		void *userData;
+		u32 numColumns;
+		u32 column;  // the column the last UpdateColumnSort sorted by
+		u32 numRows; // rows in that order - 0 if it could not be built
+		b32 descending;
+		u32 fullSorts; // counters, for profiling
+		u32 maxThreads; // full sorts use at most this many threads - 0 for the default of up to 16
+		u64 mergedRows;
+	};
+
+	void InitColumnSort(columnSort *sort, u32 numColumns, columnSortCompareFunc compare, void *userData);
+	void ResetColumnSort(columnSort *sort);
+
+	// Call when existing rows change - every order is fully re-sorted when next used.
+	void InvalidateColumnSort(columnSort *sort);
+
+	// Brings the order for the header's sort column up to date with numRows.  Fewer rows than before
+	// means rows were removed, which also forces a full sort.  Returns false if out of memory, leaving
+	// rows in data order.
+	b32 UpdateColumnSort(columnSort *sort, const columnDrawData &columns, u32 numRows);
+
+	// The data row shown at displayRow, as of the last UpdateColumnSort.
+	u32 ColumnSortRow(const columnSort *sort, u32 displayRow);
+
+} // namespace ImGui
@@ -0,0 +1,49 @@
+// Copyright (c) 2012-2019 Matt Campbell
+// MIT license (see License.txt)
+
+#pragma once
+
+#include "imgui_column_sort.h"
+
+namespace ImGui
+{
+	// Virtualized table over DrawColumnHeader/DrawColumnText.  Headers stay above a child window that
+	// scrolls the rows, and drawRow is only called for visible rows, so frame cost follows the view
+	// height rather than numRows.  Rows are a fixed height (clipped with ImGuiListClipper), or vary
+	// in height as described by rowOffsets, where finding the visible rows is a binary search.  Cells
+	// are drawn between BeginColumnChannels/EndColumnChannels, so each column is one draw command.
+	// With a rowSelection, each row is also a selectable for mouse selection, and the focused table
+	// handles keyboard selection, scrolling to keep the cursor row in view.  With a sort, the table
+	// updates it from the headers, and drawRow is passed the data row shown at each display row -
+	// rowOffsets and rowSelection stay in display order, so the selection is cleared whenever the
+	// order changes.
+	struct columnTable {
+		columnDrawData columns; // columnOffsets needs numColumns + 1 entries
+		const float *rowOffsets; // optional: numRows + 1 entries - the top of each row, then the total height
+		const char *contextMenuName; // opened by right-clicking a header
+		selection *rowSelection; // optional
+		columnSort *sort;        // optional
+		u32 numRows;
+		float rowHeight; // fixed-height rows - 0 for GetTextLineHeightWithSpacing()
+	};
+
+	struct columnTableResult {
+		b32 sortChanged;
+		b32 active; // a header or resize bar is active
+		u32 firstVisibleRow;
+		u32 visibleRows;
+		b32 selectionChanged;
+		u8 pad[4];
+	};
+
+	// Called with the cursor at the start of the row.  Draw cells with DrawColumnText(columns, ...).
+	typedef void (*columnTableRowFunc)(const columnDrawData &columns, u32 row, void *userData);
+
+	columnTableResult ColumnTable(const char *str_id, const columnTable &table, columnTableRowFunc drawRow, void *userData, const ImVec2 &size = ImVec2(0.0f, 0.0f));
+
+	// Fills rowOffsets[firstRow + 1 .. numRows] from rowHeights, keeping rowOffsets[0 .. firstRow], so
+	// when rows change height only the sums after the first changed row are rebuilt.  Sums are
+	// accumulated in double so very long tables don't drift.
+	void UpdateColumnTableRowOffsets(float *rowOffsets, const float *rowHeights, u32 numRows, u32 firstRow = 0);
+
+} // namespace ImGui
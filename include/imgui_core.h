@@ -47,6 +47,24 @@ b32 Imgui_Core_GetAndClearDirtyWindowPlacement(void);
 
 void Imgui_Core_QueueUpdateDpiDependentResources(void);
 
+// Heap allocations made during the previous frame, from one Imgui_Core_BeginFrame to the next.  The
+// CRT count covers everything on the main thread, but is only collected with the debug CRT.
+typedef struct tag_Imgui_Core_FrameAllocations {
+	u32 imgui;
+	u32 crt;
+} Imgui_Core_FrameAllocations;
+Imgui_Core_FrameAllocations Imgui_Core_GetFrameAllocations(void);
+
+// Counting is off by default.  Enabling it routes ImGui's allocations through counting wrappers of
+// malloc and free, so leave it off when ImGui has an allocator of its own, and installs a CRT alloc
+// hook that chains to the one it replaces.  Disabling it, or Imgui_Core_Shutdown, restores that
+// hook.  Returns the previous setting.
+b32 Imgui_Core_EnableAllocationCounter(b32 bEnabled);
+
+// Starts a new frame of counting.  Imgui_Core_BeginFrame calls this - headless code driving ImGui
+// frames of its own can call it instead.
+void Imgui_Core_BeginFrameAllocations(void);
+
 typedef LRESULT(Imgui_Core_UserWndProc)(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam);
 void Imgui_Core_SetUserWndProc(Imgui_Core_UserWndProc *WndProc);
 
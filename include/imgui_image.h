@@ -4,6 +4,7 @@
 #pragma once
 
 #include "common.h"
+#include "imgui_image_bc.h"
 #include "wrap_imgui.h"
 
 struct IDirect3DDevice9;
@@ -13,13 +14,84 @@ struct UserImageId {
 	const bool operator==(const UserImageId &other) const { return id == other.id; }
 };
 
+// Returns malloc'd BGRA pixels for an image whose CPU copy was dropped, or nullptr on failure.
+typedef u8 *(ImGui_Image_ReloadFunc)(UserImageId userId, void *userData, int *width, int *height);
+
+enum UserImageReloadType {
+	kUserImageReload_None,
+	kUserImageReload_Path,           // re-decode from a file on disk
+	kUserImageReload_Callback,       // ask the owner for the pixels again
+	kUserImageReload_CompressedBlob, // re-decode from an in-memory PNG/JPEG/etc
+};
+
+struct UserImageReloadSource {
+	UserImageReloadType type;
+	u8 pad[4];
+	const char *path;
+	ImGui_Image_ReloadFunc *callback;
+	void *userData;
+	const u8 *blob;
+	u64 blobSize;
+};
+
+// extraFlags for ImGui_Image_Create
+enum UserImageCreateFlag : u32 {
+	kUserImage_TakePixelDataOwnership = 4,      // pixelData was malloc'd, and is freed by the image
+	kUserImage_DiscardPixelDataAfterUpload = 32, // free owned pixels once uploaded - requires a reload source
+	kUserImage_Dedup = 64,                       // share a backing image with identical images created with the same flags
+	kUserImage_Compress = 512,                   // upload as BC1/BC3, encoded on a worker thread - see ImGui_Image_SetCompressionQuality
+};
+
 struct UserImageData {
 	const u8 *pixelData;
 	LPDIRECT3DTEXTURE9 texture;
+	LPDIRECT3DTEXTURE9 pendingTexture; // partially uploaded replacement for texture
+	UserImageReloadSource reloadSource;
 	int width;
 	int height;
 	UserImageId userId;
 	u32 flags;
+	u32 lastUsedFrame;
+	u32 refCount;    // ids sharing this image - see ImGui_Image_Create
+	u32 uploadedRows; // rows of pendingTexture filled so far
+	int pitch;        // bytes between rows of pixelData, negative for bottom-up - 0 means width * 4
+	u64 sourceHash;  // path/size/mtime of the file the image was loaded from, 0 if none
+	u64 contentHash; // pixels and dimensions, 0 if the image is not shareable
+	const void *mappedView; // file mapping pixelData points into, for raw BMP/TGA files
+	u32 encodeSerial;       // in-flight block compression job, 0 if none
+	u32 shareFlags;         // creation flags another image needs to share this one
+};
+
+enum UserImageResidency {
+	kUserImageResidency_None,     // no pixels or texture, and nothing to reload from
+	kUserImageResidency_Resident, // pixels and texture
+	kUserImageResidency_CpuOnly,  // pixels only - texture evicted or not yet uploaded
+	kUserImageResidency_GpuOnly,  // texture only - pixels evicted or discarded after upload
+	kUserImageResidency_Evicted,  // neither, but reloadable from reloadSource on next use
+	kUserImageResidency_Count
+};
+
+struct UserImageStats {
+	u64 bytesByResidency[kUserImageResidency_Count];
+	u32 countByResidency[kUserImageResidency_Count];
+	u64 gpuBytes;
+	u64 cpuBytes;
+	u64 cpuBytesSaved;
+	u64 dedupBytesSaved;
+	u64 gpuBudget;
+	u64 cpuBudget;
+	u64 uploadQueueBytes;
+	u64 uploadBytesLastFrame;
+	u64 compressionBytesSaved;
+	double uploadMsLastFrame;
+	u32 uploadQueueDepth;
+	u32 uploadBandsLastFrame;
+	u32 texturesEvicted;
+	u32 pixelDataEvicted;
+	u32 pixelDataReloads;
+	u32 dedupedImages;
+	u32 compressedImages;
+	u32 encodeQueueDepth;
 };
 
 bool ImGui_Image_Init(IDirect3DDevice9 *device);
@@ -27,9 +99,39 @@ void ImGui_Image_Shutdown();
 void ImGui_Image_InvalidateDeviceObjects();
 void ImGui_Image_NewFrame();
 
+// Budgets are in bytes, 0 for unlimited.  Images unused for at least minUnusedFrames (minimum 1,
+// so nothing drawn last frame is dropped and rebuilt) are evicted in LRU order when over budget,
+// and restored from pixel data or reloadSource on next use.
+void ImGui_Image_SetMemoryBudget(u64 gpuBytes, u64 cpuBytes, u32 minUnusedFrames);
+UserImageResidency ImGui_Image_GetResidency(UserImageId userId);
+
+// Limits texture uploads per ImGui_Image_NewFrame, 0 for unlimited.  Images drawn most recently
+// upload first, and large images upload in row bands spread across frames.  An image keeps its
+// previous texture (or none) until its upload completes.
+void ImGui_Image_SetUploadBudget(u64 bytesPerFrame, double msPerFrame);
+
+// Quality for images created with kUserImage_Compress.  Such images are encoded to BC1 (opaque or
+// 1-bit alpha) or BC3 on a background thread, cutting texture memory and upload bandwidth to 1/8
+// or 1/4.  Images whose dimensions are not a multiple of 4 are uploaded uncompressed.
+void ImGui_Image_SetCompressionQuality(bcQuality quality);
+UserImageStats ImGui_Image_GetStats();
+void ImGui_Image_DrawStats();
+
+// pixelData in the result is null, or packed top-down rows of width * 4 bytes - pixels still read
+// from a file mapping, which may be bottom-up and are released after upload, are left out.
 UserImageData ImGui_Image_Get(UserImageId userId);
 ImVec2 ImGui_Image_Constrain(const UserImageData &image, ImVec2 available);
-UserImageId ImGui_Image_CreateFromFile(const char *path);
+
+// Draws the image, or a placeholder showing upload progress if it has no texture yet.
+// Returns true if the texture was drawn.
+bool ImGui_Image_Draw(UserImageId userId, ImDrawList *drawList, ImVec2 start, ImVec2 end, ImVec2 uv0 = ImVec2(0.0f, 0.0f), ImVec2 uv1 = ImVec2(1.0f, 1.0f));
+UserImageId ImGui_Image_CreateFromFile(const char *path, u32 extraFlags = 0);
+UserImageId ImGui_Image_CreateFromMemory(const u8 *blob, u64 blobSize, u32 extraFlags = 0);
+// Images created with kUserImage_Dedup share one reference-counted backing image and texture with
+// an image from the same source file or with the same pixels, if created with the same flags.  ImGui_Image_MarkForDestroy releases the
+// backing image with its last reference, and ImGui_Image_Modify detaches a shared id first.
 UserImageId ImGui_Image_Create(const u8 *pixelData, int width, int height, u32 extraFlags = 0);
+void ImGui_Image_SetReloadSource(UserImageId userId, const UserImageReloadSource &source);
 void ImGui_Image_MarkForDestroy(UserImageId userId);
 void ImGui_Image_Modify(UserImageId userId, const u8 *pixelData, int width, int height);
+void ImGui_Image_SwizzleRGBA(u8 *pixelData, int width, int height);
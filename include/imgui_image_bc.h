@@ -0,0 +1,44 @@
+// Copyright (c) 2012-2019 Matt Campbell
+// MIT license (see License.txt)
+
+#pragma once
+
+#include "common.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+// CPU block-compression encoder for BGRA images.  Output is in D3DFMT_DXT1 (BC1) or
+// D3DFMT_DXT5 (BC3) layout.  Contains no D3D or Windows code so it can be run headlessly.
+
+typedef enum bcFormat_e {
+	kBcFormat_BC1, // 4bpp, opaque or 1-bit alpha
+	kBcFormat_BC3, // 8bpp, BC1 color plus interpolated 8-bit alpha
+	kBcFormat_Auto,
+} bcFormat;
+
+typedef enum bcQuality_e {
+	kBcQuality_Fast,   // bounding box endpoints
+	kBcQuality_Normal, // principal axis endpoints
+	kBcQuality_High,   // principal axis plus least-squares endpoint refinement
+	kBcQuality_Count
+} bcQuality;
+
+u64 bc_encoded_size(bcFormat format, u32 width, u32 height);
+u32 bc_block_pitch(bcFormat format, u32 width); // bytes per row of 4x4 blocks
+
+// kBcFormat_BC1 if every pixel is opaque or fully transparent, otherwise kBcFormat_BC3.
+bcFormat bc_choose_format(const u8 *bgra, u32 width, u32 height, s32 pitch);
+
+// pitch is the byte offset between rows of bgra.  Edge blocks of images whose dimensions are
+// not a multiple of 4 replicate the last row/column.  out must hold bc_encoded_size bytes.
+void bc_encode_image(bcFormat format, bcQuality quality, const u8 *bgra, u32 width, u32 height, s32 pitch, u8 *out);
+void bc_decode_image(bcFormat format, const u8 *blocks, u32 width, u32 height, u8 *bgra);
+
+// Peak signal-to-noise ratio in dB between two width * height BGRA images.
+double bc_psnr(const u8 *a, const u8 *b, u32 width, u32 height, b32 bIncludeAlpha);
+
+#if defined(__cplusplus)
+}
+#endif
@@ -0,0 +1,39 @@
+// Copyright (c) 2012-2019 Matt Campbell
+// MIT license (see License.txt)
+
+#pragma once
+
+#include "common.h"
+
+// Persistent cache of decoded, swizzled BGRA pixels so warm starts skip PNG/JPEG decoding.
+// Entries are keyed by source path, size, and mtime - editing a source image invalidates its
+// entry.  Each entry is a small header plus run-length encoded pixels, memory-mapped on load.
+// The cache is disabled until a directory is set.
+
+struct ImageDiskCacheStats {
+	u32 hits;
+	u32 misses;
+	u32 stores;
+	u32 rejected; // stale or corrupt entries
+	u64 bytesRead;
+	u64 bytesWritten;
+	u64 bytesDecoded;
+};
+
+void ImGui_ImageDiskCache_SetDirectory(const char *dir);
+const char *ImGui_ImageDiskCache_GetDirectory();
+void ImGui_ImageDiskCache_Shutdown();
+
+// Returns malloc'd BGRA pixels for path, or nullptr if there is no valid entry.
+u8 *ImGui_ImageDiskCache_Load(const char *path, int *width, int *height);
+bool ImGui_ImageDiskCache_Store(const char *path, const u8 *pixelData, int width, int height);
+
+// Decodes path via the cache, falling back to stb_image and populating the cache on a miss.
+// Returns malloc'd BGRA pixels, or nullptr if the image could not be decoded.
+u8 *ImGui_ImageDiskCache_LoadOrDecode(const char *path, int *width, int *height);
+
+// Identifies the current contents of a source file by path, size, and mtime, whether or not the
+// cache is enabled.  Returns 0 if the file does not exist.
+u64 ImGui_ImageDiskCache_HashSource(const char *path);
+
+ImageDiskCacheStats ImGui_ImageDiskCache_GetStats();
@@ -0,0 +1,36 @@
+// Copyright (c) 2012-2019 Matt Campbell
+// MIT license (see License.txt)
+
+#pragma once
+
+#include "common.h"
+
+// Read-only memory mapping of an image file.  Decoding from the mapping avoids stdio's buffered
+// copy, and uncompressed 32bpp BMP/TGA files are already in texture byte order, so their pixels
+// can be uploaded straight from the mapping with no intermediate buffer at all.
+
+struct MappedImageFile {
+	const u8 *view;
+	u64 size;
+};
+
+struct MappedImageRaw {
+	const u8 *firstRow; // top row of the image
+	int width;
+	int height;
+	int pitch;       // bytes from one row to the next - negative for bottom-up files
+	b32 bHasAlpha;   // false if the alpha channel is undefined and should be ignored
+};
+
+bool ImGui_ImageFile_Map(const char *path, MappedImageFile *file);
+void ImGui_ImageFile_Unmap(MappedImageFile *file);
+void ImGui_ImageFile_UnmapView(const void *view);
+
+// Recognizes uncompressed 32bpp BGRA BMP and TGA.  raw->firstRow points into the mapping.
+bool ImGui_ImageFile_ParseRaw(const MappedImageFile *file, MappedImageRaw *raw);
+
+// Decodes any stb_image format from the mapping into malloc'd BGRA pixels.
+u8 *ImGui_ImageFile_Decode(const MappedImageFile *file, int *width, int *height);
+
+// Maps, decodes, and unmaps path.  Returns malloc'd BGRA pixels, or nullptr on failure.
+u8 *ImGui_ImageFile_Load(const char *path, int *width, int *height);
@@ -0,0 +1,54 @@
+// Copyright (c) 2012-2019 Matt Campbell
+// MIT license (see License.txt)
+
+#pragma once
+
+#include "common.h"
+#include "wrap_imgui.h"
+
+struct IDirect3DDevice9;
+
+// Streaming images are for content replaced every frame (video, live plots).  A producer on any
+// thread writes into a CPU triple buffer and publishes it without locks; each ImGui_ImageStream_NewFrame
+// takes the newest published frame and uploads it into the next of a ring of dynamic textures,
+// so the upload never waits on a texture the GPU may still be reading.  Frames published faster
+// than the UI consumes them are dropped, never queued.
+
+enum {
+	kImageStream_MaxStreams = 64,
+	kImageStream_DefaultTextures = 3,
+	kImageStream_MaxTextures = 4,
+};
+
+struct StreamImageId {
+	u32 id = 0;
+	const bool operator==(const StreamImageId &other) const { return id == other.id; }
+};
+
+struct StreamImageStats {
+	u64 framesPublished;
+	u64 framesDropped; // overwritten before the UI consumed them
+	u64 framesUploaded;
+	u64 bytesUploaded;
+};
+
+bool ImGui_ImageStream_Init(IDirect3DDevice9 *device);
+void ImGui_ImageStream_Shutdown();
+void ImGui_ImageStream_InvalidateDeviceObjects();
+void ImGui_ImageStream_NewFrame();
+
+// UI thread only.  numTextures is clamped to 2..kImageStream_MaxTextures.  Producers must have
+// stopped writing before MarkForDestroy is called.
+StreamImageId ImGui_ImageStream_Create(int width, int height, u32 numTextures = kImageStream_DefaultTextures);
+void ImGui_ImageStream_MarkForDestroy(StreamImageId id);
+
+// Producer side, any single thread per stream.  BeginWrite returns a width * height BGRA buffer
+// that belongs to the producer until EndWrite publishes it.  Never blocks.
+u8 *ImGui_ImageStream_BeginWrite(StreamImageId id);
+void ImGui_ImageStream_EndWrite(StreamImageId id);
+bool ImGui_ImageStream_Write(StreamImageId id, const u8 *pixelData, u32 pitch);
+
+// UI thread only.  Returns the texture holding the newest uploaded frame, or nullptr before the first.
+ImTextureID ImGui_ImageStream_GetTexture(StreamImageId id);
+void ImGui_ImageStream_Draw(StreamImageId id, ImDrawList *drawList, ImVec2 start, ImVec2 end, ImVec2 uv0 = ImVec2(0.0f, 0.0f), ImVec2 uv1 = ImVec2(1.0f, 1.0f));
+StreamImageStats ImGui_ImageStream_GetStats(StreamImageId id);
@@ -0,0 +1,58 @@
+// Copyright (c) 2012-2019 Matt Campbell
+// MIT license (see License.txt)
+
+#pragma once
+
+#include "common.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+// CPU-side bookkeeping for tiled image residency.  Maps tile keys to a fixed
+// number of texture slots with LRU replacement.  Contains no D3D so it can be
+// driven headlessly.
+
+enum {
+	kTileCache_InvalidSlot = 0xFFFFFFFF,
+};
+
+typedef struct tag_tileCacheKey {
+	u32 imageId;
+	u32 level;
+	u32 tileX;
+	u32 tileY;
+} tileCacheKey;
+
+typedef struct tag_tileCacheSlot {
+	tileCacheKey key;
+	u32 lastUsedFrame;
+	b32 bOccupied;
+	b32 bPinned; // never chosen for eviction - used for the coarse fallback tiles
+	u8 pad[4];
+} tileCacheSlot;
+
+typedef struct tag_tileCache {
+	tileCacheSlot *slots;
+	u32 numSlots;
+	u32 frame;
+	u32 hits;
+	u32 misses;
+	u32 evictions;
+	u8 pad[4];
+} tileCache;
+
+void tileCache_init(tileCache *cache, u32 numSlots);
+void tileCache_reset(tileCache *cache);
+void tileCache_new_frame(tileCache *cache);
+void tileCache_clear(tileCache *cache);
+u32 tileCache_find(tileCache *cache, tileCacheKey key);
+u32 tileCache_acquire(tileCache *cache, tileCacheKey key, b32 *outEvicted, tileCacheKey *outEvictedKey);
+void tileCache_release_slot(tileCache *cache, u32 slot);
+void tileCache_pin_slot(tileCache *cache, u32 slot);
+void tileCache_evict_image(tileCache *cache, u32 imageId);
+u32 tileCache_count_occupied(const tileCache *cache);
+
+#if defined(__cplusplus)
+}
+#endif
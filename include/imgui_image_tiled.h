@@ -0,0 +1,50 @@
+// Copyright (c) 2012-2019 Matt Campbell
+// MIT license (see License.txt)
+
+#pragma once
+
+#include "common.h"
+#include "wrap_imgui.h"
+
+struct IDirect3DDevice9;
+
+// Tiled images split very large images into a mip pyramid of fixed-size tiles.
+// Only tiles visible at the current zoom are uploaded, into a bounded pool of
+// tile textures shared by all tiled images.
+
+struct TiledImageId {
+	u32 id = 0;
+	const bool operator==(const TiledImageId &other) const { return id == other.id; }
+};
+
+struct TiledImageInfo {
+	int width;
+	int height;
+	u32 numLevels;
+	u32 tileSize;
+};
+
+struct TiledImageStats {
+	u32 residentTiles;
+	u32 maxResidentTiles;
+	u32 uploadsThisFrame;
+	u32 missingThisFrame;
+};
+
+bool ImGui_ImageTiled_Init(IDirect3DDevice9 *device);
+void ImGui_ImageTiled_Shutdown();
+void ImGui_ImageTiled_InvalidateDeviceObjects();
+void ImGui_ImageTiled_NewFrame();
+// maxResidentTiles is at least 2, since each drawn image pins a coarse fallback tile.
+void ImGui_ImageTiled_SetResidency(u32 maxResidentTiles, u32 maxUploadsPerFrame);
+TiledImageStats ImGui_ImageTiled_GetStats();
+
+TiledImageId ImGui_ImageTiled_CreateFromFile(const char *path);
+TiledImageId ImGui_ImageTiled_Create(const u8 *pixelData, int width, int height);
+TiledImageInfo ImGui_ImageTiled_GetInfo(TiledImageId id);
+void ImGui_ImageTiled_MarkForDestroy(TiledImageId id);
+
+// Draws the uv0..uv1 region of the image into start..end.  Tiles are chosen from the
+// mip level closest to the on-screen scale; tiles that are not resident yet are drawn
+// from a coarser resident level until they stream in.
+void ImGui_ImageTiled_Draw(TiledImageId id, ImDrawList *drawList, ImVec2 start, ImVec2 end, ImVec2 uv0 = ImVec2(0.0f, 0.0f), ImVec2 uv1 = ImVec2(1.0f, 1.0f));
@@ -0,0 +1,41 @@
+// Copyright (c) 2012-2019 Matt Campbell
+// MIT license (see License.txt)
+
+#pragma once
+
+#include "common.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+// Lock-free triple buffer behind streaming images.  One producer thread writes its back buffer and
+// publishes it; one consumer acquires the newest published frame.  Frames published faster than
+// they are acquired are dropped, never queued.  Contains no D3D so it can be driven headlessly.
+
+typedef struct tag_tripleBuffer {
+	u8 *buffers[3];
+	u64 frameBytes;
+	volatile LONG64 published;
+	volatile LONG64 dropped;
+	volatile LONG state;
+	u8 pad[4];
+} tripleBuffer;
+
+// Allocates three zeroed frameBytes buffers.  Returns false if out of memory - reset either way.
+b32 tripleBuffer_init(tripleBuffer *tb, u64 frameBytes);
+void tripleBuffer_reset(tripleBuffer *tb);
+
+// Producer: the back buffer is never touched by the consumer, so it can be written freely until
+// publishing swaps it for a recycled one.
+u8 *tripleBuffer_back(tripleBuffer *tb);
+void tripleBuffer_publish(tripleBuffer *tb);
+
+// Consumer: returns the newest published frame, or NULL if nothing new arrived since the last
+// acquire.  The frame stays valid, and is returned by tripleBuffer_present, until the next acquire.
+const u8 *tripleBuffer_acquire(tripleBuffer *tb);
+const u8 *tripleBuffer_present(tripleBuffer *tb);
+
+#if defined(__cplusplus)
+}
+#endif
@@ -7,14 +7,58 @@
 #include "wrap_imgui.h"
 
 typedef struct sb_s sb_t;
+typedef struct tag_textSearch textSearch;
+typedef struct tag_gapBuffer gapBuffer;
+
+struct InputTextStateStats {
+	u32 liveStates;      // per-widget scroll, viewer and editor states in use
+	u32 freeStates;      // pooled states available for reuse
+	u32 reclaimedStates; // states reclaimed from unused widgets since startup
+	u32 sbResizes;       // resize events from sb_t-backed inputs since startup - their only length updates
+	u32 sbGrows;         // reallocations those caused
+	u32 strlens;         // texts measured by the char buffer inputs since startup - the sb_t ones read sb->count
+	u64 poolBytes;  // pool chunks - kept until InputTextShutdown, so this tracks the peak state count
+	u64 indexBytes; // line indices and text copies held by live states
+};
 
 namespace ImGui
 {
 
 	void InputTextShutdown(void);
-	bool InputTextMultilineScrolling(const char *label, char *buf, size_t buf_size, const ImVec2 &size, ImGuiInputTextFlags flags = ImGuiInputTextFlags_None);
-	bool InputTextMultilineScrolling(const char *label, sb_t *sb, u32 buf_size, const ImVec2 &size, ImGuiInputTextFlags flags = ImGuiInputTextFlags_None);
+
+	// Widget states unused for more than maxUnusedFrames are reclaimed - 0 keeps them forever.
+	// Returns the previous lifetime.
+	u32 InputTextSetStateLifetime(u32 maxUnusedFrames);
+	// States are otherwise reclaimed every so often by the widgets themselves.  Code that draws into
+	// an ImGui context it then destroys should stop drawing, let the lifetime pass and collect first.
+	void InputTextCollectStates(void);
+	InputTextStateStats InputTextGetStateStats(void);
+
+	// Handles an ImGuiInputTextFlags_CallbackResize event for text held in sb: grows it only as far as
+	// the new text needs, up to maxSize bytes including the terminator, and sets sb->count.
+	int InputTextResizeCallback(ImGuiInputTextCallbackData *data, sb_t *sb, u32 maxSize);
+
+	// The sb_t overloads grow sb on demand up to buf_size, and keep sb->count current without a strlen.
+	// They take the text length from sb->count too, so keep it current when changing sb elsewhere.
+	// search (optional) highlights its matches, and F3/Shift+F3 select the next/previous one.  A
+	// textSearch caches its matches for one text, so give each widget its own.
+	bool InputTextMultilineScrolling(const char *label, char *buf, size_t buf_size, const ImVec2 &size, ImGuiInputTextFlags flags = ImGuiInputTextFlags_None, textSearch *search = nullptr);
+	bool InputTextMultilineScrolling(const char *label, sb_t *sb, u32 buf_size, const ImVec2 &size, ImGuiInputTextFlags flags = ImGuiInputTextFlags_None, textSearch *search = nullptr);
 	bool InputTextScrolling(const char *label, char *buf, size_t buf_size, ImGuiInputTextFlags flags = ImGuiInputTextFlags_None);
 	bool InputTextScrolling(const char *label, sb_t *sb, u32 buf_size, ImGuiInputTextFlags flags = ImGuiInputTextFlags_None);
 
+	// Read-only view of large text, e.g. a log.  Lines are indexed incrementally, and only the visible
+	// lines are laid out and drawn, so frame cost doesn't grow with the text.  Supports mouse
+	// selection, Ctrl+A and Ctrl+C.  text may be appended to between frames.  A new text pointer, a
+	// shorter textLen or a new textVersion starts over, as does a change to the first or last byte
+	// already indexed - any other change to bytes already shown needs a new textVersion.  search
+	// works as for InputTextMultilineScrolling, and is searched incrementally as text is appended.
+	void TextViewer(const char *label, const char *text, u64 textLen, const ImVec2 &size = ImVec2(0.0f, 0.0f), textSearch *search = nullptr, u64 textVersion = 0);
+
+	// Editor for text held in a gapBuffer, e.g. a file too large to flatten every frame.  Lines are
+	// drawn straight from gb, and clicking one opens a window of lines around it for InputTextEx to
+	// edit, which follows the cursor.  Only the window is ever copied, and edits are written back to
+	// gb in place.  gb may also be edited between frames - editing then starts over.
+	bool InputTextMultiline(const char *label, gapBuffer *gb, const ImVec2 &size = ImVec2(0.0f, 0.0f), ImGuiInputTextFlags flags = ImGuiInputTextFlags_None);
+
 } // namespace ImGui
@@ -0,0 +1,74 @@
+// Copyright (c) 2012-2019 Matt Campbell
+// MIT license (see License.txt)
+
+#pragma once
+
+#include "common.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+// Multi-selection over items numbered 0..n-1, stored as sorted, disjoint [start, end) ranges rather
+// than a flag per item, so selecting all of a million-item list or shift-selecting a large range is
+// a single range.  Lookups are a binary search over the ranges, and range edits only move the ranges
+// they overlap.  Iterate the selection by walking ranges.data[i].start .. ranges.data[i].end.
+
+enum {
+	kSelection_None = 0xFFFFFFFF, // no anchor/cursor
+};
+
+typedef enum selectionModifiers_e {
+	kSelection_Ctrl = 0x1,
+	kSelection_Shift = 0x2,
+} selectionModifiers;
+
+typedef struct tag_selectionRange {
+	u32 start;
+	u32 end;
+} selectionRange;
+
+typedef struct tag_selectionRanges {
+	u32 count;
+	u32 allocated;
+	selectionRange *data; // sorted, non-overlapping and non-adjacent
+} selectionRanges;
+
+typedef struct tag_selection {
+	selectionRanges ranges;
+	u32 anchor; // where shift-selection ranges start, or kSelection_None
+	u32 cursor; // the item last clicked or navigated to, or kSelection_None
+} selection;
+
+void selection_init(selection *sel);
+void selection_reset(selection *sel);
+void selection_clear(selection *sel);
+
+b32 selection_contains(const selection *sel, u32 item);
+u32 selection_count(const selection *sel);
+
+// First selected item at or after item, or kSelection_None.
+u32 selection_next(const selection *sel, u32 item);
+
+// Range edits return false if the ranges could not grow, leaving the selection unchanged.
+b32 selection_add_range(selection *sel, u32 start, u32 end);
+b32 selection_remove_range(selection *sel, u32 start, u32 end);
+b32 selection_toggle(selection *sel, u32 item);
+b32 selection_select_all(selection *sel, u32 numItems);
+b32 selection_invert(selection *sel, u32 numItems); // items >= numItems are deselected
+
+// Mouse click on item, with selectionModifiers flags:
+//   none       - selects only item
+//   ctrl       - toggles item
+//   shift      - selects only the items from the anchor to item
+//   ctrl+shift - adds the items from the anchor to item
+// Clicks without shift move the anchor to item.
+void selection_click(selection *sel, u32 item, u32 modifiers);
+
+// Keyboard navigation to item: as selection_click, except ctrl alone moves the cursor without
+// changing the selection.
+void selection_navigate(selection *sel, u32 item, u32 modifiers);
+
+#if defined(__cplusplus)
+}
+#endif
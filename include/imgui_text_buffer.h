@@ -0,0 +1,102 @@
+// Copyright (c) 2012-2019 Matt Campbell
+// MIT license (see License.txt)
+
+#pragma once
+
+#include "common.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+// Gap buffer for editing very large text.  Text lives in one allocation with a movable gap at the
+// last edit position, so edits near the previous one are amortized O(1), and the buffer grows
+// geometrically with no fixed maximum.  A contiguous copy is only produced on demand: flattening
+// moves the gap out of the way rather than copying the text.  Positions are byte offsets - callers
+// editing UTF-8 should keep them on character boundaries (see gapBuffer_utf8_align).
+
+typedef struct tag_gapBuffer {
+	char *data;
+	u64 capacity; // bytes allocated, including the gap and a terminator slot
+	u64 gapStart;
+	u64 gapEnd;
+	u64 gapBytesMoved; // total text shifted to reposition the gap, for profiling
+	u32 edits;         // incremented by every modification, so caches can detect changes
+	u32 grows;
+} gapBuffer;
+
+void gapBuffer_init(gapBuffer *gb, u64 initialCapacity);
+void gapBuffer_reset(gapBuffer *gb);
+void gapBuffer_clear(gapBuffer *gb);
+b32 gapBuffer_assign(gapBuffer *gb, const char *text, u64 len);
+
+u64 gapBuffer_length(const gapBuffer *gb);
+char gapBuffer_char_at(const gapBuffer *gb, u64 pos);
+
+// Returns false if the buffer could not grow.  Positions past the end are clamped.
+b32 gapBuffer_insert(gapBuffer *gb, u64 pos, const char *text, u64 len);
+void gapBuffer_erase(gapBuffer *gb, u64 pos, u64 len);
+b32 gapBuffer_replace(gapBuffer *gb, u64 pos, u64 eraseLen, const char *text, u64 len);
+
+// The text as up to two spans either side of the gap, for scanning without flattening.
+void gapBuffer_spans(const gapBuffer *gb, const char **first, u64 *firstLen, const char **second, u64 *secondLen);
+
+// Copies [pos, pos + len) into out, which is not terminated.  Returns the bytes copied.
+u64 gapBuffer_copy(const gapBuffer *gb, u64 pos, u64 len, char *out);
+
+// Moves the gap to the end and returns the whole text, nul-terminated.  Valid until the next edit.
+const char *gapBuffer_flatten(gapBuffer *gb);
+
+// Moves the gap out of [pos, pos + len), whichever side is closer, and returns a pointer to the
+// range.  Not terminated.  Valid until the next edit.
+const char *gapBuffer_flatten_range(gapBuffer *gb, u64 pos, u64 len);
+
+// Moves pos back to the start of the UTF-8 sequence it falls inside.
+u64 gapBuffer_utf8_align(const gapBuffer *gb, u64 pos);
+
+// A window of whole lines of a gapBuffer, flattened for an editor that needs contiguous text (e.g.
+// ImGui's InputTextMultiline), and the start of every line in the text.  Edits to the window are
+// written back by gapBufferWindow_commit as one replace where the gap already is.  The line starts
+// are kept around a gap of their own: those before the window count from the start of the text and
+// those after it from the end, so an edit costs time in proportion to the window rather than the
+// text, and moving the window in proportion to the distance moved.  The window never includes the
+// newlines either side of it, so edits in it can't join lines outside it.  Zero-initialize, then
+// gapBufferWindow_sync before use.
+
+typedef struct tag_gapBufferWindow {
+	u64 *lines; // line starts - before the window from the text start, in it from start, after it from the text end
+	u64 start;  // offset of the window text
+	u64 len;
+	u64 textLen; // length of the text, as of the last sync or commit
+	u32 linesAllocated;
+	u32 linesBefore; // at the front of lines
+	u32 linesWindow; // following linesBefore
+	u32 linesAfter;  // at the back of lines
+	u32 edits;       // gb->edits the line starts are up to date with
+	b32 bOpen;
+} gapBufferWindow;
+
+void gapBufferWindow_reset(gapBufferWindow *w);
+
+// Re-indexes the lines and closes the window if gb was edited other than through the window.
+// Returns true if it did, so callers can drop anything else they kept about the old window.
+b32 gapBufferWindow_sync(gapBufferWindow *w, const gapBuffer *gb);
+
+u32 gapBufferWindow_line_count(const gapBufferWindow *w);
+u64 gapBufferWindow_line_start(const gapBufferWindow *w, u32 line);
+u64 gapBufferWindow_line_end(const gapBufferWindow *w, u32 line); // excluding the newline
+u32 gapBufferWindow_find_line(const gapBufferWindow *w, u64 pos);
+
+// Opens the window on up to maxLines lines around line - fewer if maxBytes is reached first, but
+// always including line - closing any window already open.  Returns the window text, which is not
+// terminated and is valid until the next edit of gb.
+const char *gapBufferWindow_open(gapBufferWindow *w, gapBuffer *gb, u32 line, u32 maxLines, u64 maxBytes);
+void gapBufferWindow_close(gapBufferWindow *w);
+
+// Replaces the window text in gb with text.  Returns true if that changed gb - false if the text was
+// the same, or gb could not grow.
+b32 gapBufferWindow_commit(gapBufferWindow *w, gapBuffer *gb, const char *text, u64 len);
+
+#if defined(__cplusplus)
+}
+#endif
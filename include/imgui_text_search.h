@@ -0,0 +1,83 @@
+// Copyright (c) 2012-2019 Matt Campbell
+// MIT license (see License.txt)
+
+#pragma once
+
+#include "common.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+// Find-all search over large text buffers, with cached results for highlighting and next/previous
+// navigation.  Literal patterns use an SSE2 or AVX2 first/last byte filter, picked at runtime.
+// Regex patterns support . [] [^] * + ? ^ $ and \d \w \s \D \W \S, are matched per line in time
+// linear in the text, and use the same literal search to skip to candidates when they start with
+// literal characters.
+
+enum {
+	kTextSearch_None = 0xFFFFFFFF, // no current match
+	kTextSearch_MaxMatches = 1000000,
+};
+
+typedef enum textSearchFlags_e {
+	kTextSearch_IgnoreCase = 0x1, // ASCII case folding
+	kTextSearch_Regex = 0x2,
+} textSearchFlags;
+
+typedef struct tag_textSearchMatch {
+	u64 offset;
+	u64 length;
+} textSearchMatch;
+
+typedef struct tag_textSearchMatches {
+	u32 count;
+	u32 allocated;
+	textSearchMatch *data; // sorted, non-overlapping
+} textSearchMatches;
+
+typedef struct textSearchRegex_s textSearchRegex;
+
+typedef struct tag_textSearch {
+	textSearchMatches matches;
+	textSearchRegex *regex;
+	char *pattern;
+	u64 patternLen;
+	u64 textLen;     // length of the text the matches were found in
+	u64 textVersion; // caller's edit counter for that text
+	u64 scannedLen;  // match starts before this offset have been found
+	double lastScanSeconds;
+	u32 flags;
+	u32 current; // index of the match selected by next/previous, or kTextSearch_None
+	b32 bValid;  // false for an empty pattern or a regex that failed to compile
+	b32 bScrollToCurrent; // set by next/previous, cleared by the widget that scrolls to it
+	b32 bTruncated;       // stopped at kTextSearch_MaxMatches
+	u8 pad[4];
+} textSearch;
+
+void textSearch_init(textSearch *search);
+void textSearch_reset(textSearch *search);
+
+// Returns false if the pattern is empty or is an invalid regex.  Unchanged patterns keep their results.
+b32 textSearch_set_pattern(textSearch *search, const char *pattern, u32 flags);
+
+// Brings the matches up to date with text.  version must change whenever bytes already passed are
+// edited - text that was only appended to (and may have moved) is searched incrementally.  Scans at
+// most maxScanBytes per call (0 for no limit), and returns true once the whole text is searched.
+// A regex scan that runs out mid-match picks up from there on the next call.
+b32 textSearch_update(textSearch *search, const char *text, u64 textLen, u64 version, u64 maxScanBytes);
+
+// Index of the first match ending after offset, or matches.count if none.
+u32 textSearch_first_ending_after(const textSearch *search, u64 offset);
+
+// Selects the next/previous match after/before offset (ignored if a match is already selected), and
+// requests a scroll to it.  Wraps around at either end.
+void textSearch_select_next(textSearch *search, u64 offset);
+void textSearch_select_prev(textSearch *search, u64 offset);
+
+// Offset of the first occurrence of pattern in text, or textLen if there is none.
+u64 textSearch_find_literal(const char *text, u64 textLen, const char *pattern, u64 patternLen, b32 bIgnoreCase);
+
+#if defined(__cplusplus)
+}
+#endif
@@ -8,6 +8,7 @@
 
 typedef struct sb_s sb_t;
 typedef struct tag_tooltipConfig tooltipConfig;
+typedef struct tag_selection selection;
 
 namespace ImGui
 {
@@ -50,10 +51,22 @@ namespace ImGui
 	void SelectableText(const char *label, const char *fmt, ...);
 	bool SelectableWithBackground(const char *label, bool selected, const ImColor bgColor, ImGuiSelectableFlags flags = 0, const ImVec2 &size_arg = ImVec2(0.0f, 0.0f));
 
+	// Selectables for item in a selection model (see imgui_selection.h) - clicks apply selection_click
+	// with the current ctrl/shift state.
+	u32 GetSelectionModifiers(void);
+	bool Selectable(const char *label, selection *sel, u32 item, ImGuiSelectableFlags flags = 0, const ImVec2 &size = ImVec2(0, 0));
+	bool SelectableWithBackground(const char *label, selection *sel, u32 item, const ImColor bgColor, ImGuiSelectableFlags flags = 0, const ImVec2 &size_arg = ImVec2(0.0f, 0.0f));
+
+	// Keyboard selection over numItems items: arrows, page up/down and home/end move the cursor (with
+	// shift extending from the anchor, and ctrl moving without selecting), and ctrl+A selects all.
+	// Call while the list has focus.  Returns true if the cursor or selection changed.
+	bool SelectionKeyboardNav(selection *sel, u32 numItems, u32 pageItems);
+
 	void SetTextShadowColor(ImColor shadowColor);
 	void TextShadow(const char *text, bool bWrapped = false, bool bHideLabel = false);
 	void TextShadowed(const char *text);
 	void TextWrappedShadowed(const char *text);
+	void TextOutlined(const char *text); // outlined in the text shadow color, even with text shadows off
 	void DrawStrikethrough(const char *text, ImColor color, ImVec2 pos);
 
 	enum buttonType_e {
@@ -98,6 +111,12 @@ namespace ImGui
 	void DrawColumnHeaderText(float offset, float width, const char *text, const char *end = nullptr, const char *contextMenuName = nullptr);
 	columnDrawResult DrawColumnHeader(columnDrawData h, u32 columnIndex, const char *contextMenuName = nullptr);
 
+	// Between these, DrawColumnText draws each column into its own draw channel, so all cells of a
+	// column share a clip rect and merge into one draw command.  Other drawing goes to channel 0,
+	// beneath the text.  Not nestable, and only applies to the window that called BeginColumnChannels.
+	void BeginColumnChannels(const columnDrawData &h);
+	void EndColumnChannels(void);
+
 	void PushSelectableColors(b32 selected, b32 viewActive);
 	void PopSelectableColors(b32 selected, b32 viewActive);
 
@@ -111,6 +130,19 @@ namespace ImGui
 	void IconColored(ImColor color, const char *icon);
 
 	void DrawIconAtPos(ImVec2 pos, const char *icon, ImColor color, bool align = false, float scale = 1.0f);
+
+	enum textShadowStyle_e {
+		kTextShadow_None,
+		kTextShadow_Drop,    // offset one pixel down and right
+		kTextShadow_Outline, // offset one pixel in each of four directions
+	};
+
+	// AddText with a shadow: lines are wrapped and clipped once, and each batch of glyphs is emitted
+	// as every shadow layer followed by the text, so every shadow is beneath the text.  Wraps the same
+	// way as ImFont::RenderText, so wrapWidth from CalcWrapWidthForPos matches TextWrapped.
+	void AddTextShadowed(ImDrawList *drawList, ImFont *font, float fontSize, const ImVec2 &pos, ImU32 col, ImU32 shadowCol,
+	                     const char *text, const char *textEnd = nullptr, float wrapWidth = 0.0f, textShadowStyle_e style = kTextShadow_Drop);
+
 	ImVec2 GetIconPosForButton();
 	ImVec2 GetIconPosForText();
 
@@ -3,6 +3,9 @@
 
 #pragma once
 
+#include "common.h"
+#include "message_box.h"
+
 #if defined(__cplusplus)
 extern "C" {
 #endif
@@ -14,3 +17,12 @@ typedef struct tag_messageBoxes messageBoxes;
 #endif
 
 float UIMessageBox_Update(messageBoxes *boxes);
+
+// Posts a notification from any thread, taking ownership of mb's data like mb_queue.  Posts with the
+// same key - or with no key, the same title and text - are merged into one box that shows the count,
+// and only the first post's callback runs.  Boxes are shown one at a time on the global queue, and
+// posts beyond a per-frame budget or a cap on waiting notifications are summarized in a final box.
+void UIMessageBox_Notify(messageBox mb, const char *key);
+
+// Frees notifications that were never shown.
+void UIMessageBox_NotifyShutdown(void);
@@ -35,6 +35,40 @@ static updateVersionName_t s_currentVersionName;
 static updateVersionName_t s_desiredVersionName;
 static updateManifest_t s_updateManifest;
 static u64 s_lastUpdateCheckMs;
+static Update_ManifestReader *s_manifestReader = &json_parse_file;
+
+enum {
+	kUpdate_DefaultManifestTimeoutMs = 10000,
+};
+
+// The build manifest lives on a network share, so it is read and parsed on a worker thread.  The
+// worker and the UI thread each hold a reference, and the UI thread only reads the result once done
+// is set.  A check that outlives the timeout is abandoned - its result is discarded - and another
+// can start, but only one abandoned check is waited on at a time so a hung share can't pile up
+// threads.  A check marked stale started before the manifest was rewritten - its result is dropped
+// and a fresh read started in its place.
+typedef struct tag_updateManifestCheck {
+	sb_t path;
+	updateManifest_t manifest;
+	Update_ManifestReader *reader;
+	u64 startMs;
+	b32 bUpdateImmediately;
+	volatile LONG refCount;
+	volatile LONG done;
+	b32 bStale; // UI thread only
+} updateManifestCheck;
+
+static updateManifestCheck *s_manifestCheck;
+static updateManifestCheck *s_abandonedManifestCheck;
+
+static void Update_ReleaseManifestCheck(updateManifestCheck *check)
+{
+	if(InterlockedDecrement(&check->refCount) == 0) {
+		sb_reset(&check->path);
+		updateManifest_reset(&check->manifest);
+		free(check);
+	}
+}
 
 static BOOL CALLBACK Update_EnumWindowsCallback(HWND hWnd, LPARAM version)
 {
@@ -176,6 +210,14 @@ void Update_Shutdown(void)
 		}
 		fileData_reset(&fileData);
 	}
+	if(s_manifestCheck) {
+		Update_ReleaseManifestCheck(s_manifestCheck);
+		s_manifestCheck = NULL;
+	}
+	if(s_abandonedManifestCheck) {
+		Update_ReleaseManifestCheck(s_abandonedManifestCheck);
+		s_abandonedManifestCheck = NULL;
+	}
 	updateManifest_reset(&s_updateManifest);
 	updateVersionName_reset(&s_currentVersionName);
 	updateVersionName_reset(&s_desiredVersionName);
@@ -245,8 +287,62 @@ static void Update_CheckVersions(b32 updateImmediately)
 	}
 }
 
+static DWORD WINAPI Update_ManifestCheckThread(void *param)
+{
+	updateManifestCheck *check = param;
+	JSON_Value *val = check->reader(sb_get(&check->path));
+	if(val) {
+		check->manifest = json_deserialize_updateManifest_t(val);
+		json_value_free(val);
+	}
+	InterlockedExchange(&check->done, 1);
+	Update_ReleaseManifestCheck(check);
+	return 0;
+}
+
+// Publishes a finished check at the frame boundary, or gives up on one past the timeout.
+static void Update_PollManifestCheck(void)
+{
+	updateManifestCheck *check = s_abandonedManifestCheck;
+	if(check && InterlockedCompareExchange(&check->done, 0, 0)) {
+		BB_LOG("Update", "Abandoned manifest read finished after %llu ms", bb_current_time_ms() - check->startMs);
+		Update_ReleaseManifestCheck(check);
+		s_abandonedManifestCheck = NULL;
+	}
+
+	check = s_manifestCheck;
+	if(!check)
+		return;
+	if(InterlockedCompareExchange(&check->done, 0, 0)) {
+		s_manifestCheck = NULL;
+		if(check->bStale) {
+			b32 bUpdateImmediately = check->bUpdateImmediately;
+			Update_ReleaseManifestCheck(check);
+			Update_CheckForUpdates(bUpdateImmediately);
+			return;
+		}
+		updateManifest_reset(&s_updateManifest);
+		s_updateManifest = check->manifest;
+		memset(&check->manifest, 0, sizeof(check->manifest));
+		Update_CheckVersions(check->bUpdateImmediately);
+		Update_ReleaseManifestCheck(check);
+		return;
+	}
+
+	u32 timeoutMs = s_updateData.manifestTimeoutMs ? s_updateData.manifestTimeoutMs : kUpdate_DefaultManifestTimeoutMs;
+	if(!s_abandonedManifestCheck && bb_current_time_ms() - check->startMs > timeoutMs) {
+		BB_WARNING("Update", "Timed out after %u ms reading %s", timeoutMs, sb_get(&check->path));
+		s_abandonedManifestCheck = check;
+		s_manifestCheck = NULL;
+		if(check->bStale) {
+			Update_CheckForUpdates(check->bUpdateImmediately);
+		}
+	}
+}
+
 void Update_Tick(void)
 {
+	Update_PollManifestCheck();
 	if(s_updateData.updateCheckMs > 0 && s_lastUpdateCheckMs + s_updateData.updateCheckMs < bb_current_time_ms() && mb_get_active(NULL) == NULL) {
 		Update_CheckForUpdates(false);
 	}
@@ -262,18 +358,45 @@ void Update_CheckForUpdates(b32 bUpdateImmediately)
 	if(!s_updateData.manifestDir || !*s_updateData.manifestDir)
 		return;
 
-	updateManifest_reset(&s_updateManifest);
 	s_lastUpdateCheckMs = bb_current_time_ms();
-	sb_t manifestPath = { BB_EMPTY_INITIALIZER };
-	sb_va(&manifestPath, "%s/%s_build_manifest.json", s_updateData.manifestDir, s_updateData.appName);
-	path_resolve_inplace(&manifestPath);
-	JSON_Value *val = json_parse_file(sb_get(&manifestPath));
-	if(val) {
-		s_updateManifest = json_deserialize_updateManifest_t(val);
-		json_value_free(val);
+	if(s_manifestCheck) {
+		// a read is already in flight - its result (or the re-read replacing a stale one) applies to this check too
+		s_manifestCheck->bUpdateImmediately = s_manifestCheck->bUpdateImmediately || bUpdateImmediately;
+		return;
 	}
-	sb_reset(&manifestPath);
-	Update_CheckVersions(bUpdateImmediately);
+
+	updateManifestCheck *check = calloc(1, sizeof(updateManifestCheck));
+	if(!check)
+		return;
+	sb_va(&check->path, "%s/%s_build_manifest.json", s_updateData.manifestDir, s_updateData.appName);
+	path_resolve_inplace(&check->path);
+	check->reader = s_manifestReader;
+	check->startMs = s_lastUpdateCheckMs;
+	check->bUpdateImmediately = bUpdateImmediately;
+	check->refCount = 2;
+
+	HANDLE hThread = CreateThread(NULL, 0, &Update_ManifestCheckThread, check, 0, NULL);
+	if(!hThread) {
+		BB_WARNING("Update", "Failed to start manifest read for %s", sb_get(&check->path));
+		sb_reset(&check->path);
+		free(check);
+		return;
+	}
+	CloseHandle(hThread);
+	s_manifestCheck = check;
+}
+
+void Update_ManifestChanged(void)
+{
+	if(s_manifestCheck) {
+		s_manifestCheck->bStale = true;
+	}
+	Update_CheckForUpdates(false);
+}
+
+void Update_SetManifestReader(Update_ManifestReader *reader)
+{
+	s_manifestReader = reader ? reader : &json_parse_file;
 }
 
 const char *Update_GetCurrentVersion(void)
@@ -339,7 +462,7 @@ static void update_promote_messageBoxFunc(messageBox *mb, const char *action)
 			}
 			json_value_free(val);
 			updateManifest_reset(&manifest);
-			Update_CheckForUpdates(false);
+			Update_ManifestChanged();
 		}
 	}
 }
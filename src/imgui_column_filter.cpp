@@ -0,0 +1,329 @@
+// Copyright (c) 2012-2019 Matt Campbell
+// MIT license (see License.txt)
+
+#include "imgui_column_filter.h"
+#include "bb_array.h"
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+	kColumnFilter_ChunkRows = 16384,
+	kColumnFilter_CancelCheckRows = 256, // workers notice a cancel within this many rows
+	kColumnFilter_MaxThreads = 8,
+};
+
+struct ImGui::columnFilterChunk {
+	columnFilterChunk *next; // in the pool's queue
+	columnFilter *filter;
+	const u32 *source; // rows to test, or null to test rows first..end themselves
+	u32 first;
+	u32 end;
+	u32 *matches;
+	u32 numMatches;
+	LONG generation;
+	volatile LONG done;
+	u8 pad[4];
+};
+
+using ImGui::columnFilter;
+using ImGui::columnFilterChunk;
+
+struct columnFilterPool {
+	CRITICAL_SECTION cs;
+	HANDLE hSemaphore;
+	HANDLE hThreads[kColumnFilter_MaxThreads];
+	columnFilterChunk *head;
+	columnFilterChunk *tail;
+	u32 numThreads;
+	volatile LONG shutdown;
+};
+
+static columnFilterPool s_filterPool;
+
+static void ImGui_ColumnFilter_RunChunk(columnFilterChunk *chunk)
+{
+	columnFilter *filter = chunk->filter;
+	for(u32 i = chunk->first; i < chunk->end; ++i) {
+		if(((i - chunk->first) % kColumnFilter_CancelCheckRows) == 0 && InterlockedCompareExchange(&filter->generation, 0, 0) != chunk->generation)
+			break;
+		u32 row = chunk->source ? chunk->source[i] : i;
+		if(filter->func(row, filter->query, filter->userData)) {
+			chunk->matches[chunk->numMatches++] = row;
+		}
+	}
+}
+
+static DWORD WINAPI ImGui_ColumnFilter_Thread(void *)
+{
+	for(;;) {
+		WaitForSingleObject(s_filterPool.hSemaphore, INFINITE);
+		if(InterlockedCompareExchange(&s_filterPool.shutdown, 0, 0))
+			break;
+
+		// counted in flight under the lock, so a cancel that empties the queue can wait for it
+		EnterCriticalSection(&s_filterPool.cs);
+		columnFilterChunk *chunk = s_filterPool.head;
+		if(chunk) {
+			s_filterPool.head = chunk->next;
+			if(!s_filterPool.head) {
+				s_filterPool.tail = nullptr;
+			}
+			InterlockedIncrement(&chunk->filter->inFlight);
+		}
+		LeaveCriticalSection(&s_filterPool.cs);
+		if(!chunk)
+			continue;
+
+		columnFilter *filter = chunk->filter;
+		ImGui_ColumnFilter_RunChunk(chunk);
+		InterlockedExchange(&chunk->done, 1);
+		InterlockedDecrement(&filter->inFlight);
+	}
+	return 0;
+}
+
+static bool ImGui_ColumnFilter_StartPool()
+{
+	if(s_filterPool.numThreads)
+		return true;
+
+	// leave a core for the UI thread
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	u32 numThreads = (info.dwNumberOfProcessors > 1) ? (u32)info.dwNumberOfProcessors - 1 : 1;
+	numThreads = (numThreads < kColumnFilter_MaxThreads) ? numThreads : kColumnFilter_MaxThreads;
+
+	InitializeCriticalSection(&s_filterPool.cs);
+	s_filterPool.shutdown = 0;
+	s_filterPool.hSemaphore = CreateSemaphoreA(nullptr, 0, 0x7fffffff, nullptr);
+	if(s_filterPool.hSemaphore) {
+		for(u32 i = 0; i < numThreads; ++i) {
+			s_filterPool.hThreads[s_filterPool.numThreads] = CreateThread(nullptr, 0, &ImGui_ColumnFilter_Thread, nullptr, 0, nullptr);
+			if(s_filterPool.hThreads[s_filterPool.numThreads]) {
+				++s_filterPool.numThreads;
+			}
+		}
+	}
+	if(!s_filterPool.numThreads) {
+		if(s_filterPool.hSemaphore) {
+			CloseHandle(s_filterPool.hSemaphore);
+			s_filterPool.hSemaphore = nullptr;
+		}
+		DeleteCriticalSection(&s_filterPool.cs);
+		return false;
+	}
+	return true;
+}
+
+void ImGui::ColumnFilterShutdown(void)
+{
+	if(!s_filterPool.numThreads)
+		return;
+	InterlockedExchange(&s_filterPool.shutdown, 1);
+	ReleaseSemaphore(s_filterPool.hSemaphore, (LONG)s_filterPool.numThreads, nullptr);
+	WaitForMultipleObjects(s_filterPool.numThreads, s_filterPool.hThreads, TRUE, INFINITE);
+	for(u32 i = 0; i < s_filterPool.numThreads; ++i) {
+		CloseHandle(s_filterPool.hThreads[i]);
+	}
+	CloseHandle(s_filterPool.hSemaphore);
+	DeleteCriticalSection(&s_filterPool.cs);
+	memset(&s_filterPool, 0, sizeof(s_filterPool));
+}
+
+static void ImGui_ColumnFilter_FreeChunk(columnFilterChunk *chunk)
+{
+	free(chunk->matches);
+	free(chunk);
+}
+
+// Takes the filter's chunks off the queue and waits out any a worker is running - they stop early
+// once they see the generation change.
+static void ImGui_ColumnFilter_Cancel(columnFilter *filter)
+{
+	InterlockedIncrement(&filter->generation);
+	if(s_filterPool.numThreads) {
+		EnterCriticalSection(&s_filterPool.cs);
+		columnFilterChunk *prev = nullptr;
+		columnFilterChunk *chunk = s_filterPool.head;
+		while(chunk) {
+			columnFilterChunk *next = chunk->next;
+			if(chunk->filter == filter) {
+				if(prev) {
+					prev->next = next;
+				} else {
+					s_filterPool.head = next;
+				}
+				if(s_filterPool.tail == chunk) {
+					s_filterPool.tail = prev;
+				}
+			} else {
+				prev = chunk;
+			}
+			chunk = next;
+		}
+		LeaveCriticalSection(&s_filterPool.cs);
+		while(InterlockedCompareExchange(&filter->inFlight, 0, 0)) {
+			Sleep(0);
+		}
+	}
+
+	for(u32 i = filter->nextChunk; i < filter->pending.count; ++i) {
+		ImGui_ColumnFilter_FreeChunk(filter->pending.data[i]);
+	}
+	filter->pending.count = 0;
+	filter->nextChunk = 0;
+}
+
+// Queues chunks testing [first, end) of source, or rows first..end when source is null.  Without a
+// worker pool, chunks are run on the calling thread.
+static b32 ImGui_ColumnFilter_Queue(columnFilter *filter, const u32 *source, u32 first, u32 end)
+{
+	if(!*filter->query && !source) {
+		// an empty query matches everything
+		if(!bba_add_noclear(filter->rows, end - first))
+			return false;
+		u32 *rows = filter->rows.data + filter->rows.count - (end - first);
+		for(u32 row = first; row < end; ++row) {
+			*rows++ = row;
+		}
+		return true;
+	}
+
+	b32 bPool = ImGui_ColumnFilter_StartPool();
+	while(first < end) {
+		u32 count = (end - first > kColumnFilter_ChunkRows) ? kColumnFilter_ChunkRows : end - first;
+		columnFilterChunk *chunk = (columnFilterChunk *)calloc(1, sizeof(columnFilterChunk));
+		u32 *matches = (u32 *)malloc(count * sizeof(u32));
+		if(!chunk || !matches || !bba_add_noclear(filter->pending, 1)) {
+			free(chunk);
+			free(matches);
+			return false;
+		}
+		chunk->filter = filter;
+		chunk->source = source;
+		chunk->first = first;
+		chunk->end = first + count;
+		chunk->matches = matches;
+		chunk->generation = filter->generation;
+		bba_last(filter->pending) = chunk;
+		first += count;
+
+		if(bPool) {
+			EnterCriticalSection(&s_filterPool.cs);
+			if(s_filterPool.tail) {
+				s_filterPool.tail->next = chunk;
+			} else {
+				s_filterPool.head = chunk;
+			}
+			s_filterPool.tail = chunk;
+			LeaveCriticalSection(&s_filterPool.cs);
+			ReleaseSemaphore(s_filterPool.hSemaphore, 1, nullptr);
+		} else {
+			ImGui_ColumnFilter_RunChunk(chunk);
+			chunk->done = 1;
+		}
+	}
+	return true;
+}
+
+// Appends finished chunks to rows, in order, stopping at the first still running.
+static void ImGui_ColumnFilter_Publish(columnFilter *filter)
+{
+	while(filter->nextChunk < filter->pending.count) {
+		columnFilterChunk *chunk = filter->pending.data[filter->nextChunk];
+		if(!InterlockedCompareExchange(&chunk->done, 0, 0))
+			break;
+		if(chunk->numMatches) {
+			if(!bba_add_noclear(filter->rows, chunk->numMatches))
+				break;
+			memcpy(filter->rows.data + filter->rows.count - chunk->numMatches, chunk->matches, chunk->numMatches * sizeof(u32));
+		}
+		ImGui_ColumnFilter_FreeChunk(chunk);
+		++filter->nextChunk;
+	}
+	if(filter->nextChunk == filter->pending.count) {
+		filter->pending.count = 0;
+		filter->nextChunk = 0;
+	}
+	filter->bComplete = filter->pending.count == 0;
+}
+
+void ImGui::InitColumnFilter(columnFilter *filter, columnFilterFunc func, void *userData)
+{
+	memset(filter, 0, sizeof(*filter));
+	filter->func = func;
+	filter->userData = userData;
+}
+
+void ImGui::ResetColumnFilter(columnFilter *filter)
+{
+	ImGui_ColumnFilter_Cancel(filter);
+	bba_free(filter->rows);
+	bba_free(filter->pending);
+	free(filter->query);
+	free(filter->source);
+	InitColumnFilter(filter, filter->func, filter->userData);
+}
+
+void ImGui::InvalidateColumnFilter(columnFilter *filter)
+{
+	ImGui_ColumnFilter_Cancel(filter);
+	free(filter->query);
+	filter->query = nullptr;
+	filter->rows.count = 0;
+	filter->numRows = 0;
+	filter->bComplete = false;
+}
+
+b32 ImGui::UpdateColumnFilter(columnFilter *filter, const char *query, u32 numRows)
+{
+	if(!query) {
+		query = "";
+	}
+
+	if(!filter->query || strcmp(filter->query, query) != 0 || numRows < filter->numRows) {
+		// refining needs the previous matches to be complete, and the rows they cover unchanged
+		size_t prevLen = filter->query ? strlen(filter->query) : 0;
+		b32 bRefine = prevLen && filter->bComplete && numRows >= filter->numRows && !strncmp(query, filter->query, prevLen);
+		u32 refinedRows = bRefine ? filter->numRows : 0;
+		ImGui_ColumnFilter_Cancel(filter);
+
+		size_t len = strlen(query);
+		char *newQuery = (char *)malloc(len + 1);
+		if(!newQuery)
+			return false;
+		memcpy(newQuery, query, len + 1);
+		free(filter->query);
+		filter->query = newQuery;
+
+		free(filter->source);
+		filter->source = nullptr;
+		filter->sourceCount = 0;
+		if(bRefine && filter->rows.count) {
+			filter->source = (u32 *)malloc(filter->rows.count * sizeof(u32));
+			if(filter->source) {
+				memcpy(filter->source, filter->rows.data, filter->rows.count * sizeof(u32));
+				filter->sourceCount = filter->rows.count;
+			} else {
+				refinedRows = 0;
+			}
+		}
+		filter->rows.count = 0;
+		filter->numRows = refinedRows;
+		if(filter->source && !ImGui_ColumnFilter_Queue(filter, filter->source, 0, filter->sourceCount)) {
+			InvalidateColumnFilter(filter); // out of memory - start over next update
+			return false;
+		}
+	}
+
+	if(numRows > filter->numRows) {
+		if(!ImGui_ColumnFilter_Queue(filter, nullptr, filter->numRows, numRows)) {
+			InvalidateColumnFilter(filter);
+			return false;
+		}
+		filter->numRows = numRows;
+	}
+
+	ImGui_ColumnFilter_Publish(filter);
+	return filter->bComplete;
+}
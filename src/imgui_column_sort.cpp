@@ -0,0 +1,327 @@
+// Copyright (c) 2012-2019 Matt Campbell
+// MIT license (see License.txt)
+
+#include "imgui_column_sort.h"
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+	kColumnSort_InsertionRun = 16,        // runs insertion-sorted before merging
+	kColumnSort_MinRowsPerThread = 65536, // smaller sorts stay on the calling thread
+	kColumnSort_MaxThreads = 16,
+};
+
+struct columnSortContext {
+	ImGui::columnSortCompareFunc compare;
+	void *userData;
+	u32 column;
+	u8 pad[4];
+};
+
+static int ImGui_ColumnSort_Compare(const columnSortContext *ctx, u32 rowA, u32 rowB)
+{
+	int result = ctx->compare(rowA, rowB, ctx->column, ctx->userData);
+	if(result)
+		return result;
+	return (rowA < rowB) ? -1 : (rowA > rowB) ? 1 : 0;
+}
+
+// Stable merge of a and b into out.
+static void ImGui_ColumnSort_Merge(const columnSortContext *ctx, const u32 *a, u32 aCount, const u32 *b, u32 bCount, u32 *out)
+{
+	u32 i = 0;
+	u32 j = 0;
+	while(i < aCount && j < bCount) {
+		if(ImGui_ColumnSort_Compare(ctx, b[j], a[i]) < 0) {
+			*out++ = b[j++];
+		} else {
+			*out++ = a[i++];
+		}
+	}
+	memcpy(out, a + i, (aCount - i) * sizeof(u32));
+	memcpy(out + (aCount - i), b + j, (bCount - j) * sizeof(u32));
+}
+
+// Bottom-up merge sort of rows, ping-ponging through scratch.  The result ends up in rows.
+static void ImGui_ColumnSort_MergeSort(const columnSortContext *ctx, u32 *rows, u32 *scratch, u32 count)
+{
+	for(u32 start = 0; start < count; start += kColumnSort_InsertionRun) {
+		u32 end = (count - start > kColumnSort_InsertionRun) ? start + kColumnSort_InsertionRun : count;
+		for(u32 i = start + 1; i < end; ++i) {
+			u32 row = rows[i];
+			u32 j = i;
+			while(j > start && ImGui_ColumnSort_Compare(ctx, row, rows[j - 1]) < 0) {
+				rows[j] = rows[j - 1];
+				--j;
+			}
+			rows[j] = row;
+		}
+	}
+
+	u32 *src = rows;
+	u32 *dst = scratch;
+	for(u32 width = kColumnSort_InsertionRun; width < count; width *= 2) {
+		for(u32 start = 0; start < count; start += 2 * width) {
+			u32 aCount = (count - start > width) ? width : count - start;
+			u32 bCount = (count - start - aCount > width) ? width : count - start - aCount;
+			ImGui_ColumnSort_Merge(ctx, src + start, aCount, src + start + aCount, bCount, dst + start);
+		}
+		u32 *swap = src;
+		src = dst;
+		dst = swap;
+	}
+	if(src != rows) {
+		memcpy(rows, src, count * sizeof(u32));
+	}
+}
+
+struct columnSortJob {
+	const columnSortContext *ctx;
+	u32 *src;
+	u32 *dst;
+	u32 aCount;
+	u32 bCount; // 0 for a merge sort of src (using dst as scratch), otherwise merge src's two runs into dst
+	HANDLE hThread;
+};
+
+static void ImGui_ColumnSort_RunJob(columnSortJob *job)
+{
+	if(job->bCount) {
+		ImGui_ColumnSort_Merge(job->ctx, job->src, job->aCount, job->src + job->aCount, job->bCount, job->dst);
+	} else {
+		ImGui_ColumnSort_MergeSort(job->ctx, job->src, job->dst, job->aCount);
+	}
+}
+
+static DWORD WINAPI ImGui_ColumnSort_Thread(void *param)
+{
+	ImGui_ColumnSort_RunJob((columnSortJob *)param);
+	return 0;
+}
+
+// Runs the jobs on worker threads, or inline if a thread can't be started.
+static void ImGui_ColumnSort_RunJobs(columnSortJob *jobs, u32 numJobs)
+{
+	for(u32 i = 1; i < numJobs; ++i) {
+		jobs[i].hThread = CreateThread(nullptr, 0, &ImGui_ColumnSort_Thread, jobs + i, 0, nullptr);
+		if(!jobs[i].hThread) {
+			ImGui_ColumnSort_RunJob(jobs + i);
+		}
+	}
+	if(numJobs) {
+		ImGui_ColumnSort_RunJob(jobs);
+	}
+	for(u32 i = 1; i < numJobs; ++i) {
+		if(jobs[i].hThread) {
+			WaitForSingleObject(jobs[i].hThread, INFINITE);
+			CloseHandle(jobs[i].hThread);
+			jobs[i].hThread = nullptr;
+		}
+	}
+}
+
+static u32 ImGui_ColumnSort_NumThreads(u32 count, u32 maxThreads)
+{
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	u32 threads = (u32)info.dwNumberOfProcessors;
+	threads = (threads < maxThreads) ? threads : maxThreads;
+	threads = (threads < count / kColumnSort_MinRowsPerThread) ? threads : count / kColumnSort_MinRowsPerThread;
+	return threads ? threads : 1;
+}
+
+// Sorts rows with each thread merge sorting a slice, then merges the slices pairwise, in parallel
+// while there is more than one pair.
+static b32 ImGui_ColumnSort_ParallelSort(const columnSortContext *ctx, u32 *rows, u32 count, u32 maxThreads)
+{
+	if(!count)
+		return true;
+	u32 *scratch = (u32 *)malloc((size_t)count * sizeof(u32));
+	if(!scratch)
+		return false;
+
+	columnSortJob jobs[kColumnSort_MaxThreads] = {};
+	u32 threads = ImGui_ColumnSort_NumThreads(count, maxThreads);
+	u32 slice = (count + threads - 1) / threads;
+	u32 numJobs = 0;
+	for(u32 start = 0; start < count; start += slice) {
+		columnSortJob *job = jobs + numJobs++;
+		job->ctx = ctx;
+		job->src = rows + start;
+		job->dst = scratch + start;
+		job->aCount = (count - start > slice) ? slice : count - start;
+	}
+	ImGui_ColumnSort_RunJobs(jobs, numJobs);
+
+	u32 *src = rows;
+	u32 *dst = scratch;
+	for(u32 width = slice; width < count; width *= 2) {
+		numJobs = 0;
+		for(u32 start = 0; start < count; start += 2 * width) {
+			columnSortJob *job = jobs + numJobs++;
+			job->ctx = ctx;
+			job->src = src + start;
+			job->dst = dst + start;
+			job->aCount = (count - start > width) ? width : count - start;
+			job->bCount = (count - start - job->aCount > width) ? width : count - start - job->aCount;
+			if(!job->bCount) {
+				memcpy(job->dst, job->src, job->aCount * sizeof(u32));
+				--numJobs;
+			}
+		}
+		ImGui_ColumnSort_RunJobs(jobs, numJobs);
+		u32 *swap = src;
+		src = dst;
+		dst = swap;
+	}
+	if(src != rows) {
+		memcpy(rows, src, count * sizeof(u32));
+	}
+	free(scratch);
+	return true;
+}
+
+// Sorts the rows appended since the order was built, then merges them in from the back, so only
+// the new rows need scratch space.
+static b32 ImGui_ColumnSort_AppendRows(const columnSortContext *ctx, u32 *rows, u32 oldCount, u32 newCount, u32 maxThreads)
+{
+	u32 appended = newCount - oldCount;
+	u32 *tail = (u32 *)malloc((size_t)appended * sizeof(u32));
+	if(!tail)
+		return false;
+	for(u32 i = 0; i < appended; ++i) {
+		tail[i] = oldCount + i;
+	}
+	if(!ImGui_ColumnSort_ParallelSort(ctx, tail, appended, maxThreads)) {
+		free(tail);
+		return false;
+	}
+
+	// Merge from the back.  A few rows into many binary search for where each goes and move the
+	// existing rows after it as a block, so the compares scale with the rows appended rather than
+	// the table.  Appended rows come after existing rows they tie with.
+	u32 log2Old = 0;
+	while(log2Old < 32 && (oldCount >> log2Old)) {
+		++log2Old;
+	}
+	b32 bSearch = (u64)appended * log2Old < oldCount;
+	u32 i = oldCount;
+	u32 j = appended;
+	u32 out = newCount;
+	while(j > 0) {
+		if(bSearch) {
+			u32 lo = 0;
+			u32 hi = i;
+			while(lo < hi) {
+				u32 mid = lo + (hi - lo) / 2;
+				if(ImGui_ColumnSort_Compare(ctx, rows[mid], tail[j - 1]) > 0) {
+					hi = mid;
+				} else {
+					lo = mid + 1;
+				}
+			}
+			out -= i - lo;
+			memmove(rows + out, rows + lo, (i - lo) * sizeof(u32));
+			i = lo;
+			rows[--out] = tail[--j];
+		} else if(i > 0 && ImGui_ColumnSort_Compare(ctx, rows[i - 1], tail[j - 1]) > 0) {
+			rows[--out] = rows[--i];
+		} else {
+			rows[--out] = tail[--j];
+		}
+	}
+	free(tail);
+	return true;
+}
+
+static b32 ImGui_ColumnSort_UpdateOrder(const columnSortContext *ctx, ImGui::columnSortOrder *order, u32 numRows, u32 maxThreads, ImGui::columnSort *sort)
+{
+	if(numRows < order->numRows) {
+		order->numRows = 0;
+	}
+	if(order->numRows == numRows)
+		return true;
+
+	if(numRows > order->allocated) {
+		u32 allocated = order->allocated ? order->allocated : 1024;
+		while(allocated < numRows) {
+			allocated = (allocated > 0x7fffffff) ? numRows : allocated * 2;
+		}
+		u32 *rows = (u32 *)realloc(order->rows, (size_t)allocated * sizeof(u32));
+		if(!rows)
+			return false;
+		order->rows = rows;
+		order->allocated = allocated;
+	}
+
+	if(order->numRows == 0) {
+		for(u32 i = 0; i < numRows; ++i) {
+			order->rows[i] = i;
+		}
+		if(!ImGui_ColumnSort_ParallelSort(ctx, order->rows, numRows, maxThreads))
+			return false;
+		++sort->fullSorts;
+	} else {
+		if(!ImGui_ColumnSort_AppendRows(ctx, order->rows, order->numRows, numRows, maxThreads))
+			return false;
+		sort->mergedRows += numRows - order->numRows;
+	}
+	order->numRows = numRows;
+	return true;
+}
+
+void ImGui::InitColumnSort(columnSort *sort, u32 numColumns, columnSortCompareFunc compare, void *userData)
+{
+	memset(sort, 0, sizeof(*sort));
+	sort->orders = (columnSortOrder *)calloc(numColumns, sizeof(columnSortOrder));
+	sort->numColumns = sort->orders ? numColumns : 0;
+	sort->compare = compare;
+	sort->userData = userData;
+}
+
+void ImGui::ResetColumnSort(columnSort *sort)
+{
+	for(u32 i = 0; i < sort->numColumns; ++i) {
+		free(sort->orders[i].rows);
+	}
+	free(sort->orders);
+	memset(sort, 0, sizeof(*sort));
+}
+
+void ImGui::InvalidateColumnSort(columnSort *sort)
+{
+	for(u32 i = 0; i < sort->numColumns; ++i) {
+		sort->orders[i].numRows = 0;
+	}
+	sort->numRows = 0;
+}
+
+b32 ImGui::UpdateColumnSort(columnSort *sort, const columnDrawData &columns, u32 numRows)
+{
+	u32 column = columns.sortColumn ? *columns.sortColumn : 0;
+	sort->descending = columns.sortDescending ? *columns.sortDescending : false;
+	if(column >= sort->numColumns) {
+		sort->numRows = 0;
+		return false;
+	}
+
+	sort->column = column;
+	columnSortContext ctx = { sort->compare, sort->userData, column, {} };
+	columnSortOrder *order = sort->orders + column;
+	u32 maxThreads = (sort->maxThreads && sort->maxThreads < kColumnSort_MaxThreads) ? sort->maxThreads : kColumnSort_MaxThreads;
+	if(!ImGui_ColumnSort_UpdateOrder(&ctx, order, numRows, maxThreads, sort)) {
+		order->numRows = 0;
+		sort->numRows = 0;
+		return false;
+	}
+	sort->numRows = numRows;
+	return true;
+}
+
+u32 ImGui::ColumnSortRow(const columnSort *sort, u32 displayRow)
+{
+	if(displayRow >= sort->numRows)
+		return displayRow;
+	const columnSortOrder *order = sort->orders + sort->column;
+	return order->rows[sort->descending ? sort->numRows - 1 - displayRow : displayRow];
+}
@@ -0,0 +1,155 @@
+// Copyright (c) 2012-2019 Matt Campbell
+// MIT license (see License.txt)
+
+#include "imgui_column_table.h"
+#include "imgui_selection.h"
+
+// warning C4820 : 'StructName' : '4' bytes padding added after data member 'MemberName'
+// warning C4365: '=': conversion from 'ImGuiTabItemFlags' to 'ImGuiID', signed/unsigned mismatch
+BB_WARNING_PUSH(4820 4365)
+#include "imgui_internal.h"
+BB_WARNING_POP
+
+// First row ending below top, and one past the last row starting above bottom.
+static void ImGui_ColumnTable_VisibleRows(const float *rowOffsets, u32 numRows, float top, float bottom, u32 *start, u32 *end)
+{
+	u32 lo = 0;
+	u32 hi = numRows;
+	while(lo < hi) {
+		u32 mid = lo + (hi - lo) / 2;
+		if(rowOffsets[mid + 1] > top) {
+			hi = mid;
+		} else {
+			lo = mid + 1;
+		}
+	}
+	*start = lo;
+
+	hi = numRows;
+	while(lo < hi) {
+		u32 mid = lo + (hi - lo) / 2;
+		if(rowOffsets[mid] >= bottom) {
+			hi = mid;
+		} else {
+			lo = mid + 1;
+		}
+	}
+	*end = lo;
+}
+
+// Full-width selectable behind the row's cells, leaving the cursor at the start of the row.
+static bool ImGui_ColumnTable_SelectableRow(selection *sel, u32 row, float x, float y, float height)
+{
+	ImGui::SetCursorPos(ImVec2(0.0f, y));
+	ImGui::PushID((int)row);
+	bool clicked = ImGui::Selectable("##row", sel, row, ImGuiSelectableFlags_AllowItemOverlap, ImVec2(0.0f, height));
+	ImGui::PopID();
+	ImGui::SetCursorPos(ImVec2(x, y));
+	return clicked;
+}
+
+ImGui::columnTableResult ImGui::ColumnTable(const char *str_id, const columnTable &table, columnTableRowFunc drawRow, void *userData, const ImVec2 &size)
+{
+	columnTableResult result = {};
+	PushID(str_id);
+
+	table.columns.columnOffsets[0] = GetCursorPosX();
+	for(u32 i = 0; i < table.columns.numColumns; ++i) {
+		columnDrawResult header = DrawColumnHeader(table.columns, i, table.contextMenuName);
+		result.sortChanged = result.sortChanged || header.sortChanged;
+		result.active = result.active || header.active;
+	}
+	NewLine();
+	if(table.sort) {
+		// the selection is by display row, so it no longer means the same rows once they move
+		u32 fullSorts = table.sort->fullSorts;
+		u64 mergedRows = table.sort->mergedRows;
+		UpdateColumnSort(table.sort, table.columns, table.numRows);
+		bool bOrderChanged = result.sortChanged || table.sort->fullSorts != fullSorts || table.sort->mergedRows != mergedRows;
+		selection *sel = table.rowSelection;
+		if(bOrderChanged && sel && (sel->ranges.count || sel->cursor != kSelection_None)) {
+			selection_clear(sel);
+			sel->anchor = kSelection_None;
+			sel->cursor = kSelection_None;
+			result.selectionChanged = true;
+		}
+	}
+
+	// the rows child starts at the window's left edge, so column offsets mean the same in both windows
+	ImVec2 childSize(size.x != 0.0f ? size.x : GetWindowWidth(), size.y);
+	SetCursorPosX(0.0f);
+	if(BeginChild("##rows", childSize, false, ImGuiWindowFlags_None)) {
+		float rowHeight = table.rowHeight > 0.0f ? table.rowHeight : GetTextLineHeightWithSpacing();
+		float rowsStartY = GetCursorPosY();
+		selection *sel = table.rowSelection;
+		if(sel && IsWindowFocused() && SelectionKeyboardNav(sel, table.numRows, (u32)(GetWindowHeight() / rowHeight))) {
+			result.selectionChanged = true;
+			if(sel->cursor < table.numRows) {
+				float top = rowsStartY + (table.rowOffsets ? table.rowOffsets[sel->cursor] : rowHeight * (float)sel->cursor);
+				float bottom = rowsStartY + (table.rowOffsets ? table.rowOffsets[sel->cursor + 1] : rowHeight * (float)(sel->cursor + 1));
+				if(top < GetScrollY()) {
+					SetScrollY(top);
+				} else if(bottom > GetScrollY() + GetWindowHeight()) {
+					SetScrollY(bottom - GetWindowHeight());
+				}
+			}
+		}
+		if(table.rowOffsets) {
+			float top = GetScrollY() - rowsStartY;
+			u32 start;
+			u32 end;
+			ImGui_ColumnTable_VisibleRows(table.rowOffsets, table.numRows, top, top + GetWindowHeight(), &start, &end);
+			BeginColumnChannels(table.columns);
+			for(u32 row = start; row < end; ++row) {
+				float y = rowsStartY + table.rowOffsets[row];
+				if(sel) {
+					result.selectionChanged = ImGui_ColumnTable_SelectableRow(sel, row, table.columns.columnOffsets[0], y, table.rowOffsets[row + 1] - table.rowOffsets[row]) || result.selectionChanged;
+				} else {
+					SetCursorPos(ImVec2(table.columns.columnOffsets[0], y));
+				}
+				drawRow(table.columns, table.sort ? ColumnSortRow(table.sort, row) : row, userData);
+			}
+			EndColumnChannels();
+			SetCursorPosY(rowsStartY + table.rowOffsets[table.numRows]); // extends the content to the full height
+			result.firstVisibleRow = start;
+			result.visibleRows = end - start;
+		} else {
+			ImGuiListClipper clipper;
+			clipper.Begin((int)table.numRows, rowHeight);
+			while(clipper.Step()) {
+				BeginColumnChannels(table.columns);
+				for(int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+					float y = rowsStartY + rowHeight * (float)row;
+					if(sel) {
+						result.selectionChanged = ImGui_ColumnTable_SelectableRow(sel, (u32)row, table.columns.columnOffsets[0], y, rowHeight) || result.selectionChanged;
+					} else {
+						SetCursorPos(ImVec2(table.columns.columnOffsets[0], y));
+					}
+					drawRow(table.columns, table.sort ? ColumnSortRow(table.sort, (u32)row) : (u32)row, userData);
+				}
+				EndColumnChannels();
+				if(clipper.DisplayEnd > clipper.DisplayStart) {
+					result.firstVisibleRow = (u32)clipper.DisplayStart;
+					result.visibleRows = (u32)(clipper.DisplayEnd - clipper.DisplayStart);
+				}
+			}
+			clipper.End();
+		}
+	}
+	EndChild();
+
+	PopID();
+	return result;
+}
+
+void ImGui::UpdateColumnTableRowOffsets(float *rowOffsets, const float *rowHeights, u32 numRows, u32 firstRow)
+{
+	if(firstRow == 0) {
+		rowOffsets[0] = 0.0f;
+	}
+	double offset = rowOffsets[firstRow];
+	for(u32 row = firstRow; row < numRows; ++row) {
+		offset += rowHeights[row];
+		rowOffsets[row + 1] = (float)offset;
+	}
+}
@@ -8,7 +8,10 @@
 #include "cmdline.h"
 #include "common.h"
 #include "fonts.h"
+#include "imgui_column_filter.h"
 #include "imgui_image.h"
+#include "imgui_image_stream.h"
+#include "imgui_image_tiled.h"
 #include "imgui_input_text.h"
 #include "imgui_themes.h"
 #include "keys.h"
@@ -21,6 +24,10 @@
 #include "wrap_imgui.h"
 #include "wrap_shellscalingapi.h"
 
+#if defined(_DEBUG)
+#include <crtdbg.h>
+#endif
+
 #pragma comment(lib, "d3d9.lib")
 #pragma comment(lib, "xinput9_1_0.lib")
 
@@ -54,6 +61,53 @@ static bool g_bCloseHidesWindow;
 static bool g_bDebugFocusChange;
 static HWINEVENTHOOK s_hWinEventHook;
 
+typedef struct tag_Imgui_Core_AllocCounter {
+	DWORD mainThreadId;
+	u32 imgui; // allocations through ImGui's allocator this frame
+	u32 crt;   // main thread CRT heap allocations this frame (debug CRT only)
+	b32 bEnabled;
+	b32 bAllocatorInstalled;
+	Imgui_Core_FrameAllocations lastFrame;
+	u8 pad[4];
+#if defined(_DEBUG)
+	_CRT_ALLOC_HOOK prevCrtHook; // chained to, and restored when the counter is disabled
+#endif
+} Imgui_Core_AllocCounter;
+static Imgui_Core_AllocCounter s_allocCounter;
+
+static void *Imgui_Core_MemAlloc(size_t size, void *userData)
+{
+	BB_UNUSED(userData);
+	if(s_allocCounter.bEnabled) {
+		++s_allocCounter.imgui;
+	}
+	return malloc(size);
+}
+
+static void Imgui_Core_MemFree(void *ptr, void *userData)
+{
+	BB_UNUSED(userData);
+	free(ptr);
+}
+
+#if defined(_DEBUG)
+static int __cdecl Imgui_Core_CrtAllocHook(int allocType, void *userData, size_t size, int blockType, long requestNumber, const unsigned char *filename, int lineNumber)
+{
+	BB_UNUSED(userData);
+	BB_UNUSED(size);
+	BB_UNUSED(blockType);
+	BB_UNUSED(requestNumber);
+	BB_UNUSED(filename);
+	BB_UNUSED(lineNumber);
+	if((allocType == _HOOK_ALLOC || allocType == _HOOK_REALLOC) && GetCurrentThreadId() == s_allocCounter.mainThreadId) {
+		++s_allocCounter.crt;
+	}
+	if(s_allocCounter.prevCrtHook)
+		return s_allocCounter.prevCrtHook(allocType, userData, size, blockType, requestNumber, filename, lineNumber);
+	return TRUE;
+}
+#endif
+
 static void CALLBACK Imgui_Core_WinEventProc(HWINEVENTHOOK hWinEventHook, DWORD event, HWND hwnd, LONG idObject, LONG idChild, DWORD dwEventThread, DWORD dwmsEventTime);
 
 static const char *D3DErrorString(HRESULT Hr)
@@ -108,6 +162,51 @@ static const char *D3DErrorString(HRESULT Hr)
 #undef D3D_CASE
 }
 
+extern "C" Imgui_Core_FrameAllocations Imgui_Core_GetFrameAllocations(void)
+{
+	return s_allocCounter.lastFrame;
+}
+
+// The ImGui allocator stays installed once the counter has been enabled - ImGui can't report the
+// allocator it replaced, but the wrappers allocate just as ImGui's defaults do.
+extern "C" b32 Imgui_Core_EnableAllocationCounter(b32 bEnabled)
+{
+	b32 bWasEnabled = s_allocCounter.bEnabled;
+	if(bEnabled == bWasEnabled)
+		return bWasEnabled;
+
+	if(bEnabled) {
+		s_allocCounter.mainThreadId = GetCurrentThreadId();
+		if(!s_allocCounter.bAllocatorInstalled) {
+			ImGui::SetAllocatorFunctions(&Imgui_Core_MemAlloc, &Imgui_Core_MemFree);
+			s_allocCounter.bAllocatorInstalled = true;
+		}
+#if defined(_DEBUG)
+		s_allocCounter.prevCrtHook = _CrtSetAllocHook(&Imgui_Core_CrtAllocHook);
+#endif
+	} else {
+#if defined(_DEBUG)
+		if(_CrtGetAllocHook() == &Imgui_Core_CrtAllocHook) {
+			_CrtSetAllocHook(s_allocCounter.prevCrtHook);
+		}
+		s_allocCounter.prevCrtHook = nullptr;
+#endif
+	}
+	s_allocCounter.bEnabled = bEnabled;
+	s_allocCounter.imgui = 0;
+	s_allocCounter.crt = 0;
+	s_allocCounter.lastFrame = Imgui_Core_FrameAllocations();
+	return bWasEnabled;
+}
+
+extern "C" void Imgui_Core_BeginFrameAllocations(void)
+{
+	s_allocCounter.lastFrame.imgui = s_allocCounter.imgui;
+	s_allocCounter.lastFrame.crt = s_allocCounter.crt;
+	s_allocCounter.imgui = 0;
+	s_allocCounter.crt = 0;
+}
+
 extern "C" b32 Imgui_Core_Init(const char *cmdline)
 {
 	IMGUI_CHECKVERSION();
@@ -149,6 +248,8 @@ void Imgui_Core_ResetD3D()
 		return;
 	ImGui_ImplDX9_InvalidateDeviceObjects();
 	ImGui_Image_InvalidateDeviceObjects();
+	ImGui_ImageTiled_InvalidateDeviceObjects();
+	ImGui_ImageStream_InvalidateDeviceObjects();
 	HRESULT hr = s_wnd.pd3dDevice->Reset(&g_d3dpp);
 	s_wnd.b3dValid = (hr == D3D_OK);
 	if(s_wnd.last3DResetResult != hr) {
@@ -179,8 +280,10 @@ void Imgui_Core_ResetD3D()
 extern "C" void Imgui_Core_Shutdown(void)
 {
 	ImGui::InputTextShutdown();
+	ImGui::ColumnFilterShutdown();
 	Fonts_Shutdown();
 	Imgui_Core_Freetype_Shutdown();
+	UIMessageBox_NotifyShutdown();
 	mb_shutdown(nullptr);
 
 	if(s_hWinEventHook) {
@@ -194,6 +297,7 @@ extern "C" void Imgui_Core_Shutdown(void)
 	sb_reset(&g_colorscheme);
 
 	ImGui::DestroyContext();
+	Imgui_Core_EnableAllocationCounter(false);
 
 	if(s_pD3D) {
 		s_pD3D->Release();
@@ -618,6 +722,8 @@ static void Imgui_Core_InitD3D(void)
 	if(bOk) {
 		ImGui_ImplWin32_Init(s_wnd.hwnd);
 		ImGui_Image_Init(s_wnd.pd3dDevice);
+		ImGui_ImageTiled_Init(s_wnd.pd3dDevice);
+		ImGui_ImageStream_Init(s_wnd.pd3dDevice);
 		ImGui_ImplDX9_Init(s_wnd.pd3dDevice);
 		Fonts_InitFonts();
 		s_wnd.b3dValid = true;
@@ -692,6 +798,8 @@ extern "C" void Imgui_Core_ShutdownWindow(void)
 
 		ImGui_ImplDX9_Shutdown();
 		ImGui_Image_Shutdown();
+		ImGui_ImageTiled_Shutdown();
+		ImGui_ImageStream_Shutdown();
 		ImGui_ImplWin32_Shutdown();
 		s_wnd.pd3dDevice->Release();
 	}
@@ -746,7 +854,11 @@ b32 Imgui_Core_BeginFrame(void)
 		Imgui_Core_ResetD3D();
 	}
 
+	Imgui_Core_BeginFrameAllocations();
+
 	ImGui_Image_NewFrame();
+	ImGui_ImageTiled_NewFrame();
+	ImGui_ImageStream_NewFrame();
 	ImGui_ImplDX9_NewFrame();
 	ImGui_ImplWin32_NewFrame();
 	ImGui::NewFrame();
@@ -4,6 +4,10 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include "imgui_image.h"
 #include "bb_array.h"
+#include "imgui_core.h"
+#include "imgui_image_disk_cache.h"
+#include "imgui_image_file.h"
+#include "va.h"
 BB_WARNING_PUSH(4365 4820 4296 4619 5219)
 #include "stb/stb_image.h"
 BB_WARNING_POP
@@ -12,18 +16,103 @@ BB_WARNING_POP
 enum ImGui_Image_Flag : u32 {
 	kImGui_Image_Dirty = 1,
 	kImGui_Image_PendingDestroy = 2,
-	kImGui_Image_PixelDataOwnership = 4,
+	kImGui_Image_PixelDataOwnership = kUserImage_TakePixelDataOwnership,
+	kImGui_Image_TextureEvicted = 8,
+	kImGui_Image_PixelDataEvicted = 16,
+	kImGui_Image_DiscardAfterUpload = kUserImage_DiscardPixelDataAfterUpload,
+	kImGui_Image_PixelDataMapped = 128,
+	kImGui_Image_IgnoreAlpha = 256,
+	kImGui_Image_Compress = kUserImage_Compress,
+	kImGui_Image_TextureBC1 = 1024, // texture holds DXT1 blocks
+	kImGui_Image_TextureBC3 = 2048, // texture holds DXT5 blocks
 };
 
+// Creation flags that change how an image is stored or uploaded - images only share a backing
+// image when these match.
+static const u32 kImGui_Image_ShareFlags = kUserImage_DiscardPixelDataAfterUpload | kUserImage_Compress;
+
 struct UserImages {
 	u32 count;
 	u32 allocated;
 	UserImageData *data;
 };
 
+// Additional ids that share another image's backing data.
+struct UserImageAlias {
+	UserImageId aliasId;
+	UserImageId backingId;
+};
+
+struct UserImageAliases {
+	u32 count;
+	u32 allocated;
+	UserImageAlias *data;
+};
+
+struct UserImageBudget {
+	u64 gpuBytes;
+	u64 cpuBytes;
+	u32 minUnusedFrames;
+	u32 texturesEvicted;
+	u32 pixelDataEvicted;
+	u32 pixelDataReloads;
+};
+
+struct UserImageUploadQueue {
+	u32 count;
+	u32 allocated;
+	u32 *data; // indices into s_userImages, highest priority first
+};
+
+struct UserImageUploadBudget {
+	u64 bytesPerFrame;
+	double msPerFrame;
+	u64 queueBytes;
+	u64 bytesLastFrame;
+	double msLastFrame;
+	u32 queueDepth;
+	u32 bandsLastFrame;
+};
+
+// Block compression runs on one worker thread.  Jobs own a copy of the pixels, so images can be
+// modified or destroyed while encoding - results are matched back to images by serial.
+struct UserImageEncodeJob {
+	UserImageEncodeJob *next;
+	u8 *pixelData; // tightly packed BGRA, freed by the worker
+	u8 *blocks;    // encoded result, nullptr on allocation failure
+	u32 serial;
+	u32 width;
+	u32 height;
+	bcFormat format;
+	bcQuality quality;
+	u8 pad[4];
+};
+
+struct UserImageEncoder {
+	CRITICAL_SECTION cs;
+	HANDLE hThread;
+	HANDLE hSemaphore;
+	UserImageEncodeJob *pendingHead;
+	UserImageEncodeJob *pendingTail;
+	UserImageEncodeJob *completed;
+	u32 lastSerial;
+	u32 inFlight; // submitted jobs whose results haven't been consumed yet
+	volatile LONG shutdown;
+	u8 pad[4];
+};
+
 static LPDIRECT3DDEVICE9 g_pImageDevice;
 static UserImages s_userImages;
+static UserImageAliases s_userImageAliases;
 static u32 s_lastUserId;
+static u32 s_imageFrame;
+static UserImageBudget s_budget;
+static UserImageUploadQueue s_uploadQueue;
+static UserImageUploadBudget s_upload;
+static UserImageEncoder s_encoder = { BB_EMPTY_INITIALIZER };
+static bcQuality s_compressionQuality = kBcQuality_Normal;
+
+static void ImGui_Image_CancelUpload(UserImageData *data);
 
 ImVec2 ImGui_Image_Constrain(const UserImageData &image, ImVec2 available)
 {
@@ -40,48 +129,291 @@ ImVec2 ImGui_Image_Constrain(const UserImageData &image, ImVec2 available)
 	}
 }
 
-UserImageData ImGui_Image_Get(UserImageId userId)
+static UserImageData *ImGui_Image_FindBacking(UserImageId userId)
 {
 	for(u32 i = 0; i < s_userImages.count; ++i) {
 		UserImageData *data = s_userImages.data + i;
 		if(data->userId == userId) {
-			return *data;
+			return data;
+		}
+	}
+	return nullptr;
+}
+
+static UserImageData *ImGui_Image_Find(UserImageId userId)
+{
+	UserImageData *data = ImGui_Image_FindBacking(userId);
+	if(!data) {
+		for(u32 i = 0; i < s_userImageAliases.count; ++i) {
+			const UserImageAlias *alias = s_userImageAliases.data + i;
+			if(alias->aliasId == userId) {
+				return ImGui_Image_FindBacking(alias->backingId);
+			}
 		}
 	}
+	return data;
+}
+
+static void ImGui_Image_Touch(UserImageData *data)
+{
+	data->lastUsedFrame = s_imageFrame;
+	if((data->flags & kImGui_Image_TextureEvicted) != 0) {
+		// the texture is restored by the next ImGui_Image_NewFrame
+		data->flags &= ~kImGui_Image_TextureEvicted;
+		Imgui_Core_RequestRender();
+	}
+}
+
+UserImageData ImGui_Image_Get(UserImageId userId)
+{
+	UserImageData *data = ImGui_Image_Find(userId);
+	if(data) {
+		ImGui_Image_Touch(data);
+		UserImageData result = *data;
+		result.userId = userId;
+		if((data->flags & kImGui_Image_PixelDataMapped) != 0) {
+			// callers expect packed top-down rows that outlive the upload - mapped rows are neither
+			result.pixelData = nullptr;
+			result.pitch = 0;
+			result.mappedView = nullptr;
+		}
+		return result;
+	}
 	UserImageData empty = { BB_EMPTY_INITIALIZER };
 	return empty;
 }
 
-static UserImageData *ImGui_Image_Find(UserImageId userId)
+bool ImGui_Image_Draw(UserImageId userId, ImDrawList *drawList, ImVec2 start, ImVec2 end, ImVec2 uv0, ImVec2 uv1)
+{
+	UserImageData *data = ImGui_Image_Find(userId);
+	if(!data)
+		return false;
+
+	ImGui_Image_Touch(data);
+	if(data->texture) {
+		drawList->AddImage(data->texture, start, end, uv0, uv1, 0xFFFFFFFF);
+		return true;
+	}
+
+	// placeholder: fill top-down as row bands arrive
+	drawList->AddRectFilled(start, end, ImGui::GetColorU32(ImGuiCol_FrameBg));
+	if(data->height > 0 && data->uploadedRows) {
+		float progress = (float)data->uploadedRows / (float)data->height;
+		drawList->AddRectFilled(start, ImVec2(end.x, start.y + (end.y - start.y) * progress), ImGui::GetColorU32(ImGuiCol_FrameBgActive));
+	}
+	drawList->AddRect(start, end, ImGui::GetColorU32(ImGuiCol_Border));
+	return false;
+}
+
+static u64 ImGui_Image_Bytes(const UserImageData *data)
+{
+	return (u64)data->width * (u64)data->height * 4;
+}
+
+// Size of the current texture, which is smaller than the pixels if block compressed.
+static u64 ImGui_Image_TextureBytes(const UserImageData *data)
+{
+	if((data->flags & kImGui_Image_TextureBC1) != 0)
+		return bc_encoded_size(kBcFormat_BC1, (u32)data->width, (u32)data->height);
+	if((data->flags & kImGui_Image_TextureBC3) != 0)
+		return bc_encoded_size(kBcFormat_BC3, (u32)data->width, (u32)data->height);
+	return ImGui_Image_Bytes(data);
+}
+
+static void *ImGui_Image_CopyBytes(const void *src, size_t len)
+{
+	void *copy = malloc(len);
+	if(copy) {
+		memcpy(copy, src, len);
+	}
+	return copy;
+}
+
+static void ImGui_Image_ResetReloadSource(UserImageData *data)
+{
+	UserImageReloadSource *source = &data->reloadSource;
+	free((void *)source->path);
+	free((void *)source->blob);
+	memset(source, 0, sizeof(*source));
+}
+
+static void ImGui_Image_AssignReloadSource(UserImageData *data, const UserImageReloadSource &source)
+{
+	ImGui_Image_ResetReloadSource(data);
+	UserImageReloadSource *dest = &data->reloadSource;
+	dest->type = source.type;
+	switch(source.type) {
+	case kUserImageReload_None:
+		break;
+	case kUserImageReload_Path:
+		if(source.path) {
+			dest->path = (const char *)ImGui_Image_CopyBytes(source.path, strlen(source.path) + 1);
+		}
+		break;
+	case kUserImageReload_Callback:
+		dest->callback = source.callback;
+		dest->userData = source.userData;
+		break;
+	case kUserImageReload_CompressedBlob:
+		if(source.blob && source.blobSize) {
+			dest->blob = (const u8 *)ImGui_Image_CopyBytes(source.blob, (size_t)source.blobSize);
+			dest->blobSize = dest->blob ? source.blobSize : 0;
+		}
+		break;
+	}
+}
+
+static bool ImGui_Image_CanReload(const UserImageData *data)
+{
+	const UserImageReloadSource *source = &data->reloadSource;
+	switch(source->type) {
+	case kUserImageReload_None: return false;
+	case kUserImageReload_Path: return source->path != nullptr;
+	case kUserImageReload_Callback: return source->callback != nullptr;
+	case kUserImageReload_CompressedBlob: return source->blob != nullptr;
+	}
+	return false;
+}
+
+// MurmurHash3's finalizer - every input bit affects every output bit.
+static u64 ImGui_Image_Mix64(u64 x)
+{
+	x ^= x >> 33;
+	x *= 0xff51afd7ed558ccdull;
+	x ^= x >> 33;
+	x *= 0xc4ceb9fe1a85ec53ull;
+	x ^= x >> 33;
+	return x;
+}
+
+static u64 ImGui_Image_HashPixels(const u8 *pixelData, int width, int height)
+{
+	if(!pixelData || width <= 0 || height <= 0)
+		return 0;
+
+	// 64-bit words, each mixed before it is combined so differences can't cancel out - a byte at a
+	// time is too slow for large images
+	u64 hash = ImGui_Image_Mix64(((u64)(u32)width << 32) | (u32)height);
+	u64 bytes = (u64)width * (u64)height * 4;
+	u64 numWords = bytes / sizeof(u64);
+	for(u64 i = 0; i < numWords; ++i) {
+		u64 word;
+		memcpy(&word, pixelData + i * sizeof(u64), sizeof(word));
+		hash = (hash ^ ImGui_Image_Mix64(word)) * 1099511628211ull;
+	}
+	for(u64 i = numWords * sizeof(u64); i < bytes; ++i) {
+		hash = (hash ^ ImGui_Image_Mix64(pixelData[i])) * 1099511628211ull;
+	}
+	hash = ImGui_Image_Mix64(hash);
+	return hash ? hash : 1;
+}
+
+// A hash match is only a candidate - the pixels themselves have to match to share a texture.
+static bool ImGui_Image_SamePixels(const UserImageData *data, const u8 *pixelData, int width, int height)
+{
+	if(data->width != width || data->height != height || !data->pixelData || (data->flags & kImGui_Image_IgnoreAlpha) != 0)
+		return false;
+	size_t rowBytes = (size_t)width * 4;
+	if(!data->pitch)
+		return memcmp(data->pixelData, pixelData, rowBytes * (size_t)height) == 0;
+	for(int y = 0; y < height; ++y) {
+		if(memcmp(data->pixelData + (s64)y * data->pitch, pixelData + (size_t)y * rowBytes, rowBytes) != 0)
+			return false;
+	}
+	return true;
+}
+
+static UserImageData *ImGui_Image_FindShared(u64 sourceHash, u64 contentHash, const u8 *pixelData, int width, int height, u32 shareFlags)
 {
 	for(u32 i = 0; i < s_userImages.count; ++i) {
 		UserImageData *data = s_userImages.data + i;
-		if(data->userId == userId) {
+		if((data->flags & kImGui_Image_PendingDestroy) != 0 || data->shareFlags != shareFlags)
+			continue;
+		if(sourceHash && data->sourceHash == sourceHash)
+			return data;
+		if(contentHash && data->contentHash == contentHash && ImGui_Image_SamePixels(data, pixelData, width, height))
 			return data;
-		}
 	}
 	return nullptr;
 }
 
-UserImageId ImGui_Image_CreateFromFile(const char *path)
+// Adds a new id referencing backing.  Owned pixels passed in are either adopted by backing
+// (if it was referencing caller memory) or freed, so every shared image owns its pixels.
+static UserImageId ImGui_Image_AddAlias(UserImageData *backing, const u8 *pixelData, u32 extraFlags)
 {
-	int width = 0;
-	int height = 0;
-	int channelsInFile = 0;
-	u8 *pixelData = stbi_load(path, &width, &height, &channelsInFile, 4);
-	if(pixelData) {
-		for(s64 i = 0; i < width * height; ++i) {
-			u8 *pixel = pixelData + 4 * i;
-			u8 tmp = pixel[0];
-			pixel[0] = pixel[2];
-			pixel[2] = tmp;
+	bool owned = (extraFlags & kImGui_Image_PixelDataOwnership) != 0 && pixelData;
+	if(backing->pixelData && (backing->flags & (kImGui_Image_PixelDataOwnership | kImGui_Image_PixelDataMapped)) == 0) {
+		if(owned) {
+			backing->pixelData = pixelData;
+			backing->flags |= kImGui_Image_PixelDataOwnership;
+			owned = false;
+		} else {
+			void *copy = ImGui_Image_CopyBytes(backing->pixelData, (size_t)ImGui_Image_Bytes(backing));
+			if(copy) {
+				backing->pixelData = (const u8 *)copy;
+				backing->flags |= kImGui_Image_PixelDataOwnership;
+			}
 		}
 	}
-	BB_LOG("Image", "Image %u %s %dx%d", s_lastUserId + 1, path, width, height);
-	return ImGui_Image_Create(pixelData, width, height, kImGui_Image_PixelDataOwnership);
+	if(owned) {
+		free((void *)pixelData);
+	}
+
+	UserImageAlias alias;
+	alias.aliasId.id = ++s_lastUserId;
+	alias.backingId = backing->userId;
+	bba_push(s_userImageAliases, alias);
+	++backing->refCount;
+	return alias.aliasId;
 }
 
-UserImageId ImGui_Image_Create(const u8 *pixelData, int width, int height, u32 extraFlags)
+static void ImGui_Image_RemoveAlias(UserImageId aliasId)
+{
+	for(u32 i = 0; i < s_userImageAliases.count; ++i) {
+		if(s_userImageAliases.data[i].aliasId == aliasId) {
+			bba_erase(s_userImageAliases, i);
+			return;
+		}
+	}
+}
+
+// Drops userId's reference to a shared backing image.  If userId is the backing image's own id,
+// the backing image takes over the id of one of its aliases instead.
+static void ImGui_Image_ReleaseShared(UserImageData *data, UserImageId userId)
+{
+	--data->refCount;
+	if(!(data->userId == userId)) {
+		ImGui_Image_RemoveAlias(userId);
+		return;
+	}
+	UserImageId oldId = data->userId;
+	bool promoted = false;
+	for(u32 i = 0; i < s_userImageAliases.count;) {
+		UserImageAlias *alias = s_userImageAliases.data + i;
+		if(alias->backingId == oldId) {
+			if(!promoted) {
+				data->userId = alias->aliasId;
+				promoted = true;
+				bba_erase(s_userImageAliases, i);
+				continue;
+			}
+			alias->backingId = data->userId;
+		}
+		++i;
+	}
+}
+
+void ImGui_Image_SwizzleRGBA(u8 *pixelData, int width, int height)
+{
+	for(s64 i = 0; i < (s64)width * height; ++i) {
+		u8 *pixel = pixelData + 4 * i;
+		u8 tmp = pixel[0];
+		pixel[0] = pixel[2];
+		pixel[2] = tmp;
+	}
+}
+
+static UserImageId ImGui_Image_CreateEntry(const u8 *pixelData, int width, int height, u32 extraFlags, u64 contentHash)
 {
 	UserImageId userId = { ++s_lastUserId };
 	UserImageData data = { BB_EMPTY_INITIALIZER };
@@ -89,41 +421,245 @@ UserImageId ImGui_Image_Create(const u8 *pixelData, int width, int height, u32 e
 	data.width = width;
 	data.height = height;
 	data.pixelData = pixelData;
-	data.flags = kImGui_Image_Dirty | extraFlags;
+	data.flags = kImGui_Image_Dirty | (extraFlags & ~kUserImage_Dedup);
+	data.shareFlags = extraFlags & kImGui_Image_ShareFlags;
+	data.lastUsedFrame = s_imageFrame;
+	data.refCount = 1;
+	data.contentHash = contentHash;
 	bba_push(s_userImages, data);
 	return userId;
 }
 
-void ImGui_Image_Modify(UserImageId userId, const u8 *pixelData, int width, int height)
+static void ImGui_Image_SetMappedPixels(UserImageData *data, const MappedImageFile &file, const MappedImageRaw &raw)
+{
+	data->pixelData = raw.firstRow;
+	data->width = raw.width;
+	data->height = raw.height;
+	data->pitch = raw.pitch;
+	data->mappedView = file.view;
+	data->flags |= kImGui_Image_PixelDataMapped;
+	if(raw.bHasAlpha) {
+		data->flags &= ~kImGui_Image_IgnoreAlpha;
+	} else {
+		data->flags |= kImGui_Image_IgnoreAlpha;
+	}
+}
+
+static bool ImGui_Image_MapRaw(UserImageData *data, const char *path)
+{
+	MappedImageFile file;
+	if(!ImGui_ImageFile_Map(path, &file))
+		return false;
+	MappedImageRaw raw;
+	if(!ImGui_ImageFile_ParseRaw(&file, &raw)) {
+		ImGui_ImageFile_Unmap(&file);
+		return false;
+	}
+	ImGui_Image_SetMappedPixels(data, file, raw);
+	return true;
+}
+
+UserImageId ImGui_Image_CreateFromFile(const char *path, u32 extraFlags)
+{
+	u64 sourceHash = (extraFlags & kUserImage_Dedup) ? ImGui_ImageDiskCache_HashSource(path) : 0;
+	if(sourceHash) {
+		// already loaded with the same flags - skip decoding entirely
+		UserImageData *backing = ImGui_Image_FindShared(sourceHash, 0, nullptr, 0, 0, extraFlags & kImGui_Image_ShareFlags);
+		if(backing) {
+			BB_LOG("Image", "Image %u %s shares image %u", s_lastUserId + 1, path, backing->userId.id);
+			return ImGui_Image_AddAlias(backing, nullptr, 0);
+		}
+	}
+
+	UserImageReloadSource source = { BB_EMPTY_INITIALIZER };
+	source.type = kUserImageReload_Path;
+	source.path = path;
+
+	MappedImageFile file;
+	if(ImGui_ImageFile_Map(path, &file)) {
+		MappedImageRaw raw;
+		if(ImGui_ImageFile_ParseRaw(&file, &raw)) {
+			// already in texture layout - upload straight from the mapping
+			BB_LOG("Image", "Image %u %s %dx%d (mapped)", s_lastUserId + 1, path, raw.width, raw.height);
+			UserImageId userId = ImGui_Image_CreateEntry(nullptr, 0, 0, extraFlags & ~(u32)kImGui_Image_PixelDataOwnership, 0);
+			UserImageData *data = ImGui_Image_FindBacking(userId);
+			ImGui_Image_SetMappedPixels(data, file, raw);
+			data->sourceHash = sourceHash;
+			ImGui_Image_AssignReloadSource(data, source);
+			return userId;
+		}
+		ImGui_ImageFile_Unmap(&file);
+	}
+
+	int width = 0;
+	int height = 0;
+	u8 *pixelData = ImGui_ImageDiskCache_LoadOrDecode(path, &width, &height);
+	BB_LOG("Image", "Image %u %s %dx%d", s_lastUserId + 1, path, width, height);
+	UserImageId userId = ImGui_Image_Create(pixelData, width, height, kImGui_Image_PixelDataOwnership | extraFlags);
+	UserImageData *data = ImGui_Image_FindBacking(userId);
+	if(data && pixelData) {
+		data->sourceHash = sourceHash;
+		ImGui_Image_AssignReloadSource(data, source);
+	}
+	return userId;
+}
+
+UserImageId ImGui_Image_CreateFromMemory(const u8 *blob, u64 blobSize, u32 extraFlags)
+{
+	int width = 0;
+	int height = 0;
+	int channelsInFile = 0;
+	u8 *pixelData = stbi_load_from_memory(blob, (int)blobSize, &width, &height, &channelsInFile, 4);
+	if(pixelData) {
+		ImGui_Image_SwizzleRGBA(pixelData, width, height);
+	}
+	BB_LOG("Image", "Image %u <memory %llu bytes> %dx%d", s_lastUserId + 1, blobSize, width, height);
+	UserImageId userId = ImGui_Image_Create(pixelData, width, height, kImGui_Image_PixelDataOwnership | extraFlags);
+	UserImageData *data = ImGui_Image_FindBacking(userId);
+	if(data && pixelData) {
+		UserImageReloadSource source = { BB_EMPTY_INITIALIZER };
+		source.type = kUserImageReload_CompressedBlob;
+		source.blob = blob;
+		source.blobSize = blobSize;
+		ImGui_Image_AssignReloadSource(data, source);
+	}
+	return userId;
+}
+
+void ImGui_Image_SetReloadSource(UserImageId userId, const UserImageReloadSource &source)
 {
 	UserImageData *data = ImGui_Image_Find(userId);
 	if(data) {
-		if(data->pixelData && (data->flags & kImGui_Image_PixelDataOwnership) != 0) {
-			free((void *)data->pixelData);
-			data->flags &= (~kImGui_Image_PixelDataOwnership);
+		ImGui_Image_AssignReloadSource(data, source);
+	}
+}
+
+UserImageId ImGui_Image_Create(const u8 *pixelData, int width, int height, u32 extraFlags)
+{
+	u64 contentHash = (extraFlags & kUserImage_Dedup) ? ImGui_Image_HashPixels(pixelData, width, height) : 0;
+	if(contentHash) {
+		UserImageData *backing = ImGui_Image_FindShared(0, contentHash, pixelData, width, height, extraFlags & kImGui_Image_ShareFlags);
+		if(backing) {
+			return ImGui_Image_AddAlias(backing, pixelData, extraFlags);
 		}
+	}
+	return ImGui_Image_CreateEntry(pixelData, width, height, extraFlags, contentHash);
+}
+
+static void ImGui_Image_FreePixelData(UserImageData *data)
+{
+	if((data->flags & kImGui_Image_PixelDataMapped) != 0) {
+		ImGui_ImageFile_UnmapView(data->mappedView);
+		data->mappedView = nullptr;
+		data->flags &= ~kImGui_Image_PixelDataMapped;
+	} else if(data->pixelData && (data->flags & kImGui_Image_PixelDataOwnership) != 0) {
+		free((void *)data->pixelData);
+		data->flags &= (~kImGui_Image_PixelDataOwnership);
+	}
+	data->pixelData = nullptr;
+	data->pitch = 0;
+}
+
+void ImGui_Image_Modify(UserImageId userId, const u8 *pixelData, int width, int height)
+{
+	UserImageData *data = ImGui_Image_Find(userId);
+	if(data && data->refCount > 1) {
+		// copy-on-write: detach userId from the shared image, leaving the other ids untouched
+		ImGui_Image_ReleaseShared(data, userId);
+		UserImageData detached = { BB_EMPTY_INITIALIZER };
+		detached.userId = userId;
+		detached.pixelData = pixelData;
+		detached.width = width;
+		detached.height = height;
+		detached.flags = kImGui_Image_Dirty | (data->flags & kImGui_Image_Compress);
+		detached.lastUsedFrame = s_imageFrame;
+		detached.refCount = 1;
+		bba_push(s_userImages, detached);
+	} else if(data) {
+		// contents no longer match the source or the hash
+		data->sourceHash = 0;
+		data->contentHash = 0;
+		ImGui_Image_CancelUpload(data);
+		ImGui_Image_FreePixelData(data);
+		ImGui_Image_ResetReloadSource(data);
+		data->encodeSerial = 0;
 		data->pixelData = pixelData;
 		data->width = width;
 		data->height = height;
 		data->flags |= kImGui_Image_Dirty;
+		data->flags &= ~(kImGui_Image_TextureEvicted | kImGui_Image_PixelDataEvicted | kImGui_Image_IgnoreAlpha);
 	}
 }
 
 void ImGui_Image_MarkForDestroy(UserImageId userId)
 {
 	UserImageData *data = ImGui_Image_Find(userId);
-	if(data) {
-		if(data->pixelData && (data->flags & kImGui_Image_PixelDataOwnership) != 0) {
-			free((void *)data->pixelData);
-			data->flags &= (~kImGui_Image_PixelDataOwnership);
-		}
-		data->pixelData = nullptr;
+	if(data && data->refCount > 1) {
+		ImGui_Image_ReleaseShared(data, userId);
+	} else if(data) {
+		ImGui_Image_FreePixelData(data);
+		ImGui_Image_ResetReloadSource(data);
+		data->refCount = 0;
+		data->encodeSerial = 0;
+		data->sourceHash = 0;
+		data->contentHash = 0;
 		data->width = 0;
 		data->height = 0;
 		data->flags |= kImGui_Image_PendingDestroy;
 	}
 }
 
+// Rebuilds pixel data that was evicted or discarded after upload.  Returns false if there are no pixels to upload.
+static bool ImGui_Image_RestorePixelData(UserImageData *data)
+{
+	if(data->pixelData)
+		return true;
+
+	const UserImageReloadSource *source = &data->reloadSource;
+	int width = 0;
+	int height = 0;
+	int channelsInFile = 0;
+	u8 *pixelData = nullptr;
+	switch(source->type) {
+	case kUserImageReload_None:
+		return false;
+	case kUserImageReload_Path:
+		if(source->path) {
+			if(ImGui_Image_MapRaw(data, source->path)) {
+				++s_budget.pixelDataReloads;
+				data->flags &= ~kImGui_Image_PixelDataEvicted;
+				return true;
+			}
+			pixelData = ImGui_ImageDiskCache_LoadOrDecode(source->path, &width, &height);
+		}
+		break;
+	case kUserImageReload_Callback:
+		if(source->callback) {
+			pixelData = source->callback(data->userId, source->userData, &width, &height);
+		}
+		break;
+	case kUserImageReload_CompressedBlob:
+		if(source->blob) {
+			pixelData = stbi_load_from_memory(source->blob, (int)source->blobSize, &width, &height, &channelsInFile, 4);
+			if(pixelData) {
+				ImGui_Image_SwizzleRGBA(pixelData, width, height);
+			}
+		}
+		break;
+	}
+	if(!pixelData) {
+		BB_WARNING("Image", "Image %u failed to reload pixel data (reload type %d)", data->userId.id, source->type);
+		return false;
+	}
+	++s_budget.pixelDataReloads;
+	data->pixelData = pixelData;
+	data->width = width;
+	data->height = height;
+	data->flags |= kImGui_Image_PixelDataOwnership;
+	data->flags &= ~(kImGui_Image_PixelDataEvicted | kImGui_Image_IgnoreAlpha);
+	return true;
+}
+
 void ImGui_Image_InvalidateDeviceObject(UserImageData *data)
 {
 	if(!g_pImageDevice)
@@ -133,6 +669,22 @@ void ImGui_Image_InvalidateDeviceObject(UserImageData *data)
 		data->texture->Release();
 		data->texture = nullptr;
 	}
+	if(data->pendingTexture) {
+		data->pendingTexture->Release();
+		data->pendingTexture = nullptr;
+	}
+	data->uploadedRows = 0;
+	data->flags &= ~(kImGui_Image_TextureBC1 | kImGui_Image_TextureBC3);
+}
+
+// Abandons a partial upload whose pixels are about to change, leaving the current texture in place.
+static void ImGui_Image_CancelUpload(UserImageData *data)
+{
+	if(data->pendingTexture) {
+		data->pendingTexture->Release();
+		data->pendingTexture = nullptr;
+	}
+	data->uploadedRows = 0;
 }
 
 void ImGui_Image_InvalidateDeviceObjects()
@@ -143,36 +695,588 @@ void ImGui_Image_InvalidateDeviceObjects()
 	}
 }
 
-void ImGui_Image_CreateDeviceObject(UserImageData *data)
+enum {
+	kImGui_Image_UploadBandBytes = 256 * 1024, // band size when only a time budget limits uploads
+};
+
+// Swaps in a fully uploaded texture.  textureFlags is kImGui_Image_TextureBC1/BC3 or 0.
+static void ImGui_Image_CompleteUpload(UserImageData *data, LPDIRECT3DTEXTURE9 texture, u32 textureFlags)
 {
 	if(data->texture) {
-		ImGui_Image_InvalidateDeviceObject(data);
+		data->texture->Release();
+	}
+	data->texture = texture;
+	data->flags &= ~(kImGui_Image_Dirty | kImGui_Image_TextureBC1 | kImGui_Image_TextureBC3);
+	data->flags |= textureFlags;
+
+	// opt-in: the texture is now the only copy, and is rebuilt from the reload source after device loss
+	if((data->flags & kImGui_Image_DiscardAfterUpload) != 0 && (data->flags & kImGui_Image_PixelDataOwnership) != 0 && ImGui_Image_CanReload(data)) {
+		ImGui_Image_FreePixelData(data);
+	}
+	// mappings are always released - re-mapping is as cheap as keeping the view
+	if((data->flags & kImGui_Image_PixelDataMapped) != 0) {
+		ImGui_Image_FreePixelData(data);
+	}
+}
+
+// Uploads up to maxRows rows of pixel data into pendingTexture, swapping it in once every row
+// is filled.  Returns the number of rows uploaded.
+u32 ImGui_Image_CreateDeviceObject(UserImageData *data, u32 maxRows)
+{
+	if(!data->pendingTexture) {
+		data->uploadedRows = 0;
+		D3DFORMAT format = (data->flags & kImGui_Image_IgnoreAlpha) ? D3DFMT_X8R8G8B8 : D3DFMT_A8R8G8B8;
+		if(g_pImageDevice->CreateTexture((UINT)data->width, (UINT)data->height, 1, D3DUSAGE_DYNAMIC, format, D3DPOOL_DEFAULT, &data->pendingTexture, nullptr) < 0) {
+			data->pendingTexture = nullptr;
+			return 0;
+		}
+	}
+
+	u32 numRows = BB_MIN(maxRows, (u32)data->height - data->uploadedRows);
+	RECT rect = { 0, (LONG)data->uploadedRows, (LONG)data->width, (LONG)(data->uploadedRows + numRows) };
+	D3DLOCKED_RECT lockedRect;
+	if(data->pendingTexture->LockRect(0, &lockedRect, &rect, 0) != D3D_OK)
+		return 0;
+	s64 pitch = data->pitch ? data->pitch : (s64)data->width * 4;
+	const u8 *src = data->pixelData + pitch * data->uploadedRows;
+	for(u32 y = 0; y < numRows; ++y) {
+		memcpy((unsigned char *)lockedRect.pBits + lockedRect.Pitch * (s64)y, src + pitch * y, (size_t)(data->width * 4));
+	}
+	data->pendingTexture->UnlockRect(0);
+	data->uploadedRows += numRows;
+
+	if(data->uploadedRows == (u32)data->height) {
+		LPDIRECT3DTEXTURE9 texture = data->pendingTexture;
+		data->pendingTexture = nullptr;
+		data->uploadedRows = 0;
+		ImGui_Image_CompleteUpload(data, texture, 0);
+	}
+	return numRows;
+}
+
+static bool ImGui_Image_NeedsUpload(const UserImageData *data)
+{
+	if((data->flags & (kImGui_Image_TextureEvicted | kImGui_Image_PendingDestroy)) != 0)
+		return false;
+	return (!data->texture || (data->flags & kImGui_Image_Dirty) != 0) && data->width > 0 && data->height > 0;
+}
+
+// In-progress uploads first so they finish, then most recently drawn, then oldest.
+static int ImGui_Image_CompareUploadPriority(const void *_a, const void *_b)
+{
+	const UserImageData *a = s_userImages.data + *(const u32 *)_a;
+	const UserImageData *b = s_userImages.data + *(const u32 *)_b;
+	if((a->pendingTexture != nullptr) != (b->pendingTexture != nullptr))
+		return a->pendingTexture ? -1 : 1;
+	if(a->lastUsedFrame != b->lastUsedFrame)
+		return a->lastUsedFrame > b->lastUsedFrame ? -1 : 1;
+	return a->userId.id < b->userId.id ? -1 : (a->userId.id > b->userId.id ? 1 : 0);
+}
+
+static double ImGui_Image_ElapsedMs(LARGE_INTEGER start)
+{
+	LARGE_INTEGER now, frequency;
+	QueryPerformanceCounter(&now);
+	QueryPerformanceFrequency(&frequency);
+	return (double)(now.QuadPart - start.QuadPart) * 1000.0 / (double)frequency.QuadPart;
+}
+
+static DWORD WINAPI ImGui_Image_EncodeThread(void *)
+{
+	for(;;) {
+		WaitForSingleObject(s_encoder.hSemaphore, INFINITE);
+		if(InterlockedCompareExchange(&s_encoder.shutdown, 0, 0))
+			break;
+
+		EnterCriticalSection(&s_encoder.cs);
+		UserImageEncodeJob *job = s_encoder.pendingHead;
+		if(job) {
+			s_encoder.pendingHead = job->next;
+			if(!s_encoder.pendingHead) {
+				s_encoder.pendingTail = nullptr;
+			}
+		}
+		LeaveCriticalSection(&s_encoder.cs);
+		if(!job)
+			continue;
+
+		s32 pitch = (s32)(job->width * 4);
+		if(job->format == kBcFormat_Auto) {
+			job->format = bc_choose_format(job->pixelData, job->width, job->height, pitch);
+		}
+		job->blocks = (u8 *)malloc((size_t)bc_encoded_size(job->format, job->width, job->height));
+		if(job->blocks) {
+			bc_encode_image(job->format, job->quality, job->pixelData, job->width, job->height, pitch, job->blocks);
+		}
+		free(job->pixelData);
+		job->pixelData = nullptr;
+
+		EnterCriticalSection(&s_encoder.cs);
+		job->next = s_encoder.completed;
+		s_encoder.completed = job;
+		LeaveCriticalSection(&s_encoder.cs);
+	}
+	return 0;
+}
+
+static bool ImGui_Image_StartEncoder()
+{
+	if(s_encoder.hThread)
+		return true;
+	InitializeCriticalSection(&s_encoder.cs);
+	s_encoder.shutdown = 0;
+	s_encoder.hSemaphore = CreateSemaphoreA(nullptr, 0, 0x7fffffff, nullptr);
+	if(s_encoder.hSemaphore) {
+		s_encoder.hThread = CreateThread(nullptr, 0, &ImGui_Image_EncodeThread, nullptr, 0, nullptr);
+	}
+	if(!s_encoder.hThread) {
+		if(s_encoder.hSemaphore) {
+			CloseHandle(s_encoder.hSemaphore);
+			s_encoder.hSemaphore = nullptr;
+		}
+		DeleteCriticalSection(&s_encoder.cs);
+		return false;
+	}
+	return true;
+}
+
+static void ImGui_Image_FreeEncodeJobs(UserImageEncodeJob *job)
+{
+	while(job) {
+		UserImageEncodeJob *next = job->next;
+		free(job->pixelData);
+		free(job->blocks);
+		free(job);
+		job = next;
+	}
+}
+
+static void ImGui_Image_StopEncoder()
+{
+	if(!s_encoder.hThread)
+		return;
+	InterlockedExchange(&s_encoder.shutdown, 1);
+	ReleaseSemaphore(s_encoder.hSemaphore, 1, nullptr);
+	WaitForSingleObject(s_encoder.hThread, INFINITE);
+	CloseHandle(s_encoder.hThread);
+	CloseHandle(s_encoder.hSemaphore);
+	DeleteCriticalSection(&s_encoder.cs);
+	ImGui_Image_FreeEncodeJobs(s_encoder.pendingHead);
+	ImGui_Image_FreeEncodeJobs(s_encoder.completed);
+	u32 lastSerial = s_encoder.lastSerial;
+	memset(&s_encoder, 0, sizeof(s_encoder));
+	s_encoder.lastSerial = lastSerial; // serials stay unique across restarts
+}
+
+// DXT textures need whole 4x4 blocks - other sizes take the uncompressed path.
+static bool ImGui_Image_WantsCompression(const UserImageData *data)
+{
+	return (data->flags & kImGui_Image_Compress) != 0 && (data->width & 3) == 0 && (data->height & 3) == 0;
+}
+
+// Snapshots the pixels and queues them for encoding.  The snapshot lets the image's own pixels be
+// modified, unmapped, or freed while the worker runs.
+static void ImGui_Image_SubmitEncode(UserImageData *data)
+{
+	if(!ImGui_Image_RestorePixelData(data))
+		return;
+
+	u32 width = (u32)data->width;
+	u32 height = (u32)data->height;
+	UserImageEncodeJob *job = (UserImageEncodeJob *)malloc(sizeof(UserImageEncodeJob));
+	u8 *pixelData = (u8 *)malloc((size_t)ImGui_Image_Bytes(data));
+	if(!job || !pixelData || !ImGui_Image_StartEncoder()) {
+		BB_WARNING("Image", "Image %u could not be queued for compression - uploading uncompressed", data->userId.id);
+		free(job);
+		free(pixelData);
+		data->flags &= ~kImGui_Image_Compress;
+		return;
+	}
+
+	s64 pitch = data->pitch ? data->pitch : (s64)width * 4;
+	for(u32 y = 0; y < height; ++y) {
+		memcpy(pixelData + (u64)width * 4 * y, data->pixelData + pitch * y, (size_t)width * 4);
+	}
+	if((data->flags & kImGui_Image_IgnoreAlpha) != 0) {
+		// undefined alpha would otherwise select BC3, or punch-through pixels in BC1
+		for(u64 i = 3; i < (u64)width * height * 4; i += 4) {
+			pixelData[i] = 0xff;
+		}
+	}
+
+	memset(job, 0, sizeof(*job));
+	job->pixelData = pixelData;
+	job->serial = ++s_encoder.lastSerial;
+	job->width = width;
+	job->height = height;
+	job->format = (data->flags & kImGui_Image_IgnoreAlpha) ? kBcFormat_BC1 : kBcFormat_Auto;
+	job->quality = s_compressionQuality;
+	data->encodeSerial = job->serial;
+	++s_encoder.inFlight;
+
+	EnterCriticalSection(&s_encoder.cs);
+	if(s_encoder.pendingTail) {
+		s_encoder.pendingTail->next = job;
+	} else {
+		s_encoder.pendingHead = job;
+	}
+	s_encoder.pendingTail = job;
+	LeaveCriticalSection(&s_encoder.cs);
+	ReleaseSemaphore(s_encoder.hSemaphore, 1, nullptr);
+
+	// the snapshot is the only copy needed now - mappings are re-made if the texture is lost
+	if((data->flags & kImGui_Image_PixelDataMapped) != 0) {
+		ImGui_Image_FreePixelData(data);
+	}
+}
+
+// DEFAULT pool DXT textures can't be locked, so the blocks go through a SYSTEMMEM staging texture.
+static bool ImGui_Image_UploadBlocks(UserImageData *data, const UserImageEncodeJob *job)
+{
+	D3DFORMAT format = job->format == kBcFormat_BC1 ? D3DFMT_DXT1 : D3DFMT_DXT5;
+	LPDIRECT3DTEXTURE9 staging = nullptr;
+	if(g_pImageDevice->CreateTexture(job->width, job->height, 1, 0, format, D3DPOOL_SYSTEMMEM, &staging, nullptr) < 0)
+		return false;
+
+	D3DLOCKED_RECT lockedRect;
+	if(staging->LockRect(0, &lockedRect, nullptr, 0) != D3D_OK) {
+		staging->Release();
+		return false;
+	}
+	u32 blockPitch = bc_block_pitch(job->format, job->width);
+	for(u32 row = 0; row < job->height / 4; ++row) {
+		memcpy((unsigned char *)lockedRect.pBits + lockedRect.Pitch * (s64)row, job->blocks + (u64)blockPitch * row, blockPitch);
 	}
+	staging->UnlockRect(0);
 
-	if(g_pImageDevice->CreateTexture((UINT)data->width, (UINT)data->height, 1, D3DUSAGE_DYNAMIC, D3DFMT_A8R8G8B8, D3DPOOL_DEFAULT, &data->texture, nullptr) >= 0) {
-		D3DLOCKED_RECT lockedRect;
-		if(data->texture->LockRect(0, &lockedRect, NULL, 0) == D3D_OK) {
-			for(s64 y = 0; y < data->height; ++y) {
-				memcpy((unsigned char *)lockedRect.pBits + lockedRect.Pitch * y, data->pixelData + (data->width * 4) * y, (size_t)(data->width * 4));
+	LPDIRECT3DTEXTURE9 texture = nullptr;
+	bool ok = g_pImageDevice->CreateTexture(job->width, job->height, 1, 0, format, D3DPOOL_DEFAULT, &texture, nullptr) >= 0 &&
+	          g_pImageDevice->UpdateTexture(staging, texture) == D3D_OK;
+	staging->Release();
+	if(!ok) {
+		if(texture) {
+			texture->Release();
+		}
+		return false;
+	}
+	ImGui_Image_CompleteUpload(data, texture, job->format == kBcFormat_BC1 ? kImGui_Image_TextureBC1 : kImGui_Image_TextureBC3);
+	return true;
+}
+
+static UserImageData *ImGui_Image_FindEncodeTarget(u32 serial)
+{
+	for(u32 i = 0; i < s_userImages.count; ++i) {
+		UserImageData *data = s_userImages.data + i;
+		if(data->encodeSerial == serial)
+			return data;
+	}
+	return nullptr;
+}
+
+// Uploads finished encodes within the frame's upload budget.  Results for images that were
+// modified or destroyed since submission no longer match a serial, and are dropped.
+static void ImGui_Image_UploadEncoded(LARGE_INTEGER start, u64 *bytesUploaded, u32 *bands)
+{
+	if(!s_encoder.hThread)
+		return;
+
+	EnterCriticalSection(&s_encoder.cs);
+	UserImageEncodeJob *completed = s_encoder.completed;
+	s_encoder.completed = nullptr;
+	LeaveCriticalSection(&s_encoder.cs);
+
+	while(completed) {
+		if(s_upload.bytesPerFrame && *bytesUploaded >= s_upload.bytesPerFrame)
+			break;
+		if(s_upload.msPerFrame > 0.0 && *bands && ImGui_Image_ElapsedMs(start) >= s_upload.msPerFrame)
+			break;
+
+		UserImageEncodeJob *job = completed;
+		completed = job->next;
+		job->next = nullptr;
+		--s_encoder.inFlight;
+		UserImageData *data = ImGui_Image_FindEncodeTarget(job->serial);
+		if(data) {
+			data->encodeSerial = 0;
+			if(job->blocks && ImGui_Image_UploadBlocks(data, job)) {
+				*bytesUploaded += bc_encoded_size(job->format, job->width, job->height);
+				++*bands;
+			} else {
+				BB_WARNING("Image", "Image %u compressed upload failed - uploading uncompressed", data->userId.id);
+				data->flags &= ~kImGui_Image_Compress;
 			}
-			data->texture->UnlockRect(0);
-			data->flags &= ~kImGui_Image_Dirty;
 		}
+		ImGui_Image_FreeEncodeJobs(job);
+	}
+
+	if(completed) {
+		// out of budget - hand the rest back for next frame
+		UserImageEncodeJob *tail = completed;
+		while(tail->next) {
+			tail = tail->next;
+		}
+		EnterCriticalSection(&s_encoder.cs);
+		tail->next = s_encoder.completed;
+		s_encoder.completed = completed;
+		LeaveCriticalSection(&s_encoder.cs);
 	}
 }
 
+void ImGui_Image_SetCompressionQuality(bcQuality quality)
+{
+	s_compressionQuality = quality < kBcQuality_Count ? quality : kBcQuality_Normal;
+}
+
 void ImGui_Image_CreateDeviceObjects()
 {
+	LARGE_INTEGER start;
+	QueryPerformanceCounter(&start);
+	u64 bytesUploaded = 0;
+	u32 bands = 0;
+	ImGui_Image_UploadEncoded(start, &bytesUploaded, &bands);
+
+	s_uploadQueue.count = 0;
+	for(u32 i = 0; i < s_userImages.count; ++i) {
+		UserImageData *data = s_userImages.data + i;
+		if(!ImGui_Image_NeedsUpload(data))
+			continue;
+		if(ImGui_Image_WantsCompression(data)) {
+			// the previous texture (or placeholder) stays up until the encode finishes
+			if(!data->encodeSerial) {
+				ImGui_Image_SubmitEncode(data);
+			}
+			if((data->flags & kImGui_Image_Compress) != 0)
+				continue;
+		}
+		bba_push(s_uploadQueue, i);
+	}
+	if(s_uploadQueue.count > 1) {
+		qsort(s_uploadQueue.data, s_uploadQueue.count, sizeof(u32), &ImGui_Image_CompareUploadPriority);
+	}
+
+	u32 next = 0;
+	for(; next < s_uploadQueue.count; ++next) {
+		UserImageData *data = s_userImages.data + s_uploadQueue.data[next];
+		if(s_upload.bytesPerFrame && bytesUploaded >= s_upload.bytesPerFrame)
+			break;
+		if(s_upload.msPerFrame > 0.0 && bands && ImGui_Image_ElapsedMs(start) >= s_upload.msPerFrame)
+			break;
+		if(!ImGui_Image_RestorePixelData(data))
+			continue;
+
+		u64 rowBytes = (u64)data->width * 4;
+		for(;;) {
+			// always make some progress, so an image larger than the budget still completes
+			u64 bandBytes = s_upload.bytesPerFrame ? s_upload.bytesPerFrame - BB_MIN(bytesUploaded, s_upload.bytesPerFrame) : 0;
+			if(s_upload.msPerFrame > 0.0) {
+				bandBytes = bandBytes ? BB_MIN(bandBytes, (u64)kImGui_Image_UploadBandBytes) : (u64)kImGui_Image_UploadBandBytes;
+			}
+			u32 maxRows = bandBytes ? (u32)BB_MAX(bandBytes / rowBytes, (u64)1) : (u32)data->height;
+			u32 rows = ImGui_Image_CreateDeviceObject(data, maxRows);
+			if(!rows)
+				break;
+			++bands;
+			bytesUploaded += rows * rowBytes;
+			if(!data->pendingTexture)
+				break;
+			if(s_upload.bytesPerFrame && bytesUploaded >= s_upload.bytesPerFrame)
+				break;
+			if(s_upload.msPerFrame > 0.0 && ImGui_Image_ElapsedMs(start) >= s_upload.msPerFrame)
+				break;
+		}
+		if(data->pendingTexture)
+			break; // out of budget part way through - resume with this image next frame
+	}
+
+	s_upload.bytesLastFrame = bytesUploaded;
+	s_upload.bandsLastFrame = bands;
+	s_upload.msLastFrame = ImGui_Image_ElapsedMs(start);
+	s_upload.queueDepth = 0;
+	s_upload.queueBytes = 0;
+	for(u32 i = next; i < s_uploadQueue.count; ++i) {
+		const UserImageData *data = s_userImages.data + s_uploadQueue.data[i];
+		if(ImGui_Image_NeedsUpload(data)) {
+			++s_upload.queueDepth;
+			s_upload.queueBytes += ImGui_Image_Bytes(data) - (u64)data->uploadedRows * (u64)data->width * 4;
+		}
+	}
+	if(s_upload.queueDepth || s_encoder.inFlight) {
+		// keep frames coming until the queue drains, even if the app is otherwise idle
+		Imgui_Core_RequestRender();
+	}
+}
+
+void ImGui_Image_SetUploadBudget(u64 bytesPerFrame, double msPerFrame)
+{
+	s_upload.bytesPerFrame = bytesPerFrame;
+	s_upload.msPerFrame = msPerFrame;
+}
+
+// Linear scan per eviction - image counts are small, and evictions are rare once under budget.
+static UserImageData *ImGui_Image_FindEvictionCandidate(bool bTexture)
+{
+	UserImageData *best = nullptr;
 	for(u32 i = 0; i < s_userImages.count; ++i) {
 		UserImageData *data = s_userImages.data + i;
-		if((!data->texture || (data->flags & kImGui_Image_Dirty) != 0) && data->width && data->height) {
-			ImGui_Image_CreateDeviceObject(data);
+		// NewFrame has already advanced s_imageFrame, so an image drawn last frame is 1 behind
+		if(s_imageFrame - data->lastUsedFrame <= s_budget.minUnusedFrames)
+			continue;
+		if(bTexture) {
+			// a texture can only be dropped if it can be rebuilt
+			if(!data->texture || (!data->pixelData && !ImGui_Image_CanReload(data)))
+				continue;
+		} else {
+			// pixels can only be dropped if we own them, can rebuild them, and aren't mid-upload
+			if(!data->pixelData || (data->flags & kImGui_Image_PixelDataOwnership) == 0 || !ImGui_Image_CanReload(data) || data->pendingTexture)
+				continue;
+		}
+		if(!best || data->lastUsedFrame < best->lastUsedFrame) {
+			best = data;
 		}
 	}
+	return best;
+}
+
+static void ImGui_Image_EnforceBudget()
+{
+	if(!s_budget.gpuBytes && !s_budget.cpuBytes)
+		return;
+
+	u64 gpuBytes = 0;
+	u64 cpuBytes = 0;
+	for(u32 i = 0; i < s_userImages.count; ++i) {
+		const UserImageData *data = s_userImages.data + i;
+		if(data->texture) {
+			gpuBytes += ImGui_Image_TextureBytes(data);
+		}
+		if(data->pixelData && (data->flags & kImGui_Image_PixelDataOwnership) != 0) {
+			cpuBytes += ImGui_Image_Bytes(data);
+		}
+	}
+
+	while(s_budget.gpuBytes && gpuBytes > s_budget.gpuBytes) {
+		UserImageData *data = ImGui_Image_FindEvictionCandidate(true);
+		if(!data)
+			break;
+		BB_LOG("Image", "Image %u texture evicted (unused for %u frames)", data->userId.id, s_imageFrame - data->lastUsedFrame - 1);
+		gpuBytes -= ImGui_Image_TextureBytes(data);
+		ImGui_Image_InvalidateDeviceObject(data);
+		data->flags |= kImGui_Image_TextureEvicted;
+		++s_budget.texturesEvicted;
+	}
+
+	while(s_budget.cpuBytes && cpuBytes > s_budget.cpuBytes) {
+		UserImageData *data = ImGui_Image_FindEvictionCandidate(false);
+		if(!data)
+			break;
+		BB_LOG("Image", "Image %u pixel data evicted (unused for %u frames)", data->userId.id, s_imageFrame - data->lastUsedFrame - 1);
+		cpuBytes -= ImGui_Image_Bytes(data);
+		ImGui_Image_FreePixelData(data);
+		data->flags |= kImGui_Image_PixelDataEvicted;
+		++s_budget.pixelDataEvicted;
+	}
+}
+
+void ImGui_Image_SetMemoryBudget(u64 gpuBytes, u64 cpuBytes, u32 minUnusedFrames)
+{
+	s_budget.gpuBytes = gpuBytes;
+	s_budget.cpuBytes = cpuBytes;
+	s_budget.minUnusedFrames = BB_MAX(1u, minUnusedFrames);
+}
+
+static UserImageResidency ImGui_Image_CalcResidency(const UserImageData *data)
+{
+	if(data->pixelData && data->texture)
+		return kUserImageResidency_Resident;
+	if(data->texture)
+		return kUserImageResidency_GpuOnly;
+	if(data->pixelData)
+		return kUserImageResidency_CpuOnly;
+	return ImGui_Image_CanReload(data) ? kUserImageResidency_Evicted : kUserImageResidency_None;
+}
+
+UserImageResidency ImGui_Image_GetResidency(UserImageId userId)
+{
+	const UserImageData *data = ImGui_Image_Find(userId);
+	return data ? ImGui_Image_CalcResidency(data) : kUserImageResidency_None;
+}
+
+UserImageStats ImGui_Image_GetStats()
+{
+	UserImageStats stats = { BB_EMPTY_INITIALIZER };
+	for(u32 i = 0; i < s_userImages.count; ++i) {
+		const UserImageData *data = s_userImages.data + i;
+		if((data->flags & kImGui_Image_PendingDestroy) != 0)
+			continue;
+		UserImageResidency residency = ImGui_Image_CalcResidency(data);
+		u64 bytes = ImGui_Image_Bytes(data);
+		stats.bytesByResidency[residency] += bytes;
+		++stats.countByResidency[residency];
+		if(data->texture) {
+			u64 textureBytes = ImGui_Image_TextureBytes(data);
+			stats.gpuBytes += textureBytes;
+			if(textureBytes < bytes) {
+				stats.compressionBytesSaved += bytes - textureBytes;
+				++stats.compressedImages;
+			}
+		}
+		if(data->pixelData && (data->flags & kImGui_Image_PixelDataOwnership) != 0) {
+			stats.cpuBytes += bytes;
+		}
+		if(data->texture && !data->pixelData) {
+			stats.cpuBytesSaved += bytes;
+		}
+		if(data->refCount > 1) {
+			stats.dedupedImages += data->refCount - 1;
+			stats.dedupBytesSaved += (data->refCount - 1) * bytes;
+		}
+	}
+	stats.gpuBudget = s_budget.gpuBytes;
+	stats.cpuBudget = s_budget.cpuBytes;
+	stats.texturesEvicted = s_budget.texturesEvicted;
+	stats.pixelDataEvicted = s_budget.pixelDataEvicted;
+	stats.pixelDataReloads = s_budget.pixelDataReloads;
+	stats.uploadQueueDepth = s_upload.queueDepth;
+	stats.uploadQueueBytes = s_upload.queueBytes;
+	stats.uploadBytesLastFrame = s_upload.bytesLastFrame;
+	stats.uploadBandsLastFrame = s_upload.bandsLastFrame;
+	stats.uploadMsLastFrame = s_upload.msLastFrame;
+	stats.encodeQueueDepth = s_encoder.inFlight;
+	return stats;
+}
+
+void ImGui_Image_DrawStats()
+{
+	static const char *s_residencyNames[] = {
+		"None",
+		"Resident",
+		"CPU only",
+		"GPU only",
+		"Evicted",
+	};
+	BB_CTASSERT(BB_ARRAYSIZE(s_residencyNames) == kUserImageResidency_Count);
+
+	UserImageStats stats = ImGui_Image_GetStats();
+	auto FormatBudget = [](u64 bytes) -> const char * {
+		return bytes ? va("%.1f MB", (double)bytes / (1024.0 * 1024.0)) : "unlimited";
+	};
+	ImGui::Text("GPU: %.1f MB / %s", (double)stats.gpuBytes / (1024.0 * 1024.0), FormatBudget(stats.gpuBudget));
+	ImGui::Text("CPU: %.1f MB / %s", (double)stats.cpuBytes / (1024.0 * 1024.0), FormatBudget(stats.cpuBudget));
+	ImGui::Text("CPU saved: %.1f MB (%u reloads)", (double)stats.cpuBytesSaved / (1024.0 * 1024.0), stats.pixelDataReloads);
+	ImGui::Text("Shared: %.1f MB (%u duplicate images)", (double)stats.dedupBytesSaved / (1024.0 * 1024.0), stats.dedupedImages);
+	ImGui::Text("Evictions: %u textures, %u pixel buffers", stats.texturesEvicted, stats.pixelDataEvicted);
+	ImGui::Text("Compressed: %u images, %.1f MB saved (%u encoding)", stats.compressedImages, (double)stats.compressionBytesSaved / (1024.0 * 1024.0), stats.encodeQueueDepth);
+	ImGui::Text("Upload queue: %u images, %.1f MB", stats.uploadQueueDepth, (double)stats.uploadQueueBytes / (1024.0 * 1024.0));
+	ImGui::Text("Uploaded last frame: %.1f MB in %u bands, %.2f ms", (double)stats.uploadBytesLastFrame / (1024.0 * 1024.0), stats.uploadBandsLastFrame, stats.uploadMsLastFrame);
+	ImGui::Separator();
+	for(u32 i = 0; i < kUserImageResidency_Count; ++i) {
+		ImGui::Text("%-10s %5u images %10.1f MB", s_residencyNames[i], stats.countByResidency[i], (double)stats.bytesByResidency[i] / (1024.0 * 1024.0));
+	}
 }
 
 void ImGui_Image_NewFrame()
 {
+	++s_imageFrame;
 	for(u32 i = 0; i < s_userImages.count;) {
 		UserImageData *data = s_userImages.data + i;
 		if((data->flags & kImGui_Image_PendingDestroy) == 0) {
@@ -182,6 +1286,7 @@ void ImGui_Image_NewFrame()
 			bba_erase(s_userImages, i);
 		}
 	}
+	ImGui_Image_EnforceBudget();
 	ImGui_Image_CreateDeviceObjects();
 }
 
@@ -194,15 +1299,16 @@ bool ImGui_Image_Init(IDirect3DDevice9 *device)
 
 void ImGui_Image_Shutdown()
 {
+	ImGui_Image_StopEncoder();
 	ImGui_Image_InvalidateDeviceObjects();
 	for(u32 i = 0; i < s_userImages.count; ++i) {
 		UserImageData *data = s_userImages.data + i;
-		if(data->pixelData && (data->flags & kImGui_Image_PixelDataOwnership) != 0) {
-			free((void *)data->pixelData);
-			data->flags &= (~kImGui_Image_PixelDataOwnership);
-		}
-		data->pixelData = nullptr;
+		ImGui_Image_FreePixelData(data);
+		ImGui_Image_ResetReloadSource(data);
 	}
 	bba_free(s_userImages);
+	bba_free(s_userImageAliases);
+	bba_free(s_uploadQueue);
+	ImGui_ImageDiskCache_Shutdown();
 	g_pImageDevice = nullptr;
 }
@@ -0,0 +1,589 @@
+// Copyright (c) 2012-2019 Matt Campbell
+// MIT license (see License.txt)
+
+#include "imgui_image_bc.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct tag_bcColor {
+	float c[3]; // b, g, r
+} bcColor;
+
+u64 bc_encoded_size(bcFormat format, u32 width, u32 height)
+{
+	u64 blocksX = (width + 3) / 4;
+	u64 blocksY = (height + 3) / 4;
+	return blocksX * blocksY * (format == kBcFormat_BC1 ? 8u : 16u);
+}
+
+u32 bc_block_pitch(bcFormat format, u32 width)
+{
+	return ((width + 3) / 4) * (format == kBcFormat_BC1 ? 8u : 16u);
+}
+
+bcFormat bc_choose_format(const u8 *bgra, u32 width, u32 height, s32 pitch)
+{
+	u32 x, y;
+	for(y = 0; y < height; ++y) {
+		const u8 *row = bgra + (s64)pitch * y;
+		for(x = 0; x < width; ++x) {
+			u8 a = row[x * 4 + 3];
+			if(a != 0 && a != 255)
+				return kBcFormat_BC3;
+		}
+	}
+	return kBcFormat_BC1;
+}
+
+static u16 bc_pack565(const float c[3])
+{
+	int b = (int)(c[0] * (31.0f / 255.0f) + 0.5f);
+	int g = (int)(c[1] * (63.0f / 255.0f) + 0.5f);
+	int r = (int)(c[2] * (31.0f / 255.0f) + 0.5f);
+	b = BB_MAX(0, BB_MIN(31, b));
+	g = BB_MAX(0, BB_MIN(63, g));
+	r = BB_MAX(0, BB_MIN(31, r));
+	return (u16)((r << 11) | (g << 5) | b);
+}
+
+static void bc_unpack565(u16 v, u8 out[3])
+{
+	u32 b = v & 31;
+	u32 g = (v >> 5) & 63;
+	u32 r = (v >> 11) & 31;
+	out[0] = (u8)((b << 3) | (b >> 2));
+	out[1] = (u8)((g << 2) | (g >> 4));
+	out[2] = (u8)((r << 3) | (r >> 2));
+}
+
+// Builds the 4 entry palette the hardware will decode, so the encoder picks indices against
+// exactly what ends up on screen.
+static void bc_color_palette(u16 c0, u16 c1, u8 palette[4][4])
+{
+	u32 i;
+	bc_unpack565(c0, palette[0]);
+	bc_unpack565(c1, palette[1]);
+	palette[0][3] = 255;
+	palette[1][3] = 255;
+	for(i = 0; i < 3; ++i) {
+		if(c0 > c1) {
+			palette[2][i] = (u8)((2 * palette[0][i] + palette[1][i]) / 3);
+			palette[3][i] = (u8)((palette[0][i] + 2 * palette[1][i]) / 3);
+		} else {
+			palette[2][i] = (u8)((palette[0][i] + palette[1][i]) / 2);
+			palette[3][i] = 0;
+		}
+	}
+	palette[2][3] = 255;
+	palette[3][3] = (u8)(c0 > c1 ? 255 : 0);
+}
+
+static u32 bc_color_distance(const u8 *a, const u8 *b)
+{
+	int db = (int)a[0] - (int)b[0];
+	int dg = (int)a[1] - (int)b[1];
+	int dr = (int)a[2] - (int)b[2];
+	return (u32)(db * db + dg * dg + dr * dr);
+}
+
+// Picks the nearest palette entry for each pixel.  Returns total squared error.
+static u32 bc_color_indices(const u8 block[16][4], const u8 transparent[16], u16 c0, u16 c1, u32 *outIndices)
+{
+	u8 palette[4][4];
+	u32 indices = 0;
+	u32 error = 0;
+	u32 numColors = c0 > c1 ? 4u : 3u;
+	u32 i, j;
+	bc_color_palette(c0, c1, palette);
+	for(i = 0; i < 16; ++i) {
+		u32 best = 0;
+		if(transparent[i]) {
+			best = 3;
+		} else {
+			u32 bestDistance = 0xffffffff;
+			for(j = 0; j < numColors; ++j) {
+				u32 distance = bc_color_distance(block[i], palette[j]);
+				if(distance < bestDistance) {
+					bestDistance = distance;
+					best = j;
+				}
+			}
+			error += bestDistance;
+		}
+		indices |= best << (2 * i);
+	}
+	*outIndices = indices;
+	return error;
+}
+
+static void bc_endpoints_bbox(const bcColor *colors, u32 count, float e0[3], float e1[3])
+{
+	float mean[3] = { 0.0f, 0.0f, 0.0f };
+	float cov[3] = { 0.0f, 0.0f, 0.0f };
+	u32 i, k, dominant = 0;
+	for(k = 0; k < 3; ++k) {
+		e0[k] = 255.0f;
+		e1[k] = 0.0f;
+	}
+	for(i = 0; i < count; ++i) {
+		for(k = 0; k < 3; ++k) {
+			e0[k] = BB_MIN(e0[k], colors[i].c[k]);
+			e1[k] = BB_MAX(e1[k], colors[i].c[k]);
+			mean[k] += colors[i].c[k] / (float)count;
+		}
+	}
+	for(k = 1; k < 3; ++k) {
+		if(e1[k] - e0[k] > e1[dominant] - e0[dominant]) {
+			dominant = k;
+		}
+	}
+	// flip channels that fall as the dominant channel rises, so the box diagonal follows the data
+	for(i = 0; i < count; ++i) {
+		for(k = 0; k < 3; ++k) {
+			cov[k] += (colors[i].c[k] - mean[k]) * (colors[i].c[dominant] - mean[dominant]);
+		}
+	}
+	for(k = 0; k < 3; ++k) {
+		if(cov[k] < 0.0f) {
+			float tmp = e0[k];
+			e0[k] = e1[k];
+			e1[k] = tmp;
+		}
+	}
+}
+
+static void bc_endpoints_pca(const bcColor *colors, u32 count, float e0[3], float e1[3])
+{
+	float mean[3] = { 0.0f, 0.0f, 0.0f };
+	float cov[6] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f }; // xx xy xz yy yz zz
+	float axis[3];
+	float tMin = 1e9f, tMax = -1e9f;
+	u32 i, k, iter;
+	for(i = 0; i < count; ++i) {
+		for(k = 0; k < 3; ++k) {
+			mean[k] += colors[i].c[k] / (float)count;
+		}
+	}
+	for(i = 0; i < count; ++i) {
+		float d0 = colors[i].c[0] - mean[0];
+		float d1 = colors[i].c[1] - mean[1];
+		float d2 = colors[i].c[2] - mean[2];
+		cov[0] += d0 * d0;
+		cov[1] += d0 * d1;
+		cov[2] += d0 * d2;
+		cov[3] += d1 * d1;
+		cov[4] += d1 * d2;
+		cov[5] += d2 * d2;
+	}
+
+	// power iteration from the bounding box diagonal converges in a handful of steps
+	bc_endpoints_bbox(colors, count, e0, e1);
+	for(k = 0; k < 3; ++k) {
+		axis[k] = e1[k] - e0[k];
+	}
+	for(iter = 0; iter < 8; ++iter) {
+		float next[3];
+		float len;
+		next[0] = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+		next[1] = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+		next[2] = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+		len = sqrtf(next[0] * next[0] + next[1] * next[1] + next[2] * next[2]);
+		if(len < 1e-6f)
+			break;
+		for(k = 0; k < 3; ++k) {
+			axis[k] = next[k] / len;
+		}
+	}
+	{
+		float len = sqrtf(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+		if(len < 1e-6f)
+			return; // flat block - keep the bounding box
+		for(k = 0; k < 3; ++k) {
+			axis[k] /= len;
+		}
+	}
+
+	for(i = 0; i < count; ++i) {
+		float t = 0.0f;
+		for(k = 0; k < 3; ++k) {
+			t += (colors[i].c[k] - mean[k]) * axis[k];
+		}
+		tMin = BB_MIN(tMin, t);
+		tMax = BB_MAX(tMax, t);
+	}
+	for(k = 0; k < 3; ++k) {
+		e0[k] = BB_MAX(0.0f, BB_MIN(255.0f, mean[k] + axis[k] * tMin));
+		e1[k] = BB_MAX(0.0f, BB_MIN(255.0f, mean[k] + axis[k] * tMax));
+	}
+}
+
+// Solves for the endpoints that minimize squared error given fixed 4-color indices.
+static b32 bc_refine_endpoints(const u8 block[16][4], u32 indices, u16 *c0, u16 *c1)
+{
+	static const float s_weights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+	float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+	float ax[3] = { 0.0f, 0.0f, 0.0f };
+	float bx[3] = { 0.0f, 0.0f, 0.0f };
+	float e0[3], e1[3];
+	float det;
+	u32 i, k;
+	for(i = 0; i < 16; ++i) {
+		float a = s_weights[(indices >> (2 * i)) & 3];
+		float b = 1.0f - a;
+		aa += a * a;
+		ab += a * b;
+		bb += b * b;
+		for(k = 0; k < 3; ++k) {
+			ax[k] += a * block[i][k];
+			bx[k] += b * block[i][k];
+		}
+	}
+	det = aa * bb - ab * ab;
+	if(fabsf(det) < 1e-6f)
+		return false;
+	for(k = 0; k < 3; ++k) {
+		e0[k] = BB_MAX(0.0f, BB_MIN(255.0f, (ax[k] * bb - bx[k] * ab) / det));
+		e1[k] = BB_MAX(0.0f, BB_MIN(255.0f, (bx[k] * aa - ax[k] * ab) / det));
+	}
+	*c0 = bc_pack565(e0);
+	*c1 = bc_pack565(e1);
+	return true;
+}
+
+// Best (c0, c1) 5/6-bit endpoint pairs whose 2/3 interpolant reproduces each 8-bit value, so
+// solid blocks aren't limited to 565 precision.
+static u8 s_match5[256][2];
+static u8 s_match6[256][2];
+static b32 s_bMatchTablesBuilt;
+
+static u32 bc_expand(u32 value, u32 bits)
+{
+	return bits == 5 ? ((value << 3) | (value >> 2)) : ((value << 2) | (value >> 4));
+}
+
+static void bc_build_match_table(u8 table[256][2], u32 bits)
+{
+	u32 size = 1u << bits;
+	u32 v, a, b;
+	for(v = 0; v < 256; ++v) {
+		u32 bestError = 0xffffffff;
+		for(a = 0; a < size; ++a) {
+			for(b = 0; b < size; ++b) {
+				u32 ea = bc_expand(a, bits);
+				u32 eb = bc_expand(b, bits);
+				int interp = (int)((2 * ea + eb) / 3);
+				// prefer close endpoints on ties - they degrade more gracefully on hardware with different rounding
+				u32 error = (u32)abs(interp - (int)v) * 256 + (u32)abs((int)ea - (int)eb);
+				if(error < bestError) {
+					bestError = error;
+					table[v][0] = (u8)a;
+					table[v][1] = (u8)b;
+				}
+			}
+		}
+	}
+}
+
+static void bc_build_match_tables(void)
+{
+	// idempotent, so a race between encoder threads just builds identical tables twice
+	if(!s_bMatchTablesBuilt) {
+		bc_build_match_table(s_match5, 5);
+		bc_build_match_table(s_match6, 6);
+		s_bMatchTablesBuilt = true;
+	}
+}
+
+static void bc_write_color_block(u16 c0, u16 c1, u32 indices, u8 *out)
+{
+	out[0] = (u8)(c0 & 0xff);
+	out[1] = (u8)(c0 >> 8);
+	out[2] = (u8)(c1 & 0xff);
+	out[3] = (u8)(c1 >> 8);
+	out[4] = (u8)(indices & 0xff);
+	out[5] = (u8)((indices >> 8) & 0xff);
+	out[6] = (u8)((indices >> 16) & 0xff);
+	out[7] = (u8)(indices >> 24);
+}
+
+static void bc_encode_color_block(const u8 block[16][4], bcQuality quality, b32 bAllowTransparent, u8 *out)
+{
+	bcColor colors[16];
+	u8 transparent[16];
+	float e0[3], e1[3];
+	u32 count = 0;
+	u32 i, k;
+	u16 c0, c1;
+	u32 indices;
+	u32 error;
+	b32 bTransparent = false;
+
+	for(i = 0; i < 16; ++i) {
+		transparent[i] = (u8)(bAllowTransparent && block[i][3] < 128);
+		if(transparent[i]) {
+			bTransparent = true;
+		} else {
+			for(k = 0; k < 3; ++k) {
+				colors[count].c[k] = block[i][k];
+			}
+			++count;
+		}
+	}
+	if(!count) {
+		bc_write_color_block(0, 0, 0xffffffff, out);
+		return;
+	}
+
+	if(quality == kBcQuality_Fast) {
+		bc_endpoints_bbox(colors, count, e0, e1);
+	} else {
+		bc_endpoints_pca(colors, count, e0, e1);
+	}
+	c0 = bc_pack565(e0);
+	c1 = bc_pack565(e1);
+
+	if(bTransparent) {
+		// 3-color mode with index 3 as transparent requires c0 <= c1
+		if(c0 > c1) {
+			u16 tmp = c0;
+			c0 = c1;
+			c1 = tmp;
+		}
+		bc_color_indices(block, transparent, c0, c1, &indices);
+		bc_write_color_block(c0, c1, indices, out);
+		return;
+	}
+
+	if(count == 16) {
+		b32 bSolid = true;
+		for(i = 1; i < 16 && bSolid; ++i) {
+			bSolid = memcmp(block[i], block[0], 3) == 0;
+		}
+		if(bSolid) {
+			bc_build_match_tables();
+			c0 = (u16)((s_match5[block[0][2]][0] << 11) | (s_match6[block[0][1]][0] << 5) | s_match5[block[0][0]][0]);
+			c1 = (u16)((s_match5[block[0][2]][1] << 11) | (s_match6[block[0][1]][1] << 5) | s_match5[block[0][0]][1]);
+			if(c0 > c1) {
+				bc_write_color_block(c0, c1, 0xaaaaaaaa, out); // every pixel at index 2: (2 * c0 + c1) / 3
+			} else if(c0 < c1) {
+				bc_write_color_block(c1, c0, 0xffffffff, out); // swapped, so index 3 is the same interpolant
+			} else {
+				bc_write_color_block(c0, c1, 0, out);
+			}
+			return;
+		}
+	}
+
+	// 4-color mode requires c0 > c1 - equal endpoints fall back to 3-color, where index 0 is exact
+	if(c0 < c1) {
+		u16 tmp = c0;
+		c0 = c1;
+		c1 = tmp;
+	}
+	error = bc_color_indices(block, transparent, c0, c1, &indices);
+
+	if(quality == kBcQuality_High && c0 != c1) {
+		u32 iter;
+		for(iter = 0; iter < 2 && error > 0; ++iter) {
+			u16 r0, r1;
+			u32 refinedIndices;
+			u32 refinedError;
+			if(!bc_refine_endpoints(block, indices, &r0, &r1))
+				break;
+			if(r0 == r1)
+				break;
+			if(r0 < r1) {
+				u16 tmp = r0;
+				r0 = r1;
+				r1 = tmp;
+			}
+			refinedError = bc_color_indices(block, transparent, r0, r1, &refinedIndices);
+			if(refinedError >= error)
+				break;
+			c0 = r0;
+			c1 = r1;
+			indices = refinedIndices;
+			error = refinedError;
+		}
+	}
+	bc_write_color_block(c0, c1, indices, out);
+}
+
+static void bc_encode_alpha_block(const u8 block[16][4], u8 *out)
+{
+	u8 aMin = 255, aMax = 0;
+	u8 palette[8];
+	u64 bits = 0;
+	u32 i, j;
+	for(i = 0; i < 16; ++i) {
+		aMin = BB_MIN(aMin, block[i][3]);
+		aMax = BB_MAX(aMax, block[i][3]);
+	}
+	out[0] = aMax;
+	out[1] = aMin;
+	if(aMax != aMin) {
+		// 8-level mode (a0 > a1): a0, a1, then 6 interpolated steps from a0 towards a1
+		palette[0] = aMax;
+		palette[1] = aMin;
+		for(j = 1; j < 7; ++j) {
+			palette[j + 1] = (u8)(((7 - j) * aMax + j * aMin) / 7);
+		}
+		for(i = 0; i < 16; ++i) {
+			u32 best = 0;
+			int bestDistance = 256;
+			for(j = 0; j < 8; ++j) {
+				int distance = abs((int)block[i][3] - (int)palette[j]);
+				if(distance < bestDistance) {
+					bestDistance = distance;
+					best = j;
+				}
+			}
+			bits |= (u64)best << (3 * i);
+		}
+	}
+	for(i = 0; i < 6; ++i) {
+		out[2 + i] = (u8)((bits >> (8 * i)) & 0xff);
+	}
+}
+
+static void bc_load_block(const u8 *bgra, u32 width, u32 height, s32 pitch, u32 bx, u32 by, u8 block[16][4])
+{
+	u32 x, y;
+	for(y = 0; y < 4; ++y) {
+		u32 sy = BB_MIN(by * 4 + y, height - 1);
+		const u8 *row = bgra + (s64)pitch * sy;
+		for(x = 0; x < 4; ++x) {
+			u32 sx = BB_MIN(bx * 4 + x, width - 1);
+			memcpy(block[y * 4 + x], row + sx * 4, 4);
+		}
+	}
+}
+
+void bc_encode_image(bcFormat format, bcQuality quality, const u8 *bgra, u32 width, u32 height, s32 pitch, u8 *out)
+{
+	u32 blocksX = (width + 3) / 4;
+	u32 blocksY = (height + 3) / 4;
+	u32 bx, by;
+	if(!width || !height)
+		return;
+	if(format == kBcFormat_Auto) {
+		format = bc_choose_format(bgra, width, height, pitch);
+	}
+	for(by = 0; by < blocksY; ++by) {
+		for(bx = 0; bx < blocksX; ++bx) {
+			u8 block[16][4];
+			bc_load_block(bgra, width, height, pitch, bx, by, block);
+			if(format == kBcFormat_BC1) {
+				bc_encode_color_block(block, quality, true, out);
+				out += 8;
+			} else {
+				bc_encode_alpha_block(block, out);
+				bc_encode_color_block(block, quality, false, out + 8);
+				out += 16;
+			}
+		}
+	}
+}
+
+static void bc_decode_color_block(const u8 *in, b32 bForceFourColor, u8 block[16][4])
+{
+	u16 c0 = (u16)(in[0] | (in[1] << 8));
+	u16 c1 = (u16)(in[2] | (in[3] << 8));
+	u32 indices = (u32)in[4] | ((u32)in[5] << 8) | ((u32)in[6] << 16) | ((u32)in[7] << 24);
+	u8 palette[4][4];
+	u32 i;
+	if(bForceFourColor && c0 <= c1) {
+		// BC3 color blocks always decode in 4-color mode
+		u8 e0[3], e1[3];
+		bc_unpack565(c0, e0);
+		bc_unpack565(c1, e1);
+		for(i = 0; i < 3; ++i) {
+			palette[0][i] = e0[i];
+			palette[1][i] = e1[i];
+			palette[2][i] = (u8)((2 * e0[i] + e1[i]) / 3);
+			palette[3][i] = (u8)((e0[i] + 2 * e1[i]) / 3);
+		}
+		for(i = 0; i < 4; ++i) {
+			palette[i][3] = 255;
+		}
+	} else {
+		bc_color_palette(c0, c1, palette);
+	}
+	for(i = 0; i < 16; ++i) {
+		memcpy(block[i], palette[(indices >> (2 * i)) & 3], 4);
+	}
+}
+
+static void bc_decode_alpha_block(const u8 *in, u8 block[16][4])
+{
+	u8 palette[8];
+	u64 bits = 0;
+	u32 i;
+	palette[0] = in[0];
+	palette[1] = in[1];
+	if(in[0] > in[1]) {
+		for(i = 1; i < 7; ++i) {
+			palette[i + 1] = (u8)(((7 - i) * in[0] + i * in[1]) / 7);
+		}
+	} else {
+		for(i = 1; i < 5; ++i) {
+			palette[i + 1] = (u8)(((5 - i) * in[0] + i * in[1]) / 5);
+		}
+		palette[6] = 0;
+		palette[7] = 255;
+	}
+	for(i = 0; i < 6; ++i) {
+		bits |= (u64)in[2 + i] << (8 * i);
+	}
+	for(i = 0; i < 16; ++i) {
+		block[i][3] = palette[(bits >> (3 * i)) & 7];
+	}
+}
+
+void bc_decode_image(bcFormat format, const u8 *blocks, u32 width, u32 height, u8 *bgra)
+{
+	u32 blocksX = (width + 3) / 4;
+	u32 blocksY = (height + 3) / 4;
+	u32 bx, by, x, y;
+	for(by = 0; by < blocksY; ++by) {
+		for(bx = 0; bx < blocksX; ++bx) {
+			u8 block[16][4];
+			if(format == kBcFormat_BC1) {
+				bc_decode_color_block(blocks, false, block);
+				blocks += 8;
+			} else {
+				bc_decode_color_block(blocks + 8, true, block);
+				bc_decode_alpha_block(blocks, block);
+				blocks += 16;
+			}
+			for(y = 0; y < 4 && by * 4 + y < height; ++y) {
+				for(x = 0; x < 4 && bx * 4 + x < width; ++x) {
+					memcpy(bgra + ((u64)(by * 4 + y) * width + bx * 4 + x) * 4, block[y * 4 + x], 4);
+				}
+			}
+		}
+	}
+}
+
+double bc_psnr(const u8 *a, const u8 *b, u32 width, u32 height, b32 bIncludeAlpha)
+{
+	u32 channels = bIncludeAlpha ? 4u : 3u;
+	u64 count = (u64)width * height;
+	double sum = 0.0;
+	double mse;
+	u64 i;
+	u32 k;
+	for(i = 0; i < count; ++i) {
+		for(k = 0; k < channels; ++k) {
+			double d = (double)a[i * 4 + k] - (double)b[i * 4 + k];
+			sum += d * d;
+		}
+	}
+	if(!count)
+		return 0.0;
+	mse = sum / (double)(count * channels);
+	if(mse <= 0.0)
+		return 100.0;
+	return 10.0 * log10(255.0 * 255.0 / mse);
+}
@@ -0,0 +1,352 @@
+// Copyright (c) 2012-2019 Matt Campbell
+// MIT license (see License.txt)
+
+#include "imgui_image_disk_cache.h"
+#include "imgui_image_file.h"
+#include "sb.h"
+#include "va.h"
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+	kImageDiskCache_Magic = 0x4349434d, // 'MCIC'
+	kImageDiskCache_Version = 1,
+	// Entries are untrusted input - anything larger than the biggest texture D3D9 hardware
+	// supports can't have come from us, and would let a corrupt header drive a huge allocation.
+	kImageDiskCache_MaxDimension = 16384,
+	kImageDiskCache_RLEMaxRun = 128,
+	kImageDiskCache_RLERunBytes = 1 + sizeof(u32),
+};
+
+enum ImageDiskCacheCodec : u32 {
+	kImageDiskCacheCodec_Raw,
+	kImageDiskCacheCodec_RLE32,
+};
+
+struct ImageDiskCacheHeader {
+	u32 magic;
+	u32 version;
+	u32 width;
+	u32 height;
+	u64 pathHash;
+	u64 sourceSize;
+	u64 sourceMtime;
+	u64 payloadSize;
+	ImageDiskCacheCodec codec;
+	u8 pad[4];
+};
+
+struct ImageDiskCacheKey {
+	u64 pathHash;
+	u64 sourceSize;
+	u64 sourceMtime;
+};
+
+static sb_t s_cacheDir;
+static ImageDiskCacheStats s_stats;
+
+void ImGui_ImageDiskCache_SetDirectory(const char *dir)
+{
+	sb_reset(&s_cacheDir);
+	if(dir && *dir) {
+		CreateDirectoryA(dir, nullptr);
+		sb_append(&s_cacheDir, dir);
+	}
+}
+
+const char *ImGui_ImageDiskCache_GetDirectory()
+{
+	return sb_get(&s_cacheDir);
+}
+
+void ImGui_ImageDiskCache_Shutdown()
+{
+	sb_reset(&s_cacheDir);
+}
+
+ImageDiskCacheStats ImGui_ImageDiskCache_GetStats()
+{
+	return s_stats;
+}
+
+static bool ImGui_ImageDiskCache_Enabled()
+{
+	return *sb_get(&s_cacheDir) != '\0';
+}
+
+// FNV-1a over the case-folded absolute path, so "foo.png" and "C:\Dir\FOO.PNG" share an entry.
+static u64 ImGui_ImageDiskCache_HashPath(const char *path)
+{
+	char fullPath[MAX_PATH];
+	DWORD len = GetFullPathNameA(path, sizeof(fullPath), fullPath, nullptr);
+	const char *src = (len && len < sizeof(fullPath)) ? fullPath : path;
+	u64 hash = 14695981039346656037ull;
+	for(const char *c = src; *c; ++c) {
+		char ch = *c;
+		if(ch >= 'A' && ch <= 'Z') {
+			ch = (char)(ch - 'A' + 'a');
+		} else if(ch == '/') {
+			ch = '\\';
+		}
+		hash ^= (u8)ch;
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+static bool ImGui_ImageDiskCache_BuildKey(const char *path, ImageDiskCacheKey *key)
+{
+	WIN32_FILE_ATTRIBUTE_DATA attributes;
+	if(!GetFileAttributesExA(path, GetFileExInfoStandard, &attributes))
+		return false;
+	key->pathHash = ImGui_ImageDiskCache_HashPath(path);
+	key->sourceSize = ((u64)attributes.nFileSizeHigh << 32) | attributes.nFileSizeLow;
+	key->sourceMtime = ((u64)attributes.ftLastWriteTime.dwHighDateTime << 32) | attributes.ftLastWriteTime.dwLowDateTime;
+	return true;
+}
+
+u64 ImGui_ImageDiskCache_HashSource(const char *path)
+{
+	ImageDiskCacheKey key;
+	if(!ImGui_ImageDiskCache_BuildKey(path, &key))
+		return 0;
+	u64 hash = key.pathHash;
+	hash = (hash ^ key.sourceSize) * 1099511628211ull;
+	hash = (hash ^ key.sourceMtime) * 1099511628211ull;
+	return hash ? hash : 1;
+}
+
+static const char *ImGui_ImageDiskCache_EntryPath(const ImageDiskCacheKey &key)
+{
+	return va("%s\\%016llx.img", sb_get(&s_cacheDir), key.pathHash);
+}
+
+// Run-length encoding over whole pixels: a control byte with the high bit set repeats the
+// following pixel (control & 0x7f) + 1 times, otherwise (control + 1) literal pixels follow.
+// UI art is dominated by flat fills and transparent borders, where this is both smaller
+// and far faster to decode than PNG's zlib.
+static u64 ImGui_ImageDiskCache_EncodeRLE(const u32 *pixels, u64 count, u8 *out)
+{
+	u8 *dst = out;
+	u64 i = 0;
+	while(i < count) {
+		u64 run = 1;
+		while(i + run < count && run < kImageDiskCache_RLEMaxRun && pixels[i + run] == pixels[i]) {
+			++run;
+		}
+		if(run > 1) {
+			*dst++ = (u8)(0x80 | (run - 1));
+			memcpy(dst, pixels + i, sizeof(u32));
+			dst += sizeof(u32);
+			i += run;
+		} else {
+			u64 start = i;
+			u64 literals = 0;
+			do {
+				++i;
+				++literals;
+			} while(i < count && literals < kImageDiskCache_RLEMaxRun && !(i + 1 < count && pixels[i + 1] == pixels[i]));
+			*dst++ = (u8)(literals - 1);
+			memcpy(dst, pixels + start, literals * sizeof(u32));
+			dst += literals * sizeof(u32);
+		}
+	}
+	return (u64)(dst - out);
+}
+
+// Returns the number of pixels decoded, which is less than count if the payload is malformed.
+// Trailing bytes after the last pixel also count as malformed.
+static u64 ImGui_ImageDiskCache_DecodeRLE(const u8 *src, u64 srcSize, u32 *pixels, u64 count)
+{
+	const u8 *srcEnd = src + srcSize;
+	u64 i = 0;
+	while(i < count) {
+		if(src >= srcEnd)
+			return i;
+		u8 control = *src++;
+		u64 num = (u64)(control & 0x7f) + 1;
+		if(i + num > count)
+			return i;
+		if(control & 0x80) {
+			if(srcEnd - src < (s64)sizeof(u32))
+				return i;
+			u32 pixel;
+			memcpy(&pixel, src, sizeof(u32));
+			src += sizeof(u32);
+			for(u64 j = 0; j < num; ++j) {
+				pixels[i + j] = pixel;
+			}
+		} else {
+			if((u64)(srcEnd - src) < num * sizeof(u32))
+				return i;
+			memcpy(pixels + i, src, num * sizeof(u32));
+			src += num * sizeof(u32);
+		}
+		i += num;
+	}
+	return src == srcEnd ? i : 0;
+}
+
+static u8 *ImGui_ImageDiskCache_DecodeEntry(const u8 *view, u64 viewSize, const ImageDiskCacheKey &key, int *width, int *height)
+{
+	if(viewSize < sizeof(ImageDiskCacheHeader))
+		return nullptr;
+	ImageDiskCacheHeader header;
+	memcpy(&header, view, sizeof(header));
+	if(header.magic != kImageDiskCache_Magic || header.version != kImageDiskCache_Version ||
+	   header.pathHash != key.pathHash || header.sourceSize != key.sourceSize || header.sourceMtime != key.sourceMtime ||
+	   header.payloadSize != viewSize - sizeof(header) || !header.width || !header.height ||
+	   header.width > kImageDiskCache_MaxDimension || header.height > kImageDiskCache_MaxDimension)
+		return nullptr;
+
+	// Even all-run RLE needs one control byte and pixel per kImageDiskCache_RLEMaxRun pixels,
+	// so a payload too small for the claimed size is rejected before allocating for it.
+	u64 count = (u64)header.width * header.height;
+	u64 minPayloadSize = (count + kImageDiskCache_RLEMaxRun - 1) / kImageDiskCache_RLEMaxRun * kImageDiskCache_RLERunBytes;
+	if(header.payloadSize < minPayloadSize)
+		return nullptr;
+	u8 *pixelData = (u8 *)malloc((size_t)(count * sizeof(u32)));
+	if(!pixelData)
+		return nullptr;
+
+	const u8 *payload = view + sizeof(header);
+	bool valid = false;
+	switch(header.codec) {
+	case kImageDiskCacheCodec_Raw:
+		valid = header.payloadSize == count * sizeof(u32);
+		if(valid) {
+			memcpy(pixelData, payload, (size_t)header.payloadSize);
+		}
+		break;
+	case kImageDiskCacheCodec_RLE32:
+		valid = ImGui_ImageDiskCache_DecodeRLE(payload, header.payloadSize, (u32 *)pixelData, count) == count;
+		break;
+	}
+	if(!valid) {
+		free(pixelData);
+		return nullptr;
+	}
+	*width = (int)header.width;
+	*height = (int)header.height;
+	return pixelData;
+}
+
+u8 *ImGui_ImageDiskCache_Load(const char *path, int *width, int *height)
+{
+	ImageDiskCacheKey key;
+	if(!ImGui_ImageDiskCache_Enabled() || !ImGui_ImageDiskCache_BuildKey(path, &key))
+		return nullptr;
+
+	const char *entryPath = ImGui_ImageDiskCache_EntryPath(key);
+	HANDLE hFile = CreateFileA(entryPath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if(hFile == INVALID_HANDLE_VALUE) {
+		++s_stats.misses;
+		return nullptr;
+	}
+
+	u8 *pixelData = nullptr;
+	LARGE_INTEGER fileSize;
+	if(GetFileSizeEx(hFile, &fileSize) && fileSize.QuadPart > 0) {
+		HANDLE hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if(hMapping) {
+			const u8 *view = (const u8 *)MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+			if(view) {
+				pixelData = ImGui_ImageDiskCache_DecodeEntry(view, (u64)fileSize.QuadPart, key, width, height);
+				UnmapViewOfFile(view);
+			}
+			CloseHandle(hMapping);
+		}
+	}
+	CloseHandle(hFile);
+
+	if(pixelData) {
+		++s_stats.hits;
+		s_stats.bytesRead += (u64)fileSize.QuadPart;
+		s_stats.bytesDecoded += (u64)*width * (u64)*height * sizeof(u32);
+	} else {
+		++s_stats.misses;
+		++s_stats.rejected;
+		DeleteFileA(entryPath);
+	}
+	return pixelData;
+}
+
+bool ImGui_ImageDiskCache_Store(const char *path, const u8 *pixelData, int width, int height)
+{
+	ImageDiskCacheKey key;
+	if(!ImGui_ImageDiskCache_Enabled() || !pixelData || width <= 0 || height <= 0 ||
+	   width > kImageDiskCache_MaxDimension || height > kImageDiskCache_MaxDimension || !ImGui_ImageDiskCache_BuildKey(path, &key))
+		return false;
+
+	u64 count = (u64)width * (u64)height;
+	u64 rawSize = count * sizeof(u32);
+	u64 maxEncodedSize = rawSize + count / 128 + 1;
+	u8 *buffer = (u8 *)malloc((size_t)(sizeof(ImageDiskCacheHeader) + maxEncodedSize));
+	if(!buffer)
+		return false;
+
+	ImageDiskCacheHeader header = { BB_EMPTY_INITIALIZER };
+	header.magic = kImageDiskCache_Magic;
+	header.version = kImageDiskCache_Version;
+	header.width = (u32)width;
+	header.height = (u32)height;
+	header.pathHash = key.pathHash;
+	header.sourceSize = key.sourceSize;
+	header.sourceMtime = key.sourceMtime;
+	u8 *payload = buffer + sizeof(header);
+	header.payloadSize = ImGui_ImageDiskCache_EncodeRLE((const u32 *)pixelData, count, payload);
+	header.codec = kImageDiskCacheCodec_RLE32;
+	if(header.payloadSize >= rawSize) {
+		// photographic content - RLE only adds overhead
+		memcpy(payload, pixelData, (size_t)rawSize);
+		header.payloadSize = rawSize;
+		header.codec = kImageDiskCacheCodec_Raw;
+	}
+	memcpy(buffer, &header, sizeof(header));
+
+	// Write to a temp name and rename so a crash mid-write never leaves a truncated entry
+	// that matches the key.
+	sb_t entryPath = { BB_EMPTY_INITIALIZER };
+	sb_append(&entryPath, ImGui_ImageDiskCache_EntryPath(key));
+	const char *tempPath = va("%s.tmp", sb_get(&entryPath));
+	u64 totalSize = sizeof(header) + header.payloadSize;
+	bool success = false;
+	HANDLE hFile = CreateFileA(tempPath, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if(hFile != INVALID_HANDLE_VALUE) {
+		DWORD written = 0;
+		success = totalSize <= 0xFFFFFFFFu && WriteFile(hFile, buffer, (DWORD)totalSize, &written, nullptr) && written == totalSize;
+		CloseHandle(hFile);
+		if(success) {
+			success = MoveFileExA(tempPath, sb_get(&entryPath), MOVEFILE_REPLACE_EXISTING) != 0;
+		}
+		if(!success) {
+			DeleteFileA(tempPath);
+		}
+	}
+	if(success) {
+		++s_stats.stores;
+		s_stats.bytesWritten += totalSize;
+	} else {
+		BB_WARNING("Image", "Failed to write image cache entry for %s", path);
+	}
+	sb_reset(&entryPath);
+	free(buffer);
+	return success;
+}
+
+static u8 *ImGui_ImageDiskCache_DecodeSource(const char *path, int *width, int *height)
+{
+	return ImGui_ImageFile_Load(path, width, height);
+}
+
+u8 *ImGui_ImageDiskCache_LoadOrDecode(const char *path, int *width, int *height)
+{
+	u8 *pixelData = ImGui_ImageDiskCache_Load(path, width, height);
+	if(!pixelData) {
+		pixelData = ImGui_ImageDiskCache_DecodeSource(path, width, height);
+		if(pixelData) {
+			ImGui_ImageDiskCache_Store(path, pixelData, *width, *height);
+		}
+	}
+	return pixelData;
+}
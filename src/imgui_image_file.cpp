@@ -0,0 +1,156 @@
+// Copyright (c) 2012-2019 Matt Campbell
+// MIT license (see License.txt)
+
+#include "imgui_image_file.h"
+#include "imgui_image.h"
+BB_WARNING_PUSH(4365 4820 4296 4619 5219)
+#include "stb/stb_image.h"
+BB_WARNING_POP
+#include <string.h>
+
+bool ImGui_ImageFile_Map(const char *path, MappedImageFile *file)
+{
+	memset(file, 0, sizeof(*file));
+	HANDLE hFile = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if(hFile == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize;
+	if(GetFileSizeEx(hFile, &fileSize) && fileSize.QuadPart > 0) {
+		HANDLE hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if(hMapping) {
+			// the view keeps the file mapped after both handles are closed
+			file->view = (const u8 *)MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+			if(file->view) {
+				file->size = (u64)fileSize.QuadPart;
+			}
+			CloseHandle(hMapping);
+		}
+	}
+	CloseHandle(hFile);
+	return file->view != nullptr;
+}
+
+void ImGui_ImageFile_Unmap(MappedImageFile *file)
+{
+	ImGui_ImageFile_UnmapView(file->view);
+	memset(file, 0, sizeof(*file));
+}
+
+void ImGui_ImageFile_UnmapView(const void *view)
+{
+	if(view) {
+		UnmapViewOfFile(view);
+	}
+}
+
+static u16 ImGui_ImageFile_Read16(const u8 *p)
+{
+	return (u16)(p[0] | (p[1] << 8));
+}
+
+static u32 ImGui_ImageFile_Read32(const u8 *p)
+{
+	return (u32)p[0] | ((u32)p[1] << 8) | ((u32)p[2] << 16) | ((u32)p[3] << 24);
+}
+
+static bool ImGui_ImageFile_SetRaw(const MappedImageFile *file, u64 offset, int width, int height, bool bBottomUp, bool bHasAlpha, MappedImageRaw *raw)
+{
+	if(width <= 0 || height <= 0)
+		return false;
+	u64 pitch = (u64)width * 4;
+	if(offset > file->size || pitch * (u64)height > file->size - offset || pitch > 0x7fffffff)
+		return false;
+	raw->width = width;
+	raw->height = height;
+	raw->bHasAlpha = bHasAlpha;
+	if(bBottomUp) {
+		raw->firstRow = file->view + offset + pitch * (u64)(height - 1);
+		raw->pitch = -(int)pitch;
+	} else {
+		raw->firstRow = file->view + offset;
+		raw->pitch = (int)pitch;
+	}
+	return true;
+}
+
+static bool ImGui_ImageFile_ParseBMP(const MappedImageFile *file, MappedImageRaw *raw)
+{
+	const u8 *p = file->view;
+	if(file->size < 54 || p[0] != 'B' || p[1] != 'M')
+		return false;
+	u32 dataOffset = ImGui_ImageFile_Read32(p + 10);
+	u32 headerSize = ImGui_ImageFile_Read32(p + 14);
+	int width = (int)ImGui_ImageFile_Read32(p + 18);
+	int height = (int)ImGui_ImageFile_Read32(p + 22);
+	u16 bitCount = ImGui_ImageFile_Read16(p + 28);
+	u32 compression = ImGui_ImageFile_Read32(p + 30);
+	if(headerSize < 40 || bitCount != 32)
+		return false;
+
+	bool bHasAlpha = false;
+	if(compression == 3) { // BI_BITFIELDS - masks follow the 40 byte header, or are part of a V4/V5 header
+		if(file->size < 14 + 40 + 12)
+			return false;
+		if(ImGui_ImageFile_Read32(p + 54) != 0x00ff0000 || ImGui_ImageFile_Read32(p + 58) != 0x0000ff00 || ImGui_ImageFile_Read32(p + 62) != 0x000000ff)
+			return false;
+		bHasAlpha = headerSize >= 56 && file->size >= 70 && ImGui_ImageFile_Read32(p + 66) == 0xff000000;
+	} else if(compression != 0) { // BI_RGB - the 4th byte is reserved, not alpha
+		return false;
+	}
+
+	bool bBottomUp = height > 0;
+	return ImGui_ImageFile_SetRaw(file, dataOffset, width, bBottomUp ? height : -height, bBottomUp, bHasAlpha, raw);
+}
+
+static bool ImGui_ImageFile_ParseTGA(const MappedImageFile *file, MappedImageRaw *raw)
+{
+	const u8 *p = file->view;
+	if(file->size < 18)
+		return false;
+	u8 idLength = p[0];
+	u8 colorMapType = p[1];
+	u8 imageType = p[2];
+	int width = ImGui_ImageFile_Read16(p + 12);
+	int height = ImGui_ImageFile_Read16(p + 14);
+	u8 pixelDepth = p[16];
+	u8 descriptor = p[17];
+
+	// uncompressed true-color, 32bpp, left-to-right
+	if(colorMapType != 0 || imageType != 2 || pixelDepth != 32 || (descriptor & 0x10) != 0)
+		return false;
+	bool bBottomUp = (descriptor & 0x20) == 0;
+	bool bHasAlpha = (descriptor & 0x0f) == 8;
+	return ImGui_ImageFile_SetRaw(file, 18u + idLength, width, height, bBottomUp, bHasAlpha, raw);
+}
+
+bool ImGui_ImageFile_ParseRaw(const MappedImageFile *file, MappedImageRaw *raw)
+{
+	memset(raw, 0, sizeof(*raw));
+	if(!file->view)
+		return false;
+	// TGA has no magic number - its header checks reject PNG/JPEG/GIF signatures, so try it last
+	return ImGui_ImageFile_ParseBMP(file, raw) || ImGui_ImageFile_ParseTGA(file, raw);
+}
+
+u8 *ImGui_ImageFile_Decode(const MappedImageFile *file, int *width, int *height)
+{
+	if(!file->view || file->size > 0x7fffffff)
+		return nullptr;
+	int channelsInFile = 0;
+	u8 *pixelData = stbi_load_from_memory(file->view, (int)file->size, width, height, &channelsInFile, 4);
+	if(pixelData) {
+		ImGui_Image_SwizzleRGBA(pixelData, *width, *height);
+	}
+	return pixelData;
+}
+
+u8 *ImGui_ImageFile_Load(const char *path, int *width, int *height)
+{
+	MappedImageFile file;
+	if(!ImGui_ImageFile_Map(path, &file))
+		return nullptr;
+	u8 *pixelData = ImGui_ImageFile_Decode(&file, width, height);
+	ImGui_ImageFile_Unmap(&file);
+	return pixelData;
+}
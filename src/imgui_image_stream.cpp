@@ -0,0 +1,263 @@
+// Copyright (c) 2012-2019 Matt Campbell
+// MIT license (see License.txt)
+
+#include "imgui_image_stream.h"
+#include "imgui_core.h"
+#include "imgui_image_triple_buffer.h"
+#include <d3d9.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+	kStreamTexture_None = 0xFFFFFFFF,
+};
+
+struct ImageStreamData {
+	tripleBuffer tb;
+	LPDIRECT3DTEXTURE9 textures[kImageStream_MaxTextures];
+	StreamImageId userId;
+	int width;
+	int height;
+	u32 numTextures;
+	u32 currentTexture;
+	b32 bPendingDestroy;
+	b32 bHasFrame; // present buffer holds a frame, so it can be re-uploaded after device loss
+	u8 pad[4];
+	u64 framesUploaded;
+	u64 bytesUploaded;
+};
+
+static LPDIRECT3DDEVICE9 g_pStreamDevice;
+static ImageStreamData *s_streams[kImageStream_MaxStreams];
+static u32 s_lastStreamSerial;
+
+// Producers never call into the core - they raise this flag and post a WM_NULL to wake a UI loop
+// that is waiting on messages.  NewFrame clears it and requests the render on the UI thread.
+static volatile LONG s_framesReady;
+static HWND s_wakeWindow;
+
+static ImageStreamData *ImGui_ImageStream_Find(StreamImageId id)
+{
+	if(!id.id)
+		return nullptr;
+	ImageStreamData *data = s_streams[(id.id - 1) % kImageStream_MaxStreams];
+	return (data && data->userId == id) ? data : nullptr;
+}
+
+StreamImageId ImGui_ImageStream_Create(int width, int height, u32 numTextures)
+{
+	StreamImageId id;
+	if(width <= 0 || height <= 0)
+		return id;
+
+	for(u32 slot = 0; slot < kImageStream_MaxStreams; ++slot) {
+		if(s_streams[slot])
+			continue;
+		ImageStreamData *data = (ImageStreamData *)calloc(1, sizeof(ImageStreamData));
+		if(!data)
+			return id;
+		if(!tripleBuffer_init(&data->tb, (u64)width * (u64)height * 4)) {
+			free(data);
+			return id;
+		}
+		// ids encode their slot, so producer threads can look streams up without a lock
+		data->userId.id = ++s_lastStreamSerial * kImageStream_MaxStreams + slot + 1;
+		data->width = width;
+		data->height = height;
+		data->numTextures = BB_MAX(2u, BB_MIN(numTextures, (u32)kImageStream_MaxTextures));
+		data->currentTexture = kStreamTexture_None;
+		s_streams[slot] = data;
+		return data->userId;
+	}
+	BB_WARNING("Image", "Failed to create %dx%d stream image - all %u streams in use", width, height, kImageStream_MaxStreams);
+	return id;
+}
+
+void ImGui_ImageStream_MarkForDestroy(StreamImageId id)
+{
+	ImageStreamData *data = ImGui_ImageStream_Find(id);
+	if(data) {
+		data->bPendingDestroy = true;
+	}
+}
+
+u8 *ImGui_ImageStream_BeginWrite(StreamImageId id)
+{
+	ImageStreamData *data = ImGui_ImageStream_Find(id);
+	return data ? tripleBuffer_back(&data->tb) : nullptr;
+}
+
+// Producer: only the first publish after the UI thread consumed the flag posts a message, so a
+// fast producer can't flood the message queue.
+static void ImGui_ImageStream_SignalFrameReady()
+{
+	if(InterlockedExchange(&s_framesReady, 1) == 0 && s_wakeWindow) {
+		PostMessage(s_wakeWindow, WM_NULL, 0, 0);
+	}
+}
+
+void ImGui_ImageStream_EndWrite(StreamImageId id)
+{
+	ImageStreamData *data = ImGui_ImageStream_Find(id);
+	if(data) {
+		tripleBuffer_publish(&data->tb);
+		ImGui_ImageStream_SignalFrameReady();
+	}
+}
+
+bool ImGui_ImageStream_Write(StreamImageId id, const u8 *pixelData, u32 pitch)
+{
+	ImageStreamData *data = ImGui_ImageStream_Find(id);
+	if(!data || !pixelData)
+		return false;
+	u8 *dest = tripleBuffer_back(&data->tb);
+	size_t rowBytes = (size_t)data->width * 4;
+	if(pitch == rowBytes) {
+		memcpy(dest, pixelData, (size_t)data->tb.frameBytes);
+	} else {
+		for(int y = 0; y < data->height; ++y) {
+			memcpy(dest + rowBytes * (size_t)y, pixelData + (size_t)pitch * (size_t)y, rowBytes);
+		}
+	}
+	tripleBuffer_publish(&data->tb);
+	ImGui_ImageStream_SignalFrameReady();
+	return true;
+}
+
+static void ImGui_ImageStream_ReleaseTextures(ImageStreamData *data)
+{
+	for(u32 i = 0; i < kImageStream_MaxTextures; ++i) {
+		if(data->textures[i]) {
+			data->textures[i]->Release();
+			data->textures[i] = nullptr;
+		}
+	}
+	data->currentTexture = kStreamTexture_None;
+}
+
+// Uploads into the oldest texture in the ring - the GPU has had numTextures - 1 frames to finish
+// with it, and D3DLOCK_DISCARD lets the driver rename it rather than stall if it hasn't.
+static void ImGui_ImageStream_Upload(ImageStreamData *data, const u8 *pixelData)
+{
+	u32 next = (data->currentTexture == kStreamTexture_None) ? 0 : (data->currentTexture + 1) % data->numTextures;
+	LPDIRECT3DTEXTURE9 *texture = data->textures + next;
+	if(!*texture) {
+		if(g_pStreamDevice->CreateTexture((UINT)data->width, (UINT)data->height, 1, D3DUSAGE_DYNAMIC, D3DFMT_A8R8G8B8, D3DPOOL_DEFAULT, texture, nullptr) < 0) {
+			*texture = nullptr;
+			return;
+		}
+	}
+	D3DLOCKED_RECT lockedRect;
+	if((*texture)->LockRect(0, &lockedRect, nullptr, D3DLOCK_DISCARD) != D3D_OK)
+		return;
+	size_t rowBytes = (size_t)data->width * 4;
+	if((size_t)lockedRect.Pitch == rowBytes) {
+		memcpy(lockedRect.pBits, pixelData, (size_t)data->tb.frameBytes);
+	} else {
+		for(int y = 0; y < data->height; ++y) {
+			memcpy((u8 *)lockedRect.pBits + lockedRect.Pitch * y, pixelData + rowBytes * (size_t)y, rowBytes);
+		}
+	}
+	(*texture)->UnlockRect(0);
+	data->currentTexture = next;
+	++data->framesUploaded;
+	data->bytesUploaded += data->tb.frameBytes;
+}
+
+void ImGui_ImageStream_NewFrame()
+{
+	if(InterlockedExchange(&s_framesReady, 0)) {
+		Imgui_Core_RequestRender();
+	}
+	for(u32 slot = 0; slot < kImageStream_MaxStreams; ++slot) {
+		ImageStreamData *data = s_streams[slot];
+		if(!data)
+			continue;
+		if(data->bPendingDestroy) {
+			s_streams[slot] = nullptr;
+			ImGui_ImageStream_ReleaseTextures(data);
+			tripleBuffer_reset(&data->tb);
+			free(data);
+			continue;
+		}
+		if(!g_pStreamDevice)
+			continue;
+		const u8 *pixelData = tripleBuffer_acquire(&data->tb);
+		if(pixelData) {
+			data->bHasFrame = true;
+		} else if(data->bHasFrame && data->currentTexture == kStreamTexture_None) {
+			// device was reset - restore the last frame rather than showing nothing until the next one
+			pixelData = tripleBuffer_present(&data->tb);
+		}
+		if(pixelData) {
+			ImGui_ImageStream_Upload(data, pixelData);
+		}
+	}
+}
+
+ImTextureID ImGui_ImageStream_GetTexture(StreamImageId id)
+{
+	ImageStreamData *data = ImGui_ImageStream_Find(id);
+	if(!data || data->currentTexture == kStreamTexture_None)
+		return nullptr;
+	return data->textures[data->currentTexture];
+}
+
+void ImGui_ImageStream_Draw(StreamImageId id, ImDrawList *drawList, ImVec2 start, ImVec2 end, ImVec2 uv0, ImVec2 uv1)
+{
+	ImTextureID texture = ImGui_ImageStream_GetTexture(id);
+	if(texture) {
+		drawList->AddImage(texture, start, end, uv0, uv1, 0xFFFFFFFF);
+	} else {
+		drawList->AddRectFilled(start, end, ImGui::GetColorU32(ImGuiCol_FrameBg));
+	}
+}
+
+StreamImageStats ImGui_ImageStream_GetStats(StreamImageId id)
+{
+	StreamImageStats stats = { BB_EMPTY_INITIALIZER };
+	ImageStreamData *data = ImGui_ImageStream_Find(id);
+	if(data) {
+		stats.framesPublished = (u64)data->tb.published;
+		stats.framesDropped = (u64)data->tb.dropped;
+		stats.framesUploaded = data->framesUploaded;
+		stats.bytesUploaded = data->bytesUploaded;
+	}
+	return stats;
+}
+
+void ImGui_ImageStream_InvalidateDeviceObjects()
+{
+	for(u32 slot = 0; slot < kImageStream_MaxStreams; ++slot) {
+		if(s_streams[slot]) {
+			ImGui_ImageStream_ReleaseTextures(s_streams[slot]);
+		}
+	}
+}
+
+bool ImGui_ImageStream_Init(IDirect3DDevice9 *device)
+{
+	ImGui_ImageStream_InvalidateDeviceObjects();
+	g_pStreamDevice = device;
+	D3DDEVICE_CREATION_PARAMETERS params;
+	if(device && device->GetCreationParameters(&params) == D3D_OK) {
+		s_wakeWindow = params.hFocusWindow;
+	}
+	return true;
+}
+
+void ImGui_ImageStream_Shutdown()
+{
+	ImGui_ImageStream_InvalidateDeviceObjects();
+	for(u32 slot = 0; slot < kImageStream_MaxStreams; ++slot) {
+		ImageStreamData *data = s_streams[slot];
+		if(data) {
+			tripleBuffer_reset(&data->tb);
+			free(data);
+			s_streams[slot] = nullptr;
+		}
+	}
+	g_pStreamDevice = nullptr;
+	s_wakeWindow = nullptr;
+	s_framesReady = 0;
+}
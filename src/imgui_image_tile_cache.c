@@ -0,0 +1,141 @@
+// Copyright (c) 2012-2019 Matt Campbell
+// MIT license (see License.txt)
+
+#include "imgui_image_tile_cache.h"
+#include <stdlib.h>
+#include <string.h>
+
+static b32 tileCache_key_equal(tileCacheKey a, tileCacheKey b)
+{
+	return a.imageId == b.imageId && a.level == b.level && a.tileX == b.tileX && a.tileY == b.tileY;
+}
+
+void tileCache_init(tileCache *cache, u32 numSlots)
+{
+	tileCache_reset(cache);
+	if(numSlots) {
+		cache->slots = (tileCacheSlot *)calloc(numSlots, sizeof(tileCacheSlot));
+		if(cache->slots) {
+			cache->numSlots = numSlots;
+		}
+	}
+}
+
+void tileCache_reset(tileCache *cache)
+{
+	free(cache->slots);
+	memset(cache, 0, sizeof(*cache));
+}
+
+void tileCache_new_frame(tileCache *cache)
+{
+	++cache->frame;
+	cache->hits = 0;
+	cache->misses = 0;
+	cache->evictions = 0;
+}
+
+void tileCache_clear(tileCache *cache)
+{
+	u32 i;
+	for(i = 0; i < cache->numSlots; ++i) {
+		cache->slots[i].bOccupied = false;
+		cache->slots[i].bPinned = false;
+	}
+}
+
+// Slot counts are in the hundreds, so a linear scan is cheaper than maintaining a hash.
+u32 tileCache_find(tileCache *cache, tileCacheKey key)
+{
+	u32 i;
+	for(i = 0; i < cache->numSlots; ++i) {
+		tileCacheSlot *slot = cache->slots + i;
+		if(slot->bOccupied && tileCache_key_equal(slot->key, key)) {
+			slot->lastUsedFrame = cache->frame;
+			++cache->hits;
+			return i;
+		}
+	}
+	++cache->misses;
+	return kTileCache_InvalidSlot;
+}
+
+// Claims a slot for key, preferring empty slots and then the least recently used slot.
+// Slots touched this frame and pinned slots are never evicted, so a full cache returns
+// kTileCache_InvalidSlot and the caller falls back to a coarser level.
+u32 tileCache_acquire(tileCache *cache, tileCacheKey key, b32 *outEvicted, tileCacheKey *outEvictedKey)
+{
+	u32 best = kTileCache_InvalidSlot;
+	u32 bestFrame = cache->frame;
+	u32 i;
+	if(outEvicted) {
+		*outEvicted = false;
+	}
+	for(i = 0; i < cache->numSlots; ++i) {
+		tileCacheSlot *slot = cache->slots + i;
+		if(!slot->bOccupied) {
+			best = i;
+			break;
+		}
+		if(!slot->bPinned && slot->lastUsedFrame < bestFrame) {
+			bestFrame = slot->lastUsedFrame;
+			best = i;
+		}
+	}
+	if(best != kTileCache_InvalidSlot) {
+		tileCacheSlot *slot = cache->slots + best;
+		if(slot->bOccupied) {
+			++cache->evictions;
+			if(outEvicted) {
+				*outEvicted = true;
+			}
+			if(outEvictedKey) {
+				*outEvictedKey = slot->key;
+			}
+		}
+		slot->key = key;
+		slot->lastUsedFrame = cache->frame;
+		slot->bOccupied = true;
+		slot->bPinned = false;
+	}
+	return best;
+}
+
+void tileCache_release_slot(tileCache *cache, u32 slot)
+{
+	if(slot < cache->numSlots) {
+		cache->slots[slot].bOccupied = false;
+		cache->slots[slot].bPinned = false;
+	}
+}
+
+void tileCache_pin_slot(tileCache *cache, u32 slot)
+{
+	if(slot < cache->numSlots && cache->slots[slot].bOccupied) {
+		cache->slots[slot].bPinned = true;
+	}
+}
+
+void tileCache_evict_image(tileCache *cache, u32 imageId)
+{
+	u32 i;
+	for(i = 0; i < cache->numSlots; ++i) {
+		tileCacheSlot *slot = cache->slots + i;
+		if(slot->bOccupied && slot->key.imageId == imageId) {
+			slot->bOccupied = false;
+			slot->bPinned = false;
+		}
+	}
+}
+
+u32 tileCache_count_occupied(const tileCache *cache)
+{
+	u32 count = 0;
+	u32 i;
+	for(i = 0; i < cache->numSlots; ++i) {
+		if(cache->slots[i].bOccupied) {
+			++count;
+		}
+	}
+	return count;
+}
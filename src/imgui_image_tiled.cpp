@@ -0,0 +1,492 @@
+// Copyright (c) 2012-2019 Matt Campbell
+// MIT license (see License.txt)
+
+#include "imgui_image_tiled.h"
+#include "bb_array.h"
+#include "imgui_core.h"
+#include "imgui_image.h"
+#include "imgui_image_tile_cache.h"
+#include "wrap_imgui_internal.h"
+BB_WARNING_PUSH(4365 4820 4296 4619 5219)
+#include "stb/stb_image.h"
+BB_WARNING_POP
+#include <d3d9.h>
+#include <math.h>
+
+enum {
+	kTiledImage_TileSize = 256,
+	kTiledImage_TileBytes = kTiledImage_TileSize * kTiledImage_TileSize * 4,
+	kTiledImage_MaxLevels = 16,
+	kTiledImage_DefaultMaxResidentTiles = 256,
+	kTiledImage_MinResidentTiles = 2, // the pinned coarsest tile, and one to load the desired level into
+	kTiledImage_DefaultMaxUploadsPerFrame = 16,
+};
+
+enum TiledImage_Flag : u32 {
+	kTiledImage_PendingDestroy = 1,
+};
+
+struct TiledImageLevel {
+	u32 width;
+	u32 height;
+	u32 tilesX;
+	u32 tilesY;
+	u64 offset;
+};
+
+struct TiledImageData {
+	TiledImageId userId;
+	int width;
+	int height;
+	u32 numLevels;
+	u32 flags;
+	u8 pad[4];
+	TiledImageLevel levels[kTiledImage_MaxLevels];
+	u8 *tiles;
+	u64 tilesSize;
+	HANDLE hFile;
+	HANDLE hMapping;
+};
+
+struct TiledImages {
+	u32 count;
+	u32 allocated;
+	TiledImageData *data;
+};
+
+static LPDIRECT3DDEVICE9 g_pTiledDevice;
+static TiledImages s_tiledImages;
+static u32 s_lastTiledId;
+static tileCache s_tileCache;
+static LPDIRECT3DTEXTURE9 *s_tileTextures;
+static u32 s_maxResidentTiles = kTiledImage_DefaultMaxResidentTiles;
+static u32 s_maxUploadsPerFrame = kTiledImage_DefaultMaxUploadsPerFrame;
+static u32 s_uploadsThisFrame;
+static u32 s_missingThisFrame;
+
+static TiledImageData *ImGui_ImageTiled_Find(TiledImageId id)
+{
+	for(u32 i = 0; i < s_tiledImages.count; ++i) {
+		TiledImageData *data = s_tiledImages.data + i;
+		if(data->userId == id) {
+			return data;
+		}
+	}
+	return nullptr;
+}
+
+static u8 *ImGui_ImageTiled_AllocTileStore(TiledImageData *data)
+{
+	// Back the tiles with a temporary file so the OS can page them out - a 16k pyramid
+	// is well over a gigabyte, and only the handful of tiles on screen are touched.
+	char tempDir[MAX_PATH];
+	char tempPath[MAX_PATH];
+	if(GetTempPathA(sizeof(tempDir), tempDir) && GetTempFileNameA(tempDir, "img", 0, tempPath)) {
+		HANDLE hFile = CreateFileA(tempPath, GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+		if(hFile != INVALID_HANDLE_VALUE) {
+			LARGE_INTEGER size;
+			size.QuadPart = (LONGLONG)data->tilesSize;
+			HANDLE hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READWRITE, (DWORD)size.HighPart, size.LowPart, nullptr);
+			if(hMapping) {
+				void *view = MapViewOfFile(hMapping, FILE_MAP_ALL_ACCESS, 0, 0, (SIZE_T)data->tilesSize);
+				if(view) {
+					data->hFile = hFile;
+					data->hMapping = hMapping;
+					return (u8 *)view;
+				}
+				CloseHandle(hMapping);
+			}
+			CloseHandle(hFile);
+		}
+	}
+	BB_WARNING("Image", "Failed to create tile store file - falling back to %llu bytes of heap", data->tilesSize);
+	return (u8 *)malloc((size_t)data->tilesSize);
+}
+
+static void ImGui_ImageTiled_FreeTileStore(TiledImageData *data)
+{
+	if(data->hMapping) {
+		UnmapViewOfFile(data->tiles);
+		CloseHandle(data->hMapping);
+		CloseHandle(data->hFile);
+	} else {
+		free(data->tiles);
+	}
+	data->tiles = nullptr;
+	data->hMapping = nullptr;
+	data->hFile = nullptr;
+}
+
+static void ImGui_ImageTiled_WriteLevelTiles(TiledImageData *data, u32 levelIndex, const u8 *pixels)
+{
+	const TiledImageLevel *level = data->levels + levelIndex;
+	for(u32 tileY = 0; tileY < level->tilesY; ++tileY) {
+		for(u32 tileX = 0; tileX < level->tilesX; ++tileX) {
+			u8 *tile = data->tiles + level->offset + (u64)(tileY * level->tilesX + tileX) * kTiledImage_TileBytes;
+			u32 x0 = tileX * kTiledImage_TileSize;
+			u32 y0 = tileY * kTiledImage_TileSize;
+			u32 validWidth = BB_MIN((u32)kTiledImage_TileSize, level->width - x0);
+			for(u32 y = 0; y < kTiledImage_TileSize; ++y) {
+				u32 srcY = BB_MIN(y0 + y, level->height - 1);
+				const u8 *srcRow = pixels + (u64)srcY * level->width * 4;
+				u8 *dstRow = tile + y * kTiledImage_TileSize * 4;
+				memcpy(dstRow, srcRow + x0 * 4, validWidth * 4);
+				// replicate the edge so bilinear filtering at partial tile borders doesn't pull in garbage
+				for(u32 x = validWidth; x < kTiledImage_TileSize; ++x) {
+					memcpy(dstRow + x * 4, srcRow + (level->width - 1) * 4, 4);
+				}
+			}
+		}
+	}
+}
+
+static u8 *ImGui_ImageTiled_Downsample(const u8 *src, u32 srcWidth, u32 srcHeight, u32 dstWidth, u32 dstHeight)
+{
+	u8 *dst = (u8 *)malloc((size_t)dstWidth * dstHeight * 4);
+	if(!dst)
+		return nullptr;
+
+	for(u32 y = 0; y < dstHeight; ++y) {
+		const u8 *row0 = src + (u64)BB_MIN(y * 2, srcHeight - 1) * srcWidth * 4;
+		const u8 *row1 = src + (u64)BB_MIN(y * 2 + 1, srcHeight - 1) * srcWidth * 4;
+		u8 *dstRow = dst + (u64)y * dstWidth * 4;
+		for(u32 x = 0; x < dstWidth; ++x) {
+			u32 x0 = BB_MIN(x * 2, srcWidth - 1) * 4;
+			u32 x1 = BB_MIN(x * 2 + 1, srcWidth - 1) * 4;
+			for(u32 c = 0; c < 4; ++c) {
+				u32 sum = (u32)row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c];
+				dstRow[x * 4 + c] = (u8)((sum + 2) / 4);
+			}
+		}
+	}
+	return dst;
+}
+
+TiledImageId ImGui_ImageTiled_Create(const u8 *pixelData, int width, int height)
+{
+	TiledImageId userId;
+	if(!pixelData || width <= 0 || height <= 0)
+		return userId;
+
+	TiledImageData data = {};
+	data.width = width;
+	data.height = height;
+
+	u64 offset = 0;
+	u32 levelWidth = (u32)width;
+	u32 levelHeight = (u32)height;
+	while(data.numLevels < kTiledImage_MaxLevels) {
+		TiledImageLevel *level = data.levels + data.numLevels++;
+		level->width = levelWidth;
+		level->height = levelHeight;
+		level->tilesX = (levelWidth + kTiledImage_TileSize - 1) / kTiledImage_TileSize;
+		level->tilesY = (levelHeight + kTiledImage_TileSize - 1) / kTiledImage_TileSize;
+		level->offset = offset;
+		offset += (u64)level->tilesX * level->tilesY * kTiledImage_TileBytes;
+		if(levelWidth <= kTiledImage_TileSize && levelHeight <= kTiledImage_TileSize)
+			break;
+		levelWidth = BB_MAX(1u, levelWidth / 2);
+		levelHeight = BB_MAX(1u, levelHeight / 2);
+	}
+
+	data.tilesSize = offset;
+	data.tiles = ImGui_ImageTiled_AllocTileStore(&data);
+	if(!data.tiles)
+		return userId;
+
+	// Build the pyramid one level at a time so at most two levels are in the heap at once
+	const u8 *levelPixels = pixelData;
+	u8 *ownedPixels = nullptr;
+	for(u32 i = 0; i < data.numLevels; ++i) {
+		ImGui_ImageTiled_WriteLevelTiles(&data, i, levelPixels);
+		if(i + 1 < data.numLevels) {
+			const TiledImageLevel *level = data.levels + i;
+			const TiledImageLevel *next = level + 1;
+			u8 *nextPixels = ImGui_ImageTiled_Downsample(levelPixels, level->width, level->height, next->width, next->height);
+			free(ownedPixels);
+			ownedPixels = nextPixels;
+			levelPixels = nextPixels;
+			if(!nextPixels) {
+				data.numLevels = i + 1;
+				break;
+			}
+		}
+	}
+	free(ownedPixels);
+
+	userId.id = ++s_lastTiledId;
+	data.userId = userId;
+	bba_push(s_tiledImages, data);
+	return userId;
+}
+
+TiledImageId ImGui_ImageTiled_CreateFromFile(const char *path)
+{
+	int width = 0;
+	int height = 0;
+	int channelsInFile = 0;
+	u8 *pixelData = stbi_load(path, &width, &height, &channelsInFile, 4);
+	if(!pixelData) {
+		BB_WARNING("Image", "Failed to load tiled image %s", path);
+		return TiledImageId();
+	}
+	ImGui_Image_SwizzleRGBA(pixelData, width, height);
+	TiledImageId userId = ImGui_ImageTiled_Create(pixelData, width, height);
+	stbi_image_free(pixelData);
+	BB_LOG("Image", "Tiled image %u %s %dx%d", userId.id, path, width, height);
+	return userId;
+}
+
+TiledImageInfo ImGui_ImageTiled_GetInfo(TiledImageId id)
+{
+	TiledImageInfo info = { BB_EMPTY_INITIALIZER };
+	const TiledImageData *data = ImGui_ImageTiled_Find(id);
+	if(data) {
+		info.width = data->width;
+		info.height = data->height;
+		info.numLevels = data->numLevels;
+		info.tileSize = kTiledImage_TileSize;
+	}
+	return info;
+}
+
+void ImGui_ImageTiled_MarkForDestroy(TiledImageId id)
+{
+	TiledImageData *data = ImGui_ImageTiled_Find(id);
+	if(data) {
+		data->flags |= kTiledImage_PendingDestroy;
+	}
+}
+
+static bool ImGui_ImageTiled_Upload(u32 slot, const TiledImageData *data, tileCacheKey key)
+{
+	LPDIRECT3DTEXTURE9 *texture = s_tileTextures + slot;
+	if(!*texture) {
+		if(g_pTiledDevice->CreateTexture(kTiledImage_TileSize, kTiledImage_TileSize, 1, D3DUSAGE_DYNAMIC, D3DFMT_A8R8G8B8, D3DPOOL_DEFAULT, texture, nullptr) < 0) {
+			*texture = nullptr;
+			return false;
+		}
+	}
+
+	const TiledImageLevel *level = data->levels + key.level;
+	const u8 *tile = data->tiles + level->offset + (u64)(key.tileY * level->tilesX + key.tileX) * kTiledImage_TileBytes;
+	D3DLOCKED_RECT lockedRect;
+	if((*texture)->LockRect(0, &lockedRect, NULL, D3DLOCK_DISCARD) != D3D_OK)
+		return false;
+	for(u32 y = 0; y < kTiledImage_TileSize; ++y) {
+		memcpy((unsigned char *)lockedRect.pBits + lockedRect.Pitch * (s64)y, tile + y * kTiledImage_TileSize * 4, kTiledImage_TileSize * 4);
+	}
+	(*texture)->UnlockRect(0);
+	return true;
+}
+
+// bIgnoreBudget is for the pinned fallback tiles - there are only a few per image, and without
+// them a missing tile would draw nothing.
+static u32 ImGui_ImageTiled_RequestTile(const TiledImageData *data, u32 level, u32 tileX, u32 tileY, bool bIgnoreBudget)
+{
+	tileCacheKey key = { data->userId.id, level, tileX, tileY };
+	u32 slot = tileCache_find(&s_tileCache, key);
+	if(slot != kTileCache_InvalidSlot)
+		return slot;
+
+	if(!g_pTiledDevice || (!bIgnoreBudget && s_uploadsThisFrame >= s_maxUploadsPerFrame))
+		return kTileCache_InvalidSlot;
+
+	slot = tileCache_acquire(&s_tileCache, key, nullptr, nullptr);
+	if(slot == kTileCache_InvalidSlot)
+		return kTileCache_InvalidSlot;
+
+	++s_uploadsThisFrame;
+	if(!ImGui_ImageTiled_Upload(slot, data, key)) {
+		tileCache_release_slot(&s_tileCache, slot);
+		return kTileCache_InvalidSlot;
+	}
+	return slot;
+}
+
+// Draws the image-space rect imageMin..imageMax covered by one tile of the desired level,
+// falling back to coarser resident levels when that tile isn't available yet.  The covering tile
+// of the coarsest level is requested first and pinned, so the fallback always has something.
+static void ImGui_ImageTiled_DrawTile(const TiledImageData *data, ImDrawList *drawList, u32 level, u32 tileX, u32 tileY,
+                                      ImVec2 imageMin, ImVec2 imageMax, ImVec2 screenMin, ImVec2 screenMax)
+{
+	u32 coarsest = data->numLevels - 1;
+	u32 coarsestSlot = ImGui_ImageTiled_RequestTile(data, coarsest, tileX >> (coarsest - level), tileY >> (coarsest - level), true);
+	tileCache_pin_slot(&s_tileCache, coarsestSlot);
+
+	for(u32 candidate = level; candidate < data->numLevels; ++candidate) {
+		u32 shift = candidate - level;
+		u32 candidateX = tileX >> shift;
+		u32 candidateY = tileY >> shift;
+		u32 slot;
+		if(candidate == coarsest) {
+			slot = coarsestSlot;
+		} else if(candidate == level) {
+			slot = ImGui_ImageTiled_RequestTile(data, candidate, candidateX, candidateY, false);
+		} else {
+			tileCacheKey key = { data->userId.id, candidate, candidateX, candidateY };
+			slot = tileCache_find(&s_tileCache, key);
+		}
+		if(slot == kTileCache_InvalidSlot)
+			continue;
+
+		const TiledImageLevel *candidateLevel = data->levels + candidate;
+		float scaleX = (float)candidateLevel->width / (float)data->width;
+		float scaleY = (float)candidateLevel->height / (float)data->height;
+		float tileOriginX = (float)(candidateX * kTiledImage_TileSize);
+		float tileOriginY = (float)(candidateY * kTiledImage_TileSize);
+		ImVec2 uv0((imageMin.x * scaleX - tileOriginX) / kTiledImage_TileSize, (imageMin.y * scaleY - tileOriginY) / kTiledImage_TileSize);
+		ImVec2 uv1((imageMax.x * scaleX - tileOriginX) / kTiledImage_TileSize, (imageMax.y * scaleY - tileOriginY) / kTiledImage_TileSize);
+		drawList->AddImage(s_tileTextures[slot], screenMin, screenMax, uv0, uv1, 0xFFFFFFFF);
+		if(candidate != level) {
+			++s_missingThisFrame;
+		}
+		return;
+	}
+	++s_missingThisFrame;
+}
+
+void ImGui_ImageTiled_Draw(TiledImageId id, ImDrawList *drawList, ImVec2 start, ImVec2 end, ImVec2 uv0, ImVec2 uv1)
+{
+	const TiledImageData *data = ImGui_ImageTiled_Find(id);
+	if(!data || !data->tiles || !s_tileTextures || end.x <= start.x || end.y <= start.y || uv1.x <= uv0.x || uv1.y <= uv0.y)
+		return;
+
+	// image-space region being shown, and screen pixels per image pixel
+	ImVec2 srcMin(uv0.x * data->width, uv0.y * data->height);
+	ImVec2 srcMax(uv1.x * data->width, uv1.y * data->height);
+	float scaleX = (end.x - start.x) / (srcMax.x - srcMin.x);
+	float scaleY = (end.y - start.y) / (srcMax.y - srcMin.y);
+	float scale = ImMax(scaleX, scaleY);
+	u32 level = 0;
+	if(scale < 1.0f) {
+		level = (u32)floorf(log2f(1.0f / scale));
+		level = BB_MIN(level, data->numLevels - 1);
+	}
+
+	// only walk tiles that survive clipping
+	ImVec2 clipMin = drawList->GetClipRectMin();
+	ImVec2 clipMax = drawList->GetClipRectMax();
+	ImVec2 visMin(ImMax(start.x, clipMin.x), ImMax(start.y, clipMin.y));
+	ImVec2 visMax(ImMin(end.x, clipMax.x), ImMin(end.y, clipMax.y));
+	if(visMax.x <= visMin.x || visMax.y <= visMin.y)
+		return;
+
+	const TiledImageLevel *levelData = data->levels + level;
+	float levelScaleX = (float)levelData->width / (float)data->width;
+	float levelScaleY = (float)levelData->height / (float)data->height;
+	float visImageX0 = srcMin.x + (visMin.x - start.x) / scaleX;
+	float visImageY0 = srcMin.y + (visMin.y - start.y) / scaleY;
+	float visImageX1 = srcMin.x + (visMax.x - start.x) / scaleX;
+	float visImageY1 = srcMin.y + (visMax.y - start.y) / scaleY;
+	u32 tileX0 = (u32)ImMax(0.0f, visImageX0 * levelScaleX) / kTiledImage_TileSize;
+	u32 tileY0 = (u32)ImMax(0.0f, visImageY0 * levelScaleY) / kTiledImage_TileSize;
+	u32 tileX1 = BB_MIN(levelData->tilesX - 1, (u32)ImMax(0.0f, visImageX1 * levelScaleX) / kTiledImage_TileSize);
+	u32 tileY1 = BB_MIN(levelData->tilesY - 1, (u32)ImMax(0.0f, visImageY1 * levelScaleY) / kTiledImage_TileSize);
+
+	u32 missingBefore = s_missingThisFrame;
+	for(u32 tileY = tileY0; tileY <= tileY1; ++tileY) {
+		for(u32 tileX = tileX0; tileX <= tileX1; ++tileX) {
+			u32 levelX0 = tileX * kTiledImage_TileSize;
+			u32 levelY0 = tileY * kTiledImage_TileSize;
+			u32 levelX1 = BB_MIN(levelX0 + kTiledImage_TileSize, levelData->width);
+			u32 levelY1 = BB_MIN(levelY0 + kTiledImage_TileSize, levelData->height);
+			ImVec2 imageMin((float)levelX0 / levelScaleX, (float)levelY0 / levelScaleY);
+			ImVec2 imageMax((float)levelX1 / levelScaleX, (float)levelY1 / levelScaleY);
+			ImVec2 screenMin(start.x + (imageMin.x - srcMin.x) * scaleX, start.y + (imageMin.y - srcMin.y) * scaleY);
+			ImVec2 screenMax(start.x + (imageMax.x - srcMin.x) * scaleX, start.y + (imageMax.y - srcMin.y) * scaleY);
+			ImGui_ImageTiled_DrawTile(data, drawList, level, tileX, tileY, imageMin, imageMax, screenMin, screenMax);
+		}
+	}
+
+	if(s_missingThisFrame != missingBefore) {
+		// keep rendering until the visible tiles have streamed in
+		Imgui_Core_RequestRender();
+	}
+}
+
+static void ImGui_ImageTiled_ReleaseTextures()
+{
+	if(!s_tileTextures)
+		return;
+	for(u32 i = 0; i < s_tileCache.numSlots; ++i) {
+		if(s_tileTextures[i]) {
+			s_tileTextures[i]->Release();
+			s_tileTextures[i] = nullptr;
+		}
+	}
+}
+
+void ImGui_ImageTiled_SetResidency(u32 maxResidentTiles, u32 maxUploadsPerFrame)
+{
+	s_maxUploadsPerFrame = BB_MAX(1u, maxUploadsPerFrame);
+	maxResidentTiles = BB_MAX((u32)kTiledImage_MinResidentTiles, maxResidentTiles);
+	if(maxResidentTiles != s_maxResidentTiles) {
+		s_maxResidentTiles = maxResidentTiles;
+		if(s_tileTextures) {
+			ImGui_ImageTiled_ReleaseTextures();
+			free(s_tileTextures);
+			s_tileTextures = nullptr;
+			tileCache_reset(&s_tileCache);
+			tileCache_init(&s_tileCache, s_maxResidentTiles);
+			s_tileTextures = (LPDIRECT3DTEXTURE9 *)calloc(s_tileCache.numSlots, sizeof(LPDIRECT3DTEXTURE9));
+		}
+	}
+}
+
+TiledImageStats ImGui_ImageTiled_GetStats()
+{
+	TiledImageStats stats = { BB_EMPTY_INITIALIZER };
+	stats.residentTiles = tileCache_count_occupied(&s_tileCache);
+	stats.maxResidentTiles = s_tileCache.numSlots;
+	stats.uploadsThisFrame = s_uploadsThisFrame;
+	stats.missingThisFrame = s_missingThisFrame;
+	return stats;
+}
+
+void ImGui_ImageTiled_InvalidateDeviceObjects()
+{
+	ImGui_ImageTiled_ReleaseTextures();
+	tileCache_clear(&s_tileCache);
+}
+
+void ImGui_ImageTiled_NewFrame()
+{
+	for(u32 i = 0; i < s_tiledImages.count;) {
+		TiledImageData *data = s_tiledImages.data + i;
+		if((data->flags & kTiledImage_PendingDestroy) == 0) {
+			++i;
+		} else {
+			tileCache_evict_image(&s_tileCache, data->userId.id);
+			ImGui_ImageTiled_FreeTileStore(data);
+			bba_erase(s_tiledImages, i);
+		}
+	}
+	tileCache_new_frame(&s_tileCache);
+	s_uploadsThisFrame = 0;
+	s_missingThisFrame = 0;
+}
+
+bool ImGui_ImageTiled_Init(IDirect3DDevice9 *device)
+{
+	ImGui_ImageTiled_InvalidateDeviceObjects();
+	if(!s_tileTextures) {
+		tileCache_init(&s_tileCache, s_maxResidentTiles);
+		s_tileTextures = (LPDIRECT3DTEXTURE9 *)calloc(s_tileCache.numSlots, sizeof(LPDIRECT3DTEXTURE9));
+	}
+	g_pTiledDevice = device;
+	return s_tileTextures != nullptr;
+}
+
+void ImGui_ImageTiled_Shutdown()
+{
+	ImGui_ImageTiled_InvalidateDeviceObjects();
+	for(u32 i = 0; i < s_tiledImages.count; ++i) {
+		ImGui_ImageTiled_FreeTileStore(s_tiledImages.data + i);
+	}
+	bba_free(s_tiledImages);
+	free(s_tileTextures);
+	s_tileTextures = nullptr;
+	tileCache_reset(&s_tileCache);
+	g_pTiledDevice = nullptr;
+}
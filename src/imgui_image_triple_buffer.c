@@ -0,0 +1,93 @@
+// Copyright (c) 2012-2019 Matt Campbell
+// MIT license (see License.txt)
+
+#include "imgui_image_triple_buffer.h"
+#include <stdlib.h>
+#include <string.h>
+
+// The state is packed into one LONG so producer and consumer can each swap their buffer with the
+// shared "ready" buffer in a single compare-exchange:
+//   bits 0-1 back (producer), bits 2-3 ready (shared), bits 4-5 present (consumer), bit 6 fresh
+enum {
+	kTripleBuffer_IndexMask = 3,
+	kTripleBuffer_ReadyShift = 2,
+	kTripleBuffer_PresentShift = 4,
+	kTripleBuffer_Fresh = 0x40,
+	kTripleBuffer_Initial = 0 | (1 << kTripleBuffer_ReadyShift) | (2 << kTripleBuffer_PresentShift),
+};
+
+static u32 tripleBuffer_index(LONG state, u32 shift)
+{
+	return (u32)(state >> shift) & kTripleBuffer_IndexMask;
+}
+
+b32 tripleBuffer_init(tripleBuffer *tb, u64 frameBytes)
+{
+	u32 i;
+	memset(tb, 0, sizeof(*tb));
+	tb->frameBytes = frameBytes;
+	tb->state = kTripleBuffer_Initial;
+	for(i = 0; i < BB_ARRAYSIZE(tb->buffers); ++i) {
+		tb->buffers[i] = (u8 *)calloc(1, (size_t)frameBytes);
+		if(!tb->buffers[i]) {
+			tripleBuffer_reset(tb);
+			return false;
+		}
+	}
+	return true;
+}
+
+void tripleBuffer_reset(tripleBuffer *tb)
+{
+	u32 i;
+	for(i = 0; i < BB_ARRAYSIZE(tb->buffers); ++i) {
+		free(tb->buffers[i]);
+	}
+	memset(tb, 0, sizeof(*tb));
+}
+
+u8 *tripleBuffer_back(tripleBuffer *tb)
+{
+	return tb->buffers[tripleBuffer_index(tb->state, 0)];
+}
+
+// Swaps back and ready, marking ready as fresh.  If the previous ready frame was never consumed it
+// is recycled as the new back buffer, i.e. dropped.
+void tripleBuffer_publish(tripleBuffer *tb)
+{
+	LONG oldState, newState;
+	do {
+		u32 back, ready, present;
+		oldState = tb->state;
+		back = tripleBuffer_index(oldState, 0);
+		ready = tripleBuffer_index(oldState, kTripleBuffer_ReadyShift);
+		present = tripleBuffer_index(oldState, kTripleBuffer_PresentShift);
+		newState = (LONG)(ready | (back << kTripleBuffer_ReadyShift) | (present << kTripleBuffer_PresentShift) | kTripleBuffer_Fresh);
+	} while(InterlockedCompareExchange(&tb->state, newState, oldState) != oldState);
+	InterlockedIncrement64(&tb->published);
+	if(oldState & kTripleBuffer_Fresh) {
+		InterlockedIncrement64(&tb->dropped);
+	}
+}
+
+// Swaps present and ready if a fresh frame was published.
+const u8 *tripleBuffer_acquire(tripleBuffer *tb)
+{
+	LONG oldState, newState;
+	do {
+		u32 back, ready, present;
+		oldState = tb->state;
+		if((oldState & kTripleBuffer_Fresh) == 0)
+			return NULL;
+		back = tripleBuffer_index(oldState, 0);
+		ready = tripleBuffer_index(oldState, kTripleBuffer_ReadyShift);
+		present = tripleBuffer_index(oldState, kTripleBuffer_PresentShift);
+		newState = (LONG)(back | (present << kTripleBuffer_ReadyShift) | (ready << kTripleBuffer_PresentShift));
+	} while(InterlockedCompareExchange(&tb->state, newState, oldState) != oldState);
+	return tb->buffers[tripleBuffer_index(newState, kTripleBuffer_PresentShift)];
+}
+
+const u8 *tripleBuffer_present(tripleBuffer *tb)
+{
+	return tb->buffers[tripleBuffer_index(tb->state, kTripleBuffer_PresentShift)];
+}
@@ -4,7 +4,11 @@
 #include "imgui_input_text.h"
 #include "bb_array.h"
 #include "imgui_core.h"
+#include "imgui_text_buffer.h"
+#include "imgui_text_search.h"
+#include "keys.h"
 #include "sb.h"
+#include <string.h>
 
 // warning C4820 : 'StructName' : '4' bytes padding added after data member 'MemberName'
 // warning C4365: '=': conversion from 'ImGuiTabItemFlags' to 'ImGuiID', signed/unsigned mismatch
@@ -14,8 +18,77 @@ BB_WARNING_POP
 
 // InputTextMultilineScrolling and supporting functions adapted from https://github.com/ocornut/imgui/issues/383
 
+// Start offset and pixel width of each line of text, so cursor-to-scroll math is a binary search and
+// the text extents don't need a CalcTextSize over the whole buffer each frame.  The callback in
+// InputTextEx doesn't report what was edited, so each line also keeps a hash of its bytes, and an
+// update re-measures only the lines between those still matching at either end of the text - only
+// comparing lines near the cursor when the callback saw where it was before and after.  The
+// index is updated when ImGui reports an edit or activation, or when the buffer pointer or length
+// changes, e.g. when the application appends to or replaces the text.
+struct TextLine {
+	u32 start;
+	u32 hash;
+	float width;
+};
+
+struct TextLines {
+	u32 count;
+	u32 allocated;
+	TextLine *data;
+};
+
+struct TextLineIndex {
+	TextLines lines;
+	const char *buf; // the buffer last indexed
+	const ImFont *font;
+	float fontSize;
+	float maxWidth;
+	u32 len;   // length of the text last indexed
+	u32 edits; // bumped whenever text changes, as the version for searches over it
+};
+
+// Per-widget states come from fixed-size block pools, and are reclaimed once their widget hasn't
+// been drawn for a while, so UIs with dynamic IDs (e.g. an editor per list row) don't grow without bound.
+struct WidgetStateOwner {
+	ImGuiStorage *storage; // window storage holding the pointer to the state - cleared on reclaim
+	ImGuiID key;
+	int lastUsedFrame;
+};
+
+struct WidgetStatePoolChunks {
+	u32 count;
+	u32 allocated;
+	u8 **data;
+};
+
+struct WidgetStatePool {
+	WidgetStatePoolChunks chunks;
+	void *freeList;
+	u32 liveBlocks;
+	u32 freeBlocks;
+};
+
+struct WidgetStateCollector {
+	int lastCollectFrame;
+	u32 maxUnusedFrames;
+	u32 reclaimed;
+};
+
+struct SbInputCounters {
+	u32 resizes;
+	u32 grows;
+	u32 strlens; // by the char buffer overloads, which have no other way to see outside changes
+};
+
+enum {
+	kWidgetStatePool_BlocksPerChunk = 32,
+	kWidgetState_CollectIntervalFrames = 60,
+	kWidgetState_DefaultMaxUnusedFrames = 600,
+};
+
 struct MultilineScrollState {
-	const char *externalBuf = nullptr;
+	TextLineIndex lineIndex = {};
+	WidgetStateOwner owner = {};
 
 	float scrollRegionX = 0.0f;
 	float scrollX = 0.0f;
@@ -23,15 +96,95 @@ struct MultilineScrollState {
 	float scrollY = 0.0f;
 
 	int oldCursorPos = 0;
+	int cursorPos = 0;
+	b32 bCursorMoved = false;
 
 	b32 bHasScrollTargetX = false;
 	float scrollTargetX = 0.0f;
 	b32 bHasScrollTargetY = false;
 	float scrollTargetY = 0.0f;
 
+	// search match to select - applied by the callback, so only while the widget is active
+	b32 bSelectPending = false;
+	int selectStart = 0;
+	int selectEnd = 0;
+
+	// what the callback saw of the text, so InputTextScrollingEx needn't measure it, and the span
+	// this frame's edits can have touched - between the cursor and selection of the last frame and
+	// this one, as every edit but undo and redo happens there
+	int callbackFrame = -1;
+	u32 callbackLen = 0;
+	u32 lastCursorMin = 0; // start of the cursor and selection as of the last callback
+	u32 editStart = 0;     // this frame's edits are within editStart..editEnd of the new text
+	u32 editEnd = 0;
+	b32 bEditSpanValid = false;
 	u8 pad[4];
+
+	// set for the duration of InputTextEx when the text lives in an sb_t
+	u32 sbMaxSize = 0;
+	sb_t *sb = nullptr;
 };
 
+// TextViewer - read-only text that is indexed once by line, then only the visible lines are laid
+// out and drawn each frame.  Positions are line/column (byte within the line) pairs.
+
+struct TextViewerLines {
+	u32 count;
+	u32 allocated;
+	u32 *data; // start offset of each line
+};
+
+struct TextViewerPos {
+	u32 line;
+	u32 col;
+};
+
+struct TextViewerState {
+	TextViewerLines lineStarts = {};
+	WidgetStateOwner owner = {};
+	u64 textVersion = 0;        // the caller's version of the indexed text
+	const char *text = nullptr; // the text indexed
+	u32 restarts = 0;           // bumped whenever indexing starts over, as the version for searches
+	u32 indexedLen = 0;
+	u32 longestLine = 0;
+	float longestLineWidth = 0.0f;
+	TextViewerPos anchor = {};
+	TextViewerPos cursor = {};
+	b32 bDragging = false;
+	b32 bLongestLineDirty = false;
+	char firstByte = '\0'; // the ends of the indexed text, to notice it being replaced without a new textVersion
+	char lastByte = '\0';
+	u8 pad[6];
+};
+
+// InputTextMultiline for a gapBuffer - InputTextEx edits a window of lines copied into scratch.
+struct GapBufferEditState {
+	gapBufferWindow window = {};
+	WidgetStateOwner owner = {};
+	sb_t scratch = {};       // the window text, as edited by InputTextEx
+	gapBuffer *gb = nullptr; // set for the duration of InputTextEx
+	u64 cursor = 0;          // offset in gb of the cursor, as of the last callback
+	u64 pendingCursor = 0;   // applied by the callback once the editor is active
+	float maxWidth = 0.0f;   // widest line measured so far
+	int focusFrame = -1;     // frame a click opened the window on
+	b32 bCursorPending = false;
+	b32 bCursorMoved = false;
+	b32 bChanged = false;
+	u8 pad[4];
+};
+
+typedef struct GapBufferEditStates_s {
+	u32 count;
+	u32 allocated;
+	GapBufferEditState **data;
+} GapBufferEditStates_t;
+
+typedef struct TextViewerStates_s {
+	u32 count;
+	u32 allocated;
+	TextViewerState **data;
+} TextViewerStates_t;
+
 typedef struct MultilineScrollStates_s {
 	u32 count;
 	u32 allocated;
@@ -39,93 +192,569 @@ typedef struct MultilineScrollStates_s {
 } MultilineScrollStates_t;
 
 static MultilineScrollStates_t s_multilineScrollStates;
+static TextViewerStates_t s_textViewerStates;
+static GapBufferEditStates_t s_gapBufferEditStates;
+static WidgetStatePool s_multilineScrollStatePool;
+static WidgetStatePool s_textViewerStatePool;
+static WidgetStatePool s_gapBufferEditStatePool;
+static WidgetStateCollector s_widgetStateCollector = { 0, kWidgetState_DefaultMaxUnusedFrames, 0 };
+static SbInputCounters s_sbInputCounters;
+static void Imgui_Core_TextViewer_Free(TextViewerState *state);
+static void Imgui_Core_GapBufferEdit_Free(GapBufferEditState *state);
 
 namespace ImGui
 {
-	static bool InputTextScrollingEx(const char *label, char *buf, size_t buf_size, const ImVec2 &size, ImGuiInputTextFlags flags);
+	static bool InputTextScrollingEx(const char *label, char *buf, size_t buf_size, sb_t *sb, const ImVec2 &size, ImGuiInputTextFlags flags, textSearch *search);
+}
+
+static void Imgui_Core_LineIndex_Reset(TextLineIndex *index)
+{
+	bba_free(index->lines);
+	memset(index, 0, sizeof(*index));
+}
+
+static void *Imgui_Core_WidgetStatePool_Alloc(WidgetStatePool *pool, size_t blockSize)
+{
+	if(!pool->freeList) {
+		u8 *chunk = (u8 *)malloc(blockSize * kWidgetStatePool_BlocksPerChunk);
+		if(!chunk)
+			return nullptr;
+		bba_push(pool->chunks, chunk);
+		for(u32 i = kWidgetStatePool_BlocksPerChunk; i-- > 0;) {
+			void **block = (void **)(chunk + blockSize * i);
+			*block = pool->freeList;
+			pool->freeList = block;
+		}
+		pool->freeBlocks += kWidgetStatePool_BlocksPerChunk;
+	}
+	void **block = (void **)pool->freeList;
+	pool->freeList = *block;
+	--pool->freeBlocks;
+	++pool->liveBlocks;
+	return block;
+}
+
+static void Imgui_Core_WidgetStatePool_Free(WidgetStatePool *pool, void *block)
+{
+	*(void **)block = pool->freeList;
+	pool->freeList = block;
+	--pool->liveBlocks;
+	++pool->freeBlocks;
+}
+
+static void Imgui_Core_WidgetStatePool_Reset(WidgetStatePool *pool)
+{
+	for(u32 i = 0; i < pool->chunks.count; ++i) {
+		free(pool->chunks.data[i]);
+	}
+	bba_free(pool->chunks);
+	memset(pool, 0, sizeof(*pool));
+}
+
+static void Imgui_Core_MultilineScrollState_Free(MultilineScrollState *state)
+{
+	Imgui_Core_LineIndex_Reset(&state->lineIndex);
+	Imgui_Core_WidgetStatePool_Free(&s_multilineScrollStatePool, state);
 }
 
 void ImGui::InputTextShutdown(void)
 {
 	for(u32 i = 0; i < s_multilineScrollStates.count; ++i) {
-		delete s_multilineScrollStates.data[i];
+		Imgui_Core_MultilineScrollState_Free(s_multilineScrollStates.data[i]);
 	}
 	bba_free(s_multilineScrollStates);
+	for(u32 i = 0; i < s_textViewerStates.count; ++i) {
+		Imgui_Core_TextViewer_Free(s_textViewerStates.data[i]);
+	}
+	bba_free(s_textViewerStates);
+	for(u32 i = 0; i < s_gapBufferEditStates.count; ++i) {
+		Imgui_Core_GapBufferEdit_Free(s_gapBufferEditStates.data[i]);
+	}
+	bba_free(s_gapBufferEditStates);
+	Imgui_Core_WidgetStatePool_Reset(&s_multilineScrollStatePool);
+	Imgui_Core_WidgetStatePool_Reset(&s_textViewerStatePool);
+	Imgui_Core_WidgetStatePool_Reset(&s_gapBufferEditStatePool);
+	s_widgetStateCollector.lastCollectFrame = 0;
+	s_widgetStateCollector.reclaimed = 0;
+	s_sbInputCounters = SbInputCounters();
+}
+
+u32 ImGui::InputTextSetStateLifetime(u32 maxUnusedFrames)
+{
+	u32 prevMaxUnusedFrames = s_widgetStateCollector.maxUnusedFrames;
+	s_widgetStateCollector.maxUnusedFrames = maxUnusedFrames;
+	return prevMaxUnusedFrames;
+}
+
+static bool Imgui_Core_WidgetState_IsStale(const WidgetStateOwner *owner, int frame)
+{
+	return frame - owner->lastUsedFrame > (int)s_widgetStateCollector.maxUnusedFrames;
+}
+
+// Reclaimed states drop their storage entry, so a widget that reappears later simply starts with a
+// fresh state.
+static void Imgui_Core_WidgetState_Reclaim(int frame)
+{
+	s_widgetStateCollector.lastCollectFrame = frame;
+	for(u32 i = 0; i < s_multilineScrollStates.count;) {
+		MultilineScrollState *state = s_multilineScrollStates.data[i];
+		if(Imgui_Core_WidgetState_IsStale(&state->owner, frame)) {
+			state->owner.storage->SetVoidPtr(state->owner.key, nullptr);
+			Imgui_Core_MultilineScrollState_Free(state);
+			s_multilineScrollStates.data[i] = s_multilineScrollStates.data[--s_multilineScrollStates.count];
+			++s_widgetStateCollector.reclaimed;
+		} else {
+			++i;
+		}
+	}
+	for(u32 i = 0; i < s_textViewerStates.count;) {
+		TextViewerState *state = s_textViewerStates.data[i];
+		if(Imgui_Core_WidgetState_IsStale(&state->owner, frame)) {
+			state->owner.storage->SetVoidPtr(state->owner.key, nullptr);
+			Imgui_Core_TextViewer_Free(state);
+			s_textViewerStates.data[i] = s_textViewerStates.data[--s_textViewerStates.count];
+			++s_widgetStateCollector.reclaimed;
+		} else {
+			++i;
+		}
+	}
+	for(u32 i = 0; i < s_gapBufferEditStates.count;) {
+		GapBufferEditState *state = s_gapBufferEditStates.data[i];
+		if(Imgui_Core_WidgetState_IsStale(&state->owner, frame)) {
+			state->owner.storage->SetVoidPtr(state->owner.key, nullptr);
+			Imgui_Core_GapBufferEdit_Free(state);
+			s_gapBufferEditStates.data[i] = s_gapBufferEditStates.data[--s_gapBufferEditStates.count];
+			++s_widgetStateCollector.reclaimed;
+		} else {
+			++i;
+		}
+	}
+}
+
+// Runs every kWidgetState_CollectIntervalFrames.  The frame count going backwards means another
+// ImGui context is drawing - collection restarts its interval there.
+static void Imgui_Core_WidgetState_Collect(void)
+{
+	int frame = ImGui::GetFrameCount();
+	if(frame < s_widgetStateCollector.lastCollectFrame) {
+		s_widgetStateCollector.lastCollectFrame = frame;
+	}
+	if(!s_widgetStateCollector.maxUnusedFrames || frame - s_widgetStateCollector.lastCollectFrame < kWidgetState_CollectIntervalFrames)
+		return;
+	Imgui_Core_WidgetState_Reclaim(frame);
+}
+
+void ImGui::InputTextCollectStates(void)
+{
+	if(s_widgetStateCollector.maxUnusedFrames) {
+		Imgui_Core_WidgetState_Reclaim(ImGui::GetFrameCount());
+	}
+}
+
+InputTextStateStats ImGui::InputTextGetStateStats(void)
+{
+	InputTextStateStats stats = { BB_EMPTY_INITIALIZER };
+	stats.liveStates = s_multilineScrollStatePool.liveBlocks + s_textViewerStatePool.liveBlocks + s_gapBufferEditStatePool.liveBlocks;
+	stats.freeStates = s_multilineScrollStatePool.freeBlocks + s_textViewerStatePool.freeBlocks + s_gapBufferEditStatePool.freeBlocks;
+	stats.reclaimedStates = s_widgetStateCollector.reclaimed;
+	stats.sbResizes = s_sbInputCounters.resizes;
+	stats.sbGrows = s_sbInputCounters.grows;
+	stats.strlens = s_sbInputCounters.strlens;
+	stats.poolBytes = (u64)s_multilineScrollStatePool.chunks.count * kWidgetStatePool_BlocksPerChunk * sizeof(MultilineScrollState) +
+	                  (u64)s_textViewerStatePool.chunks.count * kWidgetStatePool_BlocksPerChunk * sizeof(TextViewerState) +
+	                  (u64)s_gapBufferEditStatePool.chunks.count * kWidgetStatePool_BlocksPerChunk * sizeof(GapBufferEditState);
+	for(u32 i = 0; i < s_multilineScrollStates.count; ++i) {
+		const TextLineIndex *index = &s_multilineScrollStates.data[i]->lineIndex;
+		stats.indexBytes += (u64)index->lines.allocated * sizeof(TextLine);
+	}
+	for(u32 i = 0; i < s_textViewerStates.count; ++i) {
+		stats.indexBytes += (u64)s_textViewerStates.data[i]->lineStarts.allocated * sizeof(u32);
+	}
+	for(u32 i = 0; i < s_gapBufferEditStates.count; ++i) {
+		const GapBufferEditState *state = s_gapBufferEditStates.data[i];
+		stats.indexBytes += (u64)state->window.linesAllocated * sizeof(u64) + state->scratch.allocated;
+	}
+	return stats;
 }
 
-static int Imgui_Core_FindLineStart(const char *buf, int cursorPos)
+// ImGui raises a resize event whenever it writes edited text back to a resizable buffer, not only
+// when it grows, so BufTextLen here is the authoritative new length.
+int ImGui::InputTextResizeCallback(ImGuiInputTextCallbackData *data, sb_t *sb, u32 maxSize)
 {
-	while((cursorPos > 0) && (buf[cursorPos - 1] != '\n')) {
-		--cursorPos;
+	++s_sbInputCounters.resizes;
+	u32 wanted = BB_MIN((u32)data->BufTextLen + 1, maxSize);
+	if(sb->allocated < wanted) {
+		++s_sbInputCounters.grows;
+		sb_reserve(sb, wanted);
+	}
+	if(sb->data) {
+		data->Buf = sb->data;
+		data->BufSize = (int)BB_MIN(sb->allocated, maxSize);
 	}
-	return cursorPos;
+	// ImGui copies in at most BufSize - 1 characters once this returns
+	sb->count = sb->data ? (u32)ImMin(data->BufTextLen, data->BufSize - 1) + 1 : 0;
+	return 0;
 }
 
-static int Imgui_Core_CountLines(const char *buf, int cursorPos)
+static u32 Imgui_Core_InputText_Strlen(const char *buf)
 {
-	int lines = 1;
-	int pos = 0;
-	while(buf[pos]) {
-		if(buf[pos] == '\n') {
-			++lines;
+	++s_sbInputCounters.strlens;
+	return (u32)strlen(buf);
+}
+
+static u32 Imgui_Core_InputText_SbLen(const sb_t *sb)
+{
+	return sb->count ? sb->count - 1 : 0;
+}
+
+// Index of the line containing pos: the last line starting at or before it.
+static u32 Imgui_Core_LineIndex_FindLine(const TextLineIndex *index, u32 pos)
+{
+	u32 lo = 0;
+	u32 hi = index->lines.count;
+	while(hi - lo > 1) {
+		u32 mid = lo + (hi - lo) / 2;
+		if(index->lines.data[mid].start <= pos) {
+			lo = mid;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+static float Imgui_Core_LineIndex_RescanMaxWidth(const TextLineIndex *index)
+{
+	float maxWidth = 0.0f;
+	for(u32 i = 0; i < index->lines.count; ++i) {
+		maxWidth = ImMax(maxWidth, index->lines.data[i].width);
+	}
+	return maxWidth;
+}
+
+static u32 Imgui_Core_LineIndex_Hash(const char *start, const char *end)
+{
+	// a word at a time, folding the high bits back down after each multiply so differences in them
+	// aren't lost, then MurmurHash3's finalizer
+	u64 hash = 14695981039346656037ull ^ (u64)(end - start);
+	while(end - start >= 8) {
+		u64 word;
+		memcpy(&word, start, sizeof(word));
+		hash = (hash ^ word) * 0x9e3779b97f4a7c15ull;
+		hash ^= hash >> 29;
+		start += 8;
+	}
+	while(start < end) {
+		hash = (hash ^ (u8)*start++) * 0x9e3779b97f4a7c15ull;
+		hash ^= hash >> 29;
+	}
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdull;
+	hash ^= hash >> 33;
+	hash *= 0xc4ceb9fe1a85ec53ull;
+	hash ^= hash >> 33;
+	return (u32)hash;
+}
+
+// End offset (the newline, or the end of the text) of line i as last indexed.
+static u32 Imgui_Core_LineIndex_LineEnd(const TextLineIndex *index, u32 i)
+{
+	return (i + 1 < index->lines.count) ? index->lines.data[i + 1].start - 1 : index->len;
+}
+
+// True if old line i appears unchanged in text, shifted by delta: same length and hash, bounded by
+// newlines (or the ends of the text) on both sides.
+static bool Imgui_Core_LineIndex_LineMatches(const TextLineIndex *index, u32 i, const char *text, u32 len, s64 delta)
+{
+	const TextLine *line = index->lines.data + i;
+	s64 start = (s64)line->start + delta;
+	s64 end = (s64)Imgui_Core_LineIndex_LineEnd(index, i) + delta;
+	if(start < 0 || end > (s64)len)
+		return false;
+	if(start > 0 && text[start - 1] != '\n')
+		return false;
+	if((i + 1 < index->lines.count) ? (end == (s64)len || text[end] != '\n') : end != (s64)len)
+		return false;
+	return Imgui_Core_LineIndex_Hash(text + start, text + end) == line->hash;
+}
+
+// Brings the index up to date with text, re-measuring only the lines between the unchanged lines
+// at the start and end of the text.  Text before editStart is known to be unchanged, as is text
+// after editEnd (shifted by the change in length), so only lines between those are compared.
+static void Imgui_Core_LineIndex_Update(TextLineIndex *index, const char *text, u32 len, u32 editStart, u32 editEnd)
+{
+	const ImFont *font = ImGui::GetFont();
+	float fontSize = ImGui::GetFontSize();
+	if(index->font != font || index->fontSize != fontSize) {
+		index->lines.count = 0;
+		index->font = font;
+		index->fontSize = fontSize;
+		index->maxWidth = 0.0f;
+	}
+	index->buf = text;
+
+	u32 count = index->lines.count;
+	s64 delta = (s64)len - (s64)index->len;
+	u32 first = 0;
+	u32 unchangedAfter = count; // old lines from here on are known to be unchanged
+	if(count && (editStart || editEnd < len) && (s64)editEnd - delta >= 0) {
+		first = Imgui_Core_LineIndex_FindLine(index, BB_MIN(editStart, index->len));
+		unchangedAfter = BB_MIN(Imgui_Core_LineIndex_FindLine(index, (u32)((s64)editEnd - delta)) + 1, count);
+		first = BB_MIN(first, unchangedAfter - 1);
+	}
+	while(first < unchangedAfter && Imgui_Core_LineIndex_LineMatches(index, first, text, len, 0)) {
+		++first;
+	}
+	if(first == unchangedAfter && count) {
+		if(!delta) {
+			index->len = len; // every line matches where it was
+			return;
 		}
-		if(pos == cursorPos)
+		--first; // whole lines were inserted or removed after it
+	}
+	u32 last = unchangedAfter;
+	while(first > 0 && last < count && (s64)index->lines.data[last].start + delta <= (s64)index->lines.data[first].start) {
+		--first; // repeated text can match at both ends - keep the spans apart
+	}
+	u32 scanStart = first < count ? index->lines.data[first].start : 0;
+	while(last > first + 1 && (s64)index->lines.data[last - 1].start + delta > (s64)scanStart &&
+	      Imgui_Core_LineIndex_LineMatches(index, last - 1, text, len, delta)) {
+		--last;
+	}
+
+	// old lines first..last are replaced by re-scanning the same span of the new text
+	bool bRescanMax = false;
+	for(u32 i = first; i < last; ++i) {
+		bRescanMax = bRescanMax || index->lines.data[i].width >= index->maxWidth;
+	}
+
+	u32 scanEndPos = (last < count) ? (u32)((s64)index->lines.data[last].start + delta) - 1 : len;
+	TextLines scanned = { BB_EMPTY_INITIALIZER };
+	float scannedMax = 0.0f;
+	for(u32 start = scanStart;;) {
+		const char *lineEnd = (const char *)memchr(text + start, '\n', scanEndPos - start);
+		u32 end = lineEnd ? (u32)(lineEnd - text) : scanEndPos;
+		TextLine line = { start, Imgui_Core_LineIndex_Hash(text + start, text + end), ImGui::CalcTextSize(text + start, text + end).x };
+		bba_push(scanned, line);
+		scannedMax = ImMax(scannedMax, line.width);
+		if(!lineEnd)
 			break;
-		++pos;
+		start = end + 1;
+	}
+
+	u32 replaced = last - first;
+	u32 newCount = count - replaced + scanned.count;
+	if(newCount > count && !bba_add_noclear(index->lines, newCount - count)) {
+		// out of memory - drop the index so the next update rebuilds it from scratch
+		bba_free(scanned);
+		bba_free(index->lines);
+		index->len = 0;
+		return;
 	}
-	return lines;
+	memmove(index->lines.data + first + scanned.count, index->lines.data + last, (count - last) * sizeof(TextLine));
+	memcpy(index->lines.data + first, scanned.data, scanned.count * sizeof(TextLine));
+	index->lines.count = newCount;
+	for(u32 i = first + scanned.count; i < newCount; ++i) {
+		index->lines.data[i].start = (u32)((s64)index->lines.data[i].start + delta);
+	}
+	bba_free(scanned);
+	index->len = len;
+	++index->edits;
+	index->maxWidth = bRescanMax ? Imgui_Core_LineIndex_RescanMaxWidth(index) : ImMax(index->maxWidth, scannedMax);
+}
+
+// Matches CalcTextSize(text): a trailing newline doesn't add a line.
+static ImVec2 Imgui_Core_LineIndex_TextSize(const TextLineIndex *index)
+{
+	u32 lines = index->lines.count;
+	if(lines > 1 && index->lines.data[lines - 1].start == index->len) {
+		--lines;
+	}
+	return ImVec2((float)(int)(index->maxWidth + 0.95f), (float)BB_MAX(lines, 1u) * index->fontSize);
 }
 
 static int Imgui_Core_InputTextMultilineScrollingCallback(ImGuiInputTextCallbackData *data)
 {
+	// scroll targets are computed after InputTextEx, once the line index reflects this frame's edits
 	MultilineScrollState *scrollState = (MultilineScrollState *)data->UserData;
+	if(data->EventFlag == ImGuiInputTextFlags_CallbackResize)
+		return ImGui::InputTextResizeCallback(data, scrollState->sb, scrollState->sbMaxSize);
+	if(scrollState->bSelectPending) {
+		scrollState->bSelectPending = false;
+		data->SelectionStart = scrollState->selectStart;
+		data->SelectionEnd = scrollState->selectEnd;
+		data->CursorPos = scrollState->selectEnd;
+	}
 	if(scrollState->oldCursorPos != data->CursorPos) {
-		const char *buf = data->Buf ? data->Buf : scrollState->externalBuf;
-		int lineStartPos = Imgui_Core_FindLineStart(buf, data->CursorPos);
-		int lines = Imgui_Core_CountLines(buf, data->CursorPos);
-
-		ImVec2 lineSize = ImGui::CalcTextSize(buf + lineStartPos, buf + data->CursorPos);
-		float cursorX = lineSize.x;
-		float cursorY = (float)lines * lineSize.y;
-		float scrollAmountX = scrollState->scrollRegionX * 0.25f;
-		float scrollAmountY = scrollState->scrollRegionY * 0.25f;
-
-		if(cursorX < scrollState->scrollX) {
-			scrollState->bHasScrollTargetX = true;
-			scrollState->scrollTargetX = ImMax(0.0f, cursorX - scrollAmountX);
-		} else if((cursorX - scrollState->scrollRegionX) >= scrollState->scrollX) {
-			scrollState->bHasScrollTargetX = true;
-			if((cursorX - scrollState->scrollRegionX) > scrollAmountX) {
-				scrollState->scrollTargetX = cursorX - scrollAmountX;
-			} else {
-				scrollState->scrollTargetX = cursorX - scrollState->scrollRegionX + scrollAmountX;
-			}
+		scrollState->cursorPos = data->CursorPos;
+		scrollState->bCursorMoved = true;
+	}
+
+	int frame = ImGui::GetFrameCount();
+	u32 cursorMin = (u32)ImMin(data->CursorPos, ImMin(data->SelectionStart, data->SelectionEnd));
+	u32 cursorMax = (u32)ImMax(data->CursorPos, ImMax(data->SelectionStart, data->SelectionEnd));
+	scrollState->bEditSpanValid = scrollState->callbackFrame == frame - 1;
+	scrollState->editStart = BB_MIN(scrollState->lastCursorMin, cursorMin);
+	scrollState->editEnd = cursorMax;
+	scrollState->lastCursorMin = cursorMin;
+	scrollState->callbackFrame = frame;
+	scrollState->callbackLen = (u32)data->BufTextLen;
+	return 0;
+}
+
+// Sets scroll targets that bring byte offset pos into view, if it isn't already.
+static void Imgui_Core_InputTextMultilineScrollingScrollTo(MultilineScrollState *scrollState, const char *buf, u32 bufLen, int pos)
+{
+	const TextLineIndex *index = &scrollState->lineIndex;
+	u32 cursorPos = BB_MIN((u32)ImMax(pos, 0), BB_MIN(bufLen, index->len));
+	u32 line = Imgui_Core_LineIndex_FindLine(index, cursorPos);
+	u32 lineStartPos = index->lines.count ? index->lines.data[line].start : 0;
+
+	ImVec2 lineSize = ImGui::CalcTextSize(buf + lineStartPos, buf + cursorPos);
+	float cursorX = lineSize.x;
+	float cursorY = (float)(line + 1) * lineSize.y;
+	float scrollAmountX = scrollState->scrollRegionX * 0.25f;
+	float scrollAmountY = scrollState->scrollRegionY * 0.25f;
+
+	if(cursorX < scrollState->scrollX) {
+		scrollState->bHasScrollTargetX = true;
+		scrollState->scrollTargetX = ImMax(0.0f, cursorX - scrollAmountX);
+	} else if((cursorX - scrollState->scrollRegionX) >= scrollState->scrollX) {
+		scrollState->bHasScrollTargetX = true;
+		if((cursorX - scrollState->scrollRegionX) > scrollAmountX) {
+			scrollState->scrollTargetX = cursorX - scrollAmountX;
+		} else {
+			scrollState->scrollTargetX = cursorX - scrollState->scrollRegionX + scrollAmountX;
 		}
+	}
 
-		if(cursorY < scrollState->scrollY) {
-			scrollState->bHasScrollTargetY = true;
-			scrollState->scrollTargetY = ImMax(0.0f, cursorY - scrollAmountY);
-		} else if((cursorY - scrollState->scrollRegionY) >= scrollState->scrollY) {
-			scrollState->bHasScrollTargetY = true;
-			if((cursorY - scrollState->scrollRegionY) > scrollAmountY) {
-				scrollState->scrollTargetY = cursorY - scrollAmountY;
-			} else {
-				scrollState->scrollTargetY = cursorY - scrollState->scrollRegionY + scrollAmountY;
-			}
+	if(cursorY < scrollState->scrollY) {
+		scrollState->bHasScrollTargetY = true;
+		scrollState->scrollTargetY = ImMax(0.0f, cursorY - scrollAmountY);
+	} else if((cursorY - scrollState->scrollRegionY) >= scrollState->scrollY) {
+		scrollState->bHasScrollTargetY = true;
+		if((cursorY - scrollState->scrollRegionY) > scrollAmountY) {
+			scrollState->scrollTargetY = cursorY - scrollAmountY;
+		} else {
+			scrollState->scrollTargetY = cursorY - scrollState->scrollRegionY + scrollAmountY;
 		}
+	}
+}
 
-		scrollState->oldCursorPos = data->CursorPos;
+static void Imgui_Core_InputTextMultilineScrollingUpdateTarget(MultilineScrollState *scrollState, const char *buf, u32 bufLen)
+{
+	if(scrollState->bCursorMoved) {
+		Imgui_Core_InputTextMultilineScrollingScrollTo(scrollState, buf, bufLen, scrollState->cursorPos);
+		scrollState->oldCursorPos = scrollState->cursorPos;
+		scrollState->bCursorMoved = false;
 	}
+}
 
-	return 0;
+enum {
+	kInputTextSearch_ScanBytesPerFrame = 64 * 1024 * 1024, // huge texts are searched over several frames
+};
+
+// The index is up to date with buf by now, so its edit count versions the text being searched.
+static void Imgui_Core_InputTextSearch_Update(MultilineScrollState *scrollState, textSearch *search, const char *buf, u32 bufLen, bool bFocused)
+{
+	const TextLineIndex *index = &scrollState->lineIndex;
+	if(!textSearch_update(search, buf, BB_MIN(bufLen, index->len), index->edits, kInputTextSearch_ScanBytesPerFrame)) {
+		Imgui_Core_RequestRender();
+	}
+	if(bFocused && key_is_pressed_this_frame(Key_F3)) {
+		if(ImGui::GetIO().KeyShift) {
+			textSearch_select_prev(search, (u64)ImMax(scrollState->cursorPos, 0));
+		} else {
+			textSearch_select_next(search, (u64)ImMax(scrollState->cursorPos, 0));
+		}
+	}
+	if(search->bScrollToCurrent && search->current < search->matches.count) {
+		const textSearchMatch *match = search->matches.data + search->current;
+		scrollState->bSelectPending = true;
+		scrollState->selectStart = (int)match->offset;
+		scrollState->selectEnd = (int)(match->offset + match->length);
+		Imgui_Core_InputTextMultilineScrollingScrollTo(scrollState, buf, bufLen, scrollState->selectEnd);
+		search->bScrollToCurrent = false;
+	}
+}
+
+// Highlights matches on the visible lines, over the text drawn by InputTextEx at origin.
+static void Imgui_Core_InputTextSearch_Draw(const MultilineScrollState *scrollState, const textSearch *search, const char *text, u32 textLen, ImVec2 origin)
+{
+	const TextLineIndex *index = &scrollState->lineIndex;
+	if(!search->matches.count || !index->lines.count || textLen != index->len)
+		return;
+
+	float lineHeight = index->fontSize;
+	const ImRect &clip = ImGui::GetCurrentWindow()->ClipRect;
+	float firstY = (clip.Min.y - origin.y) / lineHeight;
+	float lastY = (clip.Max.y - origin.y) / lineHeight;
+	u32 firstLine = (firstY > 0.0f) ? BB_MIN((u32)firstY, index->lines.count - 1) : 0u;
+	u32 endLine = (lastY > 0.0f) ? BB_MIN((u32)lastY + 1, index->lines.count) : 0u;
+	if(endLine <= firstLine)
+		return;
+	u32 visibleEnd = (endLine < index->lines.count) ? index->lines.data[endLine].start : textLen;
+
+	ImDrawList *drawList = ImGui::GetWindowDrawList();
+	ImU32 matchColor = ImGui::GetColorU32(ImGuiCol_PlotHistogram, 0.35f);
+	ImU32 currentColor = ImGui::GetColorU32(ImGuiCol_PlotHistogramHovered, 0.6f);
+	for(u32 i = textSearch_first_ending_after(search, index->lines.data[firstLine].start); i < search->matches.count; ++i) {
+		const textSearchMatch *match = search->matches.data + i;
+		if(match->offset >= visibleEnd || match->offset + match->length > textLen)
+			break;
+		u32 start = (u32)match->offset;
+		u32 end = (u32)(match->offset + match->length);
+		u32 line = Imgui_Core_LineIndex_FindLine(index, start);
+		float x0 = ImGui::CalcTextSize(text + index->lines.data[line].start, text + start).x;
+		float x1 = x0 + ImGui::CalcTextSize(text + start, text + end).x;
+		ImVec2 min(origin.x + x0, origin.y + lineHeight * (float)line);
+		drawList->AddRectFilled(min, ImVec2(origin.x + x1, min.y + lineHeight), (i == search->current) ? currentColor : matchColor);
+	}
 }
 
-static bool ImGui::InputTextScrollingEx(const char *label, char *buf, size_t buf_size, const ImVec2 &size, ImGuiInputTextFlags flags)
+// With sb, buf and buf_size are ignored: the text lives in sb, which grows on demand up to buf_size.
+static bool ImGui::InputTextScrollingEx(const char *label, char *buf, size_t buf_size, sb_t *sb, const ImVec2 &size, ImGuiInputTextFlags flags, textSearch *search)
 {
 	const char *labelVisibleEnd = FindRenderedTextEnd(label);
 	bool bMultiline = (flags & ImGuiInputTextFlags_Multiline) != 0;
 
-	ImVec2 textSize = CalcTextSize(buf);
+	Imgui_Core_WidgetState_Collect();
+	ImGuiID scrollStateKey = GetID("textInputScrollState");
+	ImGuiStorage *storage = GetStateStorage();
+	MultilineScrollState *scrollState = (MultilineScrollState *)storage->GetVoidPtr(scrollStateKey);
+	if(!scrollState) {
+		scrollState = (MultilineScrollState *)Imgui_Core_WidgetStatePool_Alloc(&s_multilineScrollStatePool, sizeof(MultilineScrollState));
+		if(scrollState) {
+			*scrollState = MultilineScrollState();
+			scrollState->owner.storage = storage;
+			scrollState->owner.key = scrollStateKey;
+			bba_push(s_multilineScrollStates, scrollState);
+			storage->SetVoidPtr(scrollStateKey, scrollState);
+		}
+	}
+	if(!scrollState)
+		return false;
+	scrollState->owner.lastUsedFrame = GetFrameCount();
+
+	char emptyText[1] = { '\0' };
+	int inputBufSize = (int)buf_size;
+	if(sb) {
+		buf = sb->data ? sb->data : emptyText;
+		inputBufSize = sb->data ? (int)sb->allocated : 1;
+		flags |= ImGuiInputTextFlags_CallbackResize;
+		scrollState->sb = sb;
+		scrollState->sbMaxSize = (u32)buf_size;
+	}
+
+	// while active, InputTextEx works from its own copy of the text, which the index already matches
+	TextLineIndex *lineIndex = &scrollState->lineIndex;
+	bool bWasActive = scrollState->callbackFrame == GetFrameCount() - 1;
+	u32 bufLen = sb ? Imgui_Core_InputText_SbLen(sb) : bWasActive ? lineIndex->len : Imgui_Core_InputText_Strlen(buf);
+	if(!lineIndex->lines.count || lineIndex->font != GetFont() || lineIndex->fontSize != GetFontSize() || lineIndex->buf != buf || lineIndex->len != bufLen) {
+		Imgui_Core_LineIndex_Update(lineIndex, buf, bufLen, 0, bufLen);
+	}
+	ImVec2 textSize = Imgui_Core_LineIndex_TextSize(lineIndex);
+
 	float scrollbarSize = GetStyle().ScrollbarSize;
 	float labelWidth = CalcTextSize(label, labelVisibleEnd).x;
 
@@ -182,35 +811,55 @@ static bool ImGui::InputTextScrollingEx(const char *label, char *buf, size_t buf
 		textBoxWidth = childWidth;
 	}
 
-	ImGuiID scrollStateKey = GetID("textInputScrollState");
-	ImGuiStorage *storage = GetStateStorage();
-	MultilineScrollState *scrollState = (MultilineScrollState *)storage->GetVoidPtr(scrollStateKey);
-	if(!scrollState) {
-		scrollState = new MultilineScrollState;
-		if(scrollState) {
-			bba_push(s_multilineScrollStates, scrollState);
-			storage->SetVoidPtr(scrollStateKey, scrollState);
-		}
-	}
-	if(!scrollState)
-		return false;
-
 	ImGuiWindowFlags childFlags = ImGuiWindowFlags_HorizontalScrollbar;
 	BeginChild(label, ImVec2(childWidth, childHeight), false, childFlags);
 	scrollState->scrollRegionX = ImMax(0.0f, GetWindowWidth() - scrollbarSize);
 	scrollState->scrollX = GetScrollX();
 	scrollState->scrollRegionY = ImMax(0.0f, GetWindowHeight() - scrollbarSize);
 	scrollState->scrollY = GetScrollY();
-	scrollState->externalBuf = buf;
 	int oldCursorPos = scrollState->oldCursorPos;
+	b32 bSelectWasPending = scrollState->bSelectPending;
 
 	PushItemWidth(textBoxWidth);
-	bool changed = InputTextEx(label, nullptr, buf, (int)buf_size, ImVec2(textBoxWidth, textBoxHeight),
+	bool changed = InputTextEx(label, nullptr, buf, inputBufSize, ImVec2(textBoxWidth, textBoxHeight),
 	                           flags | ImGuiInputTextFlags_CallbackAlways | ImGuiInputTextFlags_NoHorizontalScroll, Imgui_Core_InputTextMultilineScrollingCallback, scrollState);
 	PopItemWidth();
+	if(sb) {
+		buf = sb->data ? sb->data : emptyText; // the resize callback may have moved it
+		scrollState->sb = nullptr;
+	}
+	if(bSelectWasPending) {
+		scrollState->bSelectPending = false; // the callback only runs while active
+	}
 	if(IsItemActive() && Imgui_Core_HasFocus()) {
 		Imgui_Core_RequestRender();
 	}
+	// the resize callback keeps sb->count current.  For a char buffer, the callback sees the text
+	// InputTextEx is about to write back - without it (e.g. Escape restoring the text on
+	// deactivation) the text has to be measured.
+	bool bCallbackRan = scrollState->callbackFrame == GetFrameCount();
+	if(sb) {
+		bufLen = Imgui_Core_InputText_SbLen(sb);
+	} else if(bCallbackRan) {
+		bufLen = scrollState->callbackLen;
+	} else if(bWasActive || IsItemDeactivated()) {
+		bufLen = Imgui_Core_InputText_Strlen(buf);
+	}
+	if(IsItemActivated() || IsItemEdited() || lineIndex->buf != buf || lineIndex->len != bufLen) {
+		const ImGuiIO &io = GetIO();
+		bool bUndo = io.KeyCtrl && (IsKeyPressed(io.KeyMap[ImGuiKey_Z]) || IsKeyPressed(io.KeyMap[ImGuiKey_Y]));
+		if(bCallbackRan && scrollState->bEditSpanValid && !bUndo && !IsItemActivated()) {
+			Imgui_Core_LineIndex_Update(lineIndex, buf, bufLen, scrollState->editStart, BB_MIN(scrollState->editEnd, bufLen));
+		} else {
+			Imgui_Core_LineIndex_Update(lineIndex, buf, bufLen, 0, bufLen);
+		}
+	}
+	Imgui_Core_InputTextMultilineScrollingUpdateTarget(scrollState, buf, bufLen);
+	if(search) {
+		Imgui_Core_InputTextSearch_Update(scrollState, search, buf, bufLen, IsItemActive() || IsWindowFocused(ImGuiFocusedFlags_ChildWindows));
+		ImVec2 textOrigin(GetItemRectMin().x + GetStyle().FramePadding.x, GetItemRectMin().y + GetStyle().FramePadding.y);
+		Imgui_Core_InputTextSearch_Draw(scrollState, search, buf, bufLen, textOrigin);
+	}
 
 	if(scrollState->bHasScrollTargetX) {
 		float realMaxScrollX = GetScrollMaxX();
@@ -253,32 +902,633 @@ static bool ImGui::InputTextScrollingEx(const char *label, char *buf, size_t buf
 	return changed;
 }
 
-bool ImGui::InputTextMultilineScrolling(const char *label, char *buf, size_t buf_size, const ImVec2 &size, ImGuiInputTextFlags flags)
+bool ImGui::InputTextMultilineScrolling(const char *label, char *buf, size_t buf_size, const ImVec2 &size, ImGuiInputTextFlags flags, textSearch *search)
 {
-	return InputTextScrollingEx(label, buf, buf_size, size, flags | ImGuiInputTextFlags_Multiline);
+	return InputTextScrollingEx(label, buf, buf_size, nullptr, size, flags | ImGuiInputTextFlags_Multiline, search);
 }
 
-bool ImGui::InputTextMultilineScrolling(const char *label, sb_t *sb, u32 buf_size, const ImVec2 &size, ImGuiInputTextFlags flags)
+bool ImGui::InputTextMultilineScrolling(const char *label, sb_t *sb, u32 buf_size, const ImVec2 &size, ImGuiInputTextFlags flags, textSearch *search)
 {
-	if(sb->allocated < buf_size) {
-		sb_reserve(sb, buf_size);
-	}
-	bool ret = InputTextScrollingEx(label, (char *)sb->data, sb->allocated, size, flags | ImGuiInputTextFlags_Multiline);
-	sb->count = sb->data ? (u32)strlen(sb->data) + 1 : 0;
-	return ret;
+	return InputTextScrollingEx(label, nullptr, buf_size, sb, size, flags | ImGuiInputTextFlags_Multiline, search);
 }
 
 bool ImGui::InputTextScrolling(const char *label, char *buf, size_t buf_size, ImGuiInputTextFlags flags)
 {
-	return InputTextScrollingEx(label, buf, buf_size, ImVec2(0.0f, 0.0f), flags);
+	return InputTextScrollingEx(label, buf, buf_size, nullptr, ImVec2(0.0f, 0.0f), flags, nullptr);
 }
 
 bool ImGui::InputTextScrolling(const char *label, sb_t *sb, u32 buf_size, ImGuiInputTextFlags flags)
 {
-	if(sb->allocated < buf_size) {
-		sb_reserve(sb, buf_size);
+	return InputTextScrollingEx(label, nullptr, buf_size, sb, ImVec2(0.0f, 0.0f), flags, nullptr);
+}
+
+enum {
+	kTextViewer_IndexBytesPerFrame = 32 * 1024 * 1024, // newline scan budget, so huge texts index over several frames
+	kTextViewer_MeasureBytes = 4096,                   // longer lines have their width extrapolated from a sample
+};
+
+static void Imgui_Core_TextViewer_Free(TextViewerState *state)
+{
+	bba_free(state->lineStarts);
+	Imgui_Core_WidgetStatePool_Free(&s_textViewerStatePool, state);
+}
+
+// Byte range of a line, excluding the newline and any preceding carriage return.
+static u32 Imgui_Core_TextViewer_LineEnd(const TextViewerState *state, const char *text, u32 line)
+{
+	u32 start = state->lineStarts.data[line];
+	u32 end = (line + 1 < state->lineStarts.count) ? state->lineStarts.data[line + 1] - 1 : state->indexedLen;
+	if(end > start && text[end - 1] == '\r') {
+		--end;
+	}
+	return end;
+}
+
+// Index of the line containing pos: the last line starting at or before it.
+static u32 Imgui_Core_TextViewer_FindLine(const TextViewerState *state, u32 pos)
+{
+	u32 lo = 0;
+	u32 hi = state->lineStarts.count;
+	while(hi - lo > 1) {
+		u32 mid = lo + (hi - lo) / 2;
+		if(state->lineStarts.data[mid] <= pos) {
+			lo = mid;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+static TextViewerPos Imgui_Core_TextViewer_PosFromOffset(const TextViewerState *state, u32 offset)
+{
+	TextViewerPos pos;
+	pos.line = Imgui_Core_TextViewer_FindLine(state, offset);
+	pos.col = offset - state->lineStarts.data[pos.line];
+	return pos;
+}
+
+// A cheap check that text is still what was indexed, with at most more appended: the same pointer,
+// the same first and last bytes, and a newline still before the last line.
+static bool Imgui_Core_TextViewer_IsIndexedText(const TextViewerState *state, const char *text, u32 textLen)
+{
+	if(text != state->text || textLen < state->indexedLen)
+		return false;
+	if(!state->indexedLen)
+		return true;
+	u32 lastLineStart = state->lineStarts.data[state->lineStarts.count - 1];
+	return text[0] == state->firstByte && text[state->indexedLen - 1] == state->lastByte && (!lastLineStart || text[lastLineStart - 1] == '\n');
+}
+
+static void Imgui_Core_TextViewer_Index(TextViewerState *state, const char *text, u32 textLen, u64 textVersion)
+{
+	if(textVersion != state->textVersion || !state->lineStarts.count || !Imgui_Core_TextViewer_IsIndexedText(state, text, textLen)) {
+		++state->restarts;
+		state->textVersion = textVersion;
+		state->text = text;
+		bba_free(state->lineStarts);
+		bba_push(state->lineStarts, 0u);
+		state->indexedLen = 0;
+		state->longestLine = 0;
+		state->longestLineWidth = 0.0f;
+		state->anchor = state->cursor = TextViewerPos{};
+		state->bDragging = false;
+	}
+	if(textLen == state->indexedLen)
+		return;
+
+	u32 firstChanged = state->lineStarts.count - 1; // the last line grows as text is appended
+	u32 scanEnd = (textLen - state->indexedLen > kTextViewer_IndexBytesPerFrame) ? state->indexedLen + kTextViewer_IndexBytesPerFrame : textLen;
+	u32 pos = state->indexedLen;
+	while(pos < scanEnd) {
+		const char *newline = (const char *)memchr(text + pos, '\n', scanEnd - pos);
+		if(!newline)
+			break;
+		pos = (u32)(newline - text) + 1;
+		bba_push(state->lineStarts, pos);
+	}
+	state->indexedLen = scanEnd;
+	state->firstByte = text[0];
+	state->lastByte = text[scanEnd - 1];
+
+	u32 longestLen = Imgui_Core_TextViewer_LineEnd(state, text, state->longestLine) - state->lineStarts.data[state->longestLine];
+	for(u32 line = firstChanged; line < state->lineStarts.count; ++line) {
+		u32 len = Imgui_Core_TextViewer_LineEnd(state, text, line) - state->lineStarts.data[line];
+		if(len > longestLen || line == state->longestLine) {
+			longestLen = len;
+			state->longestLine = line;
+			state->bLongestLineDirty = true;
+		}
+	}
+	if(state->indexedLen < textLen) {
+		Imgui_Core_RequestRender();
+	}
+}
+
+static float Imgui_Core_TextViewer_MeasureLongestLine(const TextViewerState *state, const char *text)
+{
+	u32 start = state->lineStarts.data[state->longestLine];
+	u32 len = Imgui_Core_TextViewer_LineEnd(state, text, state->longestLine) - start;
+	if(len <= kTextViewer_MeasureBytes)
+		return ImGui::CalcTextSize(text + start, text + start + len).x;
+	float sampleWidth = ImGui::CalcTextSize(text + start, text + start + kTextViewer_MeasureBytes).x;
+	return sampleWidth * ((float)len / (float)kTextViewer_MeasureBytes);
+}
+
+// Width of the first col bytes of a line, stopping early at maxWidth so long lines cost no more than what's visible.
+static float Imgui_Core_TextViewer_ColumnX(const char *lineBegin, u32 col, float maxWidth)
+{
+	const char *remaining = nullptr;
+	return ImGui::GetFont()->CalcTextSizeA(ImGui::GetFontSize(), maxWidth, -1.0f, lineBegin, lineBegin + col, &remaining).x;
+}
+
+static TextViewerPos Imgui_Core_TextViewer_HitTest(const TextViewerState *state, const char *text, ImVec2 origin, ImVec2 mousePos)
+{
+	float lineHeight = ImGui::GetTextLineHeight();
+	float y = (mousePos.y - origin.y) / lineHeight;
+	TextViewerPos pos = {};
+	pos.line = (y <= 0.0f) ? 0u : BB_MIN((u32)y, state->lineStarts.count - 1);
+	const char *lineBegin = text + state->lineStarts.data[pos.line];
+	const char *lineEnd = text + Imgui_Core_TextViewer_LineEnd(state, text, pos.line);
+	float x = mousePos.x - origin.x;
+	if(x > 0.0f) {
+		const char *hit = lineEnd;
+		ImGui::GetFont()->CalcTextSizeA(ImGui::GetFontSize(), x, -1.0f, lineBegin, lineEnd, &hit);
+		pos.col = (u32)(hit - lineBegin);
+	}
+	return pos;
+}
+
+static bool Imgui_Core_TextViewer_Less(TextViewerPos a, TextViewerPos b)
+{
+	return a.line < b.line || (a.line == b.line && a.col < b.col);
+}
+
+static void Imgui_Core_TextViewer_Copy(const TextViewerState *state, const char *text, TextViewerPos selStart, TextViewerPos selEnd)
+{
+	u32 begin = state->lineStarts.data[selStart.line] + selStart.col;
+	u32 end = state->lineStarts.data[selEnd.line] + selEnd.col;
+	if(end <= begin)
+		return;
+	char *copy = (char *)malloc(end - begin + 1);
+	if(copy) {
+		memcpy(copy, text + begin, end - begin);
+		copy[end - begin] = '\0';
+		ImGui::SetClipboardText(copy);
+		free(copy);
+	}
+}
+
+void ImGui::TextViewer(const char *label, const char *text, u64 textLen, const ImVec2 &size, textSearch *search, u64 textVersion)
+{
+	Imgui_Core_WidgetState_Collect();
+	PushID(label);
+	ImGuiID stateKey = GetID("textViewerState");
+	PopID();
+	ImGuiStorage *storage = GetStateStorage();
+	TextViewerState *state = (TextViewerState *)storage->GetVoidPtr(stateKey);
+	if(!state) {
+		state = (TextViewerState *)Imgui_Core_WidgetStatePool_Alloc(&s_textViewerStatePool, sizeof(TextViewerState));
+		if(state) {
+			*state = TextViewerState();
+			state->owner.storage = storage;
+			state->owner.key = stateKey;
+			bba_push(s_textViewerStates, state);
+			storage->SetVoidPtr(stateKey, state);
+		}
+	}
+	if(!state)
+		return;
+	state->owner.lastUsedFrame = GetFrameCount();
+
+	Imgui_Core_TextViewer_Index(state, text, (u32)BB_MIN(textLen, (u64)0xffffffffu), textVersion);
+	if(state->bLongestLineDirty) {
+		state->longestLineWidth = Imgui_Core_TextViewer_MeasureLongestLine(state, text);
+		state->bLongestLineDirty = false;
+	}
+	if(search && !textSearch_update(search, text, state->indexedLen, state->restarts, kInputTextSearch_ScanBytesPerFrame)) {
+		Imgui_Core_RequestRender();
+	}
+
+	ImVec2 childSize = size;
+	if(childSize.x == 0.0f) {
+		childSize.x = CalcItemWidth();
+	}
+	if(childSize.y == 0.0f) {
+		childSize.y = 8.0f * GetTextLineHeight() + 2.0f * GetStyle().WindowPadding.y + GetStyle().ScrollbarSize;
+	}
+	BeginChild(label, childSize, true, ImGuiWindowFlags_HorizontalScrollbar);
+
+	ImGuiWindow *window = GetCurrentWindow();
+	ImDrawList *drawList = GetWindowDrawList();
+	float lineHeight = GetTextLineHeight();
+	float scrollX = GetScrollX();
+	float visibleRight = scrollX + GetWindowWidth();
+	ImVec2 origin = GetCursorScreenPos();
+	window->DC.CursorMaxPos.x = ImMax(window->DC.CursorMaxPos.x, origin.x + state->longestLineWidth + GetFontSize());
+
+	const ImGuiIO &io = GetIO();
+	const ImRect &textRect = window->InnerClipRect; // excludes the scrollbars
+	if(IsWindowHovered() && IsMouseClicked(0) && textRect.Contains(io.MousePos)) {
+		state->cursor = Imgui_Core_TextViewer_HitTest(state, text, origin, io.MousePos);
+		if(!io.KeyShift) {
+			state->anchor = state->cursor;
+		}
+		state->bDragging = true;
+	}
+	if(state->bDragging) {
+		if(IsMouseDown(0)) {
+			state->cursor = Imgui_Core_TextViewer_HitTest(state, text, origin, io.MousePos);
+			if(io.MousePos.y < textRect.Min.y) {
+				SetScrollY(GetScrollY() - lineHeight);
+			} else if(io.MousePos.y > textRect.Max.y) {
+				SetScrollY(GetScrollY() + lineHeight);
+			}
+			Imgui_Core_RequestRender();
+		} else {
+			state->bDragging = false;
+		}
+	}
+
+	if(search) {
+		if(IsWindowFocused() && key_is_pressed_this_frame(Key_F3)) {
+			u64 cursorOffset = state->lineStarts.data[state->cursor.line] + state->cursor.col;
+			if(io.KeyShift) {
+				textSearch_select_prev(search, cursorOffset);
+			} else {
+				textSearch_select_next(search, cursorOffset);
+			}
+		}
+		if(search->bScrollToCurrent && search->current < search->matches.count) {
+			const textSearchMatch *match = search->matches.data + search->current;
+			state->anchor = Imgui_Core_TextViewer_PosFromOffset(state, (u32)match->offset);
+			state->cursor = Imgui_Core_TextViewer_PosFromOffset(state, (u32)(match->offset + match->length));
+			float matchY = lineHeight * (float)state->anchor.line;
+			float viewHeight = textRect.GetHeight();
+			if(matchY < GetScrollY() || matchY + lineHeight > GetScrollY() + viewHeight) {
+				SetScrollY(ImMax(0.0f, matchY - (viewHeight - lineHeight) * 0.5f));
+			}
+			float matchX = Imgui_Core_TextViewer_ColumnX(text + state->lineStarts.data[state->anchor.line], state->anchor.col, FLT_MAX);
+			float viewWidth = textRect.GetWidth();
+			if(matchX < scrollX || matchX > scrollX + viewWidth * 0.75f) {
+				SetScrollX(ImMax(0.0f, matchX - viewWidth * 0.25f));
+			}
+			search->bScrollToCurrent = false;
+		}
+	}
+
+	TextViewerPos selStart = state->anchor;
+	TextViewerPos selEnd = state->cursor;
+	if(Imgui_Core_TextViewer_Less(selEnd, selStart)) {
+		TextViewerPos tmp = selStart;
+		selStart = selEnd;
+		selEnd = tmp;
+	}
+	if(IsWindowFocused() && io.KeyCtrl) {
+		if(IsKeyPressed(io.KeyMap[ImGuiKey_A])) {
+			u32 lastLine = state->lineStarts.count - 1;
+			state->anchor = TextViewerPos{};
+			state->cursor.line = lastLine;
+			state->cursor.col = Imgui_Core_TextViewer_LineEnd(state, text, lastLine) - state->lineStarts.data[lastLine];
+		} else if(IsKeyPressed(io.KeyMap[ImGuiKey_C])) {
+			Imgui_Core_TextViewer_Copy(state, text, selStart, selEnd);
+		}
+	}
+
+	ImU32 textColor = GetColorU32(ImGuiCol_Text);
+	ImU32 selectionColor = GetColorU32(ImGuiCol_TextSelectedBg);
+	ImU32 matchColor = GetColorU32(ImGuiCol_PlotHistogram, 0.35f);
+	ImU32 currentMatchColor = GetColorU32(ImGuiCol_PlotHistogramHovered, 0.6f);
+	ImGuiListClipper clipper;
+	clipper.Begin((int)state->lineStarts.count, lineHeight);
+	while(clipper.Step()) {
+		for(int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+			u32 line = (u32)i;
+			const char *lineBegin = text + state->lineStarts.data[line];
+			const char *lineEnd = text + Imgui_Core_TextViewer_LineEnd(state, text, line);
+			u32 lineLen = (u32)(lineEnd - lineBegin);
+			ImVec2 linePos(origin.x, origin.y + lineHeight * (float)line);
+
+			if(search) {
+				u32 lineStart = state->lineStarts.data[line];
+				for(u32 m = textSearch_first_ending_after(search, lineStart); m < search->matches.count; ++m) {
+					const textSearchMatch *match = search->matches.data + m;
+					if(match->offset >= lineStart + lineLen)
+						break;
+					u32 col0 = (u32)(BB_MAX(match->offset, (u64)lineStart) - lineStart);
+					u32 col1 = (u32)BB_MIN(match->offset + match->length - lineStart, (u64)lineLen);
+					float x0 = Imgui_Core_TextViewer_ColumnX(lineBegin, col0, visibleRight);
+					float x1 = Imgui_Core_TextViewer_ColumnX(lineBegin, col1, visibleRight);
+					drawList->AddRectFilled(ImVec2(linePos.x + x0, linePos.y), ImVec2(linePos.x + x1, linePos.y + lineHeight), (m == search->current) ? currentMatchColor : matchColor);
+				}
+			}
+
+			if(line >= selStart.line && line <= selEnd.line && Imgui_Core_TextViewer_Less(selStart, selEnd)) {
+				u32 col0 = (line == selStart.line) ? BB_MIN(selStart.col, lineLen) : 0u;
+				u32 col1 = (line == selEnd.line) ? BB_MIN(selEnd.col, lineLen) : lineLen;
+				float x0 = Imgui_Core_TextViewer_ColumnX(lineBegin, col0, visibleRight);
+				float x1 = Imgui_Core_TextViewer_ColumnX(lineBegin, col1, visibleRight);
+				if(line != selEnd.line) {
+					x1 += GetFontSize() * 0.5f; // show the selected newline
+				}
+				drawList->AddRectFilled(ImVec2(linePos.x + x0, linePos.y), ImVec2(linePos.x + x1, linePos.y + lineHeight), selectionColor);
+			}
+
+			// skip glyphs scrolled off the left, and stop at the right edge
+			const char *visibleBegin = lineBegin;
+			float skippedX = 0.0f;
+			if(scrollX > 0.0f) {
+				skippedX = GetFont()->CalcTextSizeA(GetFontSize(), scrollX, -1.0f, lineBegin, lineEnd, &visibleBegin).x;
+			}
+			const char *visibleEnd = lineEnd;
+			GetFont()->CalcTextSizeA(GetFontSize(), visibleRight - skippedX + GetFontSize(), -1.0f, visibleBegin, lineEnd, &visibleEnd);
+			if(visibleEnd > visibleBegin) {
+				drawList->AddText(GetFont(), GetFontSize(), ImVec2(linePos.x + skippedX, linePos.y), textColor, visibleBegin, visibleEnd);
+			}
+		}
+	}
+	clipper.End();
+
+	EndChild();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// InputTextMultiline for a gapBuffer
+
+enum {
+	kGapBufferEdit_WindowLines = 64,
+	kGapBufferEdit_WindowBytes = 64 * 1024,
+	kGapBufferEdit_MarginLines = 4, // the window moves once the cursor is this close to an edge it can move past
+	kGapBufferEdit_MeasureBytes = 4096,
+};
+
+static void Imgui_Core_GapBufferEdit_Free(GapBufferEditState *state)
+{
+	gapBufferWindow_reset(&state->window);
+	sb_reset(&state->scratch);
+	Imgui_Core_WidgetStatePool_Free(&s_gapBufferEditStatePool, state);
+}
+
+// Longer lines have their width extrapolated from a sample, as in TextViewer.
+static float Imgui_Core_GapBufferEdit_LineWidth(const char *lineBegin, u64 len)
+{
+	if(len <= kGapBufferEdit_MeasureBytes)
+		return ImGui::CalcTextSize(lineBegin, lineBegin + len).x;
+	float sampleWidth = ImGui::CalcTextSize(lineBegin, lineBegin + kGapBufferEdit_MeasureBytes).x;
+	return sampleWidth * ((float)len / (float)kGapBufferEdit_MeasureBytes);
+}
+
+static void Imgui_Core_GapBufferEdit_MeasureWindow(GapBufferEditState *state, const char *text)
+{
+	const gapBufferWindow *w = &state->window;
+	for(u32 i = 0; i < w->linesWindow; ++i) {
+		u32 line = w->linesBefore + i;
+		u64 start = gapBufferWindow_line_start(w, line);
+		u64 end = gapBufferWindow_line_end(w, line);
+		state->maxWidth = ImMax(state->maxWidth, Imgui_Core_GapBufferEdit_LineWidth(text + start - w->start, end - start));
+	}
+}
+
+// Copies the newly opened window into scratch for InputTextEx, or closes it if scratch can't grow.
+static bool Imgui_Core_GapBufferEdit_SetScratch(GapBufferEditState *state, const char *text)
+{
+	gapBufferWindow *w = &state->window;
+	u32 len = (u32)w->len;
+	if(state->scratch.allocated < len + 1) {
+		sb_reserve(&state->scratch, len + 1);
+	}
+	if(!text || state->scratch.allocated < len + 1) {
+		gapBufferWindow_close(w);
+		return false;
+	}
+	memcpy(state->scratch.data, text, len);
+	state->scratch.data[len] = '\0';
+	state->scratch.count = len + 1;
+	Imgui_Core_GapBufferEdit_MeasureWindow(state, text);
+	return true;
+}
+
+// Writes each edit back to gb as it is made, and moves the window when the cursor nears its edge.
+// InputTextEx holds its own copy of the text while active, so a moved window replaces that copy
+// here rather than scratch, which InputTextEx overwrites on return.
+static int Imgui_Core_GapBufferEdit_Callback(ImGuiInputTextCallbackData *data)
+{
+	GapBufferEditState *state = (GapBufferEditState *)data->UserData;
+	if(data->EventFlag == ImGuiInputTextFlags_CallbackResize)
+		return ImGui::InputTextResizeCallback(data, &state->scratch, 0xffffffffu);
+	if(state->bCursorPending) {
+		state->bCursorPending = false;
+		data->CursorPos = (int)BB_MIN(state->pendingCursor - state->window.start, (u64)data->BufTextLen);
+		data->SelectionStart = data->SelectionEnd = data->CursorPos;
+	}
+
+	gapBufferWindow *w = &state->window;
+	gapBuffer *gb = state->gb;
+	if(gapBufferWindow_commit(w, gb, data->Buf, (u64)data->BufTextLen)) {
+		state->bChanged = true;
+	}
+	u64 cursor = w->start + (u64)data->CursorPos;
+	u32 line = gapBufferWindow_find_line(w, cursor);
+	u32 first = w->linesBefore;
+	u32 last = first + w->linesWindow - 1;
+	bool bNearStart = first > 0 && line < first + kGapBufferEdit_MarginLines;
+	bool bNearEnd = last + 1 < gapBufferWindow_line_count(w) && line + kGapBufferEdit_MarginLines > last;
+	if(bNearStart || bNearEnd) {
+		u64 selectionStart = w->start + (u64)data->SelectionStart;
+		u64 selectionEnd = w->start + (u64)data->SelectionEnd;
+		u64 oldStart = w->start;
+		u64 oldLen = w->len;
+		const char *text = gapBufferWindow_open(w, gb, line, kGapBufferEdit_WindowLines, kGapBufferEdit_WindowBytes);
+		if(text && (w->start != oldStart || w->len != oldLen)) {
+			data->DeleteChars(0, data->BufTextLen);
+			data->InsertChars(0, text, text + w->len);
+			data->CursorPos = (int)(cursor - w->start);
+			data->SelectionStart = (int)(BB_MIN(BB_MAX(selectionStart, w->start), w->start + w->len) - w->start);
+			data->SelectionEnd = (int)(BB_MIN(BB_MAX(selectionEnd, w->start), w->start + w->len) - w->start);
+			Imgui_Core_GapBufferEdit_MeasureWindow(state, text);
+			Imgui_Core_RequestRender(); // the box moves to the window's new first line next frame
+		}
+	}
+	if(state->cursor != cursor) {
+		state->cursor = cursor;
+		state->bCursorMoved = true;
+	}
+	return 0;
+}
+
+// Scrolls the cursor into view, once it has moved.
+static void Imgui_Core_GapBufferEdit_ScrollToCursor(GapBufferEditState *state, const ImRect &textRect)
+{
+	const gapBufferWindow *w = &state->window;
+	if(!state->bCursorMoved || state->cursor < w->start || state->cursor > w->start + w->len)
+		return;
+	state->bCursorMoved = false;
+
+	float lineHeight = ImGui::GetTextLineHeight();
+	u32 line = gapBufferWindow_find_line(w, state->cursor);
+	float cursorY = lineHeight * (float)line;
+	float viewHeight = textRect.GetHeight();
+	if(cursorY < ImGui::GetScrollY()) {
+		ImGui::SetScrollY(cursorY);
+	} else if(cursorY + lineHeight > ImGui::GetScrollY() + viewHeight) {
+		ImGui::SetScrollY(cursorY + lineHeight - viewHeight);
+	}
+
+	const char *lineBegin = state->scratch.data + (gapBufferWindow_line_start(w, line) - w->start);
+	float cursorX = ImGui::CalcTextSize(lineBegin, state->scratch.data + (state->cursor - w->start)).x;
+	float viewWidth = textRect.GetWidth();
+	state->maxWidth = ImMax(state->maxWidth, cursorX);
+	if(cursorX < ImGui::GetScrollX() || cursorX > ImGui::GetScrollX() + viewWidth * 0.75f) {
+		ImGui::SetScrollX(ImMax(0.0f, cursorX - viewWidth * 0.25f));
+	}
+}
+
+bool ImGui::InputTextMultiline(const char *label, gapBuffer *gb, const ImVec2 &size, ImGuiInputTextFlags flags)
+{
+	Imgui_Core_WidgetState_Collect();
+	PushID(label);
+	ImGuiID stateKey = GetID("gapBufferEditState");
+	PopID();
+	ImGuiStorage *storage = GetStateStorage();
+	GapBufferEditState *state = (GapBufferEditState *)storage->GetVoidPtr(stateKey);
+	if(!state) {
+		state = (GapBufferEditState *)Imgui_Core_WidgetStatePool_Alloc(&s_gapBufferEditStatePool, sizeof(GapBufferEditState));
+		if(state) {
+			*state = GapBufferEditState();
+			state->owner.storage = storage;
+			state->owner.key = stateKey;
+			bba_push(s_gapBufferEditStates, state);
+			storage->SetVoidPtr(stateKey, state);
+		}
+	}
+	if(!state)
+		return false;
+	state->owner.lastUsedFrame = GetFrameCount();
+
+	ImVec2 childSize = size;
+	if(childSize.x == 0.0f) {
+		childSize.x = CalcItemWidth();
+	}
+	if(childSize.y == 0.0f) {
+		childSize.y = 8.0f * GetTextLineHeight() + 2.0f * GetStyle().WindowPadding.y + GetStyle().ScrollbarSize;
+	}
+	BeginChild(label, childSize, true, ImGuiWindowFlags_HorizontalScrollbar);
+
+	gapBufferWindow *w = &state->window;
+	ImGuiID editId = GetID("##window");
+	bool bActive = GetActiveID() == editId;
+	if(gapBufferWindow_sync(w, gb)) {
+		// edited elsewhere - InputTextEx's copy of the window text is out of date
+		if(bActive) {
+			ClearActiveID();
+			bActive = false;
+		}
+		state->bCursorPending = false;
 	}
-	bool ret = InputTextScrollingEx(label, (char *)sb->data, sb->allocated, ImVec2(0.0f, 0.0f), flags);
-	sb->count = sb->data ? (u32)strlen(sb->data) + 1 : 0;
-	return ret;
+	if(w->bOpen && !bActive && GetFrameCount() - state->focusFrame > 1) {
+		gapBufferWindow_close(w); // editing ended - the text was written back as it was edited
+	}
+	u32 lineCount = gapBufferWindow_line_count(w);
+	if(!lineCount) {
+		EndChild();
+		return false;
+	}
+
+	ImGuiWindow *window = GetCurrentWindow();
+	ImDrawList *drawList = GetWindowDrawList();
+	float lineHeight = GetTextLineHeight();
+	float scrollX = GetScrollX();
+	float visibleRight = scrollX + GetWindowWidth();
+	ImVec2 origin = GetCursorScreenPos();
+	const ImGuiIO &io = GetIO();
+	const ImRect &textRect = window->InnerClipRect; // excludes the scrollbars
+
+	// clicks on the window go to InputTextEx - anywhere else opens a new window on the clicked line
+	if(IsWindowHovered() && IsMouseClicked(0) && textRect.Contains(io.MousePos)) {
+		float y = (io.MousePos.y - origin.y) / lineHeight;
+		u32 line = (y <= 0.0f) ? 0u : BB_MIN((u32)y, lineCount - 1);
+		u64 lineStart = gapBufferWindow_line_start(w, line);
+		u64 lineLen = gapBufferWindow_line_end(w, line) - lineStart;
+		const char *lineBegin = gapBuffer_flatten_range(gb, lineStart, lineLen);
+		const char *hit = lineBegin + lineLen;
+		float x = io.MousePos.x - origin.x;
+		if(x > 0.0f) {
+			GetFont()->CalcTextSizeA(GetFontSize(), x, -1.0f, lineBegin, lineBegin + lineLen, &hit);
+		} else {
+			hit = lineBegin;
+		}
+		if(bActive) {
+			ClearActiveID();
+		}
+		const char *text = gapBufferWindow_open(w, gb, line, kGapBufferEdit_WindowLines, kGapBufferEdit_WindowBytes);
+		if(Imgui_Core_GapBufferEdit_SetScratch(state, text)) {
+			state->pendingCursor = lineStart + (u64)(hit - lineBegin);
+			state->bCursorPending = true;
+			state->focusFrame = GetFrameCount();
+		}
+	}
+
+	// lines outside the window are drawn straight from gb
+	u32 windowFirst = w->bOpen ? w->linesBefore : lineCount;
+	u32 windowEnd = w->bOpen ? w->linesBefore + w->linesWindow : lineCount;
+	ImU32 textColor = GetColorU32(ImGuiCol_Text);
+	ImGuiListClipper clipper;
+	clipper.Begin((int)lineCount, lineHeight);
+	while(clipper.Step()) {
+		for(int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+			u32 line = (u32)i;
+			if(line >= windowFirst && line < windowEnd)
+				continue;
+			u64 lineStart = gapBufferWindow_line_start(w, line);
+			u64 lineLen = gapBufferWindow_line_end(w, line) - lineStart;
+			const char *lineBegin = gapBuffer_flatten_range(gb, lineStart, lineLen);
+			const char *lineEnd = lineBegin + lineLen;
+			ImVec2 linePos(origin.x, origin.y + lineHeight * (float)line);
+			state->maxWidth = ImMax(state->maxWidth, Imgui_Core_GapBufferEdit_LineWidth(lineBegin, lineLen));
+
+			// skip glyphs scrolled off the left, and stop at the right edge
+			const char *visibleBegin = lineBegin;
+			float skippedX = 0.0f;
+			if(scrollX > 0.0f) {
+				skippedX = GetFont()->CalcTextSizeA(GetFontSize(), scrollX, -1.0f, lineBegin, lineEnd, &visibleBegin).x;
+			}
+			const char *visibleEnd = lineEnd;
+			GetFont()->CalcTextSizeA(GetFontSize(), visibleRight - skippedX + GetFontSize(), -1.0f, visibleBegin, lineEnd, &visibleEnd);
+			if(visibleEnd > visibleBegin) {
+				drawList->AddText(GetFont(), GetFontSize(), ImVec2(linePos.x + skippedX, linePos.y), textColor, visibleBegin, visibleEnd);
+			}
+		}
+	}
+	clipper.End();
+
+	if(w->bOpen) {
+		// one line per line of the window, with no frame, so it lines up with the lines around it
+		ImVec2 boxSize(ImMax(GetWindowWidth(), state->maxWidth + GetFontSize()), lineHeight * (float)w->linesWindow);
+		SetCursorScreenPos(ImVec2(origin.x, origin.y + lineHeight * (float)w->linesBefore));
+		if(state->focusFrame == GetFrameCount()) {
+			SetKeyboardFocusHere();
+		}
+		PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(0.0f, 0.0f));
+		PushStyleColor(ImGuiCol_FrameBg, 0u);
+		state->gb = gb;
+		InputTextEx("##window", nullptr, state->scratch.data, (int)state->scratch.allocated, boxSize,
+		            flags | ImGuiInputTextFlags_Multiline | ImGuiInputTextFlags_CallbackAlways | ImGuiInputTextFlags_CallbackResize | ImGuiInputTextFlags_NoUndoRedo | ImGuiInputTextFlags_NoHorizontalScroll,
+		            Imgui_Core_GapBufferEdit_Callback, state);
+		state->gb = nullptr;
+		PopStyleColor();
+		PopStyleVar();
+		if(state->scratch.count && gapBufferWindow_commit(w, gb, state->scratch.data, state->scratch.count - 1)) {
+			state->bChanged = true;
+		}
+		if(IsItemActive() && Imgui_Core_HasFocus()) {
+			Imgui_Core_RequestRender();
+		}
+		Imgui_Core_GapBufferEdit_ScrollToCursor(state, textRect);
+	}
+	window->DC.CursorMaxPos.x = ImMax(window->DC.CursorMaxPos.x, origin.x + state->maxWidth + GetFontSize());
+	EndChild();
+
+	bool changed = state->bChanged != 0;
+	state->bChanged = false;
+	return changed;
 }
@@ -0,0 +1,209 @@
+// Copyright (c) 2012-2019 Matt Campbell
+// MIT license (see License.txt)
+
+#include "imgui_selection.h"
+#include "bb_array.h"
+#include <string.h>
+
+// Index of the first range ending after item, or ranges.count if none.
+static u32 selection_first_ending_after(const selection *sel, u32 item)
+{
+	u32 lo = 0;
+	u32 hi = sel->ranges.count;
+	while(lo < hi) {
+		u32 mid = lo + (hi - lo) / 2;
+		if(sel->ranges.data[mid].end > item) {
+			hi = mid;
+		} else {
+			lo = mid + 1;
+		}
+	}
+	return lo;
+}
+
+// Index of the first range starting after item, or ranges.count if none.
+static u32 selection_first_starting_after(const selection *sel, u32 item)
+{
+	u32 lo = 0;
+	u32 hi = sel->ranges.count;
+	while(lo < hi) {
+		u32 mid = lo + (hi - lo) / 2;
+		if(sel->ranges.data[mid].start > item) {
+			hi = mid;
+		} else {
+			lo = mid + 1;
+		}
+	}
+	return lo;
+}
+
+// Replaces ranges [first, last) with numNew ranges from newRanges.
+static b32 selection_splice(selection *sel, u32 first, u32 last, const selectionRange *newRanges, u32 numNew)
+{
+	u32 oldCount = sel->ranges.count;
+	u32 newCount = oldCount - (last - first) + numNew;
+	if(newCount > oldCount && !bba_add_noclear(sel->ranges, newCount - oldCount))
+		return false;
+	memmove(sel->ranges.data + first + numNew, sel->ranges.data + last, (oldCount - last) * sizeof(selectionRange));
+	memcpy(sel->ranges.data + first, newRanges, numNew * sizeof(selectionRange));
+	sel->ranges.count = newCount;
+	return true;
+}
+
+void selection_init(selection *sel)
+{
+	memset(sel, 0, sizeof(*sel));
+	sel->anchor = kSelection_None;
+	sel->cursor = kSelection_None;
+}
+
+void selection_reset(selection *sel)
+{
+	bba_free(sel->ranges);
+	selection_init(sel);
+}
+
+void selection_clear(selection *sel)
+{
+	sel->ranges.count = 0;
+}
+
+b32 selection_contains(const selection *sel, u32 item)
+{
+	u32 index = selection_first_ending_after(sel, item);
+	return index < sel->ranges.count && sel->ranges.data[index].start <= item;
+}
+
+u32 selection_count(const selection *sel)
+{
+	u32 count = 0;
+	u32 i;
+	for(i = 0; i < sel->ranges.count; ++i) {
+		count += sel->ranges.data[i].end - sel->ranges.data[i].start;
+	}
+	return count;
+}
+
+u32 selection_next(const selection *sel, u32 item)
+{
+	u32 index = selection_first_ending_after(sel, item);
+	if(index >= sel->ranges.count)
+		return kSelection_None;
+	return BB_MAX(item, sel->ranges.data[index].start);
+}
+
+b32 selection_add_range(selection *sel, u32 start, u32 end)
+{
+	u32 first;
+	u32 last;
+	selectionRange merged;
+	if(start >= end)
+		return true;
+
+	// merge with every range overlapping or touching [start, end)
+	first = (start > 0) ? selection_first_ending_after(sel, start - 1) : 0;
+	last = selection_first_starting_after(sel, end);
+	merged.start = start;
+	merged.end = end;
+	if(first < last) {
+		merged.start = BB_MIN(start, sel->ranges.data[first].start);
+		merged.end = BB_MAX(end, sel->ranges.data[last - 1].end);
+	}
+	return selection_splice(sel, first, last, &merged, 1);
+}
+
+b32 selection_remove_range(selection *sel, u32 start, u32 end)
+{
+	u32 first;
+	u32 last;
+	u32 numKept = 0;
+	selectionRange kept[2];
+	if(start >= end)
+		return true;
+
+	// ranges overlapping [start, end) shrink to whatever lies outside it
+	first = selection_first_ending_after(sel, start);
+	last = selection_first_starting_after(sel, end - 1);
+	if(first >= last)
+		return true;
+	if(sel->ranges.data[first].start < start) {
+		kept[numKept].start = sel->ranges.data[first].start;
+		kept[numKept].end = start;
+		++numKept;
+	}
+	if(sel->ranges.data[last - 1].end > end) {
+		kept[numKept].start = end;
+		kept[numKept].end = sel->ranges.data[last - 1].end;
+		++numKept;
+	}
+	return selection_splice(sel, first, last, kept, numKept);
+}
+
+b32 selection_toggle(selection *sel, u32 item)
+{
+	if(selection_contains(sel, item))
+		return selection_remove_range(sel, item, item + 1);
+	return selection_add_range(sel, item, item + 1);
+}
+
+b32 selection_select_all(selection *sel, u32 numItems)
+{
+	selection_clear(sel);
+	return selection_add_range(sel, 0, numItems);
+}
+
+b32 selection_invert(selection *sel, u32 numItems)
+{
+	// the gaps between n ranges are at most n + 1 ranges, written over the ranges already read
+	u32 prev = 0;
+	u32 out = 0;
+	u32 count = sel->ranges.count;
+	u32 i;
+	if(!bba_add_noclear(sel->ranges, 1))
+		return false;
+	for(i = 0; i < count; ++i) {
+		selectionRange range = sel->ranges.data[i];
+		if(range.start >= numItems)
+			break;
+		if(range.start > prev) {
+			sel->ranges.data[out].start = prev;
+			sel->ranges.data[out].end = range.start;
+			++out;
+		}
+		prev = range.end;
+	}
+	if(prev < numItems) {
+		sel->ranges.data[out].start = prev;
+		sel->ranges.data[out].end = numItems;
+		++out;
+	}
+	sel->ranges.count = out;
+	return true;
+}
+
+void selection_click(selection *sel, u32 item, u32 modifiers)
+{
+	if((modifiers & kSelection_Shift) && sel->anchor != kSelection_None) {
+		if(!(modifiers & kSelection_Ctrl)) {
+			selection_clear(sel);
+		}
+		selection_add_range(sel, BB_MIN(sel->anchor, item), BB_MAX(sel->anchor, item) + 1);
+	} else if(modifiers & kSelection_Ctrl) {
+		selection_toggle(sel, item);
+		sel->anchor = item;
+	} else {
+		selection_clear(sel);
+		selection_add_range(sel, item, item + 1);
+		sel->anchor = item;
+	}
+	sel->cursor = item;
+}
+
+void selection_navigate(selection *sel, u32 item, u32 modifiers)
+{
+	if(modifiers == kSelection_Ctrl) {
+		sel->cursor = item;
+	} else {
+		selection_click(sel, item, modifiers);
+	}
+}
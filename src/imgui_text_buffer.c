@@ -0,0 +1,420 @@
+// Copyright (c) 2012-2019 Matt Campbell
+// MIT license (see License.txt)
+
+#include "imgui_text_buffer.h"
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+	kGapBuffer_MinCapacity = 64,
+	kGapBufferWindow_MinLines = 64,
+};
+
+static u64 gapBuffer_gap(const gapBuffer *gb)
+{
+	return gb->gapEnd - gb->gapStart;
+}
+
+static void gapBuffer_move_gap(gapBuffer *gb, u64 pos)
+{
+	u64 count;
+	if(pos < gb->gapStart) {
+		count = gb->gapStart - pos;
+		memmove(gb->data + gb->gapEnd - count, gb->data + pos, (size_t)count);
+		gb->gapStart -= count;
+		gb->gapEnd -= count;
+		gb->gapBytesMoved += count;
+	} else if(pos > gb->gapStart) {
+		count = pos - gb->gapStart;
+		memmove(gb->data + gb->gapStart, gb->data + gb->gapEnd, (size_t)count);
+		gb->gapStart += count;
+		gb->gapEnd += count;
+		gb->gapBytesMoved += count;
+	}
+}
+
+// Keeps at least one byte of gap after the insert, so flattening always has room for a terminator.
+static b32 gapBuffer_reserve_gap(gapBuffer *gb, u64 len)
+{
+	u64 textLen;
+	u64 tail;
+	u64 capacity;
+	char *data;
+	if(gapBuffer_gap(gb) > len)
+		return true;
+
+	textLen = gapBuffer_length(gb);
+	capacity = BB_MAX(gb->capacity * 2, (u64)kGapBuffer_MinCapacity);
+	while(capacity < textLen + len + 1) {
+		capacity *= 2;
+	}
+	data = (char *)realloc(gb->data, (size_t)capacity);
+	if(!data)
+		return false;
+
+	// the text after the gap moves to the end of the new allocation
+	tail = gb->capacity - gb->gapEnd;
+	memmove(data + capacity - tail, data + gb->gapEnd, (size_t)tail);
+	gb->data = data;
+	gb->gapEnd = capacity - tail;
+	gb->capacity = capacity;
+	++gb->grows;
+	return true;
+}
+
+void gapBuffer_init(gapBuffer *gb, u64 initialCapacity)
+{
+	memset(gb, 0, sizeof(*gb));
+	if(initialCapacity) {
+		gb->data = (char *)malloc((size_t)initialCapacity);
+		if(gb->data) {
+			gb->capacity = initialCapacity;
+			gb->gapEnd = initialCapacity;
+		}
+	}
+}
+
+void gapBuffer_reset(gapBuffer *gb)
+{
+	free(gb->data);
+	memset(gb, 0, sizeof(*gb));
+}
+
+void gapBuffer_clear(gapBuffer *gb)
+{
+	gb->gapStart = 0;
+	gb->gapEnd = gb->capacity;
+	++gb->edits;
+}
+
+b32 gapBuffer_assign(gapBuffer *gb, const char *text, u64 len)
+{
+	gapBuffer_clear(gb);
+	return gapBuffer_insert(gb, 0, text, len);
+}
+
+u64 gapBuffer_length(const gapBuffer *gb)
+{
+	return gb->capacity - gapBuffer_gap(gb);
+}
+
+char gapBuffer_char_at(const gapBuffer *gb, u64 pos)
+{
+	if(pos >= gapBuffer_length(gb))
+		return '\0';
+	return pos < gb->gapStart ? gb->data[pos] : gb->data[pos + gapBuffer_gap(gb)];
+}
+
+b32 gapBuffer_insert(gapBuffer *gb, u64 pos, const char *text, u64 len)
+{
+	if(!gapBuffer_reserve_gap(gb, len))
+		return false;
+	gapBuffer_move_gap(gb, BB_MIN(pos, gapBuffer_length(gb)));
+	memcpy(gb->data + gb->gapStart, text, (size_t)len);
+	gb->gapStart += len;
+	++gb->edits;
+	return true;
+}
+
+void gapBuffer_erase(gapBuffer *gb, u64 pos, u64 len)
+{
+	u64 textLen = gapBuffer_length(gb);
+	if(pos >= textLen || !len)
+		return;
+	len = BB_MIN(len, textLen - pos);
+	gapBuffer_move_gap(gb, pos);
+	gb->gapEnd += len;
+	++gb->edits;
+}
+
+b32 gapBuffer_replace(gapBuffer *gb, u64 pos, u64 eraseLen, const char *text, u64 len)
+{
+	u64 textLen = gapBuffer_length(gb);
+	u64 erased = pos < textLen ? BB_MIN(eraseLen, textLen - pos) : 0;
+
+	// grow before erasing, so a failed replace leaves the text as it was
+	if(len > erased && !gapBuffer_reserve_gap(gb, len - erased))
+		return false;
+	gapBuffer_erase(gb, pos, erased);
+	return gapBuffer_insert(gb, pos, text, len);
+}
+
+void gapBuffer_spans(const gapBuffer *gb, const char **first, u64 *firstLen, const char **second, u64 *secondLen)
+{
+	*first = gb->data;
+	*firstLen = gb->gapStart;
+	*second = gb->data ? gb->data + gb->gapEnd : NULL;
+	*secondLen = gb->capacity - gb->gapEnd;
+}
+
+u64 gapBuffer_copy(const gapBuffer *gb, u64 pos, u64 len, char *out)
+{
+	u64 textLen = gapBuffer_length(gb);
+	u64 before;
+	if(pos >= textLen)
+		return 0;
+	len = BB_MIN(len, textLen - pos);
+	before = pos < gb->gapStart ? BB_MIN(len, gb->gapStart - pos) : 0;
+	memcpy(out, gb->data + pos, (size_t)before);
+	memcpy(out + before, gb->data + pos + before + gapBuffer_gap(gb), (size_t)(len - before));
+	return len;
+}
+
+const char *gapBuffer_flatten(gapBuffer *gb)
+{
+	u64 textLen = gapBuffer_length(gb);
+	if(!gb->data)
+		return "";
+	gapBuffer_move_gap(gb, textLen);
+	gb->data[textLen] = '\0';
+	return gb->data;
+}
+
+const char *gapBuffer_flatten_range(gapBuffer *gb, u64 pos, u64 len)
+{
+	u64 textLen = gapBuffer_length(gb);
+	u64 end;
+	if(!gb->data)
+		return "";
+	pos = BB_MIN(pos, textLen);
+	end = pos + BB_MIN(len, textLen - pos);
+	if(pos < gb->gapStart && end > gb->gapStart) {
+		// the gap splits the range - move it to whichever edge needs less text shifted
+		if(gb->gapStart - pos <= end - gb->gapStart) {
+			gapBuffer_move_gap(gb, pos);
+		} else {
+			gapBuffer_move_gap(gb, end);
+		}
+	}
+	return pos < gb->gapStart ? gb->data + pos : gb->data + pos + gapBuffer_gap(gb);
+}
+
+u64 gapBuffer_utf8_align(const gapBuffer *gb, u64 pos)
+{
+	u32 steps = 0;
+	while(pos > 0 && steps < 3 && ((u8)gapBuffer_char_at(gb, pos) & 0xc0) == 0x80) {
+		--pos;
+		++steps;
+	}
+	return pos;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// gapBufferWindow
+
+static u32 gapBufferWindow_count_lines(const char *text, u64 len)
+{
+	const char *end = text + len;
+	u32 count = 0;
+	while(text < end && (text = (const char *)memchr(text, '\n', (size_t)(end - text))) != NULL) {
+		++text;
+		++count;
+	}
+	return count;
+}
+
+// Ensures the gap in lines has room for count window lines.
+static b32 gapBufferWindow_reserve_lines(gapBufferWindow *w, u32 count)
+{
+	u32 used = w->linesBefore + w->linesAfter;
+	u32 allocated;
+	u64 *lines;
+	if(w->lines && w->linesAllocated - used >= count)
+		return true;
+
+	allocated = BB_MAX(w->linesAllocated * 2, (u32)kGapBufferWindow_MinLines);
+	while(allocated < used + count) {
+		allocated *= 2;
+	}
+	lines = (u64 *)realloc(w->lines, allocated * sizeof(u64));
+	if(!lines)
+		return false;
+
+	// the lines after the window move to the end of the new allocation
+	memmove(lines + allocated - w->linesAfter, lines + w->linesAllocated - w->linesAfter, w->linesAfter * sizeof(u64));
+	w->lines = lines;
+	w->linesAllocated = allocated;
+	return true;
+}
+
+// Writes the start of each line after the first, offset by base.  Returns the number written.
+static u32 gapBufferWindow_add_lines(u64 *out, const char *text, u64 len, u64 base)
+{
+	const char *pos = text;
+	const char *end = text + len;
+	u32 count = 0;
+	while(pos < end && (pos = (const char *)memchr(pos, '\n', (size_t)(end - pos))) != NULL) {
+		++pos;
+		out[count++] = base + (u64)(pos - text);
+	}
+	return count;
+}
+
+// Moves the gap in lines so that the first line after it is line, converting the starts that cross
+// it.  The window must be closed.
+static void gapBufferWindow_move_lines_gap(gapBufferWindow *w, u32 line)
+{
+	while(w->linesBefore > line) {
+		--w->linesBefore;
+		++w->linesAfter;
+		w->lines[w->linesAllocated - w->linesAfter] = w->textLen - w->lines[w->linesBefore];
+	}
+	while(w->linesBefore < line) {
+		w->lines[w->linesBefore] = w->textLen - w->lines[w->linesAllocated - w->linesAfter];
+		++w->linesBefore;
+		--w->linesAfter;
+	}
+}
+
+void gapBufferWindow_reset(gapBufferWindow *w)
+{
+	free(w->lines);
+	memset(w, 0, sizeof(*w));
+}
+
+b32 gapBufferWindow_sync(gapBufferWindow *w, const gapBuffer *gb)
+{
+	const char *first;
+	const char *second;
+	u64 firstLen;
+	u64 secondLen;
+	u32 count;
+	if(w->lines && w->edits == gb->edits)
+		return false;
+
+	gapBuffer_spans(gb, &first, &firstLen, &second, &secondLen);
+	count = 1 + gapBufferWindow_count_lines(first, firstLen) + gapBufferWindow_count_lines(second, secondLen);
+	w->linesBefore = 0;
+	w->linesWindow = 0;
+	w->linesAfter = 0;
+	w->start = 0;
+	w->len = 0;
+	w->textLen = gapBuffer_length(gb);
+	w->edits = gb->edits;
+	w->bOpen = false;
+	if(gapBufferWindow_reserve_lines(w, count)) {
+		w->lines[0] = 0;
+		w->linesBefore = 1;
+		w->linesBefore += gapBufferWindow_add_lines(w->lines + w->linesBefore, first, firstLen, 0);
+		w->linesBefore += gapBufferWindow_add_lines(w->lines + w->linesBefore, second, secondLen, firstLen);
+	}
+	return true;
+}
+
+u32 gapBufferWindow_line_count(const gapBufferWindow *w)
+{
+	return w->linesBefore + w->linesWindow + w->linesAfter;
+}
+
+u64 gapBufferWindow_line_start(const gapBufferWindow *w, u32 line)
+{
+	if(line < w->linesBefore)
+		return w->lines[line];
+	if(line < w->linesBefore + w->linesWindow)
+		return w->start + w->lines[line];
+	line -= w->linesBefore + w->linesWindow;
+	if(line < w->linesAfter)
+		return w->textLen - w->lines[w->linesAllocated - w->linesAfter + line];
+	return w->textLen;
+}
+
+u64 gapBufferWindow_line_end(const gapBufferWindow *w, u32 line)
+{
+	if(line + 1 < gapBufferWindow_line_count(w))
+		return gapBufferWindow_line_start(w, line + 1) - 1;
+	return w->textLen;
+}
+
+u32 gapBufferWindow_find_line(const gapBufferWindow *w, u64 pos)
+{
+	u32 lo = 0;
+	u32 hi = gapBufferWindow_line_count(w);
+	while(hi - lo > 1) {
+		u32 mid = lo + (hi - lo) / 2;
+		if(gapBufferWindow_line_start(w, mid) <= pos) {
+			lo = mid;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+const char *gapBufferWindow_open(gapBufferWindow *w, gapBuffer *gb, u32 line, u32 maxLines, u64 maxBytes)
+{
+	u32 count;
+	u32 first;
+	u32 last;
+	u32 i;
+	u32 after;
+	gapBufferWindow_close(w);
+	count = gapBufferWindow_line_count(w);
+	if(!count)
+		return NULL;
+
+	line = BB_MIN(line, count - 1);
+	maxLines = BB_MIN(maxLines, count);
+	maxLines = BB_MAX(maxLines, 1u);
+	first = line > maxLines / 2 ? line - maxLines / 2 : 0;
+	last = BB_MIN(first + maxLines - 1, count - 1);
+	if(last - first + 1 < maxLines) {
+		first = last + 1 > maxLines ? last + 1 - maxLines : 0;
+	}
+	while(gapBufferWindow_line_end(w, last) - gapBufferWindow_line_start(w, first) > maxBytes) {
+		// trim whichever side reaches further from line
+		if(last > line && (first == line || last - line >= line - first)) {
+			--last;
+		} else if(first < line) {
+			++first;
+		} else {
+			break;
+		}
+	}
+
+	gapBufferWindow_move_lines_gap(w, first);
+	w->start = gapBufferWindow_line_start(w, first);
+	w->len = gapBufferWindow_line_end(w, last) - w->start;
+	w->linesWindow = last - first + 1;
+	after = w->linesAllocated - w->linesAfter;
+	for(i = 0; i < w->linesWindow; ++i) {
+		w->lines[w->linesBefore + i] = w->textLen - w->lines[after + i] - w->start;
+	}
+	w->linesAfter -= w->linesWindow;
+	w->bOpen = true;
+	return gapBuffer_flatten_range(gb, w->start, w->len);
+}
+
+void gapBufferWindow_close(gapBufferWindow *w)
+{
+	u32 i;
+	if(!w->bOpen)
+		return;
+	for(i = 0; i < w->linesWindow; ++i) {
+		w->lines[w->linesBefore + i] += w->start;
+	}
+	w->linesBefore += w->linesWindow;
+	w->linesWindow = 0;
+	w->bOpen = false;
+}
+
+b32 gapBufferWindow_commit(gapBufferWindow *w, gapBuffer *gb, const char *text, u64 len)
+{
+	u32 count;
+	if(!w->bOpen)
+		return false;
+	if(len == w->len && !memcmp(text, gapBuffer_flatten_range(gb, w->start, w->len), (size_t)len))
+		return false;
+
+	count = 1 + gapBufferWindow_count_lines(text, len);
+	if(!gapBufferWindow_reserve_lines(w, count))
+		return false;
+	if(!gapBuffer_replace(gb, w->start, w->len, text, len))
+		return false;
+
+	w->textLen = w->textLen - w->len + len;
+	w->len = len;
+	w->lines[w->linesBefore] = 0;
+	w->linesWindow = 1 + gapBufferWindow_add_lines(w->lines + w->linesBefore + 1, text, len, 0);
+	w->edits = gb->edits;
+	return true;
+}
@@ -0,0 +1,753 @@
+// Copyright (c) 2012-2019 Matt Campbell
+// MIT license (see License.txt)
+
+#include "imgui_text_search.h"
+#include "bb_array.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define TEXTSEARCH_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define TEXTSEARCH_AVX2_FUNC
+#else
+#define TEXTSEARCH_AVX2_FUNC __attribute__((target("avx2")))
+#endif
+#endif
+
+enum {
+	kTextSearch_MaxTokens = 128,
+	kTextSearch_MaxPrefix = 64,
+	kTextSearch_MaxInsts = kTextSearch_MaxTokens * 2, // + becomes one token followed by *
+};
+
+static const u64 kTextSearch_NoMatch = ~0ull;
+
+typedef enum textSearchQuantifier_e {
+	kTextSearchQuant_One,
+	kTextSearchQuant_Optional,
+	kTextSearchQuant_Star,
+	kTextSearchQuant_Plus,
+} textSearchQuantifier;
+
+typedef struct tag_textSearchToken {
+	u8 bits[32]; // bytes accepted, never including '\n'
+	u32 quantifier;
+} textSearchToken;
+
+// One step of the matching program: accept a byte from tokens[token] once (kTextSearchQuant_One
+// or kTextSearchQuant_Optional) or any number of times (kTextSearchQuant_Star).
+typedef struct tag_textSearchInst {
+	u16 token;
+	u16 quantifier;
+} textSearchInst;
+
+// A match in progress: it started at start, and waits at pc for the next byte.  pc == instCount
+// is a complete match.
+typedef struct tag_textSearchThread {
+	u64 start;
+	u32 pc;
+	u8 pad[4];
+} textSearchThread;
+
+struct textSearchRegex_s {
+	textSearchToken tokens[kTextSearch_MaxTokens];
+	u32 tokenCount;
+	b32 bAnchorStart;
+	b32 bAnchorEnd;
+	u32 prefixLen; // leading single-character tokens, searched for literally to find candidates
+	char prefix[kTextSearch_MaxPrefix];
+	textSearchInst insts[kTextSearch_MaxInsts];
+	u32 instCount;
+
+	// Matcher state, kept across textSearch_update calls that run out of budget.  The live threads
+	// wait at pos, ordered by priority, and stamps[pc] == stamp marks the pcs already among them.
+	u32 stamps[kTextSearch_MaxInsts + 1];
+	u32 stamp;
+	u32 current; // index of the live thread list in threads
+	u32 threadCount;
+	b32 bRunning; // false to start over at scannedLen
+	u64 pos;
+	u64 matchStart; // best match found so far, waiting on higher priority threads, or kTextSearch_NoMatch
+	u64 matchEnd;
+	textSearchThread threads[2][kTextSearch_MaxInsts + 1];
+};
+
+static u8 textSearch_fold(u8 c)
+{
+	return (c >= 'A' && c <= 'Z') ? (u8)(c + ('a' - 'A')) : c;
+}
+
+static u8 textSearch_upper(u8 c)
+{
+	return (c >= 'a' && c <= 'z') ? (u8)(c - ('a' - 'A')) : c;
+}
+
+static b32 textSearch_equal(const u8 *a, const u8 *b, u64 len, b32 bIgnoreCase)
+{
+	u64 i;
+	if(!bIgnoreCase)
+		return memcmp(a, b, (size_t)len) == 0;
+	for(i = 0; i < len; ++i) {
+		if(textSearch_fold(a[i]) != textSearch_fold(b[i]))
+			return false;
+	}
+	return true;
+}
+
+static u64 textSearch_find_scalar(const u8 *text, u64 len, u64 start, const u8 *pattern, u64 patternLen, b32 bIgnoreCase)
+{
+	u8 first = textSearch_fold(pattern[0]);
+	u64 i;
+	for(i = start; i + patternLen <= len; ++i) {
+		u8 c = text[i];
+		if((c == pattern[0] || (bIgnoreCase && textSearch_fold(c) == first)) &&
+		   textSearch_equal(text + i + 1, pattern + 1, patternLen - 1, bIgnoreCase)) {
+			return i;
+		}
+	}
+	return len;
+}
+
+#if defined(TEXTSEARCH_X86)
+
+static u32 textSearch_ctz(u32 mask)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return (u32)index;
+#else
+	return (u32)__builtin_ctz(mask);
+#endif
+}
+
+// Compares the first and last pattern bytes against 16 candidate positions at once, and only
+// verifies the positions where both match.  Case folding compares against both cases.
+static u64 textSearch_find_sse2(const u8 *text, u64 len, const u8 *pattern, u64 patternLen, b32 bIgnoreCase)
+{
+	u8 first = bIgnoreCase ? textSearch_fold(pattern[0]) : pattern[0];
+	u8 last = bIgnoreCase ? textSearch_fold(pattern[patternLen - 1]) : pattern[patternLen - 1];
+	__m128i firstLower = _mm_set1_epi8((char)first);
+	__m128i firstUpper = _mm_set1_epi8((char)(bIgnoreCase ? textSearch_upper(first) : first));
+	__m128i lastLower = _mm_set1_epi8((char)last);
+	__m128i lastUpper = _mm_set1_epi8((char)(bIgnoreCase ? textSearch_upper(last) : last));
+	u64 i = 0;
+	for(; i + patternLen - 1 + 16 <= len; i += 16) {
+		__m128i blockFirst = _mm_loadu_si128((const __m128i *)(text + i));
+		__m128i blockLast = _mm_loadu_si128((const __m128i *)(text + i + patternLen - 1));
+		__m128i eqFirst = _mm_or_si128(_mm_cmpeq_epi8(blockFirst, firstLower), _mm_cmpeq_epi8(blockFirst, firstUpper));
+		__m128i eqLast = _mm_or_si128(_mm_cmpeq_epi8(blockLast, lastLower), _mm_cmpeq_epi8(blockLast, lastUpper));
+		u32 mask = (u32)_mm_movemask_epi8(_mm_and_si128(eqFirst, eqLast));
+		while(mask) {
+			u64 candidate = i + textSearch_ctz(mask);
+			if(patternLen <= 2 || textSearch_equal(text + candidate + 1, pattern + 1, patternLen - 2, bIgnoreCase))
+				return candidate;
+			mask &= mask - 1;
+		}
+	}
+	return textSearch_find_scalar(text, len, i, pattern, patternLen, bIgnoreCase);
+}
+
+static TEXTSEARCH_AVX2_FUNC u64 textSearch_find_avx2(const u8 *text, u64 len, const u8 *pattern, u64 patternLen, b32 bIgnoreCase)
+{
+	u8 first = bIgnoreCase ? textSearch_fold(pattern[0]) : pattern[0];
+	u8 last = bIgnoreCase ? textSearch_fold(pattern[patternLen - 1]) : pattern[patternLen - 1];
+	__m256i firstLower = _mm256_set1_epi8((char)first);
+	__m256i firstUpper = _mm256_set1_epi8((char)(bIgnoreCase ? textSearch_upper(first) : first));
+	__m256i lastLower = _mm256_set1_epi8((char)last);
+	__m256i lastUpper = _mm256_set1_epi8((char)(bIgnoreCase ? textSearch_upper(last) : last));
+	u64 i = 0;
+	for(; i + patternLen - 1 + 32 <= len; i += 32) {
+		__m256i blockFirst = _mm256_loadu_si256((const __m256i *)(text + i));
+		__m256i blockLast = _mm256_loadu_si256((const __m256i *)(text + i + patternLen - 1));
+		__m256i eqFirst = _mm256_or_si256(_mm256_cmpeq_epi8(blockFirst, firstLower), _mm256_cmpeq_epi8(blockFirst, firstUpper));
+		__m256i eqLast = _mm256_or_si256(_mm256_cmpeq_epi8(blockLast, lastLower), _mm256_cmpeq_epi8(blockLast, lastUpper));
+		u32 mask = (u32)_mm256_movemask_epi8(_mm256_and_si256(eqFirst, eqLast));
+		while(mask) {
+			u64 candidate = i + textSearch_ctz(mask);
+			if(patternLen <= 2 || textSearch_equal(text + candidate + 1, pattern + 1, patternLen - 2, bIgnoreCase))
+				return candidate;
+			mask &= mask - 1;
+		}
+	}
+	return textSearch_find_scalar(text, len, i, pattern, patternLen, bIgnoreCase);
+}
+
+static b32 textSearch_detect_avx2(void)
+{
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	if(info[0] < 7)
+		return false;
+	__cpuid(info, 1);
+	if((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0) // OSXSAVE, AVX
+		return false;
+	if((_xgetbv(0) & 6) != 6) // OS saves XMM and YMM state
+		return false;
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+#endif // #if defined(TEXTSEARCH_X86)
+
+u64 textSearch_find_literal(const char *text, u64 textLen, const char *pattern, u64 patternLen, b32 bIgnoreCase)
+{
+	const u8 *utext = (const u8 *)text;
+	const u8 *upattern = (const u8 *)pattern;
+	if(!patternLen)
+		return 0;
+	if(patternLen > textLen)
+		return textLen;
+	if(patternLen == 1 && (!bIgnoreCase || textSearch_fold(upattern[0]) == textSearch_upper(upattern[0]))) {
+		const void *found = memchr(text, pattern[0], (size_t)textLen);
+		return found ? (u64)((const char *)found - text) : textLen;
+	}
+#if defined(TEXTSEARCH_X86)
+	{
+		// detection is idempotent, so racing threads just store the same answer
+		static int s_hasAvx2 = -1;
+		if(s_hasAvx2 < 0) {
+			s_hasAvx2 = textSearch_detect_avx2() ? 1 : 0;
+		}
+		if(s_hasAvx2)
+			return textSearch_find_avx2(utext, textLen, upattern, patternLen, bIgnoreCase);
+		return textSearch_find_sse2(utext, textLen, upattern, patternLen, bIgnoreCase);
+	}
+#else
+	return textSearch_find_scalar(utext, textLen, 0, upattern, patternLen, bIgnoreCase);
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////
+// regex
+
+static void textSearch_bit_set(textSearchToken *token, u8 c, b32 bIgnoreCase)
+{
+	token->bits[c >> 3] |= (u8)(1 << (c & 7));
+	if(bIgnoreCase) {
+		u8 lower = textSearch_fold(c);
+		u8 upper = textSearch_upper(c);
+		token->bits[lower >> 3] |= (u8)(1 << (lower & 7));
+		token->bits[upper >> 3] |= (u8)(1 << (upper & 7));
+	}
+}
+
+static b32 textSearch_bit_test(const textSearchToken *token, u8 c)
+{
+	return (token->bits[c >> 3] & (1 << (c & 7))) != 0;
+}
+
+static void textSearch_bit_range(textSearchToken *token, u8 first, u8 last, b32 bIgnoreCase)
+{
+	u32 c;
+	for(c = first; c <= last; ++c) {
+		textSearch_bit_set(token, (u8)c, bIgnoreCase);
+	}
+}
+
+// \d \w \s and their negations.  Returns false for other escapes, which are literal.
+static b32 textSearch_escape_class(textSearchToken *token, char escape)
+{
+	textSearchToken cls;
+	u32 i;
+	memset(&cls, 0, sizeof(cls));
+	switch(escape) {
+	case 'd':
+	case 'D':
+		textSearch_bit_range(&cls, '0', '9', false);
+		break;
+	case 'w':
+	case 'W':
+		textSearch_bit_range(&cls, '0', '9', false);
+		textSearch_bit_range(&cls, 'a', 'z', false);
+		textSearch_bit_range(&cls, 'A', 'Z', false);
+		textSearch_bit_set(&cls, '_', false);
+		break;
+	case 's':
+	case 'S':
+		textSearch_bit_set(&cls, ' ', false);
+		textSearch_bit_set(&cls, '\t', false);
+		textSearch_bit_set(&cls, '\r', false);
+		textSearch_bit_set(&cls, '\f', false);
+		textSearch_bit_set(&cls, '\v', false);
+		break;
+	default:
+		return false;
+	}
+	for(i = 0; i < BB_ARRAYSIZE(cls.bits); ++i) {
+		token->bits[i] |= (escape >= 'A' && escape <= 'Z') ? (u8)~cls.bits[i] : cls.bits[i];
+	}
+	return true;
+}
+
+static const char *textSearch_parse_class(textSearchToken *token, const char *p, const char *end, b32 bIgnoreCase)
+{
+	textSearchToken cls;
+	b32 bNegate = false;
+	b32 bFirst = true;
+	u32 i;
+	memset(&cls, 0, sizeof(cls));
+	if(p < end && *p == '^') {
+		bNegate = true;
+		++p;
+	}
+	while(p < end && (*p != ']' || bFirst)) {
+		u8 c = (u8)*p++;
+		bFirst = false;
+		if(c == '\\' && p < end) {
+			if(textSearch_escape_class(&cls, *p)) {
+				++p;
+				continue;
+			}
+			c = (u8)*p++;
+		}
+		if(p + 1 < end && *p == '-' && p[1] != ']') {
+			u8 last = (u8)p[1];
+			p += 2;
+			if(last < c)
+				return NULL;
+			textSearch_bit_range(&cls, c, last, bIgnoreCase);
+		} else {
+			textSearch_bit_set(&cls, c, bIgnoreCase);
+		}
+	}
+	if(p >= end)
+		return NULL;
+	for(i = 0; i < BB_ARRAYSIZE(cls.bits); ++i) {
+		token->bits[i] = bNegate ? (u8)~cls.bits[i] : cls.bits[i];
+	}
+	return p + 1;
+}
+
+static textSearchRegex *textSearch_regex_compile(const char *pattern, u64 patternLen, b32 bIgnoreCase)
+{
+	const char *p = pattern;
+	const char *end = pattern + patternLen;
+	textSearchRegex *re = (textSearchRegex *)malloc(sizeof(textSearchRegex));
+	u32 i;
+	if(!re)
+		return NULL;
+	memset(re, 0, sizeof(*re));
+	if(p < end && *p == '^') {
+		re->bAnchorStart = true;
+		++p;
+	}
+	while(p < end) {
+		textSearchToken *token;
+		char c = *p++;
+		if(c == '$' && p == end) {
+			re->bAnchorEnd = true;
+			break;
+		}
+		if(c == '*' || c == '+' || c == '?') {
+			if(!re->tokenCount || re->tokens[re->tokenCount - 1].quantifier != kTextSearchQuant_One)
+				goto fail;
+			re->tokens[re->tokenCount - 1].quantifier = c == '*' ? kTextSearchQuant_Star : c == '+' ? kTextSearchQuant_Plus : kTextSearchQuant_Optional;
+			continue;
+		}
+		if(re->tokenCount == kTextSearch_MaxTokens)
+			goto fail;
+		token = re->tokens + re->tokenCount++;
+		if(c == '.') {
+			memset(token->bits, 0xff, sizeof(token->bits));
+		} else if(c == '[') {
+			p = textSearch_parse_class(token, p, end, bIgnoreCase);
+			if(!p)
+				goto fail;
+		} else if(c == '\\') {
+			if(p == end)
+				goto fail;
+			c = *p++;
+			if(!textSearch_escape_class(token, c)) {
+				textSearch_bit_set(token, (u8)c, bIgnoreCase);
+			}
+		} else {
+			textSearch_bit_set(token, (u8)c, bIgnoreCase);
+		}
+		token->bits['\n' >> 3] &= (u8)~(1 << ('\n' & 7));
+	}
+
+	for(i = 0; i < re->tokenCount; ++i) {
+		const textSearchToken *token = re->tokens + i;
+		textSearchInst *inst = re->insts + re->instCount++;
+		inst->token = (u16)i;
+		inst->quantifier = (u16)token->quantifier;
+		if(token->quantifier == kTextSearchQuant_Plus) {
+			inst->quantifier = kTextSearchQuant_One;
+			inst = re->insts + re->instCount++;
+			inst->token = (u16)i;
+			inst->quantifier = kTextSearchQuant_Star;
+		}
+	}
+
+	// a run of single-character tokens at the start can be found with the vectorized literal search
+	for(i = 0; i < re->tokenCount && re->prefixLen < kTextSearch_MaxPrefix; ++i) {
+		const textSearchToken *token = re->tokens + i;
+		u32 c;
+		u32 matched = 0;
+		u32 accepted = 0;
+		if(token->quantifier != kTextSearchQuant_One)
+			break;
+		for(c = 0; c < 256; ++c) {
+			if(textSearch_bit_test(token, (u8)c)) {
+				++accepted;
+				matched = c;
+			}
+		}
+		if(accepted == 1 || (accepted == 2 && bIgnoreCase && matched >= 'a' && matched <= 'z' && textSearch_bit_test(token, textSearch_upper((u8)matched)))) {
+			re->prefix[re->prefixLen++] = (char)matched;
+		} else {
+			break;
+		}
+	}
+	return re;
+
+fail:
+	free(re);
+	return NULL;
+}
+
+// Regexes are matched by running every way the tokens could match side by side, one byte at a time,
+// so the work is linear in the text no matter how the quantifiers overlap.  Threads are kept in the
+// order a greedy backtracking matcher would try them, so the matches are the same ones: the leftmost,
+// with each quantifier taking as much as it can.  Tokens never accept '\n', so no thread outlives
+// its line.
+
+static void textSearch_regex_next_stamp(textSearchRegex *re)
+{
+	if(++re->stamp == 0) {
+		memset(re->stamps, 0, sizeof(re->stamps));
+		re->stamp = 1;
+	}
+}
+
+// Appends the thread at pc, and those reached by skipping optional tokens after it, unless a higher
+// priority thread already got there - from there on the two can only do the same thing.
+static void textSearch_regex_add(textSearchRegex *re, textSearchThread *threads, u32 *count, u32 pc, u64 start)
+{
+	while(re->stamps[pc] != re->stamp) {
+		textSearchThread *thread = threads + (*count)++;
+		re->stamps[pc] = re->stamp;
+		thread->start = start;
+		thread->pc = pc;
+		if(pc == re->instCount || re->insts[pc].quantifier == kTextSearchQuant_One)
+			break;
+		++pc;
+	}
+}
+
+// Feeds text[pos] to the threads waiting at pos.  A complete match is kept as the best so far, and
+// drops the lower priority threads behind it.  An empty match is ignored - a longer one from the
+// same start would have had higher priority, so nothing can be found there.
+static void textSearch_regex_step(textSearchRegex *re, const u8 *text, u64 textLen)
+{
+	const textSearchThread *threads = re->threads[re->current];
+	textSearchThread *next = re->threads[re->current ^ 1];
+	u64 pos = re->pos;
+	u32 nextCount = 0;
+	u32 i;
+	textSearch_regex_next_stamp(re);
+	for(i = 0; i < re->threadCount; ++i) {
+		const textSearchThread *thread = threads + i;
+		if(thread->pc == re->instCount) {
+			if(pos > thread->start && (!re->bAnchorEnd || pos == textLen || text[pos] == '\n' || text[pos] == '\r')) {
+				re->matchStart = thread->start;
+				re->matchEnd = pos;
+				break;
+			}
+		} else if(pos < textLen) {
+			const textSearchInst *inst = re->insts + thread->pc;
+			if(textSearch_bit_test(re->tokens + inst->token, text[pos])) {
+				u32 pc = inst->quantifier == kTextSearchQuant_Star ? thread->pc : thread->pc + 1;
+				textSearch_regex_add(re, next, &nextCount, pc, thread->start);
+			}
+		}
+	}
+	re->current ^= 1;
+	re->threadCount = nextCount;
+	++re->pos;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// cached search
+
+void textSearch_init(textSearch *search)
+{
+	memset(search, 0, sizeof(*search));
+	search->current = kTextSearch_None;
+}
+
+void textSearch_reset(textSearch *search)
+{
+	bba_free(search->matches);
+	free(search->regex);
+	free(search->pattern);
+	textSearch_init(search);
+}
+
+b32 textSearch_set_pattern(textSearch *search, const char *pattern, u32 flags)
+{
+	u64 patternLen = pattern ? strlen(pattern) : 0;
+	if(search->pattern && patternLen == search->patternLen && flags == search->flags && !memcmp(pattern, search->pattern, (size_t)patternLen))
+		return search->bValid;
+
+	free(search->regex);
+	free(search->pattern);
+	search->regex = NULL;
+	search->pattern = (char *)malloc((size_t)patternLen + 1);
+	search->patternLen = search->pattern ? patternLen : 0;
+	if(search->pattern) {
+		memcpy(search->pattern, pattern, (size_t)patternLen);
+		search->pattern[patternLen] = '\0';
+	}
+	search->flags = flags;
+	search->bValid = search->patternLen > 0;
+	if(search->bValid && (flags & kTextSearch_Regex) != 0) {
+		search->regex = textSearch_regex_compile(search->pattern, search->patternLen, (flags & kTextSearch_IgnoreCase) != 0);
+		search->bValid = search->regex && search->regex->tokenCount > 0;
+	}
+
+	// textLen of zero makes the next update treat the whole text as appended
+	search->matches.count = 0;
+	search->textLen = 0;
+	search->scannedLen = 0;
+	search->current = kTextSearch_None;
+	search->bScrollToCurrent = false;
+	search->bTruncated = false;
+	return search->bValid;
+}
+
+static void textSearch_restart(textSearch *search)
+{
+	if(search->regex) {
+		search->regex->bRunning = false;
+	}
+	search->matches.count = 0;
+	search->scannedLen = 0;
+	search->current = kTextSearch_None;
+	search->bTruncated = false;
+}
+
+// Matches at the end of the old text can change when text is appended - a literal can newly straddle
+// the old end, and a regex match on the last line can grow or stop matching $.  Rescans from there.
+static void textSearch_rewind_for_append(textSearch *search, const u8 *text)
+{
+	u64 oldLen = search->textLen;
+	u64 resume;
+	if(search->regex) {
+		resume = oldLen;
+		while(resume > 0 && text[resume - 1] != '\n') {
+			--resume;
+		}
+		// the matcher may have taken the old end as the end of the text
+		search->regex->bRunning = false;
+	} else {
+		resume = oldLen >= search->patternLen ? oldLen - search->patternLen + 1 : 0;
+		if(search->matches.count) {
+			const textSearchMatch *last = search->matches.data + search->matches.count - 1;
+			resume = BB_MAX(resume, last->offset + last->length);
+		}
+	}
+	if(resume >= search->scannedLen)
+		return;
+	while(search->matches.count && search->matches.data[search->matches.count - 1].offset >= resume) {
+		--search->matches.count;
+	}
+	if(search->current != kTextSearch_None && search->current >= search->matches.count) {
+		search->current = kTextSearch_None;
+	}
+	search->scannedLen = resume;
+	search->bTruncated = false;
+}
+
+static b32 textSearch_add_match(textSearch *search, u64 offset, u64 length)
+{
+	textSearchMatch match;
+	if(search->matches.count >= kTextSearch_MaxMatches) {
+		search->bTruncated = true;
+		return false;
+	}
+	match.offset = offset;
+	match.length = length;
+	bba_push(search->matches, match);
+	return true;
+}
+
+static u64 textSearch_scan_literal(textSearch *search, const u8 *text, u64 textLen, u64 pos, u64 windowEnd)
+{
+	// candidates must start inside the window, but may run past it
+	u64 searchEnd = BB_MIN(textLen, windowEnd + search->patternLen - 1);
+	b32 bIgnoreCase = (search->flags & kTextSearch_IgnoreCase) != 0;
+	while(pos < windowEnd) {
+		u64 found = pos + textSearch_find_literal((const char *)text + pos, searchEnd - pos, search->pattern, search->patternLen, bIgnoreCase);
+		if(found >= windowEnd || found + search->patternLen > searchEnd)
+			return windowEnd;
+		if(!textSearch_add_match(search, found, search->patternLen))
+			return textLen;
+		pos = found + search->patternLen;
+	}
+	return pos;
+}
+
+// Runs the matcher for at most budget bytes, each byte stepped or skipped costing one, and returns
+// the offset before which every match has been found.  Picks up where the last call stopped.
+static u64 textSearch_scan_regex(textSearch *search, const u8 *text, u64 textLen, u64 budget)
+{
+	textSearchRegex *re = search->regex;
+	b32 bIgnoreCase = (search->flags & kTextSearch_IgnoreCase) != 0;
+	if(!re->bRunning) {
+		re->bRunning = true;
+		re->pos = search->scannedLen;
+		re->threadCount = 0;
+		re->matchStart = kTextSearch_NoMatch;
+	}
+	while(budget) {
+		u64 pos = re->pos;
+		if(!re->threadCount) {
+			// nothing in progress, so skip to the next place a match could start
+			u64 skipEnd;
+			u64 next = pos;
+			if(pos >= textLen)
+				break;
+			skipEnd = (budget < textLen - pos) ? pos + budget : textLen;
+			if(re->bAnchorStart) {
+				if(pos > 0 && text[pos - 1] != '\n') {
+					const u8 *newline = (const u8 *)memchr(text + pos, '\n', (size_t)(skipEnd - pos));
+					next = newline ? (u64)(newline - text) + 1 : skipEnd;
+				}
+			} else if(re->prefixLen) {
+				u64 searchEnd = BB_MIN(textLen, skipEnd + re->prefixLen - 1);
+				next = pos + textSearch_find_literal((const char *)text + pos, searchEnd - pos, re->prefix, re->prefixLen, bIgnoreCase);
+				next = BB_MIN(next, skipEnd);
+			}
+			budget -= next - pos;
+			re->pos = pos = next;
+			if(!budget || pos >= textLen)
+				break;
+			textSearch_regex_next_stamp(re);
+		}
+		if(re->matchStart == kTextSearch_NoMatch && pos < textLen && (!re->bAnchorStart || pos == 0 || text[pos - 1] == '\n')) {
+			textSearch_regex_add(re, re->threads[re->current], &re->threadCount, 0, pos);
+		}
+		textSearch_regex_step(re, text, textLen);
+		--budget;
+		if(!re->threadCount) {
+			if(re->matchStart != kTextSearch_NoMatch) {
+				if(!textSearch_add_match(search, re->matchStart, re->matchEnd - re->matchStart))
+					return textLen;
+				re->pos = re->matchEnd;
+				re->matchStart = kTextSearch_NoMatch;
+			} else if(pos >= textLen) {
+				re->pos = textLen;
+				break;
+			}
+		}
+	}
+	// threads are ordered by start, and a waiting match starts no earlier than the threads ahead of it
+	return re->threadCount ? re->threads[re->current][0].start : re->pos;
+}
+
+b32 textSearch_update(textSearch *search, const char *text, u64 textLen, u64 version, u64 maxScanBytes)
+{
+	const u8 *utext = (const u8 *)text;
+	clock_t start;
+	if(!search->bValid) {
+		search->matches.count = 0;
+		search->textLen = textLen;
+		search->scannedLen = textLen;
+		return true;
+	}
+
+	if(version != search->textVersion || textLen < search->textLen) {
+		textSearch_restart(search);
+	} else if(textLen > search->textLen) {
+		textSearch_rewind_for_append(search, utext);
+	}
+	search->textLen = textLen;
+	search->textVersion = version;
+	if(search->scannedLen >= textLen)
+		return true;
+
+	start = clock();
+	if(search->regex) {
+		search->scannedLen = textSearch_scan_regex(search, utext, textLen, maxScanBytes ? maxScanBytes : ~0ull);
+	} else {
+		u64 windowEnd = (maxScanBytes && textLen - search->scannedLen > maxScanBytes) ? search->scannedLen + maxScanBytes : textLen;
+		search->scannedLen = textSearch_scan_literal(search, utext, textLen, search->scannedLen, windowEnd);
+	}
+	search->lastScanSeconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+	return search->scannedLen >= textLen;
+}
+
+u32 textSearch_first_ending_after(const textSearch *search, u64 offset)
+{
+	// matches don't overlap, so their ends are sorted too
+	u32 lo = 0;
+	u32 hi = search->matches.count;
+	while(lo < hi) {
+		u32 mid = lo + (hi - lo) / 2;
+		const textSearchMatch *match = search->matches.data + mid;
+		if(match->offset + match->length > offset) {
+			hi = mid;
+		} else {
+			lo = mid + 1;
+		}
+	}
+	return lo;
+}
+
+static u32 textSearch_first_starting_at(const textSearch *search, u64 offset)
+{
+	u32 lo = 0;
+	u32 hi = search->matches.count;
+	while(lo < hi) {
+		u32 mid = lo + (hi - lo) / 2;
+		if(search->matches.data[mid].offset >= offset) {
+			hi = mid;
+		} else {
+			lo = mid + 1;
+		}
+	}
+	return lo;
+}
+
+void textSearch_select_next(textSearch *search, u64 offset)
+{
+	u32 count = search->matches.count;
+	if(!count) {
+		search->current = kTextSearch_None;
+		return;
+	}
+	if(search->current == kTextSearch_None) {
+		search->current = textSearch_first_starting_at(search, offset);
+		if(search->current >= count) {
+			search->current = 0;
+		}
+	} else {
+		search->current = (search->current + 1) % count;
+	}
+	search->bScrollToCurrent = true;
+}
+
+void textSearch_select_prev(textSearch *search, u64 offset)
+{
+	u32 count = search->matches.count;
+	if(!count) {
+		search->current = kTextSearch_None;
+		return;
+	}
+	if(search->current == kTextSearch_None) {
+		search->current = textSearch_first_starting_at(search, offset);
+	}
+	search->current = search->current ? search->current - 1 : count - 1;
+	search->bScrollToCurrent = true;
+}
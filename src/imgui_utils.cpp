@@ -3,8 +3,9 @@
 
 #include "imgui_utils.h"
 #include "imgui_core.h"
+#include "imgui_input_text.h"
+#include "imgui_selection.h"
 #include "sb.h"
-#include "va.h"
 #include <math.h>
 
 // warning C4820 : 'StructName' : '4' bytes padding added after data member 'MemberName'
@@ -14,9 +15,50 @@ BB_WARNING_PUSH(4820, 4365)
 #include "imgui_internal.h"
 BB_WARNING_POP
 
+// Routes resize events for sb_t-backed inputs to InputTextResizeCallback, and everything else to the
+// caller's callback with the caller's user data.
+struct InputTextSbUserData {
+	sb_t *sb;
+	ImGuiInputTextCallback callback;
+	void *userData;
+	u32 maxSize;
+	u8 pad[4];
+};
+
+static int InputTextSbCallback(ImGuiInputTextCallbackData *data)
+{
+	InputTextSbUserData *sbUserData = (InputTextSbUserData *)data->UserData;
+	if(data->EventFlag == ImGuiInputTextFlags_CallbackResize)
+		return ImGui::InputTextResizeCallback(data, sbUserData->sb, sbUserData->maxSize);
+	data->UserData = sbUserData->userData;
+	int ret = sbUserData->callback ? sbUserData->callback(data) : 0;
+	data->UserData = sbUserData;
+	return ret;
+}
+
+// Joins prefix and text into buffer, truncating to fit - per-frame labels are built on the stack
+// rather than formatted through va() for every item drawn.
+static const char *BuildLabel(char *buffer, size_t bufferSize, const char *prefix, const char *text)
+{
+	size_t prefixLen = strlen(prefix);
+	size_t textLen = strlen(text);
+	if(prefixLen > bufferSize - 1) {
+		prefixLen = bufferSize - 1;
+	}
+	if(textLen > bufferSize - 1 - prefixLen) {
+		textLen = bufferSize - 1 - prefixLen;
+	}
+	memcpy(buffer, prefix, prefixLen);
+	memcpy(buffer + prefixLen, text, textLen);
+	buffer[prefixLen + textLen] = '\0';
+	return buffer;
+}
+
 namespace ImGui
 {
 	int s_tabCount;
+	static ImDrawList *s_columnChannelsDrawList;
+	static u32 s_columnChannelsCount;
 	ImColor s_shadowColor(0, 0, 0);
 
 	void PushStyleColor(ImGuiCol idx, const ImColor &col)
@@ -130,13 +172,16 @@ namespace ImGui
 		return GetCurrentContext()->MovingWindow != nullptr;
 	}
 
+	// sb grows on demand up to buf_size, and its count is set by the resize callback, so frames
+	// without edits neither allocate nor strlen.
 	bool InputText(const char *label, sb_t *sb, u32 buf_size, ImGuiInputTextFlags flags, ImGuiInputTextCallback callback, void *user_data)
 	{
-		if(sb->allocated < buf_size) {
-			sb_reserve(sb, buf_size);
-		}
-		bool ret = InputText(label, (char *)sb->data, sb->allocated, flags, callback, user_data);
-		sb->count = sb->data ? (u32)strlen(sb->data) + 1 : 0;
+		IM_ASSERT((flags & ImGuiInputTextFlags_CallbackResize) == 0);
+		InputTextSbUserData sbUserData = { sb, callback, user_data, buf_size, {} };
+		char emptyText[1] = { '\0' };
+		char *buf = sb->data ? sb->data : emptyText;
+		size_t size = sb->data ? sb->allocated : 1;
+		bool ret = InputText(label, buf, size, flags | ImGuiInputTextFlags_CallbackResize, InputTextSbCallback, &sbUserData);
 		if(IsItemActive() && Imgui_Core_HasFocus()) {
 			Imgui_Core_RequestRender();
 		}
@@ -145,11 +190,12 @@ namespace ImGui
 
 	bool InputTextMultiline(const char *label, sb_t *sb, u32 buf_size, const ImVec2 &size, ImGuiInputTextFlags flags, ImGuiInputTextCallback callback, void *user_data)
 	{
-		if(sb->allocated < buf_size) {
-			sb_reserve(sb, buf_size);
-		}
-		bool ret = InputTextMultiline(label, (char *)sb->data, sb->allocated, size, flags, callback, user_data);
-		sb->count = sb->data ? (u32)strlen(sb->data) + 1 : 0;
+		IM_ASSERT((flags & ImGuiInputTextFlags_CallbackResize) == 0);
+		InputTextSbUserData sbUserData = { sb, callback, user_data, buf_size, {} };
+		char emptyText[1] = { '\0' };
+		char *buf = sb->data ? sb->data : emptyText;
+		size_t bufSize = sb->data ? sb->allocated : 1;
+		bool ret = InputTextMultiline(label, buf, bufSize, size, flags | ImGuiInputTextFlags_CallbackResize, InputTextSbCallback, &sbUserData);
 		if(IsItemActive() && Imgui_Core_HasFocus()) {
 			Imgui_Core_RequestRender();
 		}
@@ -177,10 +223,7 @@ namespace ImGui
 
 	void SelectableTextUnformattedMultiline(const char *label, const char *text, ImVec2 size)
 	{
-		InputTextMultiline(label, const_cast< char * >(text), strlen(text) + 1, size, ImGuiInputTextFlags_ReadOnly);
-		if(IsItemActive() && Imgui_Core_HasFocus()) {
-			Imgui_Core_RequestRender();
-		}
+		TextViewer(label, text, strlen(text), size);
 	}
 
 	void SelectableTextUnformatted(const char *label, const char *text)
@@ -340,12 +383,38 @@ namespace ImGui
 	{
 		float offset = h.columnOffsets[columnIndex];
 		float width = h.columnWidths[columnIndex] * Imgui_Core_GetDpiScale();
+		bool bChannel = s_columnChannelsDrawList && columnIndex < s_columnChannelsCount && s_columnChannelsDrawList == GetWindowDrawList();
+		if(bChannel) {
+			s_columnChannelsDrawList->ChannelsSetCurrent((int)columnIndex + 1);
+		}
 		PushColumnHeaderClipRect(offset, width);
 		if(columnIndex) {
 			SameLine(offset);
 		}
 		TextUnformatted(text, end);
 		PopClipRect();
+		if(bChannel) {
+			s_columnChannelsDrawList->ChannelsSetCurrent(0);
+		}
+	}
+
+	// Popping a column's clip rect leaves an empty command in its channel, which the next push with
+	// the same rect pops again - so each channel collects its column's text in a single command.
+	void BeginColumnChannels(const columnDrawData &h)
+	{
+		IM_ASSERT(!s_columnChannelsDrawList);
+		s_columnChannelsDrawList = GetWindowDrawList();
+		s_columnChannelsCount = h.numColumns;
+		s_columnChannelsDrawList->ChannelsSplit((int)h.numColumns + 1);
+	}
+
+	void EndColumnChannels(void)
+	{
+		if(s_columnChannelsDrawList) {
+			s_columnChannelsDrawList->ChannelsMerge();
+			s_columnChannelsDrawList = nullptr;
+			s_columnChannelsCount = 0;
+		}
 	}
 
 	void DrawColumnHeaderText(float offset, float width, const char *text, const char *end, const char *contextMenuName)
@@ -376,8 +445,9 @@ namespace ImGui
 		}
 		float scale = (Imgui_Core_GetDpiScale() <= 0.0f) ? 1.0f : Imgui_Core_GetDpiScale();
 		float startOffset = GetCursorPosX();
+		char label[256];
 
-		if(Button(va("###%s", text), sortable ? kButton_ColumnHeader : kButton_ColumnHeaderNoSort, ImVec2(*width * scale, 0.0f)) && sortable) {
+		if(Button(BuildLabel(label, sizeof(label), "###", text), sortable ? kButton_ColumnHeader : kButton_ColumnHeaderNoSort, ImVec2(*width * scale, 0.0f)) && sortable) {
 			res.sortChanged = true;
 			if(*h.sortColumn == columnIndex) {
 				*h.sortDescending = !*h.sortDescending;
@@ -392,12 +462,12 @@ namespace ImGui
 
 		res.active = res.active || IsItemActive();
 		float endOffset = startOffset + *width * scale + GetStyle().ItemSpacing.x;
-		const char *columnText = (sortable && *h.sortColumn == columnIndex) ? va("%s %s", *h.sortDescending ? ICON_SORT_DOWN : ICON_SORT_UP, text) : text;
+		const char *columnText = (sortable && *h.sortColumn == columnIndex) ? BuildLabel(label, sizeof(label), *h.sortDescending ? ICON_SORT_DOWN " " : ICON_SORT_UP " ", text) : text;
 		const float itemPad = GetStyle().ItemSpacing.x;
 		DrawColumnHeaderText(startOffset + GetStyle().ItemInnerSpacing.x, *width * scale - itemPad, columnText);
 		SameLine(endOffset);
 		if(!last) {
-			Button(va("|###sep%s", text), kButton_ResizeBar, ImVec2(3.0f * Imgui_Core_GetDpiScale(), 0.0f));
+			Button(BuildLabel(label, sizeof(label), "|###sep", text), kButton_ResizeBar, ImVec2(3.0f * Imgui_Core_GetDpiScale(), 0.0f));
 			if(ImGui::IsItemActive() || ImGui::IsItemHovered()) {
 				ImGui::SetMouseCursor(ImGuiMouseCursor_ResizeEW);
 			}
@@ -457,8 +527,7 @@ namespace ImGui
 		float lineHeight = GetTextLineHeightWithSpacing();
 		float deltaY = lineHeight - size.y + 2 * Imgui_Core_GetDpiScale();
 		pos.y += deltaY;
-		drawList->AddText(ImVec2(pos.x + 1, pos.y + 1), ImColor(0, 0, 0), overlay);
-		drawList->AddText(ImVec2(pos.x + 0, pos.y + 0), overlayColor, overlay);
+		AddTextShadowed(drawList, GetFont(), GetFontSize(), pos, overlayColor, ImColor(0, 0, 0), overlay);
 	}
 
 	void IconOverlay(const char *icon, const char *overlay, ImColor overlayColor)
@@ -476,8 +545,7 @@ namespace ImGui
 		float lineHeight = GetTextLineHeightWithSpacing();
 		float deltaY = lineHeight - size.y;
 		pos.y += deltaY;
-		drawList->AddText(ImVec2(pos.x + 1, pos.y + 1), ImColor(0, 0, 0), icon);
-		drawList->AddText(ImVec2(pos.x + 0, pos.y + 0), color, icon);
+		AddTextShadowed(drawList, GetFont(), GetFontSize(), pos, color, ImColor(0, 0, 0), icon);
 	}
 
 	void Icon(const char *icon)
@@ -500,10 +568,8 @@ namespace ImGui
 		}
 
 		ImDrawList *drawList = GetWindowDrawList();
-		if(color.Value.x > 0.0f || color.Value.y > 0.0f || color.Value.z > 0.0f) {
-			drawList->AddText(font, fontSize, ImVec2(pos.x + 1, pos.y + 1), ImColor(0, 0, 0), icon);
-		}
-		drawList->AddText(font, fontSize, ImVec2(pos.x + 0, pos.y + 0), color, icon);
+		bool shadow = color.Value.x > 0.0f || color.Value.y > 0.0f || color.Value.z > 0.0f;
+		AddTextShadowed(drawList, font, fontSize, pos, color, ImColor(0, 0, 0), icon, nullptr, 0.0f, shadow ? kTextShadow_Drop : kTextShadow_None);
 	}
 
 	ImVec2 GetIconPosForButton()
@@ -525,6 +591,232 @@ namespace ImGui
 		return textPos;
 	}
 
+	enum {
+		kTextShadowBatchBytes = 2048,
+	};
+
+	// Emits one layer of glyph quads for [s, end) at the given offset, advancing x across the
+	// batch.  Returns where decoding stopped, which can pass end by the rest of a UTF-8 sequence.
+	static const char *AddTextShadowedLayer(ImDrawList *drawList, ImFont *font, float scale, float *x, float y, ImU32 col, bool bText,
+	                                        const ImVec2 &offset, const ImVec4 &clip, const char *s, const char *end, const char *textEnd, int *numGlyphs)
+	{
+		float penX = *x;
+		while(s < end) {
+			unsigned int c = (unsigned int)*s;
+			if(c < 0x80) {
+				s += 1;
+			} else {
+				s += ImTextCharFromUtf8(&c, s, textEnd);
+				if(c == 0)
+					break;
+			}
+			if(c == '\r')
+				continue;
+
+			const ImFontGlyph *glyph = font->FindGlyph((ImWchar)c);
+			if(!glyph)
+				continue;
+			if(glyph->Visible) {
+				const float x0 = penX + glyph->X0 * scale;
+				const float x1 = penX + glyph->X1 * scale;
+				if(x1 + 1.0f >= clip.x && x0 - 1.0f <= clip.z) {
+					const float y0 = y + glyph->Y0 * scale;
+					const float y1 = y + glyph->Y1 * scale;
+					// colored glyphs (emoji) keep their own colors, as in ImFont::RenderText
+					const ImU32 glyphCol = (bText && glyph->Colored) ? (col | ~IM_COL32_A_MASK) : col;
+					drawList->PrimRectUV(ImVec2(x0 + offset.x, y0 + offset.y), ImVec2(x1 + offset.x, y1 + offset.y),
+					                     ImVec2(glyph->U0, glyph->V0), ImVec2(glyph->U1, glyph->V1), glyphCol);
+					++*numGlyphs;
+				}
+			}
+			penX += glyph->AdvanceX * scale;
+		}
+		*x = penX;
+		return s;
+	}
+
+	// Emits [s, end) as glyph quads: one batch per kTextShadowBatchBytes, each reserving room for the
+	// shadow layers followed by the text, so every shadow in the batch is drawn beneath the text.
+	// Each layer decodes the batch again - cheaper than staging the glyphs - and whatever the
+	// clipped glyphs didn't use is given back with PrimUnreserve, as ImFont::RenderText does.
+	// Returns where decoding stopped, which can pass end by the rest of a UTF-8 sequence.
+	static const char *AddTextShadowedLine(ImDrawList *drawList, ImFont *font, float scale, float x, float y, ImU32 col, ImU32 shadowCol,
+	                                       const ImVec2 *offsets, u32 numOffsets, const ImVec4 &clip, const char *s, const char *end, const char *textEnd)
+	{
+		static const ImVec2 s_noOffset(0.0f, 0.0f);
+		const u32 layers = numOffsets + 1;
+		while(s < end) {
+			const char *batchEnd = (end - s > kTextShadowBatchBytes) ? s + kTextShadowBatchBytes : end;
+			const int maxGlyphs = (int)(batchEnd - s);
+			const int reservedQuads = maxGlyphs * (int)layers;
+			drawList->PrimReserve(reservedQuads * 6, reservedQuads * 4);
+
+			int numQuads = 0;
+			float batchX = x;
+			const char *next = s;
+			for(u32 i = 0; i <= numOffsets; ++i) {
+				const bool bText = i == numOffsets;
+				batchX = x;
+				next = AddTextShadowedLayer(drawList, font, scale, &batchX, y, bText ? col : shadowCol, bText,
+				                            bText ? s_noOffset : offsets[i], clip, s, batchEnd, textEnd, &numQuads);
+			}
+			drawList->PrimUnreserve((reservedQuads - numQuads) * 6, (reservedQuads - numQuads) * 4);
+			x = batchX;
+			s = next;
+		}
+		return s;
+	}
+
+	void AddTextShadowed(ImDrawList *drawList, ImFont *font, float fontSize, const ImVec2 &pos, ImU32 col, ImU32 shadowCol,
+	                     const char *text, const char *textEnd, float wrapWidth, textShadowStyle_e style)
+	{
+		static const ImVec2 s_dropOffsets[] = { ImVec2(1.0f, 1.0f) };
+		static const ImVec2 s_outlineOffsets[] = { ImVec2(-1.0f, 0.0f), ImVec2(1.0f, 0.0f), ImVec2(0.0f, -1.0f), ImVec2(0.0f, 1.0f) };
+
+		if(!textEnd) {
+			textEnd = text + strlen(text);
+		}
+		if(text == textEnd || (col & IM_COL32_A_MASK) == 0)
+			return;
+
+		const ImVec2 *offsets = (style == kTextShadow_Outline) ? s_outlineOffsets : s_dropOffsets;
+		u32 numOffsets = (u32)((style == kTextShadow_Outline) ? BB_ARRAYSIZE(s_outlineOffsets) : BB_ARRAYSIZE(s_dropOffsets));
+		if(style == kTextShadow_None || (shadowCol & IM_COL32_A_MASK) == 0) {
+			numOffsets = 0;
+		}
+
+		const float scale = fontSize / font->FontSize;
+		const float lineHeight = font->FontSize * scale;
+		const bool wordWrap = wrapWidth > 0.0f;
+		const ImVec2 clipMin = drawList->GetClipRectMin();
+		const ImVec2 clipMax = drawList->GetClipRectMax();
+		const ImVec4 clip(clipMin.x, clipMin.y, clipMax.x, clipMax.y);
+		const float startX = IM_FLOOR(pos.x);
+		float y = IM_FLOOR(pos.y);
+		const char *s = text;
+
+		// fast-forward to the first visible line, as ImFont::RenderText does
+		if(!wordWrap) {
+			while(y + lineHeight < clip.y && s < textEnd) {
+				s = (const char *)memchr(s, '\n', (size_t)(textEnd - s));
+				s = s ? s + 1 : textEnd;
+				y += lineHeight;
+			}
+		}
+
+		// pushing the texture already bound doesn't split the draw command
+		drawList->PushTextureID(font->ContainerAtlas->TexID);
+		while(s < textEnd && y <= clip.w) {
+			const char *newline = (const char *)memchr(s, '\n', (size_t)(textEnd - s));
+			const char *lineEnd = newline ? newline : textEnd;
+			bool wrapped = false;
+			if(wordWrap) {
+				// matches ImFont::RenderText, which forces one character onto lines too narrow to fit any
+				const char *wrapEnd = font->CalcWordWrapPositionA(scale, s, lineEnd, wrapWidth);
+				if(wrapEnd == s && s < lineEnd) {
+					++wrapEnd;
+				}
+				if(wrapEnd < lineEnd) {
+					lineEnd = wrapEnd;
+					wrapped = true;
+				}
+			}
+
+			if(y + lineHeight >= clip.y - 1.0f) {
+				s = AddTextShadowedLine(drawList, font, scale, startX, y, col, shadowCol, offsets, numOffsets, clip, s, lineEnd, textEnd);
+			}
+			if(s < lineEnd) {
+				s = lineEnd;
+			}
+			y += lineHeight;
+
+			// wrapping skips the blanks starting the next line, and one newline
+			if(wrapped) {
+				while(s < textEnd && (*s == ' ' || *s == '\t')) {
+					++s;
+				}
+			}
+			if(s < textEnd && *s == '\n') {
+				++s;
+			}
+		}
+		drawList->PopTextureID();
+	}
+
+	u32 GetSelectionModifiers(void)
+	{
+		ImGuiIO &io = GetIO();
+		return (io.KeyCtrl ? kSelection_Ctrl : 0u) | (io.KeyShift ? kSelection_Shift : 0u);
+	}
+
+	bool Selectable(const char *label, selection *sel, u32 item, ImGuiSelectableFlags flags, const ImVec2 &size)
+	{
+		if(Selectable(label, selection_contains(sel, item) != 0, flags, size)) {
+			selection_click(sel, item, GetSelectionModifiers());
+			return true;
+		}
+		return false;
+	}
+
+	bool SelectableWithBackground(const char *label, selection *sel, u32 item, const ImColor bgColor, ImGuiSelectableFlags flags, const ImVec2 &size_arg)
+	{
+		if(SelectableWithBackground(label, selection_contains(sel, item) != 0, bgColor, flags, size_arg)) {
+			selection_click(sel, item, GetSelectionModifiers());
+			return true;
+		}
+		return false;
+	}
+
+	bool SelectionKeyboardNav(selection *sel, u32 numItems, u32 pageItems)
+	{
+		if(!numItems)
+			return false;
+
+		if(GetIO().KeyCtrl && IsKeyPressed(ImGuiKey_A, false)) {
+			selection_select_all(sel, numItems);
+			return true;
+		}
+
+		verticalScrollDir_e dir = GetVerticalScrollDir();
+		if(dir == kVerticalScroll_None)
+			return false;
+
+		u32 last = numItems - 1;
+		u32 page = (pageItems > 1) ? pageItems - 1 : 1;
+		u32 cursor = sel->cursor;
+		u32 target;
+		if(cursor > last) {
+			target = (dir == kVerticalScroll_End) ? last : 0;
+		} else {
+			switch(dir) {
+			case kVerticalScroll_PageUp:
+				target = (cursor > page) ? cursor - page : 0;
+				break;
+			case kVerticalScroll_PageDown:
+				target = (last - cursor > page) ? cursor + page : last;
+				break;
+			case kVerticalScroll_Up:
+				target = (cursor > 0) ? cursor - 1 : 0;
+				break;
+			case kVerticalScroll_Down:
+				target = (cursor < last) ? cursor + 1 : last;
+				break;
+			case kVerticalScroll_Start:
+				target = 0;
+				break;
+			case kVerticalScroll_End:
+				target = last;
+				break;
+			case kVerticalScroll_None:
+			default:
+				target = cursor;
+				break;
+			}
+		}
+		selection_navigate(sel, target, GetSelectionModifiers());
+		return true;
+	}
+
 	void SetTextShadowColor(ImColor shadowColor)
 	{
 		s_shadowColor = shadowColor;
@@ -556,16 +848,53 @@ namespace ImGui
 		drawList->AddText(font, fontSize, ImVec2(pos.x + 1, pos.y + 1), s_shadowColor, text, text_display_end, wrap_width);
 	}
 
+	// Lays out the text once for the item size and once to draw it with its shadow, where TextShadow
+	// followed by TextUnformatted lays it out twice for each.
+	static void TextShadowedEx(const char *text, bool bWrapped, textShadowStyle_e style)
+	{
+		ImGuiWindow *window = GetCurrentWindow();
+		if(window->SkipItems)
+			return;
+
+		const bool pushWrapPos = bWrapped && window->DC.TextWrapPos < 0.0f;
+		if(pushWrapPos) {
+			PushTextWrapPos(0.0f);
+		}
+		const float wrapPosX = window->DC.TextWrapPos;
+		const float wrapWidth = (wrapPosX >= 0.0f) ? CalcWrapWidthForPos(window->DC.CursorPos, wrapPosX) : 0.0f;
+		const ImVec2 textPos(window->DC.CursorPos.x, window->DC.CursorPos.y + window->DC.CurrLineTextBaseOffset);
+		const ImVec2 textSize = CalcTextSize(text, nullptr, false, wrapWidth);
+		ImRect bb(textPos, textPos + textSize);
+		ItemSize(textSize, 0.0f);
+		if(ItemAdd(bb, 0)) {
+			AddTextShadowed(window->DrawList, GetFont(), GetFontSize(), textPos, GetColorU32(ImGuiCol_Text), s_shadowColor, text, nullptr, wrapWidth, style);
+		}
+		if(pushWrapPos) {
+			PopTextWrapPos();
+		}
+	}
+
 	void TextShadowed(const char *text)
 	{
-		TextShadow(text);
-		TextUnformatted(text);
+		if(Imgui_Core_GetTextShadows()) {
+			TextShadowedEx(text, false, kTextShadow_Drop);
+		} else {
+			TextUnformatted(text);
+		}
 	}
 
 	void TextWrappedShadowed(const char *text)
 	{
-		TextShadow(text, true, true);
-		TextWrapped("%s", text);
+		if(Imgui_Core_GetTextShadows()) {
+			TextShadowedEx(text, true, kTextShadow_Drop);
+		} else {
+			TextWrapped("%s", text);
+		}
+	}
+
+	void TextOutlined(const char *text)
+	{
+		TextShadowedEx(text, false, kTextShadow_Outline);
 	}
 
 	void DrawStrikethrough(const char *text, ImColor color, ImVec2 pos)
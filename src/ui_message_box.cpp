@@ -3,11 +3,13 @@
 
 #include "ui_message_box.h"
 
+#include "bb_array.h"
 #include "bb_string.h"
 #include "imgui_core.h"
 #include "imgui_utils.h"
 #include "message_box.h"
-#include "va.h"
+#include <stdio.h>
+#include <stdlib.h>
 
 // warning C4820 : 'StructName' : '4' bytes padding added after data member 'MemberName'
 // warning C4365: '=': conversion from 'ImGuiTabItemFlags' to 'ImGuiID', signed/unsigned mismatch
@@ -18,19 +20,175 @@ BB_WARNING_POP
 
 static int s_activeFrames;
 
-static bool UIMessageBox_DrawModal(messageBox *mb)
+enum {
+	kUIMessageBox_MaxButtons = 16,
+};
+
+// The active box of each queue, compiled once from its sdict when it becomes active, so drawing it
+// each frame does no lookups or formatting.  Strings point into the box's entries.  Compiling
+// stamps the box with a serial number, so a different box that lands on the same entries - after a
+// removal that didn't go through this file - is still recompiled.
+typedef struct tag_UIMessageBoxLayout {
+	const messageBoxes *boxes;
+	const sdictEntry_t *entries;
+	u32 entryCount;
+	u32 serialIndex; // entry holding serial, or entryCount if the stamp couldn't be added
+	u32 numButtons;
+	char serial[12];
+	const char *title;
+	const char *text;
+	char *titleLabel; // " [ title ] " for the inline renderer
+	char *textLabel;  // " text "
+	sdictEntry_t *inputNumber;
+	const char *buttons[kUIMessageBox_MaxButtons];
+} UIMessageBoxLayout;
+
+typedef struct tag_UIMessageBoxLayouts {
+	u32 count;
+	u32 allocated;
+	UIMessageBoxLayout *data;
+} UIMessageBoxLayouts;
+
+static UIMessageBoxLayouts s_layouts;
+static u32 s_layoutSerial;
+static const char *kUIMessageBox_SerialKey = "uiMessageBoxSerial";
+
+// Collects the values of button1..buttonN (stopping at the first missing number) in one pass over
+// the entries.
+static u32 UIMessageBox_GetButtons(const sdict_t *sd, const char **buttons)
 {
+	for(u32 i = 0; i < kUIMessageBox_MaxButtons; ++i) {
+		buttons[i] = nullptr;
+	}
+	for(u32 i = 0; i < sd->count; ++i) {
+		const char *key = sb_get(&sd->data[i].key);
+		if(strncmp(key, "button", 6) != 0 || key[6] < '1' || key[6] > '9')
+			continue;
+		char *end = nullptr;
+		unsigned long index = strtoul(key + 6, &end, 10);
+		if(*end || index > kUIMessageBox_MaxButtons || buttons[index - 1])
+			continue;
+		buttons[index - 1] = sb_get(&sd->data[i].value);
+	}
+	u32 count = 0;
+	while(count < kUIMessageBox_MaxButtons && buttons[count]) {
+		++count;
+	}
+	return count;
+}
+
+static char *UIMessageBox_Label(const char *prefix, const char *text, const char *suffix)
+{
+	size_t prefixLen = strlen(prefix);
+	size_t textLen = strlen(text);
+	size_t suffixLen = strlen(suffix);
+	char *label = (char *)malloc(prefixLen + textLen + suffixLen + 1);
+	if(label) {
+		memcpy(label, prefix, prefixLen);
+		memcpy(label + prefixLen, text, textLen);
+		memcpy(label + prefixLen + textLen, suffix, suffixLen + 1);
+	}
+	return label;
+}
+
+static void UIMessageBox_ResetLayout(UIMessageBoxLayout *layout)
+{
+	free(layout->titleLabel);
+	free(layout->textLabel);
+	layout->titleLabel = nullptr;
+	layout->textLabel = nullptr;
+}
+
+static void UIMessageBox_StampBox(UIMessageBoxLayout *layout, sdict_t *sd)
+{
+	snprintf(layout->serial, sizeof(layout->serial), "%u", ++s_layoutSerial);
+	sdictEntry_t *entry = sdict_find_entry(sd, kUIMessageBox_SerialKey);
+	if(entry) {
+		sb_reset(&entry->value);
+		sb_append(&entry->value, layout->serial);
+	} else {
+		sdict_add_raw(sd, kUIMessageBox_SerialKey, layout->serial);
+		entry = sdict_find_entry(sd, kUIMessageBox_SerialKey);
+	}
+	layout->serialIndex = entry ? (u32)(entry - sd->data) : sd->count;
+}
+
+static void UIMessageBox_CompileLayout(UIMessageBoxLayout *layout, messageBox *mb)
+{
+	const messageBoxes *boxes = layout->boxes;
+	UIMessageBox_ResetLayout(layout);
+	memset(layout, 0, sizeof(*layout));
+	layout->boxes = boxes;
 	sdict_t *sd = &mb->data;
-	const char *title = sdict_find(sd, "title");
-	if(!title)
+	UIMessageBox_StampBox(layout, sd);
+	layout->entries = sd->data;
+	layout->entryCount = sd->count;
+	layout->title = sdict_find(sd, "title");
+	layout->text = sdict_find(sd, "text");
+	layout->inputNumber = sdict_find_entry(sd, "inputNumber");
+	layout->titleLabel = layout->title ? UIMessageBox_Label(" [ ", layout->title, " ] ") : nullptr;
+	layout->textLabel = layout->text ? UIMessageBox_Label(" ", layout->text, " ") : nullptr;
+	layout->numButtons = UIMessageBox_GetButtons(sd, layout->buttons);
+}
+
+static bool UIMessageBox_IsLayoutCurrent(const UIMessageBoxLayout *layout, const messageBox *mb)
+{
+	const sdict_t *sd = &mb->data;
+	if(layout->entries != sd->data || layout->entryCount != sd->count || layout->serialIndex >= sd->count)
 		return false;
+	const sdictEntry_t *entry = sd->data + layout->serialIndex;
+	return !strcmp(sb_get(&entry->key), kUIMessageBox_SerialKey) && !strcmp(sb_get(&entry->value), layout->serial);
+}
 
-	const char *text = sdict_find(sd, "text");
-	if(text) {
-		ImGui::TextUnformatted(text);
+static UIMessageBoxLayout *UIMessageBox_GetLayout(messageBoxes *boxes, messageBox *mb)
+{
+	UIMessageBoxLayout *layout = nullptr;
+	for(u32 i = 0; i < s_layouts.count; ++i) {
+		if(s_layouts.data[i].boxes == boxes) {
+			layout = s_layouts.data + i;
+			break;
+		}
 	}
+	if(!layout) {
+		if(!bba_add_noclear(s_layouts, 1))
+			return nullptr;
+		layout = &bba_last(s_layouts);
+		memset(layout, 0, sizeof(*layout));
+		layout->boxes = boxes;
+	}
+	if(!UIMessageBox_IsLayoutCurrent(layout, mb)) {
+		UIMessageBox_CompileLayout(layout, mb);
+	}
+	return layout;
+}
+
+static void UIMessageBox_DropLayout(const messageBoxes *boxes)
+{
+	for(u32 i = 0; i < s_layouts.count; ++i) {
+		if(s_layouts.data[i].boxes == boxes) {
+			UIMessageBox_ResetLayout(s_layouts.data + i);
+			bba_erase(s_layouts, i);
+			return;
+		}
+	}
+}
+
+static void UIMessageBox_RemoveActive(messageBoxes *boxes)
+{
+	UIMessageBox_DropLayout(boxes);
+	mb_remove_active(boxes);
+}
 
-	sdictEntry_t *inputNumber = sdict_find_entry(sd, "inputNumber");
+static bool UIMessageBox_DrawModal(const UIMessageBoxLayout *layout, messageBox *mb)
+{
+	if(!layout->title)
+		return false;
+
+	if(layout->text) {
+		ImGui::TextUnformatted(layout->text);
+	}
+
+	sdictEntry_t *inputNumber = layout->inputNumber;
 	if(inputNumber) {
 		if(s_activeFrames < 3) {
 			ImGui::SetKeyboardFocusHere();
@@ -45,10 +203,9 @@ static bool UIMessageBox_DrawModal(messageBox *mb)
 		}
 	}
 
-	u32 buttonIndex = 0;
-	const char *button;
-	while((button = sdict_find(sd, va("button%u", ++buttonIndex))) != nullptr) {
-		if(buttonIndex == 1) {
+	for(u32 buttonIndex = 0; buttonIndex < layout->numButtons; ++buttonIndex) {
+		const char *button = layout->buttons[buttonIndex];
+		if(buttonIndex == 0) {
 			ImGui::Separator();
 		} else {
 			ImGui::SameLine();
@@ -77,7 +234,10 @@ static void UIMessageBox_UpdateModal(messageBoxes *boxes)
 	if(!mb)
 		return;
 
-	const char *title = sdict_find(&mb->data, "title");
+	UIMessageBoxLayout *layout = UIMessageBox_GetLayout(boxes, mb);
+	if(!layout)
+		return;
+	const char *title = layout->title;
 	if(!title) {
 		title = "Untitled";
 	}
@@ -94,36 +254,237 @@ static void UIMessageBox_UpdateModal(messageBoxes *boxes)
 			if(mb->callback) {
 				mb->callback(mb, "");
 			}
-			mb_remove_active(nullptr);
+			UIMessageBox_RemoveActive(boxes);
 			return;
 		}
 	}
 
 	++s_activeFrames;
-	if(!UIMessageBox_DrawModal(mb)) {
+	if(!UIMessageBox_DrawModal(layout, mb)) {
 		ImGui::CloseCurrentPopup();
-		mb_remove_active(nullptr);
+		UIMessageBox_RemoveActive(boxes);
 	}
 
 	ImGui::EndPopup();
 	return;
 }
 
+enum {
+	kUIMessageBox_MaxPostsPerUpdate = 256, // posts beyond this between updates are dropped
+	kUIMessageBox_MaxPending = 64,         // distinct notifications waiting to be shown
+};
+
+typedef struct tag_UIMessageBoxNotifyNode {
+	struct tag_UIMessageBoxNotifyNode *volatile next;
+	messageBox mb;
+	char *key;
+} UIMessageBoxNotifyNode;
+
+typedef struct tag_UIMessageBoxNotification {
+	messageBox mb;
+	char *key;
+	u32 count;
+	u8 pad[4];
+} UIMessageBoxNotification;
+
+typedef struct tag_UIMessageBoxNotifications {
+	u32 count;
+	u32 allocated;
+	UIMessageBoxNotification *data;
+} UIMessageBoxNotifications;
+
+// Posts travel through an intrusive MPSC queue: producers swap themselves in at head, and the UI
+// thread pops from tail.  The stub node keeps the queue from ever being empty, so producers never
+// touch tail.  The UI thread then merges posts with the same key into pending, and shows pending
+// notifications one at a time.
+typedef struct tag_UIMessageBoxNotifyQueue {
+	UIMessageBoxNotifyNode *volatile head;
+	UIMessageBoxNotifyNode *tail;
+	UIMessageBoxNotifyNode stub;
+	volatile LONG budget;  // posts left before the next update
+	volatile LONG dropped; // posts dropped by producers since the last update
+	UIMessageBoxNotifications pending;
+	u32 overflow; // notifications dropped since the last summary
+	u8 pad[4];
+} UIMessageBoxNotifyQueue;
+
+static UIMessageBoxNotifyQueue s_notify = { &s_notify.stub, &s_notify.stub, {}, kUIMessageBox_MaxPostsPerUpdate };
+
+static UIMessageBoxNotifyNode *UIMessageBox_NotifyNext(UIMessageBoxNotifyNode *node)
+{
+	return (UIMessageBoxNotifyNode *)InterlockedCompareExchangePointer((PVOID volatile *)&node->next, nullptr, nullptr);
+}
+
+static void UIMessageBox_NotifyPush(UIMessageBoxNotifyNode *node)
+{
+	node->next = nullptr;
+	UIMessageBoxNotifyNode *prev = (UIMessageBoxNotifyNode *)InterlockedExchangePointer((PVOID volatile *)&s_notify.head, node);
+	InterlockedExchangePointer((PVOID volatile *)&prev->next, node);
+}
+
+// UI thread only.  Returns null when empty, and also while a producer has swapped in at head but
+// not yet linked its node - that node is picked up by a later pop.
+static UIMessageBoxNotifyNode *UIMessageBox_NotifyPop(void)
+{
+	UIMessageBoxNotifyNode *tail = s_notify.tail;
+	UIMessageBoxNotifyNode *next = UIMessageBox_NotifyNext(tail);
+	if(tail == &s_notify.stub) {
+		if(!next)
+			return nullptr;
+		s_notify.tail = next;
+		tail = next;
+		next = UIMessageBox_NotifyNext(next);
+	}
+	if(next) {
+		s_notify.tail = next;
+		return tail;
+	}
+	if(tail != InterlockedCompareExchangePointer((PVOID volatile *)&s_notify.head, nullptr, nullptr))
+		return nullptr;
+	UIMessageBox_NotifyPush(&s_notify.stub);
+	next = UIMessageBox_NotifyNext(tail);
+	if(next) {
+		s_notify.tail = next;
+		return tail;
+	}
+	return nullptr;
+}
+
+void UIMessageBox_Notify(messageBox mb, const char *key)
+{
+	if(InterlockedDecrement(&s_notify.budget) < 0) {
+		InterlockedIncrement(&s_notify.dropped);
+		sdict_reset(&mb.data);
+		return;
+	}
+
+	UIMessageBoxNotifyNode *node = (UIMessageBoxNotifyNode *)calloc(1, sizeof(UIMessageBoxNotifyNode));
+	char *nodeKey = key ? UIMessageBox_Label("", key, "") : UIMessageBox_Label(sdict_find_safe(&mb.data, "title"), "\n", sdict_find_safe(&mb.data, "text"));
+	if(!node || !nodeKey) {
+		free(node);
+		free(nodeKey);
+		InterlockedIncrement(&s_notify.dropped);
+		sdict_reset(&mb.data);
+		return;
+	}
+	node->mb = mb;
+	node->key = nodeKey;
+	UIMessageBox_NotifyPush(node);
+}
+
+static void UIMessageBox_AddPending(messageBox mb, char *key)
+{
+	for(u32 i = 0; i < s_notify.pending.count; ++i) {
+		UIMessageBoxNotification *notification = s_notify.pending.data + i;
+		if(!strcmp(notification->key, key)) {
+			++notification->count;
+			sdict_reset(&mb.data);
+			free(key);
+			return;
+		}
+	}
+	if(s_notify.pending.count >= kUIMessageBox_MaxPending || !bba_add_noclear(s_notify.pending, 1)) {
+		++s_notify.overflow;
+		sdict_reset(&mb.data);
+		free(key);
+		return;
+	}
+	UIMessageBoxNotification *notification = &bba_last(s_notify.pending);
+	notification->mb = mb;
+	notification->key = key;
+	notification->count = 1;
+}
+
+static void UIMessageBox_AppendCount(messageBox *mb, u32 count)
+{
+	char suffix[64];
+	sdictEntry_t *text = sdict_find_entry(&mb->data, "text");
+	if(text) {
+		snprintf(suffix, sizeof(suffix), "\n(repeated %u times)", count);
+		sb_append(&text->value, suffix);
+	} else {
+		snprintf(suffix, sizeof(suffix), "Repeated %u times", count);
+		sdict_add_raw(&mb->data, "text", suffix);
+	}
+}
+
+// Merges posts into pending, then queues the oldest pending notification once no box is showing.
+// After pending empties, one box summarizes everything dropped along the way.
+static void UIMessageBox_UpdateNotifications(messageBoxes *boxes)
+{
+	UIMessageBoxNotifyNode *node;
+	while((node = UIMessageBox_NotifyPop()) != nullptr) {
+		UIMessageBox_AddPending(node->mb, node->key);
+		free(node);
+	}
+	InterlockedExchange(&s_notify.budget, kUIMessageBox_MaxPostsPerUpdate);
+	s_notify.overflow += (u32)InterlockedExchange(&s_notify.dropped, 0);
+
+	if(mb_get_active(boxes))
+		return;
+
+	if(s_notify.pending.count) {
+		UIMessageBoxNotification notification = s_notify.pending.data[0];
+		bba_erase(s_notify.pending, 0);
+		free(notification.key);
+		if(notification.count > 1) {
+			UIMessageBox_AppendCount(&notification.mb, notification.count);
+		}
+		mb_queue(notification.mb, boxes);
+	} else if(s_notify.overflow) {
+		char text[128];
+		snprintf(text, sizeof(text), "%u more notifications were dropped.", s_notify.overflow);
+		s_notify.overflow = 0;
+		messageBox mb = {};
+		sdict_add_raw(&mb.data, "title", "Notifications");
+		sdict_add_raw(&mb.data, "text", text);
+		sdict_add_raw(&mb.data, "button1", "Ok");
+		mb_queue(mb, boxes);
+	}
+}
+
+void UIMessageBox_NotifyShutdown(void)
+{
+	UIMessageBoxNotifyNode *node;
+	while((node = UIMessageBox_NotifyPop()) != nullptr) {
+		sdict_reset(&node->mb.data);
+		free(node->key);
+		free(node);
+	}
+	for(u32 i = 0; i < s_notify.pending.count; ++i) {
+		sdict_reset(&s_notify.pending.data[i].mb.data);
+		free(s_notify.pending.data[i].key);
+	}
+	bba_free(s_notify.pending);
+	s_notify.overflow = 0;
+}
+
 float UIMessageBox_Update(messageBoxes *boxes)
 {
 	if(!boxes) {
 		boxes = mb_get_queue();
 	}
 
+	if(boxes == mb_get_queue()) {
+		UIMessageBox_UpdateNotifications(boxes);
+	}
+
 	messageBox *mb = mb_get_active(boxes);
-	if(!mb)
+	if(!mb) {
+		// drop the layout of a box removed without going through this file
+		UIMessageBox_DropLayout(boxes);
 		return 0.0f;
+	}
 
 	if(boxes->modal) {
 		UIMessageBox_UpdateModal(boxes);
 		return 0.0f;
 	}
 
+	UIMessageBoxLayout *layout = UIMessageBox_GetLayout(boxes, mb);
+	if(!layout)
+		return 0.0f;
+
 	b32 bRemove = false;
 
 	ImVec2 region = ImGui::GetContentRegionAvail();
@@ -140,17 +501,16 @@ float UIMessageBox_Update(messageBoxes *boxes)
 
 	ImGui::BeginGroup();
 	ImGui::Spacing();
-	sdict_t *sd = &mb->data;
-	const char *title = sdict_find(&mb->data, "title");
-	if(title) {
+	if(layout->titleLabel) {
 		ImGui::AlignTextToFramePadding();
-		ImGui::Text(" [ %s ] ", title);
+		ImGui::TextUnformatted(layout->titleLabel);
 		ImGui::SameLine();
 	}
 
-	const char *text = sdict_find(&mb->data, "text");
-	if(text) {
-		ImGui::TextWrapped(" %s ", text);
+	if(layout->textLabel) {
+		ImGui::PushTextWrapPos(0.0f);
+		ImGui::TextUnformatted(layout->textLabel);
+		ImGui::PopTextWrapPos();
 		ImGui::SameLine();
 	}
 
@@ -159,10 +519,9 @@ float UIMessageBox_Update(messageBoxes *boxes)
 		ImGui::NewLine();
 	}
 
-	u32 buttonIndex = 0;
-	const char *button;
-	while((button = sdict_find(sd, va("button%u", ++buttonIndex))) != nullptr) {
-		if(buttonIndex > 1) {
+	for(u32 buttonIndex = 0; buttonIndex < layout->numButtons; ++buttonIndex) {
+		const char *button = layout->buttons[buttonIndex];
+		if(buttonIndex > 0) {
 			ImGui::SameLine();
 		}
 		if(ImGui::Button(button, ImVec2(120 * Imgui_Core_GetDpiScale(), 0.0f))) {
@@ -197,7 +556,7 @@ float UIMessageBox_Update(messageBoxes *boxes)
 	bottomRight->pos.y = endY - ImGui::GetStyle().ItemSpacing.y;
 
 	if(bRemove) {
-		mb_remove_active(boxes);
+		UIMessageBox_RemoveActive(boxes);
 	}
 
 	return endY - start.y;